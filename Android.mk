@@ -20,6 +20,7 @@ LOCAL_SRC_FILES := \
 	src/gl/arbhelper.c \
 	src/gl/arbparser.c \
 	src/gl/array.c \
+	src/gl/array_simd.c \
 	src/gl/blend.c \
 	src/gl/blit.c \
 	src/gl/buffers.c \
@@ -35,12 +36,14 @@ LOCAL_SRC_FILES := \
 	src/gl/face.c \
 	src/gl/fog.c \
 	src/gl/fpe.c \
+	src/gl/fpe_prewarm.c \
 	src/gl/fpe_cache.c \
 	src/gl/fpe_shader.c \
 	src/gl/framebuffers.c \
 	src/gl/gl_lookup.c \
 	src/gl/getter.c \
 	src/gl/gl4es.c \
+	src/gl/gleshard.c \
 	src/gl/glstate.c \
 	src/gl/hint.c \
 	src/gl/init.c \
@@ -48,6 +51,7 @@ LOCAL_SRC_FILES := \
 	src/gl/line.c \
 	src/gl/list.c \
 	src/gl/listdraw.c \
+	src/gl/listopt.c \
 	src/gl/listrl.c \
 	src/gl/loader.c \
 	src/gl/logs.c \
@@ -55,6 +59,8 @@ LOCAL_SRC_FILES := \
 	src/gl/matvec.c \
 	src/gl/oldprogram.c \
 	src/gl/pixel.c \
+	src/gl/pixel_pool.c \
+	src/gl/pixel_simd.c \
 	src/gl/planes.c \
 	src/gl/pointsprite.c \
 	src/gl/preproc.c \
@@ -64,6 +70,7 @@ LOCAL_SRC_FILES := \
 	src/gl/render.c \
 	src/gl/samplers.c \
 	src/gl/shader.c \
+	src/gl/shader_cache.c \
 	src/gl/shaderconv.c \
 	src/gl/shader_hacks.c \
 	src/gl/stack.c \
@@ -77,6 +84,8 @@ LOCAL_SRC_FILES := \
 	src/gl/texture_params.c \
 	src/gl/texture_read.c \
 	src/gl/texture_3d.c \
+	src/gl/texupload.c \
+	src/gl/texres.c \
 	src/gl/uniform.c \
 	src/gl/vertexattrib.c \
 	src/gl/wrap/gl4eswraps.c \
@@ -0,0 +1,225 @@
+/*
+  arraybench: measures the conversion of client vertex arrays to float done by
+  gl4es on each draw (copy_gl_pointer_*), against the plain C loops that were
+  used before the SIMD kernels, and checks that both give the same results.
+
+  usage: arraybench [-n loops] [-v vertices]
+    -n : number of timed loops (default 2000)
+    -v : number of vertices in the arrays (default 4096)
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl/array.h"
+#include "gl/const.h"
+
+// stubs, only used for error messages
+void LogPrintf(const char *fmt,...) {}
+const char* PrintEnum(GLenum what) { return "?"; }
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+// reference: the scalar loops of copy_gl_array / copy_gl_array_texcoord / copy_gl_array_quickconvert / copy_gl_array_bgra
+static void ref_float(GLfloat *out, const char *in, int stride, int width, int to_width, int count, const GLfloat *pad)
+{
+    for (int i=0; i<count; ++i, in+=stride, out+=to_width) {
+        const GLfloat *f = (const GLfloat*)in;
+        int j;
+        for (j=0; j<width; ++j) out[j] = f[j];
+        for (; j<to_width; ++j) out[j] = pad[j];
+    }
+}
+static void ref_double(GLfloat *out, const char *in, int stride, int width, int to_width, int count, const GLfloat *pad)
+{
+    for (int i=0; i<count; ++i, in+=stride, out+=to_width) {
+        const GLdouble *d = (const GLdouble*)in;
+        int j;
+        for (j=0; j<width; ++j) out[j] = d[j];
+        for (; j<to_width; ++j) out[j] = pad[j];
+    }
+}
+static void ref_ubyte(GLfloat *out, const char *in, int stride, int count)
+{
+    const GLfloat maxf = 1.0f/255;
+    for (int i=0; i<count; ++i, in+=stride, out+=4)
+        for (int j=0; j<4; ++j) out[j] = ((GLfloat)((const GLubyte*)in)[j])*maxf;
+}
+static void ref_ushort(GLfloat *out, const char *in, int stride, int count)
+{
+    const GLfloat maxf = 1.0f/65535;
+    for (int i=0; i<count; ++i, in+=stride, out+=4)
+        for (int j=0; j<4; ++j) out[j] = ((GLfloat)((const GLushort*)in)[j])*maxf;
+}
+static void ref_bgra(GLfloat *out, const char *in, int stride, int count)
+{
+    static const float d = 1.0f/255.0f;
+    for (int i=0; i<count; ++i, in+=stride) {
+        const GLubyte *s = (const GLubyte*)in;
+        *out++ = s[2]*d; *out++ = s[1]*d; *out++ = s[0]*d; *out++ = s[3]*d;
+    }
+}
+
+typedef enum {
+    K_RAW = 0,      // copy_gl_pointer_raw (pad 0)
+    K_TEX,          // copy_gl_pointer_tex (pad 0,0,0,1)
+    K_COLOR,        // copy_gl_pointer_color
+    K_BGRA          // copy_gl_pointer_color_bgra
+} kind_t;
+
+typedef struct {
+    const char* name;
+    kind_t      kind;
+    GLenum      type;
+    int         size;
+    int         stride;     // 0 for packed
+    int         to_width;
+} case_t;
+
+static const case_t cases[] = {
+    {"float3 -> vec4 (vertex)",         K_RAW,   GL_FLOAT,          3, 0,  4},
+    {"float3 interleaved -> vec4",      K_RAW,   GL_FLOAT,          3, 32, 4},
+    {"float2 interleaved -> vec2 (tex)",K_TEX,   GL_FLOAT,          2, 32, 2},
+    {"float2 -> vec4 (tex)",            K_TEX,   GL_FLOAT,          2, 0,  4},
+    {"float4 interleaved -> vec4",      K_RAW,   GL_FLOAT,          4, 36, 4},
+    {"double3 -> vec4 (vertex)",        K_RAW,   GL_DOUBLE,         3, 0,  4},
+    {"double2 -> vec4 (tex)",           K_TEX,   GL_DOUBLE,         2, 0,  4},
+    {"ubyte4 -> vec4 (color)",          K_COLOR, GL_UNSIGNED_BYTE,  4, 0,  4},
+    {"ubyte4 interleaved -> vec4",      K_COLOR, GL_UNSIGNED_BYTE,  4, 24, 4},
+    {"ushort4 -> vec4 (color)",         K_COLOR, GL_UNSIGNED_SHORT, 4, 0,  4},
+    {"ubyte BGRA -> vec4 (color)",      K_BGRA,  GL_UNSIGNED_BYTE,  4, 0,  4},
+};
+#define NCASES (sizeof(cases)/sizeof(cases[0]))
+
+static void run_ref(const case_t *c, GLfloat *out, const char *in, int count)
+{
+    static const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    static const GLfloat tex[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    int stride = c->stride?c->stride:c->size*(c->type==GL_DOUBLE?8:(c->type==GL_FLOAT?4:(c->type==GL_UNSIGNED_SHORT?2:1)));
+    switch(c->kind) {
+        case K_RAW:
+        case K_TEX:
+            if(c->type==GL_FLOAT)
+                ref_float(out, in, stride, c->size, c->to_width, count, c->kind==K_TEX?tex:zero);
+            else
+                ref_double(out, in, stride, c->size, c->to_width, count, c->kind==K_TEX?tex:zero);
+            break;
+        case K_COLOR:
+            if(c->type==GL_UNSIGNED_BYTE)
+                ref_ubyte(out, in, stride, count);
+            else
+                ref_ushort(out, in, stride, count);
+            break;
+        case K_BGRA:
+            ref_bgra(out, in, stride, count);
+            break;
+    }
+}
+
+static void run_new(const case_t *c, GLfloat *out, const char *in, int count)
+{
+    vertexattrib_t ptr = {0};
+    ptr.size = c->size;
+    ptr.type = c->type;
+    ptr.stride = c->stride;
+    ptr.pointer = in;
+    switch(c->kind) {
+        case K_RAW:   copy_gl_pointer_raw_noalloc(out, &ptr, c->to_width, 0, count); break;
+        case K_TEX:   copy_gl_pointer_tex_noalloc(out, &ptr, c->to_width, 0, count); break;
+        case K_COLOR: copy_gl_pointer_color_noalloc(out, &ptr, c->to_width, 0, count); break;
+        case K_BGRA:  copy_gl_pointer_color_bgra_noalloc(out, in, c->stride, 4, 0, count); break;
+    }
+}
+
+// the input is sized exactly, so reading past the last vertex would be seen by ASan / valgrind
+static char* make_input(const case_t *c, int count)
+{
+    int esize = c->size*(c->type==GL_DOUBLE?8:(c->type==GL_FLOAT?4:(c->type==GL_UNSIGNED_SHORT?2:1)));
+    int stride = c->stride?c->stride:esize;
+    size_t len = (size_t)(count-1)*stride+esize;
+    char *in = (char*)malloc(len);
+    for (size_t i=0; i<len; ++i)
+        in[i] = (char)rand();
+    // keep float / double sane (no NaN, so memcmp can be used)
+    for (int i=0; i<count; ++i)
+        for (int j=0; j<c->size; ++j) {
+            if(c->type==GL_FLOAT) {
+                GLfloat f = (rand()-RAND_MAX/2)*(1.0f/1024.0f);
+                memcpy(in+i*stride+j*4, &f, 4);
+            } else if(c->type==GL_DOUBLE) {
+                GLdouble d = (rand()-RAND_MAX/2)*(1.0/3000.0);
+                memcpy(in+i*stride+j*8, &d, 8);
+            }
+        }
+    return in;
+}
+
+// compare on small counts too, to check the scalar tails
+static int check(const case_t *c)
+{
+    static const int counts[] = {1, 2, 3, 4, 5, 7, 64, 1001};
+    int ret = 0;
+    for (int k=0; k<sizeof(counts)/sizeof(counts[0]); ++k) {
+        int count = counts[k];
+        char *in = make_input(c, count);
+        GLfloat *a = (GLfloat*)malloc(count*c->to_width*sizeof(GLfloat));
+        GLfloat *b = (GLfloat*)malloc(count*c->to_width*sizeof(GLfloat));
+        run_ref(c, a, in, count);
+        run_new(c, b, in, count);
+        if(memcmp(a, b, count*c->to_width*sizeof(GLfloat))) {
+            printf("error: %s differs from reference with %d vertices\n", c->name, count);
+            ret = 1;
+        }
+        free(a); free(b); free(in);
+    }
+    return ret;
+}
+
+int main(int argc, char** argv)
+{
+    int loops = 2000;
+    int count = 4096;
+    for (int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "-n") && i+1<argc)
+            loops = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-v") && i+1<argc)
+            count = atoi(argv[++i]);
+        else {
+            printf("usage: %s [-n loops] [-v vertices]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(loops<1 || count<1) {
+        printf("invalid parameters\n");
+        return 1;
+    }
+    int ret = 0;
+    printf("%d vertices, %d loops\n", count, loops);
+    printf("%-34s %12s %12s %8s\n", "array", "C ns/vert", "new ns/vert", "speedup");
+    for (int k=0; k<NCASES; ++k) {
+        const case_t *c = cases+k;
+        ret |= check(c);
+        char *in = make_input(c, count);
+        GLfloat *out = (GLfloat*)malloc(count*c->to_width*sizeof(GLfloat));
+        double t = now();
+        for (int l=0; l<loops; ++l)
+            run_ref(c, out, in, count);
+        double tref = now()-t;
+        t = now();
+        for (int l=0; l<loops; ++l)
+            run_new(c, out, in, count);
+        double tnew = now()-t;
+        double n = (double)loops*count;
+        printf("%-34s %12.3f %12.3f %7.2fx\n", c->name, tref*1e9/n, tnew*1e9/n, tref/tnew);
+        free(out);
+        free(in);
+    }
+    return ret;
+}
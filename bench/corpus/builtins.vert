@@ -0,0 +1,15 @@
+#version 120
+// simple vertex shader using gl_Color in a comment
+varying vec3 normal;
+uniform float scale;
+void main()
+{
+    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+    gl_TexCoord[1] = gl_MultiTexCoord1;
+    gl_FrontColor = gl_Color;
+    normal = normalize(gl_NormalMatrix * gl_Normal);
+    vec4 ecPos = gl_ModelViewMatrix * gl_Vertex;
+    gl_FogFragCoord = abs(ecPos.z);
+    gl_Position = ftransform();
+    gl_PointSize = 2.0f*scale;
+}
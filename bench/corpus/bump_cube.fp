@@ -0,0 +1,19 @@
+!!ARBfp1.0
+# normal map, cube map reflection, and a projected shadow map
+PARAM lightColor = program.env[0];
+PARAM reflectFactor = program.local[1];
+TEMP normal, light, ndotl, refl, shadow, col;
+TEX normal, fragment.texcoord[0], texture[0], 2D;
+MAD normal.xyz, normal, 2.0, -1.0;
+DP3 light.w, fragment.texcoord[1], fragment.texcoord[1];
+RSQ light.w, light.w;
+MUL light.xyz, fragment.texcoord[1], light.w;
+DP3_SAT ndotl, normal, light;
+TEX refl, fragment.texcoord[2], texture[1], CUBE;
+TXP shadow, fragment.texcoord[3], texture[2], 2D;
+MUL col, lightColor, ndotl;
+MUL col, col, shadow.x;
+MAD col.rgb, refl, reflectFactor.x, col;
+POW col.a, ndotl.x, reflectFactor.y;
+MOV result.color, col;
+END
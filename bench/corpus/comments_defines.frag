@@ -0,0 +1,11 @@
+#version 120
+/* comment with gl_TexCoord[7] and max(1,2) */
+#define SCALE 2.0f
+varying vec2 uv;
+precision highp float;
+vec4 helper(vec4 v) { return v*SCALE; }
+void main() {
+  vec4 c = helper(gl_TexCoord[0]);
+  c += gl_TexCoord[3];
+  gl_FragColor = c + gl_BackLightModelProduct.sceneColor + gl_BackMaterial.specular;
+}
@@ -0,0 +1,8 @@
+uniform int i;
+varying vec2 uv;
+void main() {
+  uv = (gl_TextureMatrix[i] * gl_MultiTexCoord2).xy + vec2(float(gl_InstanceIDARB));
+  gl_TexCoord[i] = gl_MultiTexCoord3;
+  gl_Position = gl_ModelViewProjectionMatrixInverseTranspose * gl_Vertex + gl_TextureMatrixInverse[1][0];
+  gl_FrontColor = vec4(gl_FogCoord);
+}
@@ -0,0 +1,8 @@
+// FPE_Shader generated
+varying lowp vec4 Color;
+uniform highp mat4 _gl4es_ModelViewProjectionMatrix;
+attribute highp vec4 _gl4es_Vertex;
+void main() {
+gl_Position = _gl4es_ModelViewProjectionMatrix * _gl4es_Vertex;
+Color = vec4(1.0);
+}
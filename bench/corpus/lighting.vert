@@ -0,0 +1,17 @@
+#version 110
+varying vec4 diffuse, ambient;
+varying vec3 normal, lightDir, halfVector;
+void main()
+{
+    normal = normalize(gl_NormalMatrix * gl_Normal);
+    for(int i=0; i<gl_MaxLights; ++i) {
+        lightDir += normalize(vec3(gl_LightSource[i].position));
+    }
+    halfVector = normalize(gl_LightSource[0].halfVector.xyz);
+    diffuse = gl_FrontMaterial.diffuse * gl_LightSource[0].diffuse;
+    ambient = gl_FrontMaterial.ambient * gl_LightSource[0].ambient;
+    ambient += gl_LightModel.ambient * gl_FrontMaterial.ambient + gl_FrontLightProduct[0].ambient;
+    ambient += gl_FrontLightModelProduct.sceneColor;
+    gl_Position = gl_ProjectionMatrix * gl_ModelViewMatrix * gl_Vertex;
+    gl_ClipVertex = gl_ModelViewMatrix * gl_Vertex;
+}
@@ -0,0 +1,18 @@
+#version 120
+#extension GL_ARB_shader_texture_lod : enable
+precision mediump float;
+uniform sampler2D tex;
+uniform samplerCube cube;
+centroid varying vec2 uv;
+varying vec3 dir;
+uniform mat2x2 rot;
+uniform mat3x3 m3;
+void main()
+{
+    vec2 d = dFdx(uv) + dFdy(uv);
+    float w = fwidth(uv.x);
+    vec4 c = texture2DLod(tex, rot*uv, 2.0) + textureCube(cube, transpose(m3)*dir);
+    c += texture2DGradARB(tex, uv, d, d) + textureCubeLod(cube, dir, 1.5f);
+    gl_FragDepth = gl_FragCoord.z*.5f+1e-3;
+    gl_FragColor = c*w + vec4(1.f, 2.0F, 0x1f, 3);
+}
@@ -0,0 +1,8 @@
+uniform int idx;
+void main() {
+    vec4 c = gl_ProgramEnv[idx] + texture2D(gl_Sampler2D_0, gl_TexCoord[0].xy) + textureCube(gl_SamplerCube_2, gl_TexCoord[2].xyz);
+    c += gl_TextureEnvColor[0] * gl_ClipPlane[0] + gl_EyePlaneS[0] + gl_ObjectPlaneT[1];
+    c.a += float(gl_MaxTextureUnits) + gl_Point.size + gl_NormalScale;
+    gl_FragData[0] = c * gl_SecondaryColor;
+    gl_FragData[1] = gl_Color;
+}
@@ -0,0 +1,9 @@
+// ARB-like program
+attribute vec4 gl_VertexAttrib_0;
+void main() {
+    vec4 t = gl_ProgramEnv[0] + gl_ProgramEnv[3] + gl_ProgramLocal[1];
+    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex + t + gl_VertexAttrib_1;
+    gl_TexCoord[0] = gl_MultiTexCoord0 * gl_ProgramLocal[12];
+    gl_BackColor = gl_SecondaryColor;
+    gl_FrontSecondaryColor = gl_SecondaryColor;
+}
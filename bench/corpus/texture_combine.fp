@@ -0,0 +1,17 @@
+!!ARBfp1.0
+# two textures, detail blend, alpha kill and linear fog
+OPTION ARB_precision_hint_fastest;
+OPTION ARB_fog_linear;
+PARAM detail = program.local[0];
+PARAM envColor = program.env[2];
+TEMP base, det, col;
+TEX base, fragment.texcoord[0], texture[0], 2D;
+TEX det, fragment.texcoord[1], texture[1], 2D;
+MAD det, det, 2.0, -1.0;
+MAD col, det, detail.x, base;
+MUL col, col, fragment.color;
+LRP col.rgb, envColor.a, envColor, col;
+SUB det.a, col.a, 0.5;
+KIL det.a;
+MOV result.color, col;
+END
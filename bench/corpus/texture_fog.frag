@@ -0,0 +1,13 @@
+uniform sampler2D tex;
+uniform sampler2D tex1;
+varying vec3 normal;
+void main()
+{
+    vec4 c = texture2D(tex, gl_TexCoord[0].xy) * gl_Color;
+    c.rgb *= texture2D(tex1, gl_TexCoord[1].xy).rgb;
+    float l = pow(max(dot(normal, vec3(0.0,0.0,1.0)), 0.0), 2.0f);
+    float f = clamp((gl_Fog.end - gl_FogFragCoord) * gl_Fog.scale, 0.0, 1);
+    c.rgb = mix(gl_Fog.color.rgb, c.rgb*l, f);
+    c.a = mod(c.a, 1);
+    gl_FragColor = min(c, 1.0f);
+}
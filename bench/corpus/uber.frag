@@ -0,0 +1,51 @@
+#version 120
+// matching fragment shader: parallax, 3 lights, PCF shadows, detail texture and fog
+uniform sampler2D diffuseMap;
+uniform sampler2D normalMap;
+uniform sampler2D detailMap;
+uniform sampler2DShadow shadowMap;
+uniform int numLights;
+uniform float parallaxScale;
+uniform vec2 shadowTexel;
+varying vec3 eyeVec;
+varying vec3 lightVec[3];
+varying vec4 shadowCoord;
+varying float fogFactor;
+
+float pcf(vec4 sc)
+{
+    float s = 0.0;
+    for(int y=-1; y<=1; ++y)
+        for(int x=-1; x<=1; ++x)
+            s += shadow2DProj(shadowMap, sc + vec4(vec2(x, y)*shadowTexel*sc.w, 0.0, 0.0)).r;
+    return s/9.0;
+}
+
+void main()
+{
+    vec3 e = normalize(eyeVec);
+    vec2 uv = gl_TexCoord[0].st;
+    float h = texture2D(normalMap, uv).a*parallaxScale - parallaxScale*0.5;
+    uv += e.xy*h;
+    vec4 base = texture2D(diffuseMap, uv);
+    base.rgb *= texture2D(detailMap, gl_TexCoord[1].st*8.0).rgb*2.0;
+    vec3 n = normalize(texture2D(normalMap, uv).xyz*2.0-1.0);
+    vec3 diffuse = gl_LightModel.ambient.rgb;
+    vec3 specular = vec3(0.0);
+    float shadow = pcf(shadowCoord);
+    for(int i=0; i<3; ++i) {
+        if(i>=numLights)
+            break;
+        vec3 l = normalize(lightVec[i]);
+        float att = 1.0/(gl_LightSource[i].constantAttenuation + gl_LightSource[i].linearAttenuation*length(lightVec[i]));
+        float ndotl = max(dot(n, l), 0.0);
+        float lshadow = (i==0)?shadow:1.0;
+        diffuse += gl_LightSource[i].diffuse.rgb*ndotl*att*lshadow;
+        vec3 r = reflect(-l, n);
+        specular += gl_LightSource[i].specular.rgb*pow(max(dot(r, e), 0.0), gl_FrontMaterial.shininess)*att*lshadow;
+    }
+    vec4 c = vec4(base.rgb*diffuse*gl_Color.rgb + specular + gl_SecondaryColor.rgb, base.a*gl_Color.a);
+    if(c.a<0.1f)
+        discard;
+    gl_FragColor = vec4(mix(gl_Fog.color.rgb, c.rgb, fogFactor), c.a);
+}
@@ -0,0 +1,59 @@
+#version 120
+// typical "uber" vertex shader of an old engine: skinning, lights, fog, shadow coords
+#define MAX_BONES 32
+uniform vec4 bones[MAX_BONES*3];
+uniform int numLights;
+uniform mat4 shadowMatrix;
+uniform float time;
+attribute vec4 boneWeights;
+attribute vec4 boneIndices;
+attribute vec3 tangent;
+varying vec3 eyeVec;
+varying vec3 lightVec[3];
+varying vec4 shadowCoord;
+varying float fogFactor;
+
+vec4 skin(vec4 v)
+{
+    vec4 r = vec4(0.0);
+    for(int i=0; i<4; ++i) {
+        int b = int(boneIndices[i])*3;
+        vec4 p;
+        p.x = dot(bones[b+0], v);
+        p.y = dot(bones[b+1], v);
+        p.z = dot(bones[b+2], v);
+        p.w = 1.0;
+        r += p*boneWeights[i];
+    }
+    return r;
+}
+
+vec3 skinNormal(vec3 n)
+{
+    int b = int(boneIndices.x)*3;
+    return vec3(dot(bones[b+0].xyz, n), dot(bones[b+1].xyz, n), dot(bones[b+2].xyz, n));
+}
+
+void main()
+{
+    vec4 pos = skin(gl_Vertex);
+    pos.xyz += gl_Normal*0.01*sin(time+pos.y);
+    vec3 n = normalize(gl_NormalMatrix * skinNormal(gl_Normal));
+    vec3 t = normalize(gl_NormalMatrix * skinNormal(tangent));
+    vec3 b = cross(n, t);
+    vec4 ecPos = gl_ModelViewMatrix * pos;
+    vec3 v = -ecPos.xyz;
+    eyeVec = vec3(dot(v, t), dot(v, b), dot(v, n));
+    for(int i=0; i<3; ++i) {
+        vec3 l = gl_LightSource[i].position.xyz - ecPos.xyz*gl_LightSource[i].position.w;
+        lightVec[i] = vec3(dot(l, t), dot(l, b), dot(l, n));
+    }
+    shadowCoord = shadowMatrix * pos;
+    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+    gl_TexCoord[1] = gl_MultiTexCoord1;
+    gl_FrontColor = gl_Color * gl_FrontMaterial.diffuse;
+    gl_FrontSecondaryColor = gl_FrontLightModelProduct.sceneColor;
+    fogFactor = clamp((gl_Fog.end - length(ecPos.xyz)) * gl_Fog.scale, 0.0, 1.0);
+    gl_ClipVertex = ecPos;
+    gl_Position = gl_ProjectionMatrix * ecPos;
+}
@@ -0,0 +1,282 @@
+/*
+  pixelbench: measures the pixel format conversions done by gl4es on texture
+  uploads (pixel_convert), for each (format, type) pair that has a specialized
+  row kernel, against the plain C version of the kernel, and checks that both
+  give the same results. The last column is pixel_convert with the worker
+  threads of LIBGL_TEXTHREADS, the scalings are measured the same way. The
+  mipmap chains (pixel_mipmaps) are measured against a level by level build
+  with the plain C box filter kernels.
+
+  usage: pixelbench [-n loops] [-s size] [-t threads]
+    -n : number of timed conversions of the image (default 50)
+    -s : width and height of the image (default 1024)
+    -t : worker threads (default -1: one per other core, 0: no threads)
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl/const.h"
+#include "gl/enum_info.h"
+#include "gl/glstate.h"
+#include "gl/init.h"
+#include "gl/pixel.h"
+#include "gl/pixel_pool.h"
+#include "gl/pixel_simd.h"
+
+// stubs, glstate is only used for GL_COLOR_INDEX and the others for error messages
+glstate_t *glstate = NULL;
+globals4es_t globals4es = {0};
+void LogPrintf(const char *fmt,...) {}
+void LogFPrintf(FILE *fp, const char *fmt,...) {}
+const char* PrintEnum(GLenum what) { return "?"; }
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+typedef struct {
+    const char* name;
+    GLenum      src_format, src_type;
+    GLenum      dst_format, dst_type;
+} case_t;
+
+#define UB GL_UNSIGNED_BYTE
+static const case_t cases[] = {
+    {"BGRA8 -> RGBA8",          GL_BGRA,    UB, GL_RGBA,    UB},
+    {"RGB8 -> RGBA8",           GL_RGB,     UB, GL_RGBA,    UB},
+    {"BGR8 -> RGBA8",           GL_BGR,     UB, GL_RGBA,    UB},
+    {"L8 -> RGBA8",             GL_LUMINANCE, UB, GL_RGBA,  UB},
+    {"LA8 -> RGBA8",            GL_LUMINANCE_ALPHA, UB, GL_RGBA, UB},
+    {"RGBA8 -> RGB8",           GL_RGBA,    UB, GL_RGB,     UB},
+    {"RGBA8 -> LA8",            GL_RGBA,    UB, GL_LUMINANCE_ALPHA, UB},
+    {"RGBA8 -> RGB565",         GL_RGBA,    UB, GL_RGB,     GL_UNSIGNED_SHORT_5_6_5},
+    {"BGRA8 -> RGB565",         GL_BGRA,    UB, GL_RGB,     GL_UNSIGNED_SHORT_5_6_5},
+    {"RGB8 -> RGB565",          GL_RGB,     UB, GL_RGB,     GL_UNSIGNED_SHORT_5_6_5},
+    {"RGBA8 -> RGBA4444",       GL_RGBA,    UB, GL_RGBA,    GL_UNSIGNED_SHORT_4_4_4_4},
+    {"BGRA8 -> RGBA4444",       GL_BGRA,    UB, GL_RGBA,    GL_UNSIGNED_SHORT_4_4_4_4},
+    {"RGBA8 -> RGBA5551",       GL_RGBA,    UB, GL_RGBA,    GL_UNSIGNED_SHORT_5_5_5_1},
+    {"BGRA8 -> RGBA5551",       GL_BGRA,    UB, GL_RGBA,    GL_UNSIGNED_SHORT_5_5_5_1},
+    {"RGBA5551 -> RGBA8",       GL_RGBA,    GL_UNSIGNED_SHORT_5_5_5_1, GL_RGBA, UB},
+    {"RGBA32F -> RGBA16F",      GL_RGBA,    GL_FLOAT, GL_RGBA, GL_HALF_FLOAT_OES},
+    {"RGB32F -> RGB16F",        GL_RGB,     GL_FLOAT, GL_RGB,  GL_HALF_FLOAT_OES},
+    {"RGBA16F -> RGBA32F",      GL_RGBA,    GL_HALF_FLOAT_OES, GL_RGBA, GL_FLOAT},
+};
+#undef UB
+#define NCASES (sizeof(cases)/sizeof(cases[0]))
+
+static GLvoid* make_input(const case_t *c, int width, int height)
+{
+    size_t len = (size_t)width*height*pixel_sizeof(c->src_format, c->src_type);
+    GLubyte *in = (GLubyte*)malloc(len);
+    for (size_t i=0; i<len; ++i)
+        in[i] = (GLubyte)rand();
+    if(c->src_type==GL_FLOAT) {
+        // values around the half float range, with some out of it
+        GLfloat *f = (GLfloat*)in;
+        for (size_t i=0; i<len/sizeof(GLfloat); ++i)
+            f[i] = (rand()-RAND_MAX/2)*(1.0f/8192.0f);
+    }
+    return in;
+}
+
+// row by row, with the scalar kernel
+static void run_ref(const case_t *c, pixel_row_t row_c, const GLvoid *in, GLvoid *out, int width, int height)
+{
+    const GLsizei src_pitch = width*pixel_sizeof(c->src_format, c->src_type);
+    const GLsizei dst_pitch = width*pixel_sizeof(c->dst_format, c->dst_type);
+    for (int i=0; i<height; ++i)
+        row_c((const char*)in+i*src_pitch, (char*)out+i*dst_pitch, width);
+}
+
+static void run_new(const case_t *c, const GLvoid *in, GLvoid *out, int width, int height, int threads)
+{
+    globals4es.texthreads = threads;
+    pixel_convert(in, &out, width, height, c->src_format, c->src_type, c->dst_format, c->dst_type, 0, 1);
+}
+
+// odd widths too, to check the scalar tails
+static int check(const case_t *c, pixel_row_t row_c)
+{
+    int ret = 0;
+    for (int width=1; width<=70; ++width) {
+        const int height = 3;
+        GLvoid *in = make_input(c, width, height);
+        size_t len = (size_t)width*height*pixel_sizeof(c->dst_format, c->dst_type);
+        GLvoid *a = malloc(len);
+        GLvoid *b = malloc(len);
+        run_ref(c, row_c, in, a, width, height);
+        run_new(c, in, b, width, height, 0);
+        if(memcmp(a, b, len)) {
+            printf("error: %s differs from reference with width %d\n", c->name, width);
+            ret = 1;
+        }
+        free(a); free(b); free(in);
+    }
+    return ret;
+}
+
+typedef bool (*scale_t)(const GLvoid *src, GLvoid **dst, GLuint width, GLuint height, GLenum format, GLenum type);
+
+// a scaling, with and without the threads
+static int bench_scale(const char *name, scale_t scale, int div, GLenum format, GLenum type, int loops, int size, int threads)
+{
+    const case_t c = {name, format, type, format, type};
+    GLvoid *in = make_input(&c, size, size);
+    GLvoid *a = NULL, *b = NULL;
+    double t[2];
+    for (int k=0; k<2; ++k) {
+        globals4es.texthreads = k?threads:0;
+        GLvoid **out = k?&b:&a;
+        t[k] = now();
+        for (int l=0; l<loops; ++l) {
+            free(*out);
+            scale(in, out, size, size, format, type);
+        }
+        t[k] = now()-t[k];
+    }
+    int ret = 0;
+    const int news = size/div;
+    if(memcmp(a, b, (size_t)news*news*pixel_sizeof(format, type))) {
+        printf("error: %s differs with threads\n", name);
+        ret = 1;
+    }
+    double n = (double)loops*size*size*1e-6;
+    printf("%-24s %12s %12.1f %8s %12.1f\n", name, "", n/t[0], "", n/t[1]);
+    free(a); free(b); free(in);
+    return ret;
+}
+
+// the mipmap chain level by level, with the scalar kernel (same layout as pixel_mipmaps: all the levels one after the other)
+static void mipmaps_ref(pixel_half_t half_c, const GLubyte *in, GLubyte *out, int size, int pixel_size)
+{
+    int w = size, h = size;
+    while(w>1 || h>1) {
+        const int nw = (w>1)?w/2:1, nh = (h>1)?h/2:1;
+        for (int y=0; y<nh; ++y) {
+            const GLubyte *row = in+(y*2)*w*pixel_size;
+            half_c(row, row+((h>1)?w*pixel_size:0), out+y*nw*pixel_size, nw);
+        }
+        in = out;
+        out += nw*nh*pixel_size;
+        w = nw; h = nh;
+    }
+}
+
+static int bench_mipmaps(const char *name, GLenum format, GLenum type, int loops, int size, int threads)
+{
+    const case_t c = {name, format, type, format, type};
+    const int pixel_size = pixel_sizeof(format, type);
+    int nlevels = 0;
+    while((size>>nlevels)>1)
+        ++nlevels;
+    pixel_half_t half_c = pixel_half_kernel(format, type, 0, 1);
+    GLvoid *in = make_input(&c, size, size);
+    GLubyte *ref = (GLubyte*)malloc((size_t)size*size*pixel_size);
+    GLvoid *levels[32], *levels_mt[32];
+    double t = now();
+    for (int l=0; l<loops; ++l)
+        mipmaps_ref(half_c, in, ref, size, pixel_size);
+    double tref = now()-t;
+    globals4es.texthreads = 0;
+    t = now();
+    for (int l=0; l<loops; ++l) {
+        if(l) free(levels[0]);
+        pixel_mipmaps(in, levels, nlevels, size, size, format, type, 0);
+    }
+    double tnew = now()-t;
+    globals4es.texthreads = threads;
+    t = now();
+    for (int l=0; l<loops; ++l) {
+        if(l) free(levels_mt[0]);
+        pixel_mipmaps(in, levels_mt, nlevels, size, size, format, type, 0);
+    }
+    double tmt = now()-t;
+    int ret = 0;
+    size_t len = 0;
+    for (int k=1; k<=nlevels; ++k)
+        len += (size_t)(size>>k)*(size>>k)*pixel_size;
+    if(memcmp(ref, levels[0], len) || memcmp(ref, levels_mt[0], len)) {
+        printf("error: %s differs from reference\n", name);
+        ret = 1;
+    }
+    double n = (double)loops*size*size*1e-6;
+    printf("%-24s %12.1f %12.1f %7.2fx %12.1f\n", name, n/tref, n/tnew, tref/tnew, n/tmt);
+    free(levels[0]); free(levels_mt[0]); free(ref); free(in);
+    return ret;
+}
+
+int main(int argc, char** argv)
+{
+    int loops = 50;
+    int size = 1024;
+    int threads = -1;
+    for (int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "-n") && i+1<argc)
+            loops = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-s") && i+1<argc)
+            size = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-t") && i+1<argc)
+            threads = atoi(argv[++i]);
+        else {
+            printf("usage: %s [-n loops] [-s size] [-t threads]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(loops<1 || size<4) {
+        printf("invalid parameters\n");
+        return 1;
+    }
+    int ret = 0;
+    printf("%dx%d pixels, %d loops\n", size, size, loops);
+    printf("%-24s %12s %12s %8s %12s\n", "conversion", "C MPix/s", "new MPix/s", "speedup", "MT MPix/s");
+    for (int k=0; k<NCASES; ++k) {
+        const case_t *c = cases+k;
+        pixel_row_t row_c = pixel_row_kernel(c->src_format, c->src_type, c->dst_format, c->dst_type, 1);
+        if(!row_c) {
+            printf("error: no kernel for %s\n", c->name);
+            ret = 1;
+            continue;
+        }
+        ret |= check(c, row_c);
+        GLvoid *in = make_input(c, size, size);
+        size_t len = (size_t)size*size*pixel_sizeof(c->dst_format, c->dst_type);
+        GLvoid *out = malloc(len);
+        GLvoid *out_mt = malloc(len);
+        double t = now();
+        for (int l=0; l<loops; ++l)
+            run_ref(c, row_c, in, out, size, size);
+        double tref = now()-t;
+        t = now();
+        for (int l=0; l<loops; ++l)
+            run_new(c, in, out, size, size, 0);
+        double tnew = now()-t;
+        t = now();
+        for (int l=0; l<loops; ++l)
+            run_new(c, in, out_mt, size, size, threads);
+        double tmt = now()-t;
+        if(memcmp(out, out_mt, len)) {
+            printf("error: %s differs with threads\n", c->name);
+            ret = 1;
+        }
+        double n = (double)loops*size*size*1e-6;
+        printf("%-24s %12.1f %12.1f %7.2fx %12.1f\n", c->name, n/tref, n/tnew, tref/tnew, n/tmt);
+        free(out_mt);
+        free(out);
+        free(in);
+    }
+    ret |= bench_scale("halfscale RGBA8", pixel_halfscale, 2, GL_RGBA, GL_UNSIGNED_BYTE, loops, size, threads);
+    ret |= bench_scale("quarterscale RGBA8", pixel_quarterscale, 4, GL_RGBA, GL_UNSIGNED_BYTE, loops, size, threads);
+    ret |= bench_mipmaps("mipmaps RGBA8", GL_RGBA, GL_UNSIGNED_BYTE, loops, size, threads);
+    ret |= bench_mipmaps("mipmaps RGB8", GL_RGB, GL_UNSIGNED_BYTE, loops, size, threads);
+    ret |= bench_mipmaps("mipmaps LA8", GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, loops, size, threads);
+    ret |= bench_mipmaps("mipmaps L8", GL_LUMINANCE, GL_UNSIGNED_BYTE, loops, size, threads);
+    ret |= bench_mipmaps("mipmaps RGB565", GL_RGB, GL_UNSIGNED_SHORT_5_6_5, loops, size, threads);
+    pixel_pool_stop();
+    return ret;
+}
@@ -0,0 +1,474 @@
+/*
+  shaderbench: runs the shader conversion code of gl4es (preproc, ConvertShader,
+  gl4es_convertARB and the FPE shader generator) on a corpus of shaders, without
+  any GLES / EGL, and reports for each stage the time, the allocations, and a
+  hash of the outputs.
+
+  usage: shaderbench [-n loops] [-f fpe_states] [-w hashfile | -c hashfile] [-v] files...
+    files are desktop GLSL (.vert / .frag) or ARB programs (.vp / .fp)
+    -n : number of timed loops (default 20)
+    -f : number of fpe_state_t permutations to generate (default 256)
+    -w : write the hash of each output in hashfile
+    -c : compare the hash of each output with hashfile (exit code is 1 on a difference)
+    -v : print the converted shaders
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl/arbconverter.h"
+#include "gl/fpe_shader.h"
+#include "gl/init.h"
+#include "gl/preproc.h"
+#include "gl/shaderconv.h"
+#include "glx/hardext.h"
+
+// stub of the GLES side: a typical GLES2 device, default options
+hardext_t hardext;
+globals4es_t globals4es;
+
+static void stub_Init()
+{
+    memset(&hardext, 0, sizeof(hardext));
+    hardext.esversion = 2;
+    hardext.npot = 1;
+    hardext.maxtex = 8;
+    hardext.maxteximage = 8;
+    hardext.maxlights = 8;
+    hardext.maxplanes = 6;
+    hardext.maxvattrib = 16;
+    hardext.maxvarying = 16;
+    hardext.maxdrawbuffers = 1;
+    hardext.highp = 1;
+    hardext.derivatives = 1;
+    memset(&globals4es, 0, sizeof(globals4es));
+}
+
+#ifdef COUNT_ALLOCS
+// linked with -Wl,--wrap=..., so the allocations of the conversion code can be counted
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+char* __real_strdup(const char* s);
+#endif
+static int counting = 0;
+static long nallocs = 0;
+static long allocsize = 0;
+#ifdef COUNT_ALLOCS
+void* __wrap_malloc(size_t size)
+{
+    if(counting) { ++nallocs; allocsize += size; }
+    return __real_malloc(size);
+}
+void* __wrap_calloc(size_t n, size_t size)
+{
+    if(counting) { ++nallocs; allocsize += n*size; }
+    return __real_calloc(n, size);
+}
+void* __wrap_realloc(void* p, size_t size)
+{
+    if(counting) { ++nallocs; allocsize += size; }
+    return __real_realloc(p, size);
+}
+char* __wrap_strdup(const char* s)
+{
+    if(counting) { ++nallocs; allocsize += strlen(s)+1; }
+    return __real_strdup(s);
+}
+#endif
+
+// FNV-1a 64bits
+static uint64_t hash_string(const char* s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    if(!s)
+        return 0;
+    while(*s)
+        h = (h ^ (uint8_t)*(s++)) * 0x100000001b3ULL;
+    return h;
+}
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+enum {
+    STAGE_PREPROC = 0,
+    STAGE_CONVERT,
+    STAGE_ARB,
+    STAGE_ARBCONVERT,
+    STAGE_FPE,
+    STAGE_FPECONVERT,
+    STAGE_COUNT
+};
+static const char* stage_name[STAGE_COUNT] = {"preproc", "ConvertShader", "convertARB", "ARB ConvertShader", "fpe generate", "fpe ConvertShader"};
+
+typedef struct {
+    int         calls;
+    double      time;
+    long        allocs;
+    long        size;
+    uint64_t    hash;
+} stage_t;
+static stage_t stages[STAGE_COUNT];
+
+// the hashes of each output, to compare with a reference
+typedef struct {
+    char        name[128];
+    uint64_t    hash;
+} result_t;
+static result_t* results = NULL;
+static int nresults = 0;
+static int verbose = 0;
+
+static double t0;
+static void stage_begin()
+{
+    nallocs = allocsize = 0;
+    counting = 1;
+    t0 = now();
+}
+static void stage_end(int stage)
+{
+    double t = now()-t0;
+    counting = 0;
+    stages[stage].time += t;
+    stages[stage].calls++;
+    stages[stage].allocs += nallocs;
+    stages[stage].size += allocsize;
+}
+
+static void add_result(int stage, const char* name, const char* out)
+{
+    uint64_t h = hash_string(out);
+    stages[stage].hash = (stages[stage].hash ^ h) * 0x100000001b3ULL;
+    results = (result_t*)realloc(results, (nresults+1)*sizeof(result_t));
+    snprintf(results[nresults].name, sizeof(results[nresults].name), "%s:%s", stage_name[stage], name);
+    for (char* p=results[nresults].name; *p; ++p)
+        if(*p==' ') *p = '_';
+    results[nresults].hash = h;
+    ++nresults;
+    if(verbose)
+        printf("===== %s %s\n%s\n", stage_name[stage], name, out?out:"(null)");
+}
+
+static char* read_file(const char* name)
+{
+    FILE* f = fopen(name, "rb");
+    if(!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long l = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* s = (char*)malloc(l+1);
+    if(fread(s, 1, l, f)!=l) {
+        free(s);
+        fclose(f);
+        return NULL;
+    }
+    s[l] = '\0';
+    fclose(f);
+    return s;
+}
+
+static const char* base_name(const char* name)
+{
+    const char* p = strrchr(name, '/');
+    return p?(p+1):name;
+}
+
+static int has_ext(const char* name, const char* ext)
+{
+    int l = strlen(name), le = strlen(ext);
+    return (l>le && !strcmp(name+l-le, ext));
+}
+
+static char* convert(int stage, const char* source, int isVertex, int record, const char* name)
+{
+    shaderconv_need_t need = {0};
+    need.need_texcoord = -1;
+    stage_begin();
+    char* out = ConvertShader(source, isVertex, &need);
+    stage_end(stage);
+    if(record)
+        add_result(stage, name, out);
+    return out;
+}
+
+static void bench_glsl(const char* name, const char* source, int isVertex, int record)
+{
+    extensions_t exts = {0};
+    char* version = NULL;
+    stage_begin();
+    char* pp = preproc(source, 0, 0, &exts, &version);
+    stage_end(STAGE_PREPROC);
+    if(record)
+        add_result(STAGE_PREPROC, name, pp);
+    if(pp!=source)
+        free(pp);
+    free(version);
+    free(exts.ext);
+    free(convert(STAGE_CONVERT, source, isVertex, record, name));
+}
+
+static void bench_arb(const char* name, const char* source, int isVertex, int record)
+{
+    char* error_msg = NULL;
+    int error_ptr = -1;
+    stage_begin();
+    char* glsl = gl4es_convertARB(source, isVertex, &error_msg, &error_ptr);
+    stage_end(STAGE_ARB);
+    if(error_msg && record)
+        printf("%s: ARB conversion error at %d: %s\n", name, error_ptr, error_msg);
+    free(error_msg);
+    if(record)
+        add_result(STAGE_ARB, name, glsl);
+    if(glsl)
+        free(convert(STAGE_ARBCONVERT, glsl, isVertex, record, name));
+    free(glsl);
+}
+
+// a deterministic sweep of fixed pipeline states
+static uint32_t rnd(uint32_t* seed)
+{
+    *seed = *seed*1103515245u + 12345u;
+    return (*seed>>16)&0x7fff;
+}
+
+static const int tex_src[] = {FPE_SRC_TEXTURE, FPE_SRC_PREVIOUS, FPE_SRC_PRIMARY_COLOR, FPE_SRC_CONSTANT, FPE_SRC_TEXTURE0};
+
+static void fpe_state(fpe_state_t* state, int n)
+{
+    memset(state, 0, sizeof(fpe_state_t));
+    if(!n)
+        return; // default state
+    uint32_t seed = n;
+    int ntex = rnd(&seed)%4;
+    for (int i=0; i<ntex; ++i) {
+        fpe_texture_t* t = state->texture+i;
+        t->textype = 1+rnd(&seed)%4;    // 2D, RECT, 3D or CUBE
+        t->texformat = rnd(&seed)%7;
+        t->texmat = rnd(&seed)%2;
+        t->texadjust = rnd(&seed)%2;
+        fpe_texenv_t* e = state->texenv+i;
+        e->texenv = rnd(&seed)%7;
+        if(e->texenv==FPE_COMBINE || e->texenv==FPE_COMBINE4) {
+            state->texcombine[i] = (rnd(&seed)%11) | ((rnd(&seed)%6)<<4);
+            e->texsrcrgb0 = tex_src[rnd(&seed)%5];
+            e->texsrcrgb1 = tex_src[rnd(&seed)%5];
+            e->texsrcrgb2 = tex_src[rnd(&seed)%5];
+            e->texsrcalpha0 = tex_src[rnd(&seed)%5];
+            e->texsrcalpha1 = tex_src[rnd(&seed)%5];
+            e->texoprgb0 = rnd(&seed)%4;
+            e->texoprgb1 = rnd(&seed)%4;
+            e->texopalpha0 = rnd(&seed)%2;
+            e->texrgbscale = rnd(&seed)%2;
+            e->texalphascale = rnd(&seed)%2;
+        }
+        if(rnd(&seed)%4==0) {
+            fpe_texgen_t* g = state->texgen+i;
+            g->texgen_s = g->texgen_t = 1;
+            g->texgen_s_mode = g->texgen_t_mode = rnd(&seed)%5;
+        }
+    }
+    if(rnd(&seed)%2) {
+        state->lighting = 1;
+        state->light = rnd(&seed)&0xff;
+        state->light_direction = rnd(&seed)&0xff;
+        state->light_cutoff180 = rnd(&seed)&0xff;
+        state->twosided = rnd(&seed)%2;
+        state->light_separate = rnd(&seed)%2;
+        state->light_localviewer = rnd(&seed)%2;
+        state->normalize = rnd(&seed)%2;
+        state->rescaling = rnd(&seed)%2;
+        if(rnd(&seed)%2) {
+            state->color_material = 1;
+            state->cm_front_mode = rnd(&seed)%5;
+            state->cm_back_mode = rnd(&seed)%5;
+        }
+        state->cm_front_nullexp = rnd(&seed)%2;
+        state->cm_back_nullexp = rnd(&seed)%2;
+    }
+    if(rnd(&seed)%3==0) {
+        state->fog = 1;
+        state->fogmode = rnd(&seed)%3;
+        state->fogsource = rnd(&seed)%2;
+        state->fogdist = rnd(&seed)%3;
+    }
+    if(rnd(&seed)%3==0) {
+        state->alphatest = 1;
+        state->alphafunc = rnd(&seed)%8;
+    }
+    state->colorsum = rnd(&seed)%2;
+    if(rnd(&seed)%4==0)
+        state->plane = rnd(&seed)&0x3f;
+    if(rnd(&seed)%8==0) {
+        state->point = 1;
+        state->pointsprite = rnd(&seed)%2;
+        state->pointsprite_coord = rnd(&seed)%2;
+        state->pointsprite_upper = rnd(&seed)%2;
+    }
+}
+
+static void bench_fpe(int n, int record)
+{
+    fpe_state_t state;
+    char name[32];
+    fpe_state(&state, n);
+    snprintf(name, sizeof(name), "state%d", n);
+    for (int isVertex=1; isVertex>=0; --isVertex) {
+        stage_begin();
+        const char* shad = (isVertex?fpe_VertexShader(NULL, &state):fpe_FragmentShader(NULL, &state))[0];
+        stage_end(STAGE_FPE);
+        if(record) {
+            char tmp[40];
+            snprintf(tmp, sizeof(tmp), "%s.%s", name, isVertex?"vert":"frag");
+            add_result(STAGE_FPE, tmp, shad);
+            free(convert(STAGE_FPECONVERT, shad, isVertex, record, tmp));
+        } else
+            free(convert(STAGE_FPECONVERT, shad, isVertex, record, name));
+    }
+}
+
+static int check_hashes(const char* filename)
+{
+    FILE* f = fopen(filename, "r");
+    if(!f) {
+        printf("Cannot read %s\n", filename);
+        return 1;
+    }
+    char line[256], name[128];
+    unsigned long long h;
+    int bad = 0, found = 0;
+    while(fgets(line, sizeof(line), f)) {
+        if(sscanf(line, "%127s %llx", name, &h)!=2)
+            continue;
+        int i;
+        for (i=0; i<nresults && strcmp(results[i].name, name); ++i);
+        if(i==nresults) {
+            printf("Missing output: %s\n", name);
+            ++bad;
+        } else {
+            ++found;
+            if(results[i].hash!=h) {
+                printf("Changed output: %s\n", name);
+                ++bad;
+            }
+        }
+    }
+    fclose(f);
+    if(found!=nresults) {
+        printf("%d outputs not in %s\n", nresults-found, filename);
+        ++bad;
+    }
+    return bad?1:0;
+}
+
+static int write_hashes(const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if(!f) {
+        printf("Cannot write %s\n", filename);
+        return 1;
+    }
+    for (int i=0; i<nresults; ++i)
+        fprintf(f, "%s %016llx\n", results[i].name, (unsigned long long)results[i].hash);
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int loops = 20;
+    int nfpe = 256;
+    const char* check = NULL;
+    const char* write = NULL;
+    int nfiles = 0;
+    char** files = (char**)malloc(argc*sizeof(char*));
+    for (int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "-n") && i+1<argc)
+            loops = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-f") && i+1<argc)
+            nfpe = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-c") && i+1<argc)
+            check = argv[++i];
+        else if(!strcmp(argv[i], "-w") && i+1<argc)
+            write = argv[++i];
+        else if(!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else if(argv[i][0]=='-') {
+            printf("usage: %s [-n loops] [-f fpe_states] [-w hashfile | -c hashfile] [-v] files...\n", argv[0]);
+            return 1;
+        } else
+            files[nfiles++] = argv[i];
+    }
+    if(loops<1)
+        loops = 1;
+    stub_Init();
+
+    char** sources = (char**)calloc(nfiles, sizeof(char*));
+    for (int i=0; i<nfiles; ++i)
+        if(!(sources[i] = read_file(files[i])))
+            printf("Cannot read %s\n", files[i]);
+
+    // first loop records the outputs, the others are just timed
+    for (int loop=0; loop<=loops; ++loop) {
+        int record = (loop==0);
+        if(loop==1) {
+            // the first loop also warms the caches: only keep its hashes
+            for (int s=0; s<STAGE_COUNT; ++s) {
+                uint64_t hash = stages[s].hash;
+                memset(stages+s, 0, sizeof(stage_t));
+                stages[s].hash = hash;
+            }
+        }
+        for (int i=0; i<nfiles; ++i) {
+            if(!sources[i])
+                continue;
+            const char* name = base_name(files[i]);
+            if(has_ext(name, ".vert") || has_ext(name, ".vs"))
+                bench_glsl(name, sources[i], 1, record);
+            else if(has_ext(name, ".frag") || has_ext(name, ".fs"))
+                bench_glsl(name, sources[i], 0, record);
+            else if(has_ext(name, ".vp"))
+                bench_arb(name, sources[i], 1, record);
+            else if(has_ext(name, ".fp"))
+                bench_arb(name, sources[i], 0, record);
+            else if(record)
+                printf("Unknown shader type: %s\n", name);
+        }
+        for (int n=0; n<nfpe; ++n)
+            bench_fpe(n, record);
+    }
+
+    printf("%-18s %8s %10s %10s %10s %12s  %s\n", "stage", "calls", "total ms", "us/call", "allocs", "bytes/call", "output hash");
+    for (int s=0; s<STAGE_COUNT; ++s) {
+        stage_t* st = stages+s;
+        if(!st->calls)
+            continue;
+#ifdef COUNT_ALLOCS
+        printf("%-18s %8d %10.3f %10.2f %10.1f %12.0f  %016llx\n", stage_name[s], st->calls/loops, st->time*1000./loops,
+            st->time*1e6/st->calls, (double)st->allocs/st->calls, (double)st->size/st->calls, (unsigned long long)st->hash);
+#else
+        printf("%-18s %8d %10.3f %10.2f %10s %12s  %016llx\n", stage_name[s], st->calls/loops, st->time*1000./loops,
+            st->time*1e6/st->calls, "n/a", "n/a", (unsigned long long)st->hash);
+#endif
+    }
+
+    int ret = 0;
+    if(write)
+        ret = write_hashes(write);
+    if(check)
+        ret = check_hashes(check);
+    for (int i=0; i<nfiles; ++i)
+        free(sources[i]);
+    free(sources);
+    free(files);
+    free(results);
+    return ret;
+}
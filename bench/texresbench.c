@@ -0,0 +1,276 @@
+/*
+  texresbench: evicts and restores a texture with the residency code of
+  LIBGL_TEXBUDGET (texres.c), on a stub GLES driver that keeps the texel
+  storage in memory, and checks that level 0 comes back the same as it was
+  uploaded. Three cases: level 0 read back thru the FBO (kept as DXTc), the
+  LIBGL_COPY data, and the LIBGL_COPY data when the app uploaded its own
+  mipmaps over it (then the FBO read back has to be used). The timings are
+  for one evict + restore cycle.
+
+  usage: texresbench [-n loops] [-s size]
+    -n : number of timed evict + restore cycles (default 20)
+    -s : width and height of the texture (default 1024)
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl/glstate.h"
+#include "gl/init.h"
+#include "gl/texres.h"
+#include "glx/hardext.h"
+
+// stubs, only the texture residency code is used
+glstate_t *glstate = NULL;
+globals4es_t globals4es = {0};
+hardext_t hardext = {0};
+void *gles = (void*)1;
+void LogPrintf(const char *fmt,...) {}
+void LogFPrintf(FILE *fp, const char *fmt,...) {}
+const char* PrintEnum(GLenum what) { return "?"; }
+void gleshard_glActiveTexture(GLenum texture) { glstate->gleshard->active = texture - GL_TEXTURE0; }
+int is_mipmap_needed(glsampler_t* sampler) { return 0; }
+void texupload_flush() {}
+
+KHASH_MAP_IMPL_INT(tex, gltexture_t *);
+
+// stub of the GLES side: the storage of the levels of each texture, RGBA only
+#define STUB_TEX    4
+#define STUB_LEVELS 16
+typedef struct {
+    GLsizei w, h;
+    GLubyte *data;
+} stub_level_t;
+static stub_level_t stub_tex[STUB_TEX][STUB_LEVELS];
+static GLuint stub_bound = 0;
+static GLuint stub_attached = 0;
+
+static void APIENTRY_GLES stub_glBindTexture(GLenum target, GLuint texture) { stub_bound = texture; }
+static void APIENTRY_GLES stub_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+    stub_level_t *l = &stub_tex[stub_bound][level];
+    free(l->data);
+    l->w = width;
+    l->h = height;
+    l->data = NULL;
+    if(width && height) {
+        l->data = (GLubyte*)calloc(width*height, 4);
+        if(pixels)
+            memcpy(l->data, pixels, width*height*4);
+    }
+}
+static void APIENTRY_GLES stub_glPixelStorei(GLenum pname, GLint param) {}
+static void APIENTRY_GLES stub_glGenFramebuffers(GLsizei n, GLuint *ids) { ids[0] = 1; }
+static void APIENTRY_GLES stub_glBindFramebuffer(GLenum target, GLuint framebuffer) {}
+static void APIENTRY_GLES stub_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    stub_attached = texture;
+}
+static GLenum APIENTRY_GLES stub_glCheckFramebufferStatus(GLenum target)
+{
+    return stub_tex[stub_attached][0].data?GL_FRAMEBUFFER_COMPLETE:GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT;
+}
+static void APIENTRY_GLES stub_glDeleteFramebuffers(GLsizei n, const GLuint *ids) {}
+static void APIENTRY_GLES stub_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pixels)
+{
+    memcpy(pixels, stub_tex[stub_attached][0].data, width*height*4);
+}
+static GLenum APIENTRY_GLES stub_glGetError() { return GL_NO_ERROR; }
+
+void *proc_address(void *lib, const char *name)
+{
+    #define STUB(func) if(!strcmp(name, #func)) return (void*)stub_##func;
+    STUB(glBindTexture);
+    STUB(glTexImage2D);
+    STUB(glPixelStorei);
+    STUB(glGenFramebuffers);
+    STUB(glBindFramebuffer);
+    STUB(glFramebufferTexture2D);
+    STUB(glCheckFramebufferStatus);
+    STUB(glDeleteFramebuffers);
+    STUB(glReadPixels);
+    STUB(glGetError);
+    #undef STUB
+    return NULL;
+}
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static void stub_Init()
+{
+    glstate = (glstate_t*)calloc(1, sizeof(glstate_t));
+    glstate->gleshard = (gleshard_t*)calloc(1, sizeof(gleshard_t));
+    glstate->texres = (texres_t*)calloc(1, sizeof(texres_t));
+    glstate->actual_tex2d = (GLuint*)calloc(MAX_TEX, sizeof(GLuint));
+    glstate->fbo.current_fb = (glframebuffer_t*)calloc(1, sizeof(glframebuffer_t));
+    glstate->texture.list = kh_init(tex);
+    glstate->texture.pack_align = 4;
+    glstate->texture.unpack_align = 4;
+    hardext.maxtex = 1;
+    hardext.fbo = 1;
+    // 1MB, any texture of the bench is over it
+    globals4es.texbudget = 1;
+}
+
+// level 0 of the test texture: smooth gradients, like most real textures
+static GLubyte *make_image(int w, int h, int alpha)
+{
+    GLubyte *img = (GLubyte*)malloc(w*h*4);
+    for (int y=0; y<h; ++y)
+        for (int x=0; x<w; ++x) {
+            GLubyte *p = img+(x+y*w)*4;
+            p[0] = x*255/(w-1);
+            p[1] = y*255/(h-1);
+            p[2] = (x+y)*255/(w+h-2);
+            p[3] = alpha?(255-p[0]):255;
+        }
+    return img;
+}
+
+// what glTexImage2D does for texres, on the texture bound to the stub
+static void upload(gltexture_t *tex, int level, const GLubyte *pixels)
+{
+    const int w = tex->width>>level, h = tex->height>>level;
+    stub_bound = tex->glname;
+    stub_glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if(globals4es.texcopydata) {
+        // LIBGL_COPY keeps the last upload, whatever the level
+        tex->data = realloc(tex->data, w*h*4);
+        memcpy(tex->data, pixels, w*h*4);
+    }
+    texres_uploaded(tex, level, 0);
+}
+
+static gltexture_t *new_texture(GLuint name, int size)
+{
+    gltexture_t *tex = (gltexture_t*)calloc(1, sizeof(gltexture_t));
+    tex->texture = tex->glname = name;
+    tex->target = GL_TEXTURE_2D;
+    tex->width = tex->nwidth = size;
+    tex->height = tex->nheight = size;
+    tex->format = GL_RGBA;
+    tex->type = GL_UNSIGNED_BYTE;
+    tex->valid = 1;
+    int ret;
+    khint_t k = kh_put(tex, glstate->texture.list, name, &ret);
+    kh_value(glstate->texture.list, k) = tex;
+    return tex;
+}
+
+static void del_texture(gltexture_t *tex)
+{
+    texres_forget(tex);
+    kh_del(tex, glstate->texture.list, kh_get(tex, glstate->texture.list, tex->texture));
+    for (int i=0; i<STUB_LEVELS; ++i) {
+        free(stub_tex[tex->glname][i].data);
+        stub_tex[tex->glname][i].data = NULL;
+    }
+    free(tex->data);
+    free(tex);
+}
+
+// biggest difference between level 0 on the stub and img, -1 if level 0 is not there
+static int compare(gltexture_t *tex, const GLubyte *img)
+{
+    stub_level_t *l = &stub_tex[tex->glname][0];
+    if(!l->data || l->w!=tex->width || l->h!=tex->height)
+        return -1;
+    int maxdiff = 0;
+    for (int i=0; i<tex->width*tex->height*4; ++i) {
+        int d = abs((int)l->data[i]-(int)img[i]);
+        if(d>maxdiff)
+            maxdiff = d;
+    }
+    return maxdiff;
+}
+
+// one evict + restore cycle, 0 if the texture wasn't evicted then restored as expected
+static int cycle(gltexture_t *tex, int readback)
+{
+    texres_enforce();
+    if(!tex->res_evicted || stub_tex[tex->glname][0].data || (tex->res_copy!=NULL)!=readback)
+        return 0;
+    texres_restore(tex, 0);
+    return !tex->res_evicted;
+}
+
+typedef struct {
+    const char* name;
+    int         copydata;   // LIBGL_COPY
+    int         mipmaps;    // the app uploads its own level 1
+    int         alpha;      // DXT5 else DXT1
+    int         tolerance;  // DXTc is lossy
+} case_t;
+
+static const case_t cases[] = {
+    {"readback DXT1",           0, 0, 0, 16},
+    {"readback DXT5",           0, 0, 1, 16},
+    {"LIBGL_COPY",              1, 0, 1, 0},
+    {"LIBGL_COPY + app mips",   1, 1, 1, 16},
+};
+
+static int run(const case_t *c, int loops, int size)
+{
+    globals4es.texcopydata = c->copydata;
+    gltexture_t *tex = new_texture(1, size);
+    GLubyte *img = make_image(size, size, c->alpha);
+    upload(tex, 0, img);
+    if(c->mipmaps) {
+        GLubyte *mip = make_image(size/2, size/2, 0);
+        upload(tex, 1, mip);
+        free(mip);
+    }
+    const int readback = !c->copydata || c->mipmaps;
+    int ok = cycle(tex, readback);
+    int diff = ok?compare(tex, img):-1;
+    ok = ok && diff>=0 && diff<=c->tolerance && (!c->mipmaps || stub_tex[tex->glname][1].data);
+    double t = now();
+    for (int l=0; l<loops && ok; ++l)
+        ok = cycle(tex, readback);
+    t = now()-t;
+    if(ok)
+        printf("%-24s %4dx%-4d max diff %3d %10.1f us/cycle\n", c->name, size, size, diff, t*1e6/loops);
+    else
+        printf("%-24s %4dx%-4d error: not restored as uploaded (max diff %d)\n", c->name, size, size, diff);
+    free(img);
+    del_texture(tex);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int loops = 20;
+    int size = 1024;
+    for (int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "-n") && i+1<argc)
+            loops = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-s") && i+1<argc)
+            size = atoi(argv[++i]);
+        else {
+            printf("usage: %s [-n loops] [-s size]\n", argv[0]);
+            return 1;
+        }
+    }
+    // the texture has to be over the 1MB budget
+    if(loops<1 || size<1024 || size>4096) {
+        printf("invalid parameters\n");
+        return 1;
+    }
+    stub_Init();
+    int ok = 1;
+    for (int i=0; i<sizeof(cases)/sizeof(cases[0]); ++i)
+        ok &= run(&cases[i], loops, size);
+    if(glstate->texres->gpu || glstate->texres->shadow) {
+        printf("error: %ld bytes of GPU and %ld bytes of CPU still accounted\n", (long)glstate->texres->gpu, (long)glstate->texres->shadow);
+        ok = 0;
+    }
+    return ok?0:1;
+}
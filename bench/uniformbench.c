@@ -0,0 +1,160 @@
+/*
+  uniformbench: measures the glUniform* throughput of gl4es (location lookup,
+  value cache and call to the GLES driver), with a stub GLES driver, for the
+  location indexed uniform table and for the hashmap fallback.
+
+  usage: uniformbench [-n loops] [-u uniforms] [-s stride]
+    -n : number of timed loops over all the uniforms (default 100000)
+    -u : number of uniforms in the program (default 64, half vec4, half mat4)
+    -s : spacing between the locations given by the "driver" (default 1)
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl/glstate.h"
+#include "gl/program.h"
+#include "gl/uniform.h"
+
+// stub of the GLES side: no driver, the gles calls are only counted
+glstate_t *glstate = NULL;
+void *gles = (void*)1;
+
+static long ncalls = 0;
+static void APIENTRY_GLES stub_glUniformfv(GLint location, GLsizei count, const GLfloat *value) { ++ncalls; }
+static void APIENTRY_GLES stub_glUniformiv(GLint location, GLsizei count, const GLint *value) { ++ncalls; }
+static void APIENTRY_GLES stub_glUniformMatrixfv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) { ++ncalls; }
+static void APIENTRY_GLES stub_glUseProgram(GLuint program) { }
+
+void *proc_address(void *lib, const char *name)
+{
+    if(!strcmp(name, "glUniform1fv") || !strcmp(name, "glUniform2fv") || !strcmp(name, "glUniform3fv") || !strcmp(name, "glUniform4fv"))
+        return (void*)stub_glUniformfv;
+    if(!strcmp(name, "glUniform1iv") || !strcmp(name, "glUniform2iv") || !strcmp(name, "glUniform3iv") || !strcmp(name, "glUniform4iv"))
+        return (void*)stub_glUniformiv;
+    if(!strcmp(name, "glUniformMatrix2fv") || !strcmp(name, "glUniformMatrix3fv") || !strcmp(name, "glUniformMatrix4fv"))
+        return (void*)stub_glUniformMatrixfv;
+    if(!strcmp(name, "glUseProgram"))
+        return (void*)stub_glUseProgram;
+    return NULL;
+}
+// never called, no display list is active
+void gl4es_flush() {}
+void glPushCall(void *call) {}
+renderlist_t *extend_renderlist(renderlist_t *list) { return list; }
+
+KHASH_MAP_IMPL_INT(uniformlist, uniform_t *);
+KHASH_MAP_IMPL_INT(programlist, program_t *);
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static program_t glprogram;
+
+static void stub_Init(int nuniforms, int stride)
+{
+    glstate = (glstate_t*)calloc(1, sizeof(glstate_t));
+    glstate->glsl = (glsl_t*)calloc(1, sizeof(glsl_t));
+    glstate->gleshard = (gleshard_t*)calloc(1, sizeof(gleshard_t));
+    glstate->glsl->programs = kh_init(programlist);
+    // a linked program, as fill_program would leave it
+    memset(&glprogram, 0, sizeof(glprogram));
+    glprogram.id = 1;
+    glprogram.linked = 1;
+    glprogram.uniform = kh_init(uniformlist);
+    int offs = 0;
+    for (int i=0; i<nuniforms; ++i) {
+        int ret;
+        uniform_t *m = (uniform_t*)calloc(1, sizeof(uniform_t));
+        m->id = i*stride;
+        m->type = (i&1)?GL_FLOAT_MAT4:GL_FLOAT_VEC4;
+        m->size = 1;
+        m->cache_offs = offs;
+        m->cache_size = uniformsize(m->type);
+        offs += m->cache_size;
+        khint_t k = kh_put(uniformlist, glprogram.uniform, m->id, &ret);
+        kh_value(glprogram.uniform, k) = m;
+    }
+    glprogram.cache.cap = offs;
+    glprogram.cache.cache = calloc(1, offs);
+    glprogram.cache.gen = (GLuint*)calloc(1, offs);
+    FillUniformLoc(&glprogram);
+    int ret;
+    khint_t k = kh_put(programlist, glstate->glsl->programs, glprogram.id, &ret);
+    kh_value(glstate->glsl->programs, k) = &glprogram;
+    glstate->glsl->program = glprogram.id;
+    glstate->gleshard->program = glprogram.id;
+}
+
+// one frame: every uniform is set once, with a new value if change is set
+static void run(int loops, int nuniforms, int stride, int change)
+{
+    GLfloat v[16] = {0};
+    for (int l=0; l<loops; ++l) {
+        if(change)
+            v[0] += 1.0f;
+        for (int i=0; i<nuniforms; ++i)
+            if(i&1)
+                gl4es_glUniformMatrix4fv(i*stride, 1, GL_FALSE, v);
+            else
+                gl4es_glUniform4fv(i*stride, 1, v);
+    }
+}
+
+static void bench(const char* name, int loops, int nuniforms, int stride)
+{
+    for (int change=0; change<2; ++change) {
+        ncalls = 0;
+        double t = now();
+        run(loops, nuniforms, stride, change);
+        t = now()-t;
+        long n = (long)loops*nuniforms;
+        printf("%-10s %-10s %10ld calls %8.3f s %8.1f ns/call (%ld to GLES)\n",
+            name, change?"changed":"unchanged", n, t, t*1e9/n, ncalls);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int loops = 100000;
+    int nuniforms = 64;
+    int stride = 1;
+    for (int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "-n") && i+1<argc)
+            loops = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-u") && i+1<argc)
+            nuniforms = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-s") && i+1<argc)
+            stride = atoi(argv[++i]);
+        else {
+            printf("usage: %s [-n loops] [-u uniforms] [-s stride]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(loops<1 || nuniforms<1 || stride<1) {
+        printf("invalid parameters\n");
+        return 1;
+    }
+    stub_Init(nuniforms, stride);
+    printf("%d uniforms, locations stride %d, %d loops\n", nuniforms, stride, loops);
+    // sanity check: the values have to go through
+    run(1, nuniforms, stride, 1);
+    if(ncalls!=nuniforms || glstate->shim_error) {
+        printf("error: %ld GLES calls for %d uniforms (error 0x%04X)\n", ncalls, nuniforms, glstate->shim_error);
+        return 1;
+    }
+    if(glprogram.uniformloc)
+        bench("table", loops, nuniforms, stride);
+    // same thing with the hashmap
+    uniformloc_t *uniformloc = glprogram.uniformloc;
+    glprogram.uniformloc = NULL;
+    bench("hashmap", loops, nuniforms, stride);
+    glprogram.uniformloc = uniformloc;
+    return 0;
+}
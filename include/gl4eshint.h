@@ -33,6 +33,17 @@
 #define GL_AVOID16BITS_HINT_GL4ES	    0xA10E
 // same as using LIBGL_GAMMA=xx (PANDORA only)
 #define GL_GAMMA_HINT_GL4ES             0xA10F
+// same as using LIBGL_STREAMVBO=x
+#define GL_STREAMVBO_HINT_GL4ES         0xA110
+// same as using LIBGL_VCACHE=x
+#define GL_VCACHE_HINT_GL4ES            0xA111
+// same as using LIBGL_TEXBUDGET=x (in MB)
+#define GL_TEXBUDGET_HINT_GL4ES         0xA112
+// texture residency counters, read only: GPU size and CPU copies size in KB, number of evictions and re-uploads
+#define GL_TEXBUDGET_GPU_GL4ES          0xA113
+#define GL_TEXBUDGET_SHADOW_GL4ES       0xA114
+#define GL_TEXBUDGET_EVICTED_GL4ES      0xA115
+#define GL_TEXBUDGET_RELOADED_GL4ES     0xA116
 
 // special value to query underlying Hardware value using glGetString
 #define GL_VENDOR_GL4ES                 (GL_VENDOR | 0x10000)
@@ -22,7 +22,9 @@ void aglSetBitmap(void * bitmap);
 void* aglGetProcAddress(const char* name);
 // TODO: something less error prone, but agl.h cannot be included here, as some Amiga header conflict with some GLES ones
 
-void *gl4es_aglGetProcAddress(const char *name) {
+void *gl4es_aglGetProcAddress(const char *name);
+
+static void fill_aglprocaddr(khash_t(procaddr) *procs) {
 
     MAP("glXSwapIntervalMESA", gl4es_glXSwapInterval);
     MAP("glXSwapIntervalSGI", gl4es_glXSwapInterval);
@@ -37,6 +39,13 @@ void *gl4es_aglGetProcAddress(const char *name) {
     MAP("aglSwapBuffers", aglSwapBuffers);
     MAP("aglSetParams2", aglSetParams2);
     MAP("aglSetBitmap", aglSetBitmap);
+}
+
+void *gl4es_aglGetProcAddress(const char *name) {
+    static khash_t(procaddr) *procs = NULL;
+    void *func = lookup_find_once(&procs, fill_aglprocaddr, name);
+    if(func)
+        return func;
 
     return gl4es_GetProcAddress(name);
 }
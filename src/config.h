@@ -19,5 +19,19 @@
 #define MAX_FRG_PROG_ENV_PARAMS 24
 #define MAX_FRG_PROG_LOC_PARAMS 24
 #define MAX_DRAW_BUFFERS    16
+#define STREAM_VERTEX_SIZE  (2*1024*1024)
+#define STREAM_INDICES_SIZE (256*1024)
+#define STREAM_UNPACK_SIZE  (4*1024*1024)
+#define VCACHE_DEFAULT_SIZE 16
+#define CALLLISTS_CACHE_SIZE 16
+#define CALLLISTS_MAX_LISTS 1024
+#define PSA_PREWARM         4
+#define SHADERCACHE_MAX_SIZE (64*1024*1024)
+#define TEXTHREADS_MAX      8
+#define TEXTHREADS_MINPIXELS (512*512)
+#define MIPMAP_BLOCK_LEVELS 4
+#define MAX_MIPMAP_LEVELS   32
+#define TEXUPLOAD_ARENA_MIN (256*1024)
+#define TEXUPLOAD_ARENA_MAX (8*1024*1024)
 
 #endif // _GL4ES_MAIN_CONFIG_H
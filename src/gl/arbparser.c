@@ -790,7 +790,7 @@ char **resolveParam(sCurStatus_NewVar *newVar, int vertex, int type) {
 							ARBCONV_DBG_RE("Failed to get param: state.light[%s].spot(tok NULL)\n", sln)
 							return NULL;
 						} else if (!strcmp(tok, "direction")) {
-							mtxNameLen = 9;
+							mtxNameLen = 13;
 							matrixName = "spotDirection";
 						} else {
 							ARBCONV_DBG_RE("Failed to get param: state.light[%s].spot.%s\n", sln, tok)
@@ -807,7 +807,7 @@ char **resolveParam(sCurStatus_NewVar *newVar, int vertex, int type) {
 						return NULL;
 					}
 					
-					matrixNameMallocd = (char*)malloc((mtxNameLen + strlen(sln) + 8) * sizeof(char));
+					matrixNameMallocd = (char*)malloc((mtxNameLen + strlen(sln) + 18) * sizeof(char));
 					sprintf(matrixNameMallocd, "gl_LightSource[%s].%s", sln, matrixName);
 					free(sln);
 					char **r = (char**)calloc(2, sizeof(char*));
@@ -1,5 +1,6 @@
 #include "array.h"
 
+#include "array_simd.h"
 #include "debug.h"
 #include "enum_info.h"
 #include "glcase.h"
@@ -35,6 +36,14 @@ GLvoid *copy_gl_array(const GLvoid *src,
     // so we leave it in a uintptr_t and cast after incrementing
     uintptr_t in = (uintptr_t)src;
     in += stride*skip;
+    static const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    if (to == GL_FLOAT && (from == GL_FLOAT || from == GL_DOUBLE)) {
+        if (from == GL_FLOAT)
+            array_copy_f((GLfloat*)dst, (GLvoid*)in, stride, width, to_width, count-skip, zero);
+        else
+            array_double_f((GLfloat*)dst, (GLvoid*)in, stride, width, to_width, count-skip, zero);
+        return dst;
+    }
     if (from == to && to_width >= width) {
         GL_TYPE_SWITCH(out, dst, to,
             for (int i = skip; i < count; i++) {
@@ -93,22 +102,11 @@ GLvoid *copy_gl_array_texcoord(const GLvoid *src,
     uintptr_t in = (uintptr_t)src;
     in += stride*skip;
     GLfloat* out = (GLfloat*)dst;
+    static const GLfloat pad[4] = {0.0f, 0.0f, 0.0f, 1.0f};
     if (from == GL_FLOAT && to_width >= width) {
-        for (int i = skip; i < count; i++) {
-            GLfloat* input = (GLfloat*)in;
-            //memcpy(out, (GLvoid *)in, from_size);   // which one is faster ?
-            for (int j = 0; j < width; j++) {
-                out[j] = input[j];
-            }
-            for (int j = width; j < to_width; j++) {
-                if(j==3)
-                    out[j] = 1.0f;
-                else
-                    out[j] = 0.0f;
-            }
-            out += to_width;
-            in += stride;
-        }
+        array_copy_f(out, (GLvoid*)in, stride, width, to_width, count-skip, pad);
+    } else if (from == GL_DOUBLE && to_width >= width) {
+        array_double_f(out, (GLvoid*)in, stride, width, to_width, count-skip, pad);
     } else {
         for (int i = skip; i < count; i++) {
             GL_TYPE_SWITCH(input, in, from,
@@ -148,6 +146,20 @@ GLvoid *copy_gl_array_quickconvert(const GLvoid *src,
     int j;
     
     GLfloat *out = (GLfloat*)dst;
+    switch (from) {
+        case GL_UNSIGNED_BYTE:
+            array_ubyte_f(out, (GLvoid*)in, stride, count-skip, 1.0f/gl_max_value(from));
+            return dst;
+        case GL_UNSIGNED_SHORT:
+            array_ushort_f(out, (GLvoid*)in, stride, count-skip, 1.0f/gl_max_value(from));
+            return dst;
+        case GL_FLOAT:
+            array_copy_f(out, (GLvoid*)in, stride, 4, 4, count-skip, NULL);
+            return dst;
+        case GL_DOUBLE:
+            array_double_f(out, (GLvoid*)in, stride, 4, 4, count-skip, NULL);
+            return dst;
+    }
     GL_TYPE_SWITCH2(input, in, from,
         const GLfloat maxf = 1.0f/gl_max_value(from);
         for (int i = skip; i < count; i++)
@@ -471,30 +483,7 @@ void *copy_gl_array_bgra(void* dest, const void *ptr, GLint stride, GLsizei widt
     GLfloat* dst = dest;
     src += skip*(stride);
 
-    static const float d = 1.0f/255.0f;
-    for (int i=skip; i<count; i++) {
-        #if defined(__ARM_NEON__) && !defined(__APPLE__)
-        int lsrc = *(int*)src;
-        lsrc = (lsrc&0xff00ff00) | ((lsrc&0x00ff0000)>>16) | ((lsrc&0x000000ff)<<16);
-        asm volatile (
-        "vmov           s12, %1              \n\t"   // because you cannot vmovl.u8 d6, s11
-        "vmovl.u8       q3, d6               \n\t"   // Expand to 16-bit (so unsetuped s13 is expanded in d7)
-        "vmovl.u16      q3, d6               \n\t"   // Expand to 32-bit, ignoring expanded d7
-        "vcvt.f32.u32   q3, q3               \n\t"   // Convert to float
-        "vmul.f32       q3, q3, %y2          \n\t"   // Normalize
-        "vst1.f32       {q3}, [%0]!          \n\t"   // Store, next
-        :"+r"(dst) :"r"(lsrc), "w"(d)
-        : "q3", "memory"
-        );
-        #else
-        const GLubyte b = src[0], g = src[1], r = src[2], a = src[3];
-        *dst++ = r*d;
-        *dst++ = g*d;
-        *dst++ = b*d;
-        *dst++ = a*d;
-        #endif
-        src+=stride;
-    }
+    array_bgra_f(dst, src, stride, count-skip);
     return dest;
 }
 
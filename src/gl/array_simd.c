@@ -0,0 +1,224 @@
+#include "array_simd.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ARRAY_SSE2
+#define ARRAY_SIMD
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ARRAY_NEON
+#define ARRAY_SIMD
+#endif
+
+#ifdef ARRAY_SIMD
+// lanes < width are set
+static const uint32_t lane_mask[5][4] = {
+    {0, 0, 0, 0},
+    {0xffffffff, 0, 0, 0},
+    {0xffffffff, 0xffffffff, 0, 0},
+    {0xffffffff, 0xffffffff, 0xffffffff, 0},
+    {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}
+};
+#endif
+
+#ifdef ARRAY_SSE2
+typedef __m128 vec4;
+static inline vec4 v_load(const void *p) { return _mm_loadu_ps((const float*)p); }
+static inline void v_store(GLfloat *p, vec4 v) { _mm_storeu_ps(p, v); }
+static inline vec4 v_mask(int width) { return _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)lane_mask[width])); }
+static inline vec4 v_select(vec4 mask, vec4 a, vec4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline vec4 v_mul(vec4 a, GLfloat s) { return _mm_mul_ps(a, _mm_set1_ps(s)); }
+static inline vec4 v_ubyte(uint32_t u) {
+    const __m128i z = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u), z);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, z));
+}
+static inline vec4 v_ushort(const void *p) {
+    __m128i x = _mm_loadl_epi64((const __m128i*)p);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, _mm_setzero_si128()));
+}
+static inline vec4 v_double(const void *p) {
+    const double *d = (const double*)p;
+    return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(d)), _mm_cvtpd_ps(_mm_loadu_pd(d+2)));
+}
+#endif
+
+#ifdef ARRAY_NEON
+typedef float32x4_t vec4;
+static inline vec4 v_load(const void *p) { return vld1q_f32((const float*)p); }
+static inline void v_store(GLfloat *p, vec4 v) { vst1q_f32(p, v); }
+static inline vec4 v_mask(int width) { return vreinterpretq_f32_u32(vld1q_u32(lane_mask[width])); }
+static inline vec4 v_select(vec4 mask, vec4 a, vec4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+static inline vec4 v_mul(vec4 a, GLfloat s) { return vmulq_n_f32(a, s); }
+static inline vec4 v_ubyte(uint32_t u) {
+    uint16x8_t h = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(u)));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(h)));
+}
+static inline vec4 v_ushort(const void *p) {
+    uint64_t u;
+    memcpy(&u, p, sizeof(u));
+    return vcvtq_f32_u32(vmovl_u16(vcreate_u16(u)));
+}
+static inline vec4 v_double(const void *p) {
+    const double *d = (const double*)p;
+#ifdef __aarch64__
+    return vcombine_f32(vcvt_f32_f64(vld1q_f64(d)), vcvt_f32_f64(vld1q_f64(d+2)));
+#else
+    // no double in ARMv7 NEON
+    GLfloat f[4] = {d[0], d[1], d[2], d[3]};
+    return vld1q_f32(f);
+#endif
+}
+#endif
+
+#ifdef ARRAY_SIMD
+// number of elements (from the first one) that can be read with a load of "load" bytes
+// and written with a store of 4 floats, without going past the end of in or out
+static inline GLsizei simd_count(GLsizei count, GLsizei stride, int bytes, int load, GLsizei to_width)
+{
+    long end = (long)(count-1)*stride + bytes;
+    if(end<load || count*to_width<4)
+        return 0;
+    long n = (end-load)/stride + 1;
+    long nout = (count*to_width-4)/to_width + 1;
+    if(n>nout)
+        n = nout;
+    return (n>count)?count:n;
+}
+
+static inline vec4 v_pad(GLsizei width, GLsizei to_width, const GLfloat *pad)
+{
+    GLfloat p[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int j=width; j<to_width; ++j)
+        p[j] = pad[j];
+    return v_load(p);
+}
+#endif
+
+void array_copy_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei width, GLsizei to_width, GLsizei count, const GLfloat *pad)
+{
+    const char *src = (const char*)in;
+    GLsizei i = 0;
+#ifdef ARRAY_SIMD
+    GLsizei n = simd_count(count, stride, width*sizeof(GLfloat), 4*sizeof(GLfloat), to_width);
+    if(n) {
+        // the 4 floats store write into the next element when to_width<4, it will be overwritten after
+        const vec4 vpad = v_pad(width, to_width, pad);
+        const vec4 mask = v_mask(width);
+        for (; i<n; ++i) {
+            v_store(out, v_select(mask, v_load(src), vpad));
+            src += stride;
+            out += to_width;
+        }
+    }
+#endif
+    for (; i<count; ++i) {
+        const GLfloat *f = (const GLfloat*)src;
+        int j;
+        for (j=0; j<width; ++j)
+            out[j] = f[j];
+        for (; j<to_width; ++j)
+            out[j] = pad[j];
+        src += stride;
+        out += to_width;
+    }
+}
+
+void array_double_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei width, GLsizei to_width, GLsizei count, const GLfloat *pad)
+{
+    const char *src = (const char*)in;
+    GLsizei i = 0;
+#ifdef ARRAY_SIMD
+    GLsizei n = simd_count(count, stride, width*sizeof(GLdouble), 4*sizeof(GLdouble), to_width);
+    if(n) {
+        const vec4 vpad = v_pad(width, to_width, pad);
+        const vec4 mask = v_mask(width);
+        for (; i<n; ++i) {
+            v_store(out, v_select(mask, v_double(src), vpad));
+            src += stride;
+            out += to_width;
+        }
+    }
+#endif
+    for (; i<count; ++i) {
+        const GLdouble *d = (const GLdouble*)src;
+        int j;
+        for (j=0; j<width; ++j)
+            out[j] = d[j];
+        for (; j<to_width; ++j)
+            out[j] = pad[j];
+        src += stride;
+        out += to_width;
+    }
+}
+
+void array_ubyte_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei count, GLfloat scale)
+{
+    const char *src = (const char*)in;
+#ifdef ARRAY_SIMD
+    for (GLsizei i=0; i<count; ++i) {
+        uint32_t u;
+        memcpy(&u, src, sizeof(u));
+        v_store(out, v_mul(v_ubyte(u), scale));
+        src += stride;
+        out += 4;
+    }
+#else
+    for (GLsizei i=0; i<count; ++i) {
+        const GLubyte *b = (const GLubyte*)src;
+        for (int j=0; j<4; ++j)
+            out[j] = ((GLfloat)b[j])*scale;
+        src += stride;
+        out += 4;
+    }
+#endif
+}
+
+void array_ushort_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei count, GLfloat scale)
+{
+    const char *src = (const char*)in;
+#ifdef ARRAY_SIMD
+    for (GLsizei i=0; i<count; ++i) {
+        v_store(out, v_mul(v_ushort(src), scale));
+        src += stride;
+        out += 4;
+    }
+#else
+    for (GLsizei i=0; i<count; ++i) {
+        const GLushort *s = (const GLushort*)src;
+        for (int j=0; j<4; ++j)
+            out[j] = ((GLfloat)s[j])*scale;
+        src += stride;
+        out += 4;
+    }
+#endif
+}
+
+void array_bgra_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei count)
+{
+    static const GLfloat d = 1.0f/255.0f;
+    const char *src = (const char*)in;
+#ifdef ARRAY_SIMD
+    for (GLsizei i=0; i<count; ++i) {
+        uint32_t u;
+        memcpy(&u, src, sizeof(u));
+        u = (u&0xff00ff00) | ((u&0x00ff0000)>>16) | ((u&0x000000ff)<<16);   // swap R and B
+        v_store(out, v_mul(v_ubyte(u), d));
+        src += stride;
+        out += 4;
+    }
+#else
+    for (GLsizei i=0; i<count; ++i) {
+        const GLubyte *b = (const GLubyte*)src;
+        out[0] = b[2]*d;
+        out[1] = b[1]*d;
+        out[2] = b[0]*d;
+        out[3] = b[3]*d;
+        src += stride;
+        out += 4;
+    }
+#endif
+}
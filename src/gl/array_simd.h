@@ -0,0 +1,22 @@
+#ifndef _GL4ES_ARRAY_SIMD_H_
+#define _GL4ES_ARRAY_SIMD_H_
+
+#include "gles.h"
+
+// Kernels used by copy_gl_array* to convert client arrays to float.
+// in is read count times, stride bytes apart (stride must be >0), out is packed (to_width floats per element).
+// Components width..to_width-1 are taken from pad. Results are the same as the plain C loops.
+// NEON or SSE2 is used if the build target has it, a scalar loop otherwise.
+
+// float[width] => float[to_width]
+void array_copy_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei width, GLsizei to_width, GLsizei count, const GLfloat *pad);
+// double[width] => float[to_width]
+void array_double_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei width, GLsizei to_width, GLsizei count, const GLfloat *pad);
+// ubyte[4] => float[4]*scale
+void array_ubyte_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei count, GLfloat scale);
+// ushort[4] => float[4]*scale
+void array_ushort_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei count, GLfloat scale);
+// ubyte BGRA => float RGBA / 255
+void array_bgra_f(GLfloat *out, const GLvoid *in, GLsizei stride, GLsizei count);
+
+#endif // _GL4ES_ARRAY_SIMD_H_
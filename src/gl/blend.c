@@ -3,6 +3,7 @@
 #include "../glx/hardext.h"
 #include "debug.h"
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "init.h"
 #include "loader.h"
@@ -30,7 +31,6 @@ void gl4es_glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfac
     if(!glstate->list.pending) 
         PUSH_IF_COMPILING(glBlendFuncSeparate)
 
-    LOAD_GLES2_OR_OES(glBlendFuncSeparate);
     if(sfactorRGB==glstate->blendsfactorrgb && dfactorRGB==glstate->blenddfactorrgb 
         && sfactorAlpha==glstate->blendsfactoralpha && dfactorAlpha==glstate->blenddfactoralpha)
         return; // no change...
@@ -38,6 +38,7 @@ void gl4es_glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfac
     FLUSH_BEGINEND;
 
 #ifndef PANDORA
+    LOAD_GLES2_OR_OES(glBlendFuncSeparate);
     if(gles_glBlendFuncSeparate==NULL) {
         // some fallback function to have better rendering with SDL2, better then nothing...
         if(sfactorRGB==GL_SRC_ALPHA && dfactorRGB==GL_ONE_MINUS_SRC_ALPHA && sfactorAlpha==GL_ONE && dfactorAlpha==GL_ONE_MINUS_SRC_ALPHA)
@@ -50,7 +51,7 @@ void gl4es_glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfac
             gl4es_glBlendFunc(sfactorRGB, dfactorRGB);
     } else
 #endif
-    gles_glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+    gleshard_glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
 
     glstate->blendsfactorrgb = sfactorRGB;
     glstate->blenddfactorrgb = dfactorRGB;
@@ -62,11 +63,11 @@ void glBlendFuncSeparateEXT (GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfacto
 
 void gl4es_glBlendEquationSeparate(GLenum modeRGB, GLenum modeA) {
     PUSH_IF_COMPILING(glBlendEquationSeparate);
-    LOAD_GLES2_OR_OES(glBlendEquationSeparate);
 #ifndef PANDORA
+    LOAD_GLES2_OR_OES(glBlendEquationSeparate);
     if(gles_glBlendEquationSeparate)
 #endif
-    gles_glBlendEquationSeparate(modeRGB, modeA);
+    gleshard_glBlendEquationSeparate(modeRGB, modeA);
 }
 void glBlendEquationSeparate(GLenum modeRGB, GLenum modeA) AliasExport("gl4es_glBlendEquationSeparate");
 void glBlendEquationSeparateEXT(GLenum modeRGB, GLenum modeA) AliasExport("gl4es_glBlendEquationSeparate");
@@ -81,7 +82,6 @@ void gl4es_glBlendFunc(GLenum sfactor, GLenum dfactor) {
 
     FLUSH_BEGINEND;
 
-    LOAD_GLES(glBlendFunc);
     LOAD_GLES2_OR_OES(glBlendFuncSeparate);
     errorGL();
     
@@ -94,14 +94,14 @@ void gl4es_glBlendFunc(GLenum sfactor, GLenum dfactor) {
         #if 0
         case GL_SRC_COLOR:
             if (gles_glBlendFuncSeparate) {
-                gles_glBlendFuncSeparate(sfactor, dfactor, sfactor, dfactor);
+                gleshard_glBlendFuncSeparate(sfactor, dfactor, sfactor, dfactor);
                 return;
             }
             sfactor = GL_ONE;   // approx...
             break;
         case GL_ONE_MINUS_SRC_COLOR:
             if (gles_glBlendFuncSeparate) {
-                gles_glBlendFuncSeparate(sfactor, dfactor, sfactor, dfactor);
+                gleshard_glBlendFuncSeparate(sfactor, dfactor, sfactor, dfactor);
                 return;
             }
             sfactor = GL_ONE;  // not sure it make sense...
@@ -151,20 +151,21 @@ void gl4es_glBlendFunc(GLenum sfactor, GLenum dfactor) {
         sfactor = GL_ONE;
     }
 #ifdef ODROID
+    LOAD_GLES(glBlendFunc);
     if(gles_glBlendFunc)
 #endif
-    gles_glBlendFunc(sfactor, dfactor);
+    gleshard_glBlendFunc(sfactor, dfactor);
 }
 void glBlendFunc(GLenum sfactor, GLenum dfactor) AliasExport("gl4es_glBlendFunc");
 
 void gl4es_glBlendEquation(GLenum mode) {
     PUSH_IF_COMPILING(glBlendEquation)
-    LOAD_GLES2_OR_OES(glBlendEquation);
     errorGL();
 #ifdef ODROID
+    LOAD_GLES2_OR_OES(glBlendEquation);
     if(gles_glBlendEquation)
 #endif
-    gles_glBlendEquation(mode);
+    gleshard_glBlendEquation(mode);
 }
 void glBlendEquation(GLenum mode) AliasExport("gl4es_glBlendEquation");
 void glBlendEquationEXT(GLenum mode) AliasExport("gl4es_glBlendEquation");
\ No newline at end of file
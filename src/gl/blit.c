@@ -5,6 +5,7 @@
 
 #include "fpe.h"
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "init.h"
 #include "loader.h"
@@ -345,7 +346,6 @@ void gl4es_blitTexture(GLuint texture,
     GLfloat x, GLfloat y, GLint mode) {
 //printf("blitTexture(%d, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %d) customvp=%d, vp=%d/%d/%d/%d\n", texture, sx, sy, width, height, nwidth, nheight, zoomx, zoomy, vpwidth, vpheight, x, y, mode, (vpwidth>0.0), glstate->raster.viewport.x, glstate->raster.viewport.y, glstate->raster.viewport.width, glstate->raster.viewport.height);
     LOAD_GLES(glBindTexture);
-    LOAD_GLES(glActiveTexture);
     LOAD_GLES(glEnable);
     LOAD_GLES(glDisable);
 
@@ -353,10 +353,7 @@ void gl4es_blitTexture(GLuint texture,
 
     gl4es_glPushAttrib(GL_TEXTURE_BIT | GL_ENABLE_BIT | GL_TRANSFORM_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
 
-    if(glstate->gleshard->active) {
-        glstate->gleshard->active = 0;
-        gles_glActiveTexture(GL_TEXTURE0);
-    }
+    gleshard_glActiveTexture(GL_TEXTURE0);
 
     GLint depthwrite = glstate->depth.mask;
 
@@ -693,6 +693,13 @@ void bindBuffer(GLenum target, GLuint buffer)
         glstate->bind_buffer.index = buffer;
         DBG(printf("Bind buffer %d to GL_ELEMENT_ARRAY_BUFFER\n", buffer);)
         gles_glBindBuffer(target, buffer);
+    } else if (target==GL_PIXEL_UNPACK_BUFFER) {
+        if(glstate->bind_buffer.unpack == buffer)
+            return;
+        DBG(printf("Bind buffer %d to GL_PIXEL_UNPACK_BUFFER\n", buffer);)
+        glstate->bind_buffer.unpack = buffer;
+        gles_glBindBuffer(target, buffer);
+        return;
     } else {
         LOGE("Warning, unhandled Buffer type %s in bindBuffer\n", PrintEnum(target));
         return;
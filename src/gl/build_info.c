@@ -7,3 +7,12 @@ void print_build_infos()
 {
 	SHUT_LOGD("v%d.%d.%d built on %s %s\n", MAJOR, MINOR, REVISION, __DATE__, __TIME__);
 }
+
+const char* get_build_id()
+{
+	// build_info.c is rebuilt each time a source change
+	static char id[100] = {0};
+	if(!id[0])
+		snprintf(id, sizeof(id), "v%d.%d.%d %s %s", MAJOR, MINOR, REVISION, __DATE__, __TIME__);
+	return id;
+}
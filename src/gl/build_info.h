@@ -2,5 +2,6 @@
 #define _GL4ES_BUILD_INFO_H_
 
 void print_build_infos();
+const char* get_build_id();
 
 #endif // _GL4ES_BUILD_INFO_H_
@@ -492,6 +492,12 @@
 #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT  0x8C4E
 #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT  0x8C4F
 
+/* sRGB textures */
+#define GL_SRGB                                 0x8C40
+#define GL_SRGB8                                0x8C41
+#define GL_SRGB_ALPHA                           0x8C42
+#define GL_SRGB8_ALPHA8                         0x8C43
+
 
 /* Render Mode */
 #define GL_SELECT                         0x1c02
@@ -1,6 +1,7 @@
 #include "depth.h"
 
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "loader.h"
 
@@ -13,9 +14,8 @@ void gl4es_glDepthFunc(GLenum func) {
         return;
     FLUSH_BEGINEND;
     glstate->depth.func = func;
-    LOAD_GLES(glDepthFunc);
     errorGL();
-    gles_glDepthFunc(func);
+    gleshard_glDepthFunc(func);
 }
 
 void gl4es_glDepthMask(GLboolean flag) {
@@ -27,9 +27,8 @@ void gl4es_glDepthMask(GLboolean flag) {
         return;
     FLUSH_BEGINEND;
     glstate->depth.mask = flag;
-    LOAD_GLES(glDepthMask);
     errorGL();
-    gles_glDepthMask(flag);
+    gleshard_glDepthMask(flag);
 }
 
 GLfloat clamp(GLfloat a) {
@@ -179,7 +179,7 @@ static renderlist_t *arrays_to_renderlist(renderlist_t *list, GLenum mode,
     return list;
 }
 static renderlist_t *arrays_add_renderlist(renderlist_t *a, GLenum mode,
-                                        GLsizei skip, GLsizei count, GLushort* indices, int ilen_b) {
+                                        GLsizei skip, GLsizei count, GLuint* indices, int ilen_b) {
     DBG(LOGD("arrays_add_renderlist(%p, %s, %d, %d, %p, %d)\n", a, PrintEnum(mode), skip, count, indices, ilen_b);)
     // check cache if any
     if(glstate->vao->shared_arrays)  {
@@ -264,7 +264,8 @@ static inline bool should_intercept_render(GLenum mode) {
     if ((hardext.esversion==1) && (glstate->vao->vertexattrib[ATT_COLOR].enabled && (glstate->vao->vertexattrib[ATT_COLOR].size != 4)))
         return true;
     return (
-        (glstate->vao->vertexattrib[ATT_VERTEX].enabled && ! valid_vertex_type(glstate->vao->vertexattrib[ATT_VERTEX].type)) ||
+        // with GLES2+, the other types are converted in realize_glenv, without going through a renderlist
+        (hardext.esversion==1 && glstate->vao->vertexattrib[ATT_VERTEX].enabled && ! valid_vertex_type(glstate->vao->vertexattrib[ATT_VERTEX].type)) ||
         (mode == GL_LINES && glstate->enable.line_stipple) ||
         /*(mode == GL_QUADS) ||*/ (glstate->list.active && !glstate->list.pending)
     );
@@ -303,12 +304,6 @@ static void glDrawElementsCommon(GLenum mode, GLint first, GLsizei count, GLuint
             else                                            \
                 fpe_glDisableClientState(B);                \
         }
-#if 0
-// FEZ draw the stars (intro menu and the ones visible by night)
-// by drawing a huge list of 500k+ triangles!
-// it's a bit too much for mobile hardware, so it can be simply disabled here
-if(count>500000) return;
-#endif
     GLenum mode_init = mode;
     /*if (glstate->polygon_mode == GL_LINE && mode>=GL_TRIANGLES)
         mode = GL_LINE_LOOP;*/
@@ -353,7 +348,6 @@ if(count>500000) return;
     }
     // of course, GL_SELECT with shader will just not work if not using standard transformation method... Instance count is ignored also
     if (glstate->render_mode == GL_SELECT) {
-        // TODO handling uint indices
         if(!sindices && !iindices)
             select_glDrawArrays(&glstate->vao->vertexattrib[ATT_VERTEX], mode, first, count);
         else
@@ -481,11 +475,16 @@ void gl4es_glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei co
 	noerrorShim();
     GLushort *sindices = NULL;
     GLuint *iindices = NULL;
+    GLuint *lindices = NULL;
     bool need_free = !(
         (type==GL_UNSIGNED_SHORT) || 
-        (!compiling && !intercept && type==GL_UNSIGNED_INT && hardext.elementuint)
+        (type==GL_UNSIGNED_INT && hardext.elementuint)
         );
-    if(need_free) {
+    if(compiling || intercept) {
+        // renderlist always use 32bits indices
+        lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+            type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+    } else if(need_free) {
         sindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
             type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
     } else {
@@ -496,20 +495,15 @@ void gl4es_glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei co
     }
 
     if (compiling) {
-        // TODO, handle uint indices
         renderlist_t *list = glstate->list.active;
 
-        if(!need_free) {
-            GLushort *tmp = sindices;
-            sindices = (GLushort*)malloc(count*sizeof(GLushort));
-            memcpy(sindices, tmp, count*sizeof(GLushort));
-        }
-        for (int i=0; i<count; i++) sindices[i]-=start; //TODO: should be optimizable
+        for (int i=0; i<count; i++) lindices[i]-=start; //TODO: should be optimizable
 
-        if(globals4es.mergelist && list->stage>=STAGE_DRAW && is_list_compatible(list) && !list->use_glstate && sindices) {
+        if(globals4es.mergelist && list->stage>=STAGE_DRAW && is_list_compatible(list) && !list->use_glstate) {
             list = NewDrawStage(list, mode);
             if(list->vert) {
-                glstate->list.active = arrays_add_renderlist(list, mode, start, end + 1, sindices, count);
+                glstate->list.active = arrays_add_renderlist(list, mode, start, end + 1, lindices, count);
+                free(lindices);
                 NewStage(glstate->list.active, STAGE_POSTDRAW);
                 return;
             }
@@ -518,7 +512,7 @@ void gl4es_glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei co
 		NewStage(list, STAGE_DRAW);
 
         glstate->list.active = list = arrays_to_renderlist(list, mode, start, end + 1);
-        list->indices = sindices;
+        list->indices = lindices;
         list->ilen = count;
         list->indice_cap = count;
         //end_renderlist(list);
@@ -528,17 +522,11 @@ void gl4es_glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei co
     }
 
     if (intercept) {
-         //TODO handling uint indices
         renderlist_t *list = NULL;
 
-        if(!need_free) {
-            GLushort *tmp = sindices;
-            sindices = (GLushort*)malloc(count*sizeof(GLushort));
-            memcpy(sindices, tmp, count*sizeof(GLushort));
-        }
-        for (int i=0; i<count; i++) sindices[i]-=start;
+        for (int i=0; i<count; i++) lindices[i]-=start;
         list = arrays_to_renderlist(list, mode, start, end + 1);
-        list->indices = sindices;
+        list->indices = lindices;
         list->ilen = count;
         list->indice_cap = count;
         list = end_renderlist(list);
@@ -587,12 +575,17 @@ void gl4es_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid
 	noerrorShim();
     GLushort *sindices = NULL;
     GLuint *iindices = NULL;
+    GLuint *lindices = NULL;
     GLuint old_index = 0;
     bool need_free = !(
         (type==GL_UNSIGNED_SHORT) || 
-        (!compiling && !intercept && type==GL_UNSIGNED_INT && hardext.elementuint)
+        (type==GL_UNSIGNED_INT && hardext.elementuint)
         );
-    if(need_free) {
+    if(compiling || intercept) {
+        // renderlist always use 32bits indices
+        lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+            type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+    } else if(need_free) {
         sindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
             type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
         old_index = wantBufferIndex(0);
@@ -604,21 +597,15 @@ void gl4es_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid
     }
 
     if (compiling) {
-        // TODO, handle uint indices
         renderlist_t *list = glstate->list.active;
         GLsizei min, max;
 
-        if(!need_free) {
-            GLushort *tmp = sindices;
-            sindices = (GLushort*)malloc(count*sizeof(GLushort));
-            memcpy(sindices, tmp, count*sizeof(GLushort));
-        }
+        normalize_indices_ui(lindices, &max, &min, count);
 
-        normalize_indices_us(sindices, &max, &min, count);
-
-        if(globals4es.mergelist && list->stage>=STAGE_DRAW && is_list_compatible(list) && !list->use_glstate && sindices) {
+        if(globals4es.mergelist && list->stage>=STAGE_DRAW && is_list_compatible(list) && !list->use_glstate) {
             list = NewDrawStage(list, mode);
-            glstate->list.active = arrays_add_renderlist(list, mode, min, max + 1, sindices, count);
+            glstate->list.active = arrays_add_renderlist(list, mode, min, max + 1, lindices, count);
+            free(lindices);
             NewStage(glstate->list.active, STAGE_POSTDRAW);
             return;
         }
@@ -626,7 +613,7 @@ void gl4es_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid
 		NewStage(list, STAGE_DRAW);
 
         glstate->list.active = list = arrays_to_renderlist(list, mode, min, max + 1);
-        list->indices = sindices;
+        list->indices = lindices;
         list->ilen = count;
         list->indice_cap = count;
         //end_renderlist(list);
@@ -636,18 +623,12 @@ void gl4es_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid
     }
 
     if (intercept) {
-         //TODO handling uint indices
         renderlist_t *list = NULL;
         GLsizei min, max;
 
-        if(!need_free) {
-            GLushort *tmp = sindices;
-            sindices = (GLushort*)malloc(count*sizeof(GLushort));
-            memcpy(sindices, tmp, count*sizeof(GLushort));
-        }
-        normalize_indices_us(sindices, &max, &min, count);
+        normalize_indices_ui(lindices, &max, &min, count);
         list = arrays_to_renderlist(list, mode, min, max + 1);
-        list->indices = sindices;
+        list->indices = lindices;
         list->ilen = count;
         list->indice_cap = count;
         list = end_renderlist(list);
@@ -929,12 +910,17 @@ void gl4es_glMultiDrawElements( GLenum mode, GLsizei *counts, GLenum type, const
         noerrorShim();
         GLushort *sindices = NULL;
         GLuint *iindices = NULL;
+        GLuint *lindices = NULL;
         GLuint old_index = 0;
         bool need_free = !(
             (type==GL_UNSIGNED_SHORT) || 
-            (!compiling && !intercept && type==GL_UNSIGNED_INT && hardext.elementuint)
+            (type==GL_UNSIGNED_INT && hardext.elementuint)
             );
-        if(need_free) {
+        if(compiling || intercept) {
+            // renderlist always use 32bits indices
+            lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+                type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+        } else if(need_free) {
             sindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
                 type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
             old_index = wantBufferIndex(0);
@@ -946,21 +932,15 @@ void gl4es_glMultiDrawElements( GLenum mode, GLsizei *counts, GLenum type, const
         }
 
         if (compiling) {
-            // TODO, handle uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
             NewStage(glstate->list.active, STAGE_DRAW);
             list = glstate->list.active;
 
-            if(!need_free) {
-                GLushort *tmp = sindices;
-                sindices = (GLushort*)malloc(count*sizeof(GLushort));
-                memcpy(sindices, tmp, count*sizeof(GLushort));
-            }
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             list = arrays_to_renderlist(list, mode, min, max + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             //end_renderlist(list);
@@ -974,21 +954,15 @@ void gl4es_glMultiDrawElements( GLenum mode, GLsizei *counts, GLenum type, const
         }
 
         if (intercept) {
-            //TODO handling uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
-            if(!need_free) {
-                GLushort *tmp = sindices;
-                sindices = (GLushort*)malloc(count*sizeof(GLushort));
-                memcpy(sindices, tmp, count*sizeof(GLushort));
-            }
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             if(list) {
                 NewStage(list, STAGE_DRAW);
             }
             list = arrays_to_renderlist(list, mode, min, max + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             continue;
@@ -1046,8 +1020,12 @@ void gl4es_glMultiDrawElementsBaseVertex( GLenum mode, GLsizei *counts, GLenum t
         noerrorShim();
         GLushort *sindices = NULL;
         GLuint *iindices = NULL;
+        GLuint *lindices = NULL;
 
-        if(type==GL_UNSIGNED_INT && hardext.elementuint && !compiling && !intercept)
+        if(compiling || intercept)
+            lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+                type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+        else if(type==GL_UNSIGNED_INT && hardext.elementuint)
             iindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
                 type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
         else
@@ -1055,16 +1033,15 @@ void gl4es_glMultiDrawElementsBaseVertex( GLenum mode, GLsizei *counts, GLenum t
                 type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
 
         if (compiling) {
-            // TODO, handle uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
             NewStage(glstate->list.active, STAGE_DRAW);
             list = glstate->list.active;
 
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             list = arrays_to_renderlist(list, mode, min + basevertex[i], max + basevertex[i] + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             //end_renderlist(list);
@@ -1078,15 +1055,14 @@ void gl4es_glMultiDrawElementsBaseVertex( GLenum mode, GLsizei *counts, GLenum t
         }
 
         if (intercept) {
-            //TODO handling uint indices
             GLsizei min, max;
 
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             if(list) {
                 NewStage(list, STAGE_DRAW);
             }
             list = arrays_to_renderlist(list, mode, min + basevertex[i], max + basevertex[i] + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             continue;
@@ -1147,8 +1123,12 @@ void gl4es_glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, con
         noerrorShim();
         GLushort *sindices = NULL;
         GLuint *iindices = NULL;
+        GLuint *lindices = NULL;
 
-        if(type==GL_UNSIGNED_INT && hardext.elementuint && !compiling && !intercept)
+        if(compiling || intercept)
+            lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+                type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+        else if(type==GL_UNSIGNED_INT && hardext.elementuint)
             iindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
                 type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
         else
@@ -1156,16 +1136,15 @@ void gl4es_glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, con
                 type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
 
         if (compiling) {
-            // TODO, handle uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
             NewStage(glstate->list.active, STAGE_DRAW);
             list = glstate->list.active;
 
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             list = arrays_to_renderlist(list, mode, min + basevertex, max + basevertex + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             //end_renderlist(list);
@@ -1179,13 +1158,12 @@ void gl4es_glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, con
         }
 
         if (intercept) {
-            //TODO handling uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             list = arrays_to_renderlist(list, mode, min + basevertex, max + basevertex + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             list = end_renderlist(list);
@@ -1243,7 +1221,11 @@ void gl4es_glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end,
         noerrorShim();
         GLushort *sindices = NULL;
         GLuint *iindices = NULL;
-        if(type==GL_UNSIGNED_INT && hardext.elementuint && !compiling && !intercept)
+        GLuint *lindices = NULL;
+        if(compiling || intercept)
+            lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+                type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+        else if(type==GL_UNSIGNED_INT && hardext.elementuint)
             iindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
                 type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
         else
@@ -1251,15 +1233,14 @@ void gl4es_glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end,
                 type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
 
         if (compiling) {
-            // TODO, handle uint indices
             renderlist_t *list = NULL;
 
             NewStage(glstate->list.active, STAGE_DRAW);
             list = glstate->list.active;
 
-            for (int i=0; i<count; i++) sindices[i]-=start;
+            for (int i=0; i<count; i++) lindices[i]-=start;
             list = arrays_to_renderlist(list, mode, start + basevertex, end + basevertex + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             //end_renderlist(list);
@@ -1273,12 +1254,11 @@ void gl4es_glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end,
         }
 
         if (intercept) {
-            //TODO handling uint indices
             renderlist_t *list = NULL;
 
-            for (int i=0; i<count; i++) sindices[i]-=start;
+            for (int i=0; i<count; i++) lindices[i]-=start;
             list = arrays_to_renderlist(list, mode, start + basevertex, end + basevertex + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             list = end_renderlist(list);
@@ -1430,12 +1410,17 @@ void gl4es_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, cons
 	noerrorShim();
     GLushort *sindices = NULL;
     GLuint *iindices = NULL;
+    GLuint *lindices = NULL;
     GLuint old_index = 0;
     bool need_free = !(
         (type==GL_UNSIGNED_SHORT) || 
-        (!compiling && !intercept && type==GL_UNSIGNED_INT && hardext.elementuint)
+        (type==GL_UNSIGNED_INT && hardext.elementuint)
         );
-    if(need_free) {
+    if(compiling || intercept) {
+        // renderlist always use 32bits indices
+        lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+            type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+    } else if(need_free) {
         sindices = copy_gl_array((glstate->vao->elements)?(glstate->vao->elements->data + (uintptr_t)indices):indices,
             type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
         old_index = wantBufferIndex(0);
@@ -1447,21 +1432,15 @@ void gl4es_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, cons
     }
 
     if (compiling) {
-        // TODO, handle uint indices
         renderlist_t *list = NULL;
         GLsizei min, max;
 
 		NewStage(glstate->list.active, STAGE_DRAW);
         list = glstate->list.active;
 
-        if(!need_free) {
-            GLushort *tmp = sindices;
-            sindices = (GLushort*)malloc(count*sizeof(GLushort));
-            memcpy(sindices, tmp, count*sizeof(GLushort));
-        }
-        normalize_indices_us(sindices, &max, &min, count);
+        normalize_indices_ui(lindices, &max, &min, count);
         list = arrays_to_renderlist(list, mode, min, max + 1);
-        list->indices = sindices;
+        list->indices = lindices;
         list->ilen = count;
         list->indice_cap = count;
         list->instanceCount = primcount;
@@ -1476,18 +1455,12 @@ void gl4es_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, cons
     }
 
     if (intercept) {
-         //TODO handling uint indices
         renderlist_t *list = NULL;
         GLsizei min, max;
 
-        if(!need_free) {
-            GLushort *tmp = sindices;
-            sindices = (GLushort*)malloc(count*sizeof(GLushort));
-            memcpy(sindices, tmp, count*sizeof(GLushort));
-        }
-        normalize_indices_us(sindices, &max, &min, count);
+        normalize_indices_ui(lindices, &max, &min, count);
         list = arrays_to_renderlist(list, mode, min, max + 1);
-        list->indices = sindices;
+        list->indices = lindices;
         list->ilen = count;
         list->indice_cap = count;
         list->instanceCount = primcount;
@@ -1540,8 +1513,12 @@ void gl4es_glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum
         noerrorShim();
         GLushort *sindices = NULL;
         GLuint *iindices = NULL;
+        GLuint *lindices = NULL;
 
-        if(type==GL_UNSIGNED_INT && hardext.elementuint && !compiling && !intercept)
+        if(compiling || intercept)
+            lindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
+                type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
+        else if(type==GL_UNSIGNED_INT && hardext.elementuint)
             iindices = copy_gl_array((glstate->vao->elements)?glstate->vao->elements->data + (uintptr_t)indices:indices,
                 type, 1, 0, GL_UNSIGNED_INT, 1, 0, count, NULL);
         else
@@ -1549,16 +1526,15 @@ void gl4es_glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum
                 type, 1, 0, GL_UNSIGNED_SHORT, 1, 0, count, NULL);
 
         if (compiling) {
-            // TODO, handle uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
             NewStage(glstate->list.active, STAGE_DRAW);
             list = glstate->list.active;
 
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             list = arrays_to_renderlist(list, mode, min + basevertex, max + basevertex + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             list->instanceCount = primcount;
@@ -1573,13 +1549,12 @@ void gl4es_glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum
         }
 
         if (intercept) {
-            //TODO handling uint indices
             renderlist_t *list = NULL;
             GLsizei min, max;
 
-            normalize_indices_us(sindices, &max, &min, count);
+            normalize_indices_ui(lindices, &max, &min, count);
             list = arrays_to_renderlist(list, mode, min + basevertex, max + basevertex + 1);
-            list->indices = sindices;
+            list->indices = lindices;
             list->ilen = count;
             list->indice_cap = count;
             list->instanceCount = primcount;
@@ -154,6 +154,18 @@ static const GLboolean pixel_hasalpha(GLenum format) {
     }
 }
 
+// types GLES2+ can take directly in glVertexAttribPointer
+static inline const GLboolean valid_vertexattrib_type(GLenum type) {
+    switch (type) {
+        case GL_DOUBLE:
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+            return false;
+        default:
+            return true;
+    }
+}
+
 static inline const GLboolean valid_vertex_type(GLenum type) {
     switch (type) {
         case GL_UNSIGNED_BYTE:
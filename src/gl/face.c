@@ -2,6 +2,7 @@
 
 #include "loader.h"
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 
 void gl4es_glCullFace(GLenum mode) {
@@ -18,8 +19,7 @@ void gl4es_glCullFace(GLenum mode) {
     FLUSH_BEGINEND;
     
     glstate->face.cull = mode;
-    LOAD_GLES(glCullFace);
-    gles_glCullFace(mode);
+    gleshard_glCullFace(mode);
 }
 
 void gl4es_glFrontFace(GLenum mode) {
@@ -36,8 +36,7 @@ void gl4es_glFrontFace(GLenum mode) {
     FLUSH_BEGINEND;
     
     glstate->face.front = mode;
-    LOAD_GLES(glFrontFace);
-    gles_glFrontFace(mode);
+    gleshard_glFrontFace(mode);
 }
 
 
@@ -65,6 +65,7 @@ void gl4es_glFogfv(GLenum pname, const GLfloat* params) {
             return;
     }
     #undef GO
+    BUILTIN_CHANGED(BUILTIN_FOG);
     LOAD_GLES_FPE(glFogfv);
     gles_glFogfv(pname, params);
     errorGL();
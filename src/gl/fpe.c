@@ -350,11 +350,17 @@ void fpe_oldprogram(fpe_state_t* state) {
 void fpe_program(int ispoint) {
     glstate->fpe_state->point = ispoint;
     fpe_state_t state;
-    fpe_ReleventState(&state, glstate->fpe_state, 1);
-    if(glstate->fpe==NULL || memcmp(&glstate->fpe->state, &state, sizeof(fpe_state_t))) {
-        // get cached fpe (or new one)
-        glstate->fpe = fpe_GetCache(glstate->fpe_cache, &state, 1);
-    }   
+    if(glstate->fpe && !memcmp(&glstate->fpe_last, glstate->fpe_state, sizeof(fpe_state_t))) {
+        // same raw state as last time, so same fpe (no need to filter the state and hash it)
+        memcpy(&state, &glstate->fpe->state, sizeof(fpe_state_t));
+    } else {
+        fpe_ReleventState(&state, glstate->fpe_state, 1);
+        if(glstate->fpe==NULL || memcmp(&glstate->fpe->state, &state, sizeof(fpe_state_t))) {
+            // get cached fpe (or new one)
+            glstate->fpe = fpe_GetCache(glstate->fpe_cache, &state, 1);
+        }
+        memcpy(&glstate->fpe_last, glstate->fpe_state, sizeof(fpe_state_t));
+    }
     if(glstate->fpe->glprogram==NULL) {
         glstate->fpe->prog = gl4es_glCreateProgram();
         DBG(int from_psa = 1;)
@@ -578,14 +584,19 @@ program_t* fpe_CustomShader_DefaultVertex(program_t* glprogram, fpe_state_t* sta
 }
 
 void fpe_SyncUniforms(uniformcache_t *cache, program_t* glprogram) {
-    //TODO: Optimize this...
+    // nothing changed in the parent since last sync?
+    if(glprogram->parent_serial == cache->serial)
+        return;
+    glprogram->parent_serial = cache->serial;
     khash_t(uniformlist) *uniforms = glprogram->uniform;
     uniform_t *m;
     khint_t k;
     DBG(int cnt = 0;)
     // don't use m->size, as each element has it's own uniform...
     kh_foreach(uniforms, k, m,
-        if(m->parent_size) {
+        // only the uniforms that got a new value in the parent since last sync
+        if(m->parent_size && m->parent_gen != cache->gen[m->parent_offs>>2]) {
+            m->parent_gen = cache->gen[m->parent_offs>>2];
             DBG(++cnt;)
             switch(m->type) {
                 case GL_FLOAT:
@@ -1138,11 +1149,23 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
             //gles_glFramebufferTexture2D(GL_FRAMEBUFFER, tex->binded_attachment, GL_TEXTURE_2D, tex->glname, 0);
         }
     }
+    // builtin uniforms groups changed since last upload to this program
+    uint32_t dirty = 0;
+    if(glprogram->builtin_serial != builtin_serial) {
+        for (int i=0; i<BUILTIN_MAX; i++)
+            if(glprogram->builtin_stamp[i] != glstate->builtin_stamp[i]) {
+                glprogram->builtin_stamp[i] = glstate->builtin_stamp[i];
+                dirty |= 1u<<i;
+            }
+        glprogram->builtin_serial = builtin_serial;
+    }
+    #define DIRTY(G) (dirty&(1u<<(G)))
     // setup fixed pipeline builtin matrix uniform if needed
-    if(glprogram->has_builtin_matrix)
+    if(glprogram->has_builtin_matrix && dirty)
     {
-        if(glprogram->builtin_matrix[MAT_MVP]!=-1 || glprogram->builtin_matrix[MAT_MVP_I]!=-1
-            || glprogram->builtin_matrix[MAT_MVP_T]!=-1 || glprogram->builtin_matrix[MAT_MVP_IT]!=-1)
+        if((DIRTY(BUILTIN_MV) || DIRTY(BUILTIN_P))
+            && (glprogram->builtin_matrix[MAT_MVP]!=-1 || glprogram->builtin_matrix[MAT_MVP_I]!=-1
+            || glprogram->builtin_matrix[MAT_MVP_T]!=-1 || glprogram->builtin_matrix[MAT_MVP_IT]!=-1))
         {
             GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_MVP], 1, GL_FALSE, getMVPMat());
             GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_MVP_T], 1, GL_TRUE, getMVPMat());
@@ -1153,8 +1176,9 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
                 GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_MVP_IT], 1, GL_TRUE, invmat);
             }
         }
-        if(glprogram->builtin_matrix[MAT_MV]!=-1 || glprogram->builtin_matrix[MAT_MV_I]!=-1
-            || glprogram->builtin_matrix[MAT_MV_T]!=-1 || glprogram->builtin_matrix[MAT_MV_IT]!=-1)
+        if(DIRTY(BUILTIN_MV)
+            && (glprogram->builtin_matrix[MAT_MV]!=-1 || glprogram->builtin_matrix[MAT_MV_I]!=-1
+            || glprogram->builtin_matrix[MAT_MV_T]!=-1 || glprogram->builtin_matrix[MAT_MV_IT]!=-1))
         {
             GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_MV], 1, GL_FALSE, getMVMat());
             GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_MV_T], 1, GL_TRUE, getMVMat());
@@ -1163,8 +1187,9 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
                 GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_MV_IT], 1, GL_TRUE, getInvMVMat());
             }
         }
-        if(glprogram->builtin_matrix[MAT_P]!=-1 || glprogram->builtin_matrix[MAT_P_I]!=-1
-            || glprogram->builtin_matrix[MAT_P_T]!=-1 || glprogram->builtin_matrix[MAT_P_IT]!=-1)
+        if(DIRTY(BUILTIN_P)
+            && (glprogram->builtin_matrix[MAT_P]!=-1 || glprogram->builtin_matrix[MAT_P_I]!=-1
+            || glprogram->builtin_matrix[MAT_P_T]!=-1 || glprogram->builtin_matrix[MAT_P_IT]!=-1))
         {
             GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_P], 1, GL_FALSE, getPMat());
             GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_P_T], 1, GL_TRUE, getPMat());
@@ -1176,7 +1201,7 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
             }
         }
         //Normal matrix (mat3 version of transpose(inverse(gl_ModelViewMatrix)))
-        if(glprogram->builtin_matrix[MAT_N]!=-1 || glprogram->builtin_normalrescale!=-1)
+        if(DIRTY(BUILTIN_MV) && (glprogram->builtin_matrix[MAT_N]!=-1 || glprogram->builtin_normalrescale!=-1))
         {
             if(glprogram->builtin_normalrescale!=-1 && !glstate->fpe_state->rescaling)
             {
@@ -1198,8 +1223,9 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
         }
         //Texture matrices
         for (int i=0; i<MAX_TEX; i++) {
-            if(glprogram->builtin_matrix[MAT_T0+i*4]!=-1 || glprogram->builtin_matrix[MAT_T0_I+i*4]!=-1
-                || glprogram->builtin_matrix[MAT_T0_T+i*4]!=-1 || glprogram->builtin_matrix[MAT_T0_IT+i*4]!=-1)
+            if(DIRTY(BUILTIN_T0+i)
+                && (glprogram->builtin_matrix[MAT_T0+i*4]!=-1 || glprogram->builtin_matrix[MAT_T0_I+i*4]!=-1
+                || glprogram->builtin_matrix[MAT_T0_T+i*4]!=-1 || glprogram->builtin_matrix[MAT_T0_IT+i*4]!=-1))
             {
                 GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_T0+i*4], 1, GL_FALSE, getTexMat(i));
                 GoUniformMatrix4fv(glprogram, glprogram->builtin_matrix[MAT_T0_T+i*4], 1, GL_TRUE, getTexMat(i));
@@ -1213,10 +1239,10 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
         }
     }
     // set light and material if needed
-    if(glprogram->has_builtin_light)
+    if(glprogram->has_builtin_light && (DIRTY(BUILTIN_LIGHT) || DIRTY(BUILTIN_MATERIAL)))
     {
         for (int i=0; i<MAX_LIGHT; i++) {
-            if(glprogram->builtin_lights[i].has) {
+            if(DIRTY(BUILTIN_LIGHT) && glprogram->builtin_lights[i].has) {
                GLfloat tmp[4];
                GoUniformfv(glprogram, glprogram->builtin_lights[i].ambient, 4, 1, glstate->light.lights[i].ambient);
                GoUniformfv(glprogram, glprogram->builtin_lights[i].diffuse, 4, 1, glstate->light.lights[i].diffuse);
@@ -1264,10 +1290,10 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
                 GoUniformfv(glprogram, glprogram->builtin_lightprod[1][i].specular, 4, 1, tmp);
             }
         }
-        if(glprogram->builtin_lightmodel.ambient!=-1) {
+        if(DIRTY(BUILTIN_LIGHT) && glprogram->builtin_lightmodel.ambient!=-1) {
             GoUniformfv(glprogram, glprogram->builtin_lightmodel.ambient, 4, 1, glstate->light.ambient);
         }
-        if(glprogram->builtin_material[0].has) {
+        if(DIRTY(BUILTIN_MATERIAL) && glprogram->builtin_material[0].has) {
             GoUniformfv(glprogram, glprogram->builtin_material[0].emission, 4, 1, glstate->material.front.emission);
             GoUniformfv(glprogram, glprogram->builtin_material[0].ambient, 4, 1, glstate->material.front.ambient);
             GoUniformfv(glprogram, glprogram->builtin_material[0].diffuse, 4, 1, glstate->material.front.diffuse);
@@ -1275,7 +1301,7 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
             GoUniformfv(glprogram, glprogram->builtin_material[0].shininess, 1, 1, &glstate->material.front.shininess);
             GoUniformfv(glprogram, glprogram->builtin_material[0].alpha, 1, 1, &glstate->material.front.diffuse[3]);
         }
-        if(glprogram->builtin_material[1].has) {
+        if(DIRTY(BUILTIN_MATERIAL) && glprogram->builtin_material[1].has) {
             GoUniformfv(glprogram, glprogram->builtin_material[1].emission, 4, 1, glstate->material.back.emission);
             GoUniformfv(glprogram, glprogram->builtin_material[1].ambient, 4, 1, glstate->material.back.ambient);
             GoUniformfv(glprogram, glprogram->builtin_material[1].diffuse, 4, 1, glstate->material.back.diffuse);
@@ -1302,7 +1328,7 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
         GoUniformiv(glprogram, glprogram->builtin_instanceID, 1, 1, &glstate->instanceID);
     }
     // fog parameters
-    if(glprogram->builtin_fog.has)
+    if(glprogram->builtin_fog.has && DIRTY(BUILTIN_FOG))
     {
         GoUniformfv(glprogram, glprogram->builtin_fog.color, 4, 1, glstate->fog.color);
         GoUniformfv(glprogram, glprogram->builtin_fog.density, 1, 1, &glstate->fog.density);
@@ -1314,14 +1340,14 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
         }
     }
     // clip planes
-    if(glprogram->has_builtin_clipplanes)
+    if(glprogram->has_builtin_clipplanes && DIRTY(BUILTIN_CLIPPLANES))
     {
         for (int i=0; i<hardext.maxplanes; i++) {
             GoUniformfv(glprogram, glprogram->builtin_clipplanes[i], 4, 1, glstate->planes[i]);
         }
     }
     // check point sprite if needed
-    if(glprogram->builtin_pointsprite.has)
+    if(glprogram->builtin_pointsprite.has && DIRTY(BUILTIN_POINTSPRITE))
     {
         GoUniformfv(glprogram, glprogram->builtin_pointsprite.size, 1, 1, &glstate->pointsprite.size);
         GoUniformfv(glprogram, glprogram->builtin_pointsprite.sizeMin, 1, 1, &glstate->pointsprite.sizeMin);
@@ -1332,7 +1358,7 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
         GoUniformfv(glprogram, glprogram->builtin_pointsprite.distanceQuadraticAttenuation, 1, 1, glstate->pointsprite.distance+2);
     }
     // texenv
-    if(glprogram->has_builtin_texenv)
+    if(glprogram->has_builtin_texenv && DIRTY(BUILTIN_TEXENV))
     {
         for (int i=0; i<hardext.maxtex; i++) {
             GoUniformfv(glprogram, glprogram->builtin_texenvcolor[i], 4, 1, glstate->texenv[i].env.color);
@@ -1342,7 +1368,7 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
         }
     }
     // texgen
-    if(glprogram->has_builtin_texgen)
+    if(glprogram->has_builtin_texgen && DIRTY(BUILTIN_TEXGEN))
     {
         for (int i=0; i<hardext.maxtex; i++) {
             GoUniformfv(glprogram, glprogram->builtin_eye[0][i], 4, 1, glstate->texgen[i].S_E);
@@ -1355,6 +1381,7 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
             GoUniformfv(glprogram, glprogram->builtin_obj[3][i], 4, 1, glstate->texgen[i].Q_O);
         }
     }
+    #undef DIRTY
     // fpe
     if(glprogram->fpe_alpharef!=-1)
     {
@@ -1431,11 +1458,11 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
                 || v->stride!=w->stride || v->buffer!=w->buffer || (w->real_buffer==0 && v->pointer!=ptr)
                 || v->real_buffer!=w->real_buffer || (w->real_buffer!=0 && v->real_pointer != w->real_pointer) 
                 || w->real_buffer!=glstate->bind_buffer.array) {
-                if((w->size==GL_BGRA || w->type==GL_DOUBLE) && scratch->size<8) { 
+                if((w->size==GL_BGRA || !valid_vertexattrib_type(w->type)) && scratch->size<8) {
                     // need to adjust, so first need the min/max (a shame as I already must have that somewhere)
                     int imin, imax;
                     if(type==0) {
-                        imin = first; imax = count;
+                        imin = first; imax = first+count;
                     } else {
                         if(type==GL_UNSIGNED_INT)
                             getminmax_indices_ui(indices, &imax, &imin, count);
@@ -1445,21 +1472,23 @@ void realize_glenv(int ispoint, int first, int count, GLenum type, const void* i
                     }
                     if(w->size==GL_BGRA) {
                         v->size = 4;
-                        v->type = GL_FLOAT;
-                        v->normalized = 0;
                         v->pointer = scratch->scratch[scratch->size++] = copy_gl_pointer_color_bgra(ptr, w->stride, 4, imin, imax);
-                        v->pointer -= imin*4*sizeof(GLfloat);   // adjust for min...
-                        v->stride = 0;
-                        v->buffer = NULL;
-                        v->real_buffer = 0;
-                    } else if (w->type == GL_DOUBLE) {
-                        // TODO
-                        static int warn = 1;
-                        if(warn) {
-                            printf("LIBGL: VertexAttribArray using GL_DOUBLE unimplemented!\n");
-                            warn=0;
-                        }
+                    } else {
+                        // GL_DOUBLE, GL_INT or GL_UNSIGNED_INT: not supported by GLES, convert to float
+                        GLfloat filler = 0.0f;
+                        v->size = w->size;
+                        if(w->normalized && w->type!=GL_DOUBLE)
+                            v->pointer = copy_gl_array_convert(ptr, w->type, w->size, w->stride, GL_FLOAT, w->size, imin, imax, &filler, NULL);
+                        else
+                            v->pointer = copy_gl_array(ptr, w->type, w->size, w->stride, GL_FLOAT, w->size, imin, imax, NULL);
+                        scratch->scratch[scratch->size++] = (void*)v->pointer;
                     }
+                    v->pointer -= imin*v->size*sizeof(GLfloat);   // adjust for min...
+                    v->type = GL_FLOAT;
+                    v->normalized = 0;
+                    v->stride = 0;
+                    v->buffer = NULL;
+                    v->real_buffer = 0;
                 } else {
                     v->size = w->size;
                     v->type = w->type;
@@ -1629,6 +1658,9 @@ void builtin_Init(program_t *glprogram) {
     glprogram->builtin_fog.start = -1;
     glprogram->builtin_fog.end = -1;
     glprogram->builtin_fog.scale = -1;
+    // nothing uploaded yet
+    glprogram->builtin_serial = 0;
+    memset(glprogram->builtin_stamp, 0, sizeof(glprogram->builtin_stamp));
     // fpe uniform
     glprogram->fpe_alpharef = -1;
     // initialise emulated builtin attrib to -1
@@ -1,5 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#ifndef AMIGAOS4
+#include <sys/mman.h>
+#endif
 
 #include "../glx/hardext.h"
 #include "init.h"
@@ -18,14 +22,33 @@
 #endif
 
 static const char PSA_SIGN[] = "GL4ES PrecompiledShaderArchive";
-#define CACHE_VERSION 111
+#define CACHE_VERSION 112
+#define CACHE_VERSION_V1 111
 
 static kh_inline khint_t _hash_fpe(fpe_state_t *p)
 {
-    const char* s = (const char*)p;
-	khint_t h = (khint_t)*s;
-	for (int i=1 ; i<sizeof(fpe_state_t); ++i) h = (h << 5) - h + (khint_t)*(++s);
-	return h;
+    // murmur3 like hash, done 32bits at a time on the packed state
+    const uint8_t* s = (const uint8_t*)p;
+    uint32_t h = sizeof(fpe_state_t);
+    int i = 0;
+    for (; i+4<=sizeof(fpe_state_t); i+=4) {
+        uint32_t k;
+        memcpy(&k, s+i, 4);   // the struct is packed, so no aligned access here
+        k *= 0xcc9e2d51u;
+        k = (k<<15) | (k>>17);
+        k *= 0x1b873593u;
+        h ^= k;
+        h = (h<<13) | (h>>19);
+        h = h*5 + 0xe6546b64u;
+    }
+    for (; i<sizeof(fpe_state_t); ++i)
+        h = (h ^ s[i]) * 0x01000193u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
 }
 
 #define kh_fpe_hash_func(key) _hash_fpe(key)
@@ -82,136 +105,344 @@ typedef struct psa_s {
 
 KHASH_MAP_INIT_FPE(psalist, psa_t *);
 
+// index entry of the PSA file, sorted by hash then state
+typedef struct psa_index_s {
+    uint32_t    hash;
+    fpe_state_t state;
+    GLenum      format;
+    int         size;
+    uint32_t    offset;     // of the program binary, from the start of the file
+} __attribute__((packed)) psa_index_t;
+
 // Precompiled Shader Archive
 typedef struct gl4es_psa_s {
     int             size;
     int             dirty;
-    kh_psalist_t*   cache;    
+    kh_psalist_t*   cache;      // new programs (and the ones from the journal)
+    // the archive itself, mapped read only
+    void*           map;
+    size_t          map_size;
+    int             map_n;
+    psa_index_t*    index;
 } gl4es_psa_t;
 
 static gl4es_psa_t *psa = NULL;
 static char *psa_name = NULL;
+static char *psa_journal = NULL;
 
-void fpe_readPSA()
+static uint32_t psa_checksum(uint32_t h, const void* data, int size)
 {
-    if(!psa || !psa_name)
-        return;
-    FILE *f = fopen(psa_name, "rb");
-    if(!f)
-        return;
-    char tmp[sizeof(PSA_SIGN)];
-    if(fread(tmp, sizeof(PSA_SIGN), 1, f)!=1) {
-        fclose(f);
-        return; //to short
-    }
-    if(strcmp(tmp, PSA_SIGN)!=0) {
-        fclose(f);
-        return; // bad signature
+    const uint8_t* s = (const uint8_t*)data;
+    for (int i=0; i<size; ++i)
+        h = (h ^ s[i]) * 0x01000193u;
+    return h;
+}
+
+static void psa_put(fpe_state_t* state, GLenum format, int size, void* prog)
+{
+    psa_t *p = (psa_t*)calloc(1, sizeof(psa_t));
+    memcpy(&p->state, state, sizeof(p->state));
+    p->format = format;
+    p->size = size;
+    p->prog = prog;
+    int ret;
+    khint_t k = kh_put(psalist, psa->cache, &p->state, &ret);
+    if(!ret) {
+        psa_t *p2 = kh_value(psa->cache, k);
+        kh_key(psa->cache, k) = &p->state;  // the key was pointing to the old entry
+        free(p2->prog);
+        free(p2);
     }
-    int version = 0;
-    if(fread(&version, sizeof(version), 1, f)!=1) {
-        fclose(f);
-        return;
+    kh_value(psa->cache, k) = p;
+}
+
+static psa_index_t* psa_find(fpe_state_t* state)
+{
+    if(!psa->map_n)
+        return NULL;
+    uint32_t hash = _hash_fpe(state);
+    int lo = 0, hi = psa->map_n;
+    while(lo<hi) {
+        int mid = (lo+hi)/2;
+        if(psa->index[mid].hash<hash)
+            lo = mid+1;
+        else
+            hi = mid;
     }
-    if(version!=CACHE_VERSION) {
-        fclose(f);
-        return; // unsupported version
+    for (; lo<psa->map_n && psa->index[lo].hash==hash; ++lo) {
+        psa_index_t* idx = &psa->index[lo];
+        if(!memcmp(&idx->state, state, sizeof(fpe_state_t))) {
+            if((size_t)idx->offset+idx->size > psa->map_size)
+                return NULL;    // corrupted entry
+            return idx;
+        }
     }
+    return NULL;
+}
+
+static int psa_read_header(FILE* f, int *version)
+{
+    char tmp[sizeof(PSA_SIGN)];
+    if(fread(tmp, sizeof(PSA_SIGN), 1, f)!=1)
+        return 0; //to short
+    if(strcmp(tmp, PSA_SIGN)!=0)
+        return 0; // bad signature
+    if(fread(version, sizeof(*version), 1, f)!=1)
+        return 0;
     int sz_fpe = 0;
-    if(fread(&sz_fpe, sizeof(sz_fpe), 1, f)!=1) {
-        fclose(f);
-        return;
-    }
-    if(sz_fpe!=sizeof(fpe_state_t)) {
-        fclose(f);
-        return; // maybe try to adapt instead?
-    }
+    if(fread(&sz_fpe, sizeof(sz_fpe), 1, f)!=1)
+        return 0;
+    if(sz_fpe!=sizeof(fpe_state_t))
+        return 0; // maybe try to adapt instead?
+    return 1;
+}
+
+// old format, everything is read in memory, and will be saved in the new format
+static void psa_read_v1(FILE* f)
+{
     int n = 0;
-    if(fread(&n, sizeof(n), 1, f)!=1) {
-        fclose(f);
+    if(fread(&n, sizeof(n), 1, f)!=1)
         return;
-    }
     for (int i=0; i<n; ++i) {
-        psa_t *p = (psa_t*)calloc(1, sizeof(psa_t));
-        if(fread(&p->state, sizeof(p->state), 1, f)!=1) {
-            free(p);
-            fclose(f);
+        psa_t p;
+        if(fread(&p.state, sizeof(p.state), 1, f)!=1)
             return;
-        }
-        if(fread(&p->format, sizeof(p->format), 1, f)!=1) {
-            free(p);
-            fclose(f);
+        if(fread(&p.format, sizeof(p.format), 1, f)!=1)
             return;
-        }
-        if(fread(&p->size, sizeof(p->size), 1, f)!=1) {
-            free(p);
-            fclose(f);
+        if(fread(&p.size, sizeof(p.size), 1, f)!=1)
             return;
-        }
-        p->prog = malloc(p->size);
-        if(fread(p->prog, p->size, 1, f)!=1) {
-            free(p->prog);
-            free(p);
-            fclose(f);
+        if(p.size<=0)
+            return;
+        p.prog = malloc(p.size);
+        if(fread(p.prog, p.size, 1, f)!=1) {
+            free(p.prog);
             return;
         }
-        int ret;
-        khint_t k = kh_put(psalist, psa->cache, &p->state, &ret);
-        kh_value(psa->cache, k) = p;
-        psa->size = kh_size(psa->cache);
+        psa_put(&p.state, p.format, p.size, p.prog);
     }
-    fclose(f);
-    SHUT_LOGD("Loaded a PSA with %d Precompiled Programs\n", psa->size);
+    psa->dirty = 1;
 }
 
-void fpe_writePSA()
+static void psa_map(FILE* f)
 {
-    if(!psa || !psa_name)
+    int n = 0;
+    if(fread(&n, sizeof(n), 1, f)!=1)
         return;
-    if(!psa->dirty)
-        return; // no need
-    FILE *f = fopen(psa_name, "wb");
-    if(!f)
+    long header = ftell(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    if(n<=0 || header+(long)n*sizeof(psa_index_t)>size)
+        return;
+#ifdef AMIGAOS4
+    void* map = malloc(size);
+    fseek(f, 0, SEEK_SET);
+    if(fread(map, size, 1, f)!=1) {
+        free(map);
         return;
-    if(fwrite(PSA_SIGN, sizeof(PSA_SIGN), 1, f)!=1) {
-        fclose(f);
-        return; //to short
     }
-    int version = CACHE_VERSION;
-    if(fwrite(&version, sizeof(version), 1, f)!=1) {
+#else
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    if(map==MAP_FAILED)
+        return;
+#endif
+    psa->map = map;
+    psa->map_size = size;
+    psa->map_n = n;
+    psa->index = (psa_index_t*)((uintptr_t)map+header);
+}
+
+static void psa_unmap()
+{
+    if(!psa->map)
+        return;
+#ifdef AMIGAOS4
+    free(psa->map);
+#else
+    munmap(psa->map, psa->map_size);
+#endif
+    psa->map = NULL;
+    psa->map_size = 0;
+    psa->map_n = 0;
+    psa->index = NULL;
+}
+
+static const char PSA_JOURNAL_SIGN[] = "GL4ES PSA Journal";
+#define JOURNAL_MAGIC 0x4A415350    // "PSAJ"
+
+// programs added since the last save, they are written as soon as they are created
+static void psa_read_journal()
+{
+    FILE *f = fopen(psa_journal, "rb");
+    if(!f)
+        return;
+    char tmp[sizeof(PSA_JOURNAL_SIGN)];
+    int version = 0, sz_fpe = 0;
+    if(fread(tmp, sizeof(PSA_JOURNAL_SIGN), 1, f)!=1 || strcmp(tmp, PSA_JOURNAL_SIGN)
+     || fread(&version, sizeof(version), 1, f)!=1 || version!=CACHE_VERSION
+     || fread(&sz_fpe, sizeof(sz_fpe), 1, f)!=1 || sz_fpe!=sizeof(fpe_state_t)) {
         fclose(f);
         return;
     }
-    int sz_fpe = sizeof(fpe_state_t);
-    if(fwrite(&sz_fpe, sizeof(sz_fpe), 1, f)!=1) {
-        fclose(f);
+    int n = 0;
+    while(1) {
+        // stop at the first incomplete record (if the program crashed while writing it)
+        uint32_t magic, check;
+        psa_t p;
+        if(fread(&magic, sizeof(magic), 1, f)!=1 || magic!=JOURNAL_MAGIC)
+            break;
+        if(fread(&p.state, sizeof(p.state), 1, f)!=1)
+            break;
+        if(fread(&p.format, sizeof(p.format), 1, f)!=1)
+            break;
+        if(fread(&p.size, sizeof(p.size), 1, f)!=1 || p.size<=0)
+            break;
+        p.prog = malloc(p.size);
+        if(fread(p.prog, p.size, 1, f)!=1 || fread(&check, sizeof(check), 1, f)!=1) {
+            free(p.prog);
+            break;
+        }
+        uint32_t h = psa_checksum(0x811c9dc5u, &p.state, sizeof(p.state));
+        h = psa_checksum(h, p.prog, p.size);
+        if(h!=check) {
+            free(p.prog);
+            break;
+        }
+        psa_put(&p.state, p.format, p.size, p.prog);
+        ++n;
+    }
+    fclose(f);
+    if(n)
+        psa->dirty = 1; // so they go in the archive at exit
+}
+
+static void psa_append_journal(psa_t *p)
+{
+    FILE *f = fopen(psa_journal, "ab");
+    if(!f)
         return;
+    fseek(f, 0, SEEK_END);
+    if(ftell(f)==0) {
+        int version = CACHE_VERSION;
+        int sz_fpe = sizeof(fpe_state_t);
+        fwrite(PSA_JOURNAL_SIGN, sizeof(PSA_JOURNAL_SIGN), 1, f);
+        fwrite(&version, sizeof(version), 1, f);
+        fwrite(&sz_fpe, sizeof(sz_fpe), 1, f);
     }
-    if(fwrite(&psa->size, sizeof(psa->size), 1, f)!=1) {
+    // build the record first, so it's written in one go
+    int l = sizeof(uint32_t)+sizeof(p->state)+sizeof(p->format)+sizeof(p->size)+p->size+sizeof(uint32_t);
+    char* buff = (char*)malloc(l);
+    char* s = buff;
+    uint32_t magic = JOURNAL_MAGIC;
+    uint32_t check = psa_checksum(0x811c9dc5u, &p->state, sizeof(p->state));
+    check = psa_checksum(check, p->prog, p->size);
+    memcpy(s, &magic, sizeof(magic)); s+=sizeof(magic);
+    memcpy(s, &p->state, sizeof(p->state)); s+=sizeof(p->state);
+    memcpy(s, &p->format, sizeof(p->format)); s+=sizeof(p->format);
+    memcpy(s, &p->size, sizeof(p->size)); s+=sizeof(p->size);
+    memcpy(s, p->prog, p->size); s+=p->size;
+    memcpy(s, &check, sizeof(check));
+    fwrite(buff, l, 1, f);
+    fclose(f);
+    free(buff);
+}
+
+void fpe_readPSA()
+{
+    if(!psa || !psa_name)
+        return;
+    FILE *f = fopen(psa_name, "rb");
+    if(f) {
+        int version = 0;
+        if(psa_read_header(f, &version)) {
+            if(version==CACHE_VERSION)
+                psa_map(f);
+            else if(version==CACHE_VERSION_V1)
+                psa_read_v1(f);
+        }
         fclose(f);
+    }
+    psa_read_journal();
+    psa->size = psa->map_n + kh_size(psa->cache);
+    SHUT_LOGD("Loaded a PSA with %d Precompiled Programs\n", psa->size);
+}
+
+static int psa_compare(const void* a, const void* b)
+{
+    const psa_index_t* pa = (const psa_index_t*)a;
+    const psa_index_t* pb = (const psa_index_t*)b;
+    if(pa->hash!=pb->hash)
+        return (pa->hash<pb->hash)?-1:1;
+    return memcmp(&pa->state, &pb->state, sizeof(fpe_state_t));
+}
+
+void fpe_writePSA()
+{
+    if(!psa || !psa_name)
         return;
+    if(!psa->dirty)
+        return; // no need
+    // merge the mapped archive and the new programs in a new archive
+    int n = 0;
+    psa_index_t* index = (psa_index_t*)malloc((psa->map_n+kh_size(psa->cache))*sizeof(psa_index_t));
+    void** progs = (void**)malloc((psa->map_n+kh_size(psa->cache))*sizeof(void*));
+    for (int i=0; i<psa->map_n; ++i) {
+        psa_index_t* idx = &psa->index[i];
+        if((size_t)idx->offset+idx->size > psa->map_size)
+            continue;
+        if(kh_get(psalist, psa->cache, &idx->state)!=kh_end(psa->cache))
+            continue;   // replaced by a newer one
+        memcpy(&index[n], idx, sizeof(psa_index_t));
+        progs[n++] = (void*)((uintptr_t)psa->map+idx->offset);
     }
     psa_t *p;
-    kh_foreach_value(psa->cache, p, 
-        if(fwrite(&p->state, sizeof(p->state), 1, f)!=1) {
-            fclose(f);
-            return;
-        }
-        if(fwrite(&p->format, sizeof(p->format), 1, f)!=1) {
-            fclose(f);
-            return;
-        }
-        if(fwrite(&p->size, sizeof(p->size), 1, f)!=1) {
-            fclose(f);
-            return;
-        }
-        if(fwrite(p->prog, p->size, 1, f)!=1) {
-            fclose(f);
-            return;
-        }
+    kh_foreach_value(psa->cache, p,
+        index[n].hash = _hash_fpe(&p->state);
+        memcpy(&index[n].state, &p->state, sizeof(fpe_state_t));
+        index[n].format = p->format;
+        index[n].size = p->size;
+        progs[n++] = p->prog;
     );
-    fclose(f);
-    SHUT_LOGD("Saved a PSA with %d Precompiled Programs\n", psa->size);
+    // sort the index (and the program pointers with it)
+    for (int i=0; i<n; ++i)
+        index[i].offset = i;
+    qsort(index, n, sizeof(psa_index_t), psa_compare);
+    int header = sizeof(PSA_SIGN)+3*sizeof(int);
+    uint32_t offset = header + n*sizeof(psa_index_t);
+    void** sorted = (void**)malloc(n*sizeof(void*));
+    for (int i=0; i<n; ++i) {
+        sorted[i] = progs[index[i].offset];
+        index[i].offset = offset;
+        offset += index[i].size;
+    }
+    free(progs);
+    // write in a temporary file, the old archive + journal stay valid until the rename
+    char* tmpname = (char*)malloc(strlen(psa_name)+5);
+    strcpy(tmpname, psa_name);
+    strcat(tmpname, ".tmp");
+    int ok = 0;
+    FILE *f = fopen(tmpname, "wb");
+    if(f) {
+        int version = CACHE_VERSION;
+        int sz_fpe = sizeof(fpe_state_t);
+        ok = (fwrite(PSA_SIGN, sizeof(PSA_SIGN), 1, f)==1)
+          && (fwrite(&version, sizeof(version), 1, f)==1)
+          && (fwrite(&sz_fpe, sizeof(sz_fpe), 1, f)==1)
+          && (fwrite(&n, sizeof(n), 1, f)==1)
+          && (!n || fwrite(index, sizeof(psa_index_t), n, f)==n);
+        for (int i=0; i<n && ok; ++i)
+            ok = (fwrite(sorted[i], index[i].size, 1, f)==1);
+        if(fclose(f))
+            ok = 0;
+    }
+    if(ok && rename(tmpname, psa_name)==0) {
+        remove(psa_journal);
+        psa->dirty = 0;
+        SHUT_LOGD("Saved a PSA with %d Precompiled Programs\n", n);
+    } else
+        remove(tmpname);
+    free(tmpname);
+    free(sorted);
+    free(index);
 }
 
 void fpe_InitPSA(const char* name)
@@ -221,6 +452,9 @@ void fpe_InitPSA(const char* name)
     psa = (gl4es_psa_t*)calloc(1, sizeof(gl4es_psa_t));
     psa->cache = kh_init(psalist);
     psa_name = strdup(name);
+    psa_journal = (char*)malloc(strlen(name)+9);
+    strcpy(psa_journal, name);
+    strcat(psa_journal, ".journal");
 }
 
 void fpe_FreePSA()
@@ -234,11 +468,14 @@ void fpe_FreePSA()
         free(m);
     )
     kh_destroy(psalist, psa->cache);
+    psa_unmap();
 
     free(psa);
     psa = NULL;
     free(psa_name);
     psa_name = NULL;
+    free(psa_journal);
+    psa_journal = NULL;
 }
 
 int fpe_GetProgramPSA(GLuint program, fpe_state_t* state)
@@ -249,11 +486,36 @@ int fpe_GetProgramPSA(GLuint program, fpe_state_t* state)
     if(state->vertex_prg_enable || state->fragment_prg_enable)
         return 0;
     khint_t k = kh_get(psalist, psa->cache, state);
-    if(k==kh_end(psa->cache))
+    if(k!=kh_end(psa->cache)) {
+        psa_t *p = kh_value(psa->cache, k);
+        return gl4es_useProgramBinary(program, p->size, p->format, p->prog);
+    }
+    // the program binary is only read from the archive now
+    psa_index_t* idx = psa_find(state);
+    if(!idx)
         return 0; // not here
-    psa_t *p = kh_value(psa->cache, k);
-    // try to load...
-    return gl4es_useProgramBinary(program, p->size, p->format, p->prog);
+    return gl4es_useProgramBinary(program, idx->size, idx->format, (void*)((uintptr_t)psa->map+idx->offset));
+}
+
+int fpe_NextProgramPSA(int *cursor, fpe_state_t** state)
+{
+    if(!psa)
+        return 0;
+    // cursor walks the archive index first, then the new programs
+    if(*cursor<psa->map_n) {
+        *state = &psa->index[*cursor].state;
+        ++*cursor;
+        return 1;
+    }
+    for (khint_t k=*cursor-psa->map_n; k<kh_end(psa->cache); ++k) {
+        if(kh_exist(psa->cache, k)) {
+            *state = &kh_value(psa->cache, k)->state;
+            *cursor = psa->map_n+k+1;
+            return 1;
+        }
+    }
+    *cursor = psa->map_n+kh_end(psa->cache);
+    return 0;
 }
 
 void fpe_AddProgramPSA(GLuint program, fpe_state_t* state)
@@ -264,25 +526,19 @@ void fpe_AddProgramPSA(GLuint program, fpe_state_t* state)
     if(state->vertex_prg_enable || state->fragment_prg_enable)
         return;
     psa->dirty = 1;
-    psa_t *p = (psa_t*)calloc(1, sizeof(psa_t));
-    memcpy(&p->state, state, sizeof(p->state));
-
-    int l = gl4es_getProgramBinary(program, &p->size, &p->format, &p->prog);
+    int size = 0;
+    GLenum format = 0;
+    void* prog = NULL;
+    int l = gl4es_getProgramBinary(program, &size, &format, &prog);
     if(l==0) { // there was an error...
-        free(p->prog);
-        free(p);
+        free(prog);
         return;
     }
     // add program
-    int ret;
-    khint_t k = kh_put(psalist, psa->cache, &p->state, &ret);
-    if(!ret) {
-        psa_t *p2 = kh_value(psa->cache, k);
-        free(p2->prog);
-        p2->prog = NULL;
-        free(p2);
-    }
-    kh_value(psa->cache, k) = p;
+    psa_put(state, format, size, prog);
+    khint_t k = kh_get(psalist, psa->cache, state);
+    // and save it right now
+    psa_append_journal(kh_value(psa->cache, k));
     // all done
-    psa->size = kh_size(psa->cache);
-}
\ No newline at end of file
+    psa->size = psa->map_n + kh_size(psa->cache);
+}
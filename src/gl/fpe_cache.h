@@ -18,6 +18,7 @@ void fpe_FreePSA();
 void fpe_readPSA();
 void fpe_writePSA();
 int fpe_GetProgramPSA(GLuint program, fpe_state_t* state);
+int fpe_NextProgramPSA(int *cursor, fpe_state_t** state);
 void fpe_AddProgramPSA(GLuint program, fpe_state_t* state);
 
 #endif //__FPE_CACHE_H__
\ No newline at end of file
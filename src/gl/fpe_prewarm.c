@@ -0,0 +1,45 @@
+#include "../glx/hardext.h"
+#include "debug.h"
+#include "fpe_cache.h"
+#include "fpe_prewarm.h"
+#include "fpe.h"
+#include "glstate.h"
+#include "init.h"
+#include "loader.h"
+#include "shader.h"
+
+//#define DEBUG
+#ifdef DEBUG
+#define DBG(a) a
+#else
+#define DBG(a)
+#endif
+
+static program_t* fpe_findprogram(GLuint prog) {
+    khint_t k_program;
+    khash_t(programlist) *programs = glstate->glsl->programs;
+    k_program = kh_get(programlist, programs, prog);
+    if (k_program != kh_end(programs))
+        return kh_value(programs, k_program);
+    return NULL;
+}
+
+void fpe_PrewarmPSA(int budget) {
+    if(!globals4es.psaprewarm || hardext.esversion<2 || !glstate || !glstate->fpe_cache)
+        return;
+    fpe_state_t *state;
+    while(budget>0 && fpe_NextProgramPSA(&glstate->fpe_prewarm, &state)) {
+        fpe_fpe_t *fpe = fpe_GetCache(glstate->fpe_cache, state, 1);
+        if(fpe->glprogram)
+            continue;   // already there, doesn't count
+        fpe->prog = gl4es_glCreateProgram();
+        if(fpe_GetProgramPSA(fpe->prog, state)) {
+            fpe->glprogram = fpe_findprogram(fpe->prog);
+        } else {
+            gl4es_glDeleteProgram(fpe->prog);
+            fpe->prog = 0;
+        }
+        DBG(printf("Prewarm FPE program %d (%p)\n", fpe->prog, fpe->glprogram);)
+        --budget;
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef __FPE_PREWARM_H__
+#define __FPE_PREWARM_H__
+
+/*
+  Prewarm of FPE programs from the PSA (LIBGL_PSAPREWARM)
+
+  The programs of the PSA are loaded a few at a time on each SwapBuffers, in the current FPE cache,
+  so most of them are already there when a draw needs them, instead of being loaded in the middle of a frame.
+*/
+
+// load up to budget programs from the PSA in the current fpe cache
+void fpe_PrewarmPSA(int budget);
+
+#endif //__FPE_PREWARM_H__
@@ -14,13 +14,235 @@
 #endif
 
 const char* fpeshader_signature = "// FPE_Shader generated\n";
+const char* fpeshader_es_signature = "// FPE_Shader generated for GLES\n";
 
 static char* shad = NULL;
 static int shad_cap = 0;
 
 static int comments = 1;
 
-#define ShadAppend(S) shad = Append(shad, &shad_cap, S)
+#define CustomAppend(S) shad = Append(shad, &shad_cap, S)
+
+/*
+  fpe_VertexShader / fpe_FragmentShader write GLSL ES directly, so ConvertShader has nothing left to do.
+  The declarations and main() are written in 2 separate texts (so nothing has to be inserted afterward),
+  the builtins are written with their _gl4es_ names, and the one used are flagged, to be declared
+  at the end from the table below (in the same order ConvertShader would use).
+*/
+typedef struct {
+    char* s;
+    int   len;
+    int   cap;
+} fpe_text_t;
+
+static fpe_text_t decl = {0};
+static fpe_text_t body = {0};
+static fpe_text_t *cur = &decl;
+
+static void text_append(fpe_text_t* t, const char* s, int l)
+{
+    if(t->len+l+1>t->cap) {
+        t->cap = (t->len+l+1)*2;
+        if(t->cap<1024) t->cap = 1024;
+        t->s = (char*)realloc(t->s, t->cap);
+    }
+    memcpy(t->s+t->len, s, l);
+    t->len += l;
+    t->s[t->len] = '\0';
+}
+
+#define ShadAppend(S) text_append(cur, S, strlen(S))
+
+enum {
+    FPE_VERTEX = 0,
+    FPE_COLOR,
+    FPE_MULTITEXCOORD0,
+    FPE_SECONDARYCOLOR = FPE_MULTITEXCOORD0 + MAX_TEX,
+    FPE_NORMAL,
+    FPE_FOGCOORD,
+    FPE_FRONTCOLOR,
+    FPE_BACKCOLOR,
+    FPE_FRONTSECONDARYCOLOR,
+    FPE_BACKSECONDARYCOLOR,
+    FPE_MODELVIEWMATRIX,
+    FPE_MVPMATRIX,
+    FPE_NORMALMATRIX,
+    FPE_LIGHTMODEL,
+    FPE_LIGHTMODELPRODUCT,
+    FPE_MATERIAL,
+    FPE_POINT,
+    FPE_FOG,
+    FPE_BUILTINS
+};
+
+#define MTC(n) "attribute highp vec4 _gl4es_MultiTexCoord" #n ";\n"
+static const char* fpe_builtin_decl[FPE_BUILTINS] = {
+    "attribute highp vec4 _gl4es_Vertex;\n",
+    "attribute lowp vec4 _gl4es_Color;\n",
+    MTC(0), MTC(1), MTC(2), MTC(3), MTC(4), MTC(5), MTC(6), MTC(7),
+    MTC(8), MTC(9), MTC(10), MTC(11), MTC(12), MTC(13), MTC(14), MTC(15),
+    "attribute lowp vec4 _gl4es_SecondaryColor;\n",
+    "attribute highp vec3 _gl4es_Normal;\n",
+    "attribute highp float _gl4es_FogCoord;\n",
+    "varying lowp vec4 _gl4es_FrontColor;\n",
+    "varying lowp vec4 _gl4es_BackColor;\n",
+    "varying lowp vec4 _gl4es_FrontSecondaryColor;\n",
+    "varying lowp vec4 _gl4es_BackSecondaryColor;\n",
+    "uniform highp mat4 _gl4es_ModelViewMatrix;\n",
+    "uniform highp mat4 _gl4es_ModelViewProjectionMatrix;\n",
+    "uniform highp mat3 _gl4es_NormalMatrix;\n",
+    "struct _gl4es_LightModelParameters {\n"
+    "  vec4 ambient;\n"
+    "};\n"
+    "uniform _gl4es_LightModelParameters _gl4es_LightModel;\n",
+    "struct _gl4es_LightModelProducts\n"
+    "{\n"
+    "   vec4 sceneColor;\n"
+    "};\n"
+    "uniform _gl4es_LightModelProducts _gl4es_FrontLightModelProduct;\n"
+    "uniform _gl4es_LightModelProducts _gl4es_BackLightModelProduct;\n",
+    "struct _gl4es_MaterialParameters\n"
+    "{\n"
+    "   vec4 emission;\n"
+    "   vec4 ambient;\n"
+    "   vec4 diffuse;\n"
+    "   vec4 specular;\n"
+    "   float shininess;\n"
+    "};\n"
+    "uniform _gl4es_MaterialParameters _gl4es_FrontMaterial;\n"
+    "uniform _gl4es_MaterialParameters _gl4es_BackMaterial;\n",
+    "struct _gl4es_PointParameters\n"
+    "{\n"
+    "   float size;\n"
+    "   float sizeMin;\n"
+    "   float sizeMax;\n"
+    "   float fadeThresholdSize;\n"
+    "   float distanceConstantAttenuation;\n"
+    "   float distanceLinearAttenuation;\n"
+    "   float distanceQuadraticAttenuation;\n"
+    "};\n"
+    "uniform _gl4es_PointParameters _gl4es_Point;\n",
+    "struct _gl4es_FogParameters {\n"
+    "    lowp vec4 color;\n"
+    "    mediump float density;\n"
+    "    mediump float start;\n"
+    "    mediump float end;\n"
+    "    mediump float scale;\n"
+    "};\n"
+    "uniform _gl4es_FogParameters _gl4es_Fog;\n"
+};
+#undef MTC
+static const char* fpe_fog_highp =
+    "struct _gl4es_FogParameters {\n"
+    "    lowp vec4 color;\n"
+    "    mediump float density;\n"
+    "    highp   float start;\n"
+    "    highp   float end;\n"
+    "    highp   float scale;\n"
+    "};\n"
+    "uniform _gl4es_FogParameters _gl4es_Fog;\n";
+
+// the builtins names, as ConvertShader expects them (MultiTexCoord are handled apart)
+static const char* fpe_builtin_names[][2] = {
+    {"_gl4es_Vertex", "gl_Vertex"},
+    {"_gl4es_Color", "gl_Color"},
+    {"_gl4es_SecondaryColor", "gl_SecondaryColor"},
+    {"_gl4es_Normal", "gl_Normal"},
+    {"_gl4es_FogCoord", "gl_FogCoord"},
+    {"_gl4es_FrontColor", "gl_FrontColor"},
+    {"_gl4es_BackColor", "gl_BackColor"},
+    {"_gl4es_FrontSecondaryColor", "gl_FrontSecondaryColor"},
+    {"_gl4es_BackSecondaryColor", "gl_BackSecondaryColor"},
+    {"_gl4es_ModelViewMatrix", "gl_ModelViewMatrix"},
+    {"_gl4es_ModelViewProjectionMatrix", "gl_ModelViewProjectionMatrix"},
+    {"_gl4es_NormalMatrix", "gl_NormalMatrix"},
+    {"_gl4es_LightModel", "gl_LightModel"},
+    {"_gl4es_FrontLightModelProduct", "gl_FrontLightModelProduct"},
+    {"_gl4es_BackLightModelProduct", "gl_BackLightModelProduct"},
+    {"_gl4es_FrontMaterial", "gl_FrontMaterial"},
+    {"_gl4es_BackMaterial", "gl_BackMaterial"},
+    {"_gl4es_Point", "gl_Point"},
+    {"_gl4es_Fog", "gl_Fog"}
+};
+
+static uint64_t builtins = 0;   // builtins used by the shader being generated
+#define Use(B) builtins |= 1ULL<<(B)
+
+// flag the builtin used by an expression of the lighting
+static const char* fpe_use(const char* s)
+{
+    if(!strncmp(s, "_gl4es_Color", 12))
+        Use(FPE_COLOR);
+    else if(!strncmp(s, "_gl4es_FrontMaterial.", 21) || !strncmp(s, "_gl4es_BackMaterial.", 20))
+        Use(FPE_MATERIAL);
+    return s;
+}
+
+static void fpe_begin()
+{
+    decl.len = body.len = 0;
+    text_append(&decl, fpeshader_es_signature, strlen(fpeshader_es_signature));
+    cur = &decl;
+    builtins = 0;
+}
+
+// put everything together: GLES header, builtins, declarations, main (starting with prologue)
+static const char* const* fpe_end(const char* main, const char* prologue)
+{
+    static const char* header = "#version 100\nprecision mediump float;\nprecision mediump int;\n";
+    const char* parts[FPE_BUILTINS+5];
+    int n = 0;
+    parts[n++] = header;
+    for (int i=0; i<FPE_BUILTINS; ++i)
+        if(builtins&(1ULL<<i))
+            parts[n++] = (i==FPE_FOG && hardext.highp)?fpe_fog_highp:fpe_builtin_decl[i];
+    int len[FPE_BUILTINS+5];
+    int total = decl.len + body.len;
+    for (int i=0; i<n; ++i)
+        total += (len[i] = strlen(parts[i]));
+    int lmain = strlen(main), lprologue = strlen(prologue);
+    total += lmain + lprologue;
+    if(shad_cap<total+1) {
+        shad_cap = total+1;
+        shad = (char*)realloc(shad, shad_cap);
+    }
+    char* p = shad;
+    for (int i=0; i<n; ++i) {
+        memcpy(p, parts[i], len[i]);
+        p += len[i];
+    }
+    memcpy(p, decl.s, decl.len); p += decl.len;
+    memcpy(p, main, lmain); p += lmain;
+    memcpy(p, prologue, lprologue); p += lprologue;
+    memcpy(p, body.s, body.len); p += body.len;
+    *p = '\0';
+
+    DBG(printf("FPE Shader: \n%s\n", shad);)
+
+    return (const char* const*)&shad;
+}
+
+char* fpe_DesktopShader(const char* source)
+{
+    // the generated part only, with the desktop names back
+    const char* p = strstr(source, fpeshader_es_signature);
+    if(!p)
+        return strdup(source);
+    p += strlen(fpeshader_es_signature);
+    int size = strlen(fpeshader_signature)+strlen(p)+1;
+    char* ret = (char*)malloc(size);
+    strcpy(ret, fpeshader_signature);
+    strcat(ret, p);
+    for (int i=0; i<sizeof(fpe_builtin_names)/sizeof(fpe_builtin_names[0]); ++i)
+        ret = InplaceReplace(ret, &size, fpe_builtin_names[i][0], fpe_builtin_names[i][1]);
+    for (int i=0; i<MAX_TEX; ++i) {
+        char name[50], glname[50];
+        sprintf(name, "_gl4es_MultiTexCoord%d", i);
+        sprintf(glname, "gl_MultiTexCoord%d", i);
+        ret = InplaceReplace(ret, &size, name, glname);
+    }
+    return ret;
+}
 
 //                           2D   Rectangle    3D   CubeMap  Stream
 const char* texvecsize[] = {"vec4", "vec2", "vec2", "vec3", "vec2"};
@@ -154,9 +376,6 @@ char* fpe_binary(int x, int s) {
     
 
 const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state) {
-    // vertex is first called, so 1st time init is only here
-    if(!shad_cap) shad_cap = 1024;
-    if(!shad) shad = (char*)malloc(shad_cap);
     // state can be NULL, so provide a 0 default
     fpe_state_t default_state = {0};
     int is_default = !!need;
@@ -174,7 +393,6 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
     int color_material = state->color_material && lighting;
     int point = state->point;
     int pointsprite = state->pointsprite;
-    int headers = 0;
     int planes = state->plane;
     char buff[1024];
     int need_vertex = 0;
@@ -195,7 +413,7 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
             texmats = 1;
     }
 
-    strcpy(shad, fpeshader_signature);
+    fpe_begin();
 
     comments = globals4es.comments;
     DBG(comments=1-comments;)   // When DEBUG is activated, the effect of LIBGL_COMMENTS is reversed
@@ -204,26 +422,21 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
         sprintf(buff, "// ** Vertex Shader **\n// ligthting=%d (twosided=%d, separate=%d, color_material=%d)\n// secondary=%d, planes=%s\n// point=%d%s\n",
             lighting, twosided, light_separate, color_material, secondary, fpe_binary(planes, 6), point, need?" with need":"");
         ShadAppend(buff);
-        headers+=CountLine(buff);
         if(need) {
             sprintf(buff, "// need: color=%d, texs=%s, fogcoord=%d\n", need->need_color, fpe_binary(need->need_texs, 16), need->need_fogcoord);
             ShadAppend(buff);
-            headers+=CountLine(buff);
         }
     }
     if(!is_default) {
         ShadAppend("varying vec4 Color;\n");  // might be unused...
-        headers++;
     }
     if(planes) {
         for (int i=0; i<hardext.maxplanes; i++) {
             if((planes>>i)&1) {
                 sprintf(buff, "uniform highp vec4 _gl4es_ClipPlane_%d;\n", i);
                 ShadAppend(buff);
-                ++headers;
                 sprintf(buff, "varying mediump float clippedvertex_%d;\n", i);
                 ShadAppend(buff);
-                ++headers;
             }
         }
     }
@@ -247,7 +460,6 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
             : ""
             );
         ShadAppend(buff);
-        headers += CountLine(buff);
         sprintf(buff, 
             "struct _gl4es_FPELightSourceParameters0\n"
             "{\n"
@@ -264,7 +476,6 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
             : ""
             );
         ShadAppend(buff);
-        headers += CountLine(buff);
 
         sprintf(buff,
                 "struct _gl4es_LightProducts\n"
@@ -275,38 +486,30 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                 "};\n"                
         );
         ShadAppend(buff);
-        headers += CountLine(buff);
 
         if(!(cm_front_nullexp && color_material)) {
             ShadAppend("uniform highp float _gl4es_FrontMaterial_shininess;\n");
-            headers++;
         }
         if(twosided && !(cm_back_nullexp && color_material)) {
             ShadAppend("uniform highp float _gl4es_BackMaterial_shininess;\n");
-            headers++;
         }
         if(!(color_material && (state->cm_front_mode==FPE_CM_DIFFUSE || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))) {
             ShadAppend("uniform highp float _gl4es_FrontMaterial_alpha;\n");
-            headers++;
             if(twosided) {
                 ShadAppend("uniform highp float _gl4es_BackMaterial_alpha;\n");
-                headers++;
             }
         }
         for(int i=0; i<hardext.maxlights; i++) {
             if(state->light&(1<<i)) {
                 sprintf(buff, "uniform _gl4es_FPELightSourceParameters%d _gl4es_LightSource_%d;\n", (state->light_direction>>i&1)?1:0, i);
                 ShadAppend(buff);
-                headers++;
 
                 sprintf(buff, "uniform _gl4es_LightProducts _gl4es_FrontLightProduct_%d;\n", i);
                 ShadAppend(buff);
-                headers++;
 
                 if(twosided) {
                     sprintf(buff, "uniform _gl4es_LightProducts _gl4es_BackLightProduct_%d;\n", i);
                     ShadAppend(buff);
-                    headers++;
                 }
             }
         }
@@ -314,21 +517,17 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
     if(!is_default) {
         if(twosided) {
             ShadAppend("varying vec4 BackColor;\n");
-            headers++;
         }
         if(light_separate || secondary) {
             ShadAppend("varying vec4 SecColor;\n");
-            headers++;
             if(twosided) {
                 ShadAppend("varying vec4 SecBackColor;\n");
-                headers++;
             }
         }
     }
     if(fog) {
         #if 0   // vertex fog
         ShadAppend("varying mediump float FogF;\n");
-        headers++;
         if(fogsource==FPE_FOG_SRC_DEPTH && need_vertex<1)
             need_vertex = 1;
         #else   // pixel fog
@@ -354,18 +553,15 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
         if(t) {
             sprintf(buff, "varying %s _gl4es_TexCoord_%d;\n", texvecsize[t-1], i);
             ShadAppend(buff);
-            headers++;
             if(state->texture[i].texmat) {
                 sprintf(buff, "uniform highp mat4 _gl4es_TextureMatrix_%d;\n", i);
                 ShadAppend(buff);
-                headers++;
             }
         }
     }
     // let's start
-    ShadAppend("\nvoid main() {\n");
+    cur = &body;
     int need_normal = 0;
-    int normal_line = CountLine(shad) - headers;
     if(planes) {
         for (int i=0; i<hardext.maxplanes; i++) {
             if((planes>>i)&1) {
@@ -377,23 +573,35 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
             need_vertex  = 1;
         //ShadAppend("gl_Position = clipvertex;\n");
     }
-    ShadAppend("gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n");
+    ShadAppend("gl_Position = _gl4es_ModelViewProjectionMatrix * _gl4es_Vertex;\n");
+    Use(FPE_MVPMATRIX); Use(FPE_VERTEX);
     // initial Color / lighting calculation
     if(!lighting) {
         if(is_default && need) {
-            if(need->need_color>=1)
-                ShadAppend("gl_FrontColor = gl_Color;\n");
-            if(need->need_color==2)
-                ShadAppend("gl_BackColor = gl_Color;\n");
-            if(need->need_secondary>=1)
-                ShadAppend("gl_FrontSecondaryColor = gl_SecondaryColor;\n");
-            if(need->need_secondary==2)
-                ShadAppend("gl_BackSecondaryColor = gl_SecondaryColor;\n");
+            if(need->need_color>=1) {
+                ShadAppend("_gl4es_FrontColor = _gl4es_Color;\n");
+                Use(FPE_FRONTCOLOR); Use(FPE_COLOR);
+            }
+            if(need->need_color==2) {
+                ShadAppend("_gl4es_BackColor = _gl4es_Color;\n");
+                Use(FPE_BACKCOLOR);
+            }
+            if(need->need_secondary>=1) {
+                ShadAppend("_gl4es_FrontSecondaryColor = _gl4es_SecondaryColor;\n");
+                Use(FPE_FRONTSECONDARYCOLOR); Use(FPE_SECONDARYCOLOR);
+            }
+            if(need->need_secondary==2) {
+                ShadAppend("_gl4es_BackSecondaryColor = _gl4es_SecondaryColor;\n");
+                Use(FPE_BACKSECONDARYCOLOR);
+            }
         } else {
-            if(!need || (need && need->need_color))
-                ShadAppend("Color = gl_Color;\n");
+            if(!need || (need && need->need_color)) {
+                ShadAppend("Color = _gl4es_Color;\n");
+                Use(FPE_COLOR);
+            }
             if(secondary) {
-                ShadAppend("SecColor = gl_SecondaryColor;\n");
+                ShadAppend("SecColor = _gl4es_SecondaryColor;\n");
+                Use(FPE_SECONDARYCOLOR);
             }
         }
     } else {
@@ -413,15 +621,15 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
         // material emission
         char fm_emission[60], fm_ambient[60], fm_diffuse[60], fm_specular[60];
         char bm_emission[60], bm_ambient[60], bm_diffuse[60], bm_specular[60];
-        sprintf(fm_emission, "%s", (color_material && state->cm_front_mode==FPE_CM_EMISSION)?"gl_Color":"gl_FrontMaterial.emission");
-        sprintf(fm_ambient, "%s", (color_material && (state->cm_front_mode==FPE_CM_AMBIENT || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))?"gl_Color":"gl_FrontMaterial.ambient");
-        sprintf(fm_diffuse, "%s", (color_material && (state->cm_front_mode==FPE_CM_DIFFUSE || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))?"gl_Color.xyz * _gl4es_LightSource_":"_gl4es_FrontLightProduct_");
-        sprintf(fm_specular, "%s", (color_material && state->cm_front_mode==FPE_CM_SPECULAR)?"gl_Color.xyz * _gl4es_LightSource_":"_gl4es_FrontLightProduct_");
+        sprintf(fm_emission, "%s", (color_material && state->cm_front_mode==FPE_CM_EMISSION)?"_gl4es_Color":"_gl4es_FrontMaterial.emission");
+        sprintf(fm_ambient, "%s", (color_material && (state->cm_front_mode==FPE_CM_AMBIENT || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))?"_gl4es_Color":"_gl4es_FrontMaterial.ambient");
+        sprintf(fm_diffuse, "%s", (color_material && (state->cm_front_mode==FPE_CM_DIFFUSE || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))?"_gl4es_Color.xyz * _gl4es_LightSource_":"_gl4es_FrontLightProduct_");
+        sprintf(fm_specular, "%s", (color_material && state->cm_front_mode==FPE_CM_SPECULAR)?"_gl4es_Color.xyz * _gl4es_LightSource_":"_gl4es_FrontLightProduct_");
         if(twosided) {
-            sprintf(bm_emission, "%s", (color_material && state->cm_back_mode==FPE_CM_EMISSION)?"gl_Color":"gl_BackMaterial.emission");
-            sprintf(bm_ambient, "%s", (color_material && (state->cm_back_mode==FPE_CM_AMBIENT || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE))?"gl_Color":"gl_BackMaterial.ambient");
-            sprintf(bm_diffuse, "%s", (color_material && (state->cm_back_mode==FPE_CM_DIFFUSE || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE))?"gl_Color.xyz * _gl4es_LightSource_":"_gl4es_BackLightProduct_");
-            sprintf(bm_specular, "%s", (color_material && state->cm_back_mode==FPE_CM_SPECULAR)?"gl_Color.xyz * _gl4es_LightSource_":"_gl4es_BackLightProduct_");
+            sprintf(bm_emission, "%s", (color_material && state->cm_back_mode==FPE_CM_EMISSION)?"_gl4es_Color":"_gl4es_BackMaterial.emission");
+            sprintf(bm_ambient, "%s", (color_material && (state->cm_back_mode==FPE_CM_AMBIENT || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE))?"_gl4es_Color":"_gl4es_BackMaterial.ambient");
+            sprintf(bm_diffuse, "%s", (color_material && (state->cm_back_mode==FPE_CM_DIFFUSE || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE))?"_gl4es_Color.xyz * _gl4es_LightSource_":"_gl4es_BackLightProduct_");
+            sprintf(bm_specular, "%s", (color_material && state->cm_back_mode==FPE_CM_SPECULAR)?"_gl4es_Color.xyz * _gl4es_LightSource_":"_gl4es_BackLightProduct_");
         }
 
         if(color_material && 
@@ -431,24 +639,26 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
             || (twosided && 
                 (state->cm_back_mode==FPE_CM_EMISSION || state->cm_back_mode==FPE_CM_AMBIENT || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE)))) 
         {
-            sprintf(buff, "Color = %s;\n", fm_emission);
+            sprintf(buff, "Color = %s;\n", fpe_use(fm_emission));
             ShadAppend(buff);
             if(twosided) {
-                sprintf(buff, "BackColor = %s;\n", bm_emission);
+                sprintf(buff, "BackColor = %s;\n", fpe_use(bm_emission));
                 ShadAppend(buff);
             }
             
-            sprintf(buff, "Color += %s*gl_LightModel.ambient;\n", fm_ambient);
+            sprintf(buff, "Color += %s*_gl4es_LightModel.ambient;\n", fpe_use(fm_ambient));
+            Use(FPE_LIGHTMODEL);
             ShadAppend(buff);
             if(twosided) {
-                sprintf(buff, "BackColor += %s*gl_LightModel.ambient;\n", bm_ambient);
+                sprintf(buff, "BackColor += %s*_gl4es_LightModel.ambient;\n", fpe_use(bm_ambient));
                 ShadAppend(buff);
             }
         } else {
-            ShadAppend("Color = gl_FrontLightModelProduct.sceneColor;\n");
+            ShadAppend("Color = _gl4es_FrontLightModelProduct.sceneColor;\n");
             if(twosided) {
-                ShadAppend("BackColor = gl_BackLightModelProduct.sceneColor;\n");
+                ShadAppend("BackColor = _gl4es_BackLightModelProduct.sceneColor;\n");
             }
+            Use(FPE_LIGHTMODELPRODUCT);
         }
         if(light_separate) {
             ShadAppend("SecColor=vec4(0.);\n");
@@ -502,7 +712,7 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                     ShadAppend("att *= spot;\n");
                 }
                 if(color_material && (state->cm_front_mode==FPE_CM_AMBIENT || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE)) {
-                    sprintf(buff, "aa = %s.xyz * _gl4es_LightSource_%d.ambient.xyz;\n", fm_ambient, i);
+                    sprintf(buff, "aa = %s.xyz * _gl4es_LightSource_%d.ambient.xyz;\n", fpe_use(fm_ambient), i);
                     ShadAppend(buff);
                 } else {
                     sprintf(buff, "aa = _gl4es_FrontLightProduct_%d.ambient.xyz;\n", i);
@@ -511,7 +721,7 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                 }
                 if(twosided) {
                     if(color_material && (state->cm_back_mode==FPE_CM_AMBIENT || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE)) {
-                        sprintf(buff, "back_aa = %s.xyz * _gl4es_LightSource_%d.ambient.xyz;\n", bm_ambient, i);
+                        sprintf(buff, "back_aa = %s.xyz * _gl4es_LightSource_%d.ambient.xyz;\n", fpe_use(bm_ambient), i);
                         ShadAppend(buff);
                     } else {
                         sprintf(buff, "back_aa = _gl4es_BackLightProduct_%d.ambient.xyz;\n", i);
@@ -521,11 +731,11 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                 }
                 sprintf(buff, "nVP = dot(normal, VP);\n");
                 ShadAppend(buff);
-                sprintf(buff, "dd = (nVP>0.)?(nVP * %s%d.diffuse.xyz):vec3(0.);\n", fm_diffuse, i);
+                sprintf(buff, "dd = (nVP>0.)?(nVP * %s%d.diffuse.xyz):vec3(0.);\n", fpe_use(fm_diffuse), i);
                 ShadAppend(buff);
                 need_lightproduct[0][i] = 1;
                 if(twosided) {
-                    sprintf(buff, "back_dd = (nVP<0.)?(-nVP * %s%d.diffuse.xyz):vec3(0.);\n", bm_diffuse, i);
+                    sprintf(buff, "back_dd = (nVP<0.)?(-nVP * %s%d.diffuse.xyz):vec3(0.);\n", fpe_use(bm_diffuse), i);
                     ShadAppend(buff);
                     need_lightproduct[1][i] = 1;
                 }
@@ -537,15 +747,15 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                 }
                 ShadAppend("lVP = dot(normal, hi);\n");
                 if(cm_front_nullexp)
-                    sprintf(buff, "ss = (nVP>0. && lVP>0.)?(pow(lVP, %s)*%s%d.specular.xyz):vec3(0.);\n", (color_material)?"gl_FrontMaterial.shininess":"_gl4es_FrontMaterial_shininess", fm_specular, i);
+                    sprintf(buff, "ss = (nVP>0. && lVP>0.)?(pow(lVP, %s)*%s%d.specular.xyz):vec3(0.);\n", fpe_use((color_material)?"_gl4es_FrontMaterial.shininess":"_gl4es_FrontMaterial_shininess"), fpe_use(fm_specular), i);
                 else
-                    sprintf(buff, "ss = (nVP>0. && lVP>0.)?(%s%d.specular.xyz):vec3(0.);\n", fm_specular, i);
+                    sprintf(buff, "ss = (nVP>0. && lVP>0.)?(%s%d.specular.xyz):vec3(0.);\n", fpe_use(fm_specular), i);
                 ShadAppend(buff);
                 if(twosided) {
                     if(state->cm_back_nullexp)    // 1, exp is not null
-                        sprintf(buff, "back_ss = (nVP<0. && lVP<0.)?(pow(-lVP, %s)*%s%d.specular.xyz):vec3(0.);\n", (color_material)?"gl_BackMaterial.shininess":"_gl4es_BackMaterial_shininess", bm_specular, i);
+                        sprintf(buff, "back_ss = (nVP<0. && lVP<0.)?(pow(-lVP, %s)*%s%d.specular.xyz):vec3(0.);\n", fpe_use((color_material)?"_gl4es_BackMaterial.shininess":"_gl4es_BackMaterial_shininess"), fpe_use(bm_specular), i);
                     else
-                        sprintf(buff, "back_ss = (nVP<0. && lVP<0.)?(%s%d.specular.xyz):vec3(0.);\n", bm_specular, i);
+                        sprintf(buff, "back_ss = (nVP<0. && lVP<0.)?(%s%d.specular.xyz):vec3(0.);\n", fpe_use(bm_specular), i);
                     ShadAppend(buff);
                 }
                 if(state->light_separate) {
@@ -566,11 +776,11 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                 }
             }
         }
-        sprintf(buff, "Color.a = %s;\n", (color_material && (state->cm_front_mode==FPE_CM_DIFFUSE || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))?"gl_Color.a":"_gl4es_FrontMaterial_alpha");
+        sprintf(buff, "Color.a = %s;\n", fpe_use((color_material && (state->cm_front_mode==FPE_CM_DIFFUSE || state->cm_front_mode==FPE_CM_AMBIENTDIFFUSE))?"_gl4es_Color.a":"_gl4es_FrontMaterial_alpha"));
         ShadAppend(buff);
         ShadAppend("Color.rgb = clamp(Color.rgb, 0., 1.);\n");
         if(twosided) {
-            sprintf(buff, "BackColor.a = %s;\n", (color_material && (state->cm_back_mode==FPE_CM_DIFFUSE || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE))?"gl_Color.a":"_gl4es_BackMaterial_alpha");
+            sprintf(buff, "BackColor.a = %s;\n", fpe_use((color_material && (state->cm_back_mode==FPE_CM_DIFFUSE || state->cm_back_mode==FPE_CM_AMBIENTDIFFUSE))?"_gl4es_Color.a":"_gl4es_BackMaterial_alpha"));
             ShadAppend("BackColor.rgb = clamp(BackColor.rgb, 0., 1.);\n");
             ShadAppend(buff);
         }
@@ -581,14 +791,22 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
             }
         }
         if(is_default && need) {
-            if(need->need_color>0)
-                ShadAppend("gl_FrontColor = Color;\n");
-            if(need->need_color>1)
-                ShadAppend("gl_BackColor = BackColor;\n");
-            if(need->need_secondary>0)
-                ShadAppend("gl_FrontSecondaryColor = SecColor;\n");
-            if(need->need_secondary>1)
-                ShadAppend("gl_BackSecondaryColor = SecBackColor;\n");
+            if(need->need_color>0) {
+                ShadAppend("_gl4es_FrontColor = Color;\n");
+                Use(FPE_FRONTCOLOR);
+            }
+            if(need->need_color>1) {
+                ShadAppend("_gl4es_BackColor = BackColor;\n");
+                Use(FPE_BACKCOLOR);
+            }
+            if(need->need_secondary>0) {
+                ShadAppend("_gl4es_FrontSecondaryColor = SecColor;\n");
+                Use(FPE_FRONTSECONDARYCOLOR);
+            }
+            if(need->need_secondary>1) {
+                ShadAppend("_gl4es_BackSecondaryColor = SecBackColor;\n");
+                Use(FPE_BACKSECONDARYCOLOR);
+            }
         }
     }
     // calculate texture coordinates
@@ -660,7 +878,7 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                         else
                             sprintf(buff, "tmp_tcoor.%c=tmpsphere.%c;\n", texcoordxy[j], texcoordxy[j]);
                     } else if(tg[j]==FPE_TG_OBJLINEAR) {
-                        sprintf(buff, "tmp_tcoor.%c=dot(gl_Vertex, _gl4es_ObjectPlane%c_%d);\n", texcoordxy[j], texcoordNAME[j], i);
+                        sprintf(buff, "tmp_tcoor.%c=dot(_gl4es_Vertex, _gl4es_ObjectPlane%c_%d);\n", texcoordxy[j], texcoordNAME[j], i);
                         need_objplane[i][j] = 1;
                     } else if(tg[j]==FPE_TG_EYELINEAR) {
                         sprintf(buff, "tmp_tcoor.%c=dot(vertex, _gl4es_EyePlane%c_%d);\n", texcoordxy[j], texcoordNAME[j], i);
@@ -681,12 +899,14 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
                         else
                             sprintf(buff, "tmp_tcoor.%c=tmpreflect.%c;\n", texcoordxy[j], texcoordxy[j]);
                     } else if(tg[j]==FPE_TG_NONE) {
-                        sprintf(buff, "tmp_tcoor.%c=gl_MultiTexCoord%d.%c;\n", texcoordxy[j], i, texcoordxy[j]);
+                        sprintf(buff, "tmp_tcoor.%c=_gl4es_MultiTexCoord%d.%c;\n", texcoordxy[j], i, texcoordxy[j]);
+                        Use(FPE_MULTITEXCOORD0+i);
                     }
                     ShadAppend(buff);
                 }
             } else {
-                sprintf(texcoord, "gl_MultiTexCoord%d", i);
+                sprintf(texcoord, "_gl4es_MultiTexCoord%d", i);
+                Use(FPE_MULTITEXCOORD0+i);
             }
             const char* text_tmp = texcoord;
             static const char* tmp_tex = "tmp_tex";
@@ -713,17 +933,17 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
         if(!need_vertex)
             need_vertex = 1;
         ShadAppend("float ps_d = length(vertex);\n");
-        sprintf(buff, "gl_PointSize = clamp(gl_Point.size*inversesqrt(gl_Point.distanceConstantAttenuation + ps_d*(gl_Point.distanceLinearAttenuation + ps_d*gl_Point.distanceQuadraticAttenuation)), gl_Point.sizeMin, gl_Point.sizeMax);\n");
+        sprintf(buff, "gl_PointSize = clamp(_gl4es_Point.size*inversesqrt(_gl4es_Point.distanceConstantAttenuation + ps_d*(_gl4es_Point.distanceLinearAttenuation + ps_d*_gl4es_Point.distanceQuadraticAttenuation)), _gl4es_Point.sizeMin, _gl4es_Point.sizeMax);\n");
         ShadAppend(buff);
+        Use(FPE_POINT);
     }
-    // insert normal, vertex and eye/obj planes if needed
+    // normal and vertex, at the start of main, and eye/obj planes if needed
+    char prologue[200] = {0};
     if(need_vertex) {
-        buff[0] = '\0';
         if(need_vertex==1)
-            strcat(buff, "vec4 ");
-        strcat(buff, "vertex = gl_ModelViewMatrix * gl_Vertex;\n");
-        shad = InplaceInsert(GetLine(shad, normal_line + headers), buff, shad, &shad_cap);
-        normal_line += CountLine(buff);
+            strcat(prologue, "vec4 ");
+        strcat(prologue, "vertex = _gl4es_ModelViewMatrix * _gl4es_Vertex;\n");
+        Use(FPE_MODELVIEWMATRIX); Use(FPE_VERTEX);
     }
     if(need_normal) {
 #if 0
@@ -736,35 +956,29 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
 #else
 // Implementions may choose to normalize for rescale...
         if(state->rescaling || state->normalize || globals4es.normalize)
-            strcpy(buff, "vec3 normal = normalize(gl_NormalMatrix * gl_Normal);\n");
+            strcat(prologue, "vec3 normal = normalize(_gl4es_NormalMatrix * _gl4es_Normal);\n");
         else
             //strcpy(buff, "vec3 normal = (vec4(gl_Normal, (gl_Vertex.w==0.0)?0.0:(-dot(gl_Normal, gl_Vertex.xyz)/gl_Vertex.w))*gl_ModelViewMatrixInverse).xyz;\n");
-            strcpy(buff, "vec3 normal = gl_NormalMatrix * gl_Normal;\n");
+            strcat(prologue, "vec3 normal = _gl4es_NormalMatrix * _gl4es_Normal;\n");
 #endif
-        shad = InplaceInsert(GetLine(shad, normal_line + headers), buff, shad, &shad_cap);
+        Use(FPE_NORMALMATRIX); Use(FPE_NORMAL);
     }
-    buff[0] = '\0';
     for (int i=0; i<MAX_TEX; i++) {
-        char tmp[100];
         for (int j=0; j<4; j++) {
             if(need_objplane[i][j]) {
-                sprintf(tmp, "uniform vec4 _gl4es_ObjectPlane%c_%d;\n", texcoordNAME[j], i);
-                strcat(buff, tmp);
+                sprintf(buff, "uniform vec4 _gl4es_ObjectPlane%c_%d;\n", texcoordNAME[j], i);
+                text_append(&decl, buff, strlen(buff));
             }
             if(need_eyeplane[i][j]) {
-                sprintf(tmp, "uniform vec4 _gl4es_EyePlane%c_%d;\n", texcoordNAME[j], i);
-                strcat(buff, tmp);
+                sprintf(buff, "uniform vec4 _gl4es_EyePlane%c_%d;\n", texcoordNAME[j], i);
+                text_append(&decl, buff, strlen(buff));
             }
         }
         if(need_adjust[i]) {
-            sprintf(tmp, "uniform vec2 _gl4es_TexAdjust_%d;\n", i);
-            strcat(buff, tmp);
+            sprintf(buff, "uniform vec2 _gl4es_TexAdjust_%d;\n", i);
+            text_append(&decl, buff, strlen(buff));
         }
     }
-    if(buff[0]!='\0') {
-        shad = InplaceInsert(GetLine(shad, headers), buff, shad, &shad_cap);
-        headers += CountLine(buff);
-    }
     if(fog) {
         if(comments) {
             sprintf(buff, "// Fog On: mode=%X, source=%X distance=%X\n", fogmode, fogsource, fogdist);
@@ -773,7 +987,7 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
         #if 0    // vertex fog
         char fogsrc[50];
         if(fogsource==FPE_FOG_SRC_COORD)
-            strcpy(fogsrc, "gl_FogCoord");
+            strcpy(fogsrc, "_gl4es_FogCoord");
         else switch(fogdist) {
             case FPE_FOG_DIST_RADIAL: strcpy(fogsrc, "length(vertex.xyz)"); break;
             case FPE_FOG_DIST_PLANE: strcpy(fogsrc, "vertex.z"); break;
@@ -783,19 +997,20 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
         ShadAppend(buff);
         switch(fogmode) {
             case FPE_FOG_EXP:
-                ShadAppend("FogF = clamp(exp(-gl_Fog.density * fog_c), 0., 1.);\n");
+                ShadAppend("FogF = clamp(exp(-_gl4es_Fog.density * fog_c), 0., 1.);\n");
                 break;
             case FPE_FOG_EXP2:
-                ShadAppend("FogF = clamp(exp(-(gl_Fog.density * fog_c)*(gl_Fog.density * fog_c)), 0., 1.);\n");
+                ShadAppend("FogF = clamp(exp(-(_gl4es_Fog.density * fog_c)*(_gl4es_Fog.density * fog_c)), 0., 1.);\n");
                 break;
             case FPE_FOG_LINEAR:
-                ShadAppend("FogF = clamp((gl_Fog.end - fog_c) * gl_Fog.scale, 0., 1.);\n");
+                ShadAppend("FogF = clamp((_gl4es_Fog.end - fog_c) * _gl4es_Fog.scale, 0., 1.);\n");
                 break;
         }
         #else   // pixel fog
-        if(fogsource==FPE_FOG_SRC_COORD)
-            sprintf(buff, "FogSrc = gl_FogCoord;\n");
-        else switch(fogdist) {
+        if(fogsource==FPE_FOG_SRC_COORD) {
+            sprintf(buff, "FogSrc = _gl4es_FogCoord;\n");
+            Use(FPE_FOGCOORD);
+        } else switch(fogdist) {
             case FPE_FOG_DIST_RADIAL: sprintf(buff, "FogSrc = vertex.xyz;\n"); break;
             case FPE_FOG_DIST_PLANE:
             default: sprintf(buff, "FogSrc = vertex.z;\n");
@@ -807,9 +1022,7 @@ const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state)
 
     ShadAppend("}\n");
 
-    DBG(printf("FPE Shader: \n%s\n", shad);)
-
-    return (const char* const*)&shad;
+    return fpe_end("\nvoid main() {\n", prologue);
 }
 
 const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *state) {
@@ -817,7 +1030,6 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
     fpe_state_t default_state = {0};
     int is_default = !!need;
     if(!state) state = &default_state;
-    int headers = 0;
     int lighting = state->lighting;
     int twosided = state->twosided && lighting;
     int light_separate = state->light_separate && lighting;
@@ -839,7 +1051,7 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
     const char* fogp = hardext.highp?"highp":"mediump";
 
 
-    strcpy(shad, fpeshader_signature);
+    fpe_begin();
 
     // check texture streaming and texturing
     {
@@ -858,26 +1070,20 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
     if(comments) {
         sprintf(buff, "// ** Fragment Shader **\n// lighting=%d, alpha=%d, secondary=%d, planes=%s, texturing=%d point=%d\n", lighting, alpha_test, secondary, fpe_binary(planes, 6), texturing, point);
         ShadAppend(buff);
-        headers+=CountLine(buff);
     }
     ShadAppend("varying vec4 Color;\n");
-    headers++;
     if(twosided) {
         ShadAppend("varying vec4 BackColor;\n");
-        headers++;
     }
     if(light_separate || secondary) {
         ShadAppend("varying vec4 SecColor;\n");
-        headers++;
         if(twosided) {
             ShadAppend("varying vec4 SecBackColor;\n");
-            headers++;
         }
     }
     if(fog) {
         #if 0   // vertex fog
         ShadAppend("varying mediump float FogF;\n");
-        headers++;
         #else   // pixel fog
         if(fogsource==FPE_FOG_SRC_COORD) {
             sprintf(buff, "varying %s float FogSrc;\n", fogp);
@@ -895,7 +1101,6 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
             if((planes>>i)&1) {
                 sprintf(buff, "varying mediump float clippedvertex_%d;\n", i);
                 ShadAppend(buff);
-                headers++;
             }
         }
     }
@@ -908,7 +1113,6 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
             ShadAppend(buff);
             sprintf(buff, "uniform %s _gl4es_TexSampler_%d;\n", texsampler[t-1], i);
             ShadAppend(buff);
-            headers++;
 
             int texenv = state->texenv[i].texenv;
             if (texenv>=FPE_COMBINE) {
@@ -917,22 +1121,20 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
                 if(state->texenv[i].texrgbscale) {
                     sprintf(buff, "uniform float _gl4es_TexEnvRGBScale_%d;\n", i);
                     ShadAppend(buff);
-                    headers++;
                 }
                 if(state->texenv[i].texalphascale) {
                     sprintf(buff, "uniform float _gl4es_TexEnvAlphaScale_%d;\n", i);
                     ShadAppend(buff);
-                    headers++;
                 }
             }
         }
     }
     if(alpha_test && alpha_func>FPE_NEVER) {
         ShadAppend(gl4es_alphaRefSource);
-        headers++;
     } 
 
-    ShadAppend("void main() {\n");
+    // let's start
+    cur = &body;
 
     //*** Clip Planes (it's probably not the best idea to do that here...)
     if(planes) {
@@ -1022,8 +1224,7 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
                     case FPE_BLEND:
                         // create the Uniform for TexEnv Constant color
                         sprintf(buff, "uniform lowp vec4 _gl4es_TextureEnvColor_%d;\n", i);
-                        shad = InplaceInsert(GetLine(shad, headers), buff, shad, &shad_cap);
-                        headers+=CountLine(buff);
+                        text_append(&decl, buff, strlen(buff));
                         needclamp=0;
                         if(texformat!=FPE_TEX_ALPHA) {
                             sprintf(buff, "fColor.rgb = mix(fColor.rgb, _gl4es_TextureEnvColor_%d.rgb, texColor%d.rgb);\n", i, i);
@@ -1133,8 +1334,7 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
                             if(constant) {
                                 // yep, create the Uniform
                                 sprintf(buff, "uniform lowp vec4 _gl4es_TextureEnvColor_%d;\n", i);
-                                shad = InplaceInsert(GetLine(shad, headers), buff, shad, &shad_cap);
-                                headers+=CountLine(buff);                            
+                                text_append(&decl, buff, strlen(buff));
                             }
                             for (int j=0; j<4; j++) {
                                 if(src_r[j]==src_a[j] && op_r[j]==FPE_OP_SRCCOLOR && op_a[j]==FPE_OP_ALPHA) {
@@ -1349,7 +1549,7 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
             ShadAppend(buff);
         }
         #if 0   // vertex fog
-        ShadAppend("fColor.rgb = mix(gl_Fog.color.rgb, fColor.rgb, FogF);\n");
+        ShadAppend("fColor.rgb = mix(_gl4es_Fog.color.rgb, fColor.rgb, FogF);\n");
         #else   // pixel fog
         char fogsrc[50];
         if(fogsource==FPE_FOG_SRC_COORD)
@@ -1363,17 +1563,18 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
         ShadAppend(buff);
         switch(fogmode) {
             case FPE_FOG_EXP:
-                sprintf(buff, "%s float FogF = clamp(exp(-gl_Fog.density * fog_c), 0., 1.);\n", fogp);
+                sprintf(buff, "%s float FogF = clamp(exp(-_gl4es_Fog.density * fog_c), 0., 1.);\n", fogp);
                 break;
             case FPE_FOG_EXP2:
-                sprintf(buff, "%s float FogF = clamp(exp(-(gl_Fog.density * fog_c)*(gl_Fog.density * fog_c)), 0., 1.);\n", fogp);
+                sprintf(buff, "%s float FogF = clamp(exp(-(_gl4es_Fog.density * fog_c)*(_gl4es_Fog.density * fog_c)), 0., 1.);\n", fogp);
                 break;
             case FPE_FOG_LINEAR:
-                sprintf(buff, "%s float FogF = clamp((gl_Fog.end - fog_c) %s, 0., 1.);\n", fogp, hardext.highp?"* gl_Fog.scale":"/ (gl_Fog.end - gl_Fog.start)");
+                sprintf(buff, "%s float FogF = clamp((_gl4es_Fog.end - fog_c) %s, 0., 1.);\n", fogp, hardext.highp?"* _gl4es_Fog.scale":"/ (_gl4es_Fog.end - _gl4es_Fog.start)");
                 break;
         }
         ShadAppend(buff);
-        ShadAppend("fColor.rgb = mix(gl_Fog.color.rgb, fColor.rgb, FogF);\n");
+        ShadAppend("fColor.rgb = mix(_gl4es_Fog.color.rgb, fColor.rgb, FogF);\n");
+        Use(FPE_FOG);
         #endif
     }
 
@@ -1381,9 +1582,7 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
     ShadAppend("gl_FragColor = fColor;\n");
     ShadAppend("}");
 
-    DBG(printf("FPE Shader: \n%s\n", shad);)
-
-    return (const char* const*)&shad;
+    return fpe_end("void main() {\n", "");
 }
 
 const char* const* fpe_CustomVertexShader(const char* initial, fpe_state_t* state)
@@ -1396,17 +1595,17 @@ const char* const* fpe_CustomVertexShader(const char* initial, fpe_state_t* stat
     if(headline) --headline;
 
     strcpy(shad, "");
-    ShadAppend(initial);
+    CustomAppend(initial);
 
     // add some uniform and varying
     if(planes) {
         for (int i=0; i<hardext.maxplanes; i++) {
             if((planes>>i)&1) {
                 sprintf(buff, "uniform highp vec4 _gl4es_ClipPlane_%d;\n", i);
-                ShadAppend(buff);
+                CustomAppend(buff);
                 ++headline;
                 sprintf(buff, "varying mediump float clippedvertex_%d;\n", i);
-                ShadAppend(buff);
+                CustomAppend(buff);
                 ++headline;
             }
         }
@@ -1419,8 +1618,8 @@ const char* const* fpe_CustomVertexShader(const char* initial, fpe_state_t* stat
 
     // let's start
     if(strstr(shad, "_gl4es_main")) {
-        ShadAppend("\nvoid main() {\n");
-        ShadAppend("_gl4es_main();");
+        CustomAppend("\nvoid main() {\n");
+        CustomAppend("_gl4es_main();");
         if(planes) {
             int clipvertex = 0;
             if(strstr(shad, "gl4es_ClipVertex"))
@@ -1428,11 +1627,11 @@ const char* const* fpe_CustomVertexShader(const char* initial, fpe_state_t* stat
             for (int i=0; i<hardext.maxplanes; i++) {
                 if((planes>>i)&1) {
                     sprintf(buff, "clippedvertex_%d = dot(%s, _gl4es_ClipPlane_%d);\n", i, clipvertex?"gl4es_ClipVertex":"gl_ModelViewMatrix * gl_Vertex", i);
-                    ShadAppend(buff);
+                    CustomAppend(buff);
                 }
             }
         }
-        ShadAppend("}");
+        CustomAppend("}");
     }
 
     return (const char* const*)&shad;
@@ -1451,14 +1650,14 @@ const char* const* fpe_CustomFragmentShader(const char* initial, fpe_state_t* st
     if(headline) --headline;
 
     strcpy(shad, "");
-    ShadAppend(initial);
+    CustomAppend(initial);
 
     // add some varying
     if(planes) {
         for (int i=0; i<hardext.maxplanes; i++) {
             if((planes>>i)&1) {
                 sprintf(buff, "varying mediump float clippedvertex_%d;\n", i);
-                ShadAppend(buff);
+                CustomAppend(buff);
             }
         }
     }
@@ -1468,21 +1667,21 @@ const char* const* fpe_CustomFragmentShader(const char* initial, fpe_state_t* st
     }
     int is_fragcolor = (strstr(shad, "gl_FragColor")!=NULL)?1:0;
     if(strstr(shad, "_gl4es_main")) {
-        ShadAppend("void main() {\n");
-        ShadAppend(" _gl4es_main();\n");
+        CustomAppend("void main() {\n");
+        CustomAppend(" _gl4es_main();\n");
         //*** Plane Culling
         if(planes) {
-            ShadAppend(" if((");
+            CustomAppend(" if((");
             int k=0;
             for (int i=0; i<hardext.maxplanes; i++) {
                 if((planes>>i)&1) {
                     //sprintf(buff, "%smin(0., dot(clipvertex, gl_ClipPlane[%d]))", k?"+":"",  i);
                     sprintf(buff, "%smin(0., clippedvertex_%d)", k?"+":"",  i);
-                    ShadAppend(buff);
+                    CustomAppend(buff);
                     k=1;
                 }
             }
-            ShadAppend(")<0.) discard;\n");
+            CustomAppend(")<0.) discard;\n");
         }
 
         //*** Alpha Test
@@ -1493,22 +1692,22 @@ const char* const* fpe_CustomFragmentShader(const char* initial, fpe_state_t* st
             } 
             if(comments) {
                 sprintf(buff, "// Alpha Test, fct=%X\n", alpha_func);
-                ShadAppend(buff);
+                CustomAppend(buff);
             }
             if(alpha_func==FPE_ALWAYS) {
                 // nothing here...
             } else if (alpha_func==FPE_NEVER) {
-                ShadAppend("discard;\n"); // Never pass...
+                CustomAppend("discard;\n"); // Never pass...
             } else {
                 // FPE_LESS FPE_EQUAL FPE_LEQUAL FPE_GREATER FPE_NOTEQUAL FPE_GEQUAL
                 // but need to negate the operator
                 const char* alpha_test_op[] = {">=","!=",">","<=","==","<"}; 
                 sprintf(buff, " if (floor(%s.a*255.) %s _gl4es_AlphaRef) discard;\n", is_fragcolor?"gl_FragColor":"gl_FragData[0]", alpha_test_op[alpha_func-FPE_LESS]);
-                ShadAppend(buff);
+                CustomAppend(buff);
             }
         }
 
-        ShadAppend("}");
+        CustomAppend("}");
     }
 
     return (const char* const*)&shad;
@@ -1521,6 +1720,10 @@ void fpe_shader_reset_internals() {
 		shad=NULL;
 	}
 	shad_cap=0;
+	free(decl.s);
+	free(body.s);
+	memset(&decl, 0, sizeof(decl));
+	memset(&body, 0, sizeof(body));
 	comments=1;
 }
 #endif
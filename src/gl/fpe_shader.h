@@ -4,6 +4,7 @@
 #include "fpe.h"
 
 extern const char* fpeshader_signature;
+extern const char* fpeshader_es_signature;
 
 const char* const* fpe_VertexShader(shaderconv_need_t* need, fpe_state_t *state);
 const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *state);
@@ -11,4 +12,7 @@ const char* const* fpe_FragmentShader(shaderconv_need_t* need, fpe_state_t *stat
 const char* const* fpe_CustomVertexShader(const char* initial, fpe_state_t* state);
 const char* const* fpe_CustomFragmentShader(const char* initial, fpe_state_t* state);
 
+// FPE shader (generated for GLES) back to its desktop GLSL form, for a full ConvertShader (to be freed by the caller)
+char* fpe_DesktopShader(const char* source);
+
 #endif // _GL4ES_FPE_SHADER_H_
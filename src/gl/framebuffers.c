@@ -5,9 +5,11 @@
 #include "debug.h"
 #include "fpe.h"
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "init.h"
 #include "loader.h"
+#include "texres.h"
 
 //#define DEBUG
 #ifdef DEBUG
@@ -214,6 +216,7 @@ GLenum gl4es_glCheckFramebufferStatus(GLenum target) {
 void gl4es_glBindFramebuffer(GLenum target, GLuint framebuffer) {
     DBG(printf("glBindFramebuffer(%s, %u), list=%s, glstate->fbo.current_fb=%d (draw=%d, read=%d)\n", PrintEnum(target), framebuffer, glstate->list.active?"active":"none", glstate->fbo.current_fb->id, glstate->fbo.fbo_draw->id, glstate->fbo.fbo_read->id);)
 	PUSH_IF_COMPILING(glBindFramebuffer);
+    FLUSH_TEXUPLOAD;
     LOAD_GLES2_OR_OES(glBindFramebuffer);
 //    LOAD_GLES2_OR_OES(glCheckFramebufferStatus);
     LOAD_GLES(glGetError);
@@ -425,7 +428,6 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
     LOAD_GLES2_OR_OES(glFramebufferTexture2D);
     LOAD_GLES(glTexImage2D);
     LOAD_GLES(glBindTexture);
-    LOAD_GLES(glActiveTexture);
     LOAD_GLES(glTexParameteri);
 
     glframebuffer_t *fb = get_framebuffer(target);
@@ -452,6 +454,7 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
             LOGE("texture for FBO not found, name=%u\n", texture);
         } else {
             texture = tex->glname;
+            RESTORE_TEXTURE(tex, glstate->texture.active);
             // check if texture is shrinked...
             if (tex->shrink || tex->useratio || (tex->adjust && (hardext.npot==1 || hardext.npot==2) && !globals4es.potframebuffer)) {
                 LOGD("%s texture for FBO\n",(tex->useratio)?"going back to npot size pot'ed":"unshrinking shrinked");
@@ -470,14 +473,14 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                 tex->adjustxy[1] = (float)tex->height / tex->nheight;
                 tex->adjust=(tex->width!=tex->nwidth || tex->height!=tex->nheight);
                 tex->shrink = 0; tex->useratio = 0;
-                int oldactive = glstate->texture.active;
-                if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                int oldactive = glstate->gleshard->active;
+                gleshard_glActiveTexture(GL_TEXTURE0);
                 gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                 GLuint oldtex = bound->glname;
                 if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
                 gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
                 if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
             }
             int need_change = (globals4es.potframebuffer && (npot(twidth)!=twidth || npot(theight)!=theight))?1:0;
             if((tex->type==GL_FLOAT && !hardext.floatfbo) || (tex->type==GL_HALF_FLOAT_OES && !hardext.halffloatfbo)) {
@@ -498,14 +501,14 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     tex->adjustxy[1] = (float)tex->height / tex->nheight;
                     tex->adjust=(tex->width!=tex->nwidth || tex->height!=tex->nheight);
                 }
-                int oldactive = glstate->texture.active;
-                if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                int oldactive = glstate->gleshard->active;
+                gleshard_glActiveTexture(GL_TEXTURE0);
                 gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                 GLuint oldtex = bound->glname;
                 if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
                 gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
                 if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
             }
             twidth = tex->nwidth;
             theight = tex->nheight;
@@ -585,8 +588,8 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                 if(tex->type!=GL_UNSIGNED_INT && tex->type!=GL_UNSIGNED_SHORT && tex->type!=GL_FLOAT) tex->type = (hardext.depth24)?GL_UNSIGNED_INT:GL_UNSIGNED_SHORT;
                 tex->fpe_format = FPE_TEX_DEPTH;
                 realize_textures(0);
-                int oldactive = glstate->texture.active;
-                if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                int oldactive = glstate->gleshard->active;
+                gleshard_glActiveTexture(GL_TEXTURE0);
                 gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                 GLuint oldtex = bound->glname;
                 if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
@@ -596,7 +599,7 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                 gles_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
                 gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
                 if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
             }
             // bind the depth texture...
             gles_glFramebufferTexture2D(ntarget, attachment, GL_TEXTURE_2D, texture, 0);
@@ -627,8 +630,8 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     //TODO: need to create a new texture, as the depth one is probably used
                     gl4es_glGenTextures(1, &texture);
                     realize_textures(0);
-                    int oldactive = glstate->texture.active;
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                    int oldactive = glstate->gleshard->active;
+                    gleshard_glActiveTexture(GL_TEXTURE0);
                     gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                     GLuint oldtex = bound->glname;
                     int nwidth = tex->nwidth;
@@ -644,14 +647,14 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     tex->type = (hardext.stenciltex)?GL_UNSIGNED_BYTE:GL_UNSIGNED_INT_24_8;
                     gl4es_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, nwidth, nheight, 0, tex->format, tex->type, NULL);
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                    gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
                 } else {
                     tex->format = GL_STENCIL_INDEX8;
                     if(tex->type!=GL_UNSIGNED_BYTE && tex->type!=GL_UNSIGNED_SHORT && tex->type!=GL_FLOAT) tex->type = GL_UNSIGNED_BYTE;
                     tex->fpe_format = FPE_TEX_DEPTH;
                     realize_textures(0);
-                    int oldactive = glstate->texture.active;
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                    int oldactive = glstate->gleshard->active;
+                    gleshard_glActiveTexture(GL_TEXTURE0);
                     gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                     GLuint oldtex = bound->glname;
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
@@ -661,7 +664,7 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     gles_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
                     gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                    gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
                 }
             }
             // bind the stencil texture...
@@ -690,8 +693,8 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     tex->format = GL_DEPTH_STENCIL;
                     tex->type = GL_UNSIGNED_INT_24_8;
                     tex->fpe_format = FPE_TEX_DEPTH; // add depth_stencil?
-                    int oldactive = glstate->texture.active;
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                    int oldactive = glstate->gleshard->active;
+                    gleshard_glActiveTexture(GL_TEXTURE0);
                     gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                     GLuint oldtex = bound->glname;
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
@@ -701,7 +704,7 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     gles_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
                     gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                    gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
                 }
                 gles_glFramebufferTexture2D(ntarget, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
                 gles_glFramebufferTexture2D(ntarget, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
@@ -724,8 +727,8 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     tex->format = GL_DEPTH_COMPONENT;
                     if(tex->type!=GL_UNSIGNED_INT && tex->type!=GL_UNSIGNED_SHORT && tex->type!=GL_FLOAT) tex->type = (hardext.depth24)?GL_UNSIGNED_INT:GL_UNSIGNED_SHORT;
                     tex->fpe_format = FPE_TEX_DEPTH;
-                    int oldactive = glstate->texture.active;
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+                    int oldactive = glstate->gleshard->active;
+                    gleshard_glActiveTexture(GL_TEXTURE0);
                     gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
                     GLuint oldtex = bound->glname;
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
@@ -735,7 +738,7 @@ void gl4es_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texta
                     gles_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
                     gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
                     if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-                    if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+                    gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
                 }
                 // bind the depth texture...
                 gles_glFramebufferTexture2D(ntarget, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
@@ -1016,11 +1019,10 @@ void gl4es_glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei w
     if(rend->secondarytexture) {
         // should check if texture is still needed?
         gltexture_t *tex = gl4es_getTexture(GL_TEXTURE_2D, rend->secondarytexture);
-        LOAD_GLES(glActiveTexture);
         LOAD_GLES(glBindTexture);
         LOAD_GLES(glTexImage2D);
-        int oldactive = glstate->texture.active;
-        if(oldactive) gles_glActiveTexture(GL_TEXTURE0);
+        int oldactive = glstate->gleshard->active;
+        gleshard_glActiveTexture(GL_TEXTURE0);
         gltexture_t *bound = glstate->texture.bound[0/*glstate->texture.active*/][ENABLED_TEX2D];
         GLuint oldtex = bound->glname;
         if (oldtex!=rend->secondarytexture) gles_glBindTexture(GL_TEXTURE_2D, rend->secondarytexture);
@@ -1028,7 +1030,7 @@ void gl4es_glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei w
         tex->nheight = tex->height = height;
         gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, tex->nwidth, tex->nheight, 0, tex->format, tex->type, NULL);
         if (oldtex!=tex->glname) gles_glBindTexture(GL_TEXTURE_2D, oldtex);
-        if(oldactive) gles_glActiveTexture(GL_TEXTURE0+oldactive);
+        gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
     }
 
     rend->width  = width;
@@ -1204,7 +1206,6 @@ void createMainFBO(int width, int height) {
     LOAD_GLES(glTexImage2D);
     LOAD_GLES(glGenTextures);
     LOAD_GLES(glBindTexture);
-    LOAD_GLES(glActiveTexture);
     LOAD_GLES(glTexParameteri);
     LOAD_GLES2(glClientActiveTexture);
     LOAD_GLES(glClear);
@@ -1219,8 +1220,8 @@ void createMainFBO(int width, int height) {
     }
     DBG(printf("LIBGL: Create FBO of %ix%i 32bits\n", width, height);)
     // switch to texture unit 0 if needed
-    if (glstate->texture.active != 0)
-        gles_glActiveTexture(GL_TEXTURE0);
+    int oldactive = glstate->gleshard->active;
+    gleshard_glActiveTexture(GL_TEXTURE0);
     if (glstate->texture.client != 0 && gles_glClientActiveTexture)
         gles_glClientActiveTexture(GL_TEXTURE0);
         
@@ -1269,8 +1270,7 @@ void createMainFBO(int width, int height) {
 
     // Put everything back
     gles_glBindTexture(GL_TEXTURE_2D, glstate->texture.bound[0][ENABLED_TEX2D]->glname);
-    if (glstate->texture.active != 0)
-        gles_glActiveTexture(GL_TEXTURE0 + glstate->texture.active);
+    gleshard_glActiveTexture(GL_TEXTURE0 + oldactive);
     if (glstate->texture.client != 0 && gles_glClientActiveTexture)
         gles_glClientActiveTexture(GL_TEXTURE0 + glstate->texture.client);
     GLuint current_rb = glstate->fbo.current_rb->renderbuffer;
@@ -8,6 +8,7 @@
 #include "light.h"
 #include "matvec.h"
 #include "texgen.h"
+#include "texres.h"
 
 //#define DEBUG
 #ifdef DEBUG
@@ -769,6 +770,20 @@ int gl4es_commonGet(GLenum pname, GLfloat *params) {
         case GL_GAMMA_HINT_GL4ES:
             *params=globals4es.gamma*10.f;
             break;
+        case GL_STREAMVBO_HINT_GL4ES:
+            *params=globals4es.streamvbo;
+            break;
+        case GL_VCACHE_HINT_GL4ES:
+            *params=globals4es.vcache;
+            break;
+        case GL_TEXBUDGET_HINT_GL4ES:
+            *params=globals4es.texbudget;
+            break;
+        case GL_TEXBUDGET_GPU_GL4ES:
+        case GL_TEXBUDGET_SHADOW_GL4ES:
+        case GL_TEXBUDGET_EVICTED_GL4ES:
+        case GL_TEXBUDGET_RELOADED_GL4ES:
+            return texres_getter(pname, params);
         default:
             return 0;
     }
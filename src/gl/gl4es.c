@@ -11,7 +11,9 @@
 #include "debug.h"
 #include "enum_info.h"
 #include "fpe.h"
+#include "fpe_prewarm.h"
 #include "framebuffers.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "init.h"
 #include "loader.h"
@@ -836,6 +838,7 @@ void gl4es_glEndList() {
     }
     if (glstate->list.compiling) {
 	// Free the previous list if it exist...
+        calllists_invalidate(glstate->calllists, list);
         free_renderlist(kh_value(lists, k));
         renderlist_t* l = kh_value(lists, k) = GetFirst(glstate->list.active);
         // set name
@@ -844,8 +847,18 @@ void gl4es_glEndList() {
             l = l->next;
         }
         glstate->list.compiling = false;
+        // optimize the stages of the list (ES1.1 path still adjust the list at draw time)
+        if (hardext.esversion>1 && !globals4es.nolistopt) {
+            l = kh_value(lists, k) = optimize_renderlist(kh_value(lists, k));
+            while(l->next) l = l->next;
+            glstate->list.active = l;
+        }
         end_renderlist(glstate->list.active);
         glstate->list.active = NULL;
+        // pack the arrays of the list in 1 interleaved buffer (ES1.1 path still need separate arrays)
+        if (hardext.esversion>1)
+            for (l = kh_value(lists, k); l; l = l->next)
+                interleave_renderlist(l);
 
         if (glstate->list.mode == GL_COMPILE_AND_EXECUTE) {
         	noerrorShim();
@@ -857,7 +870,6 @@ void gl4es_glEndList() {
 }
 void glEndList() AliasExport("gl4es_glEndList");
 
-renderlist_t* append_calllist(renderlist_t *list, renderlist_t *a);
 void gl4es_glCallList(GLuint list) {
 	noerrorShim();
     if (glstate->list.active) {
@@ -878,9 +890,9 @@ void glPushCall(void *call) {
     }
 }
 
-void gl4es_glCallLists(GLsizei n, GLenum type, const GLvoid *lists) {
+static GLuint calllists_name(GLenum type, const GLvoid *lists, int i) {
     #define call(name, type) \
-        case name: glCallList(((type *)lists)[i] + glstate->list.base); break
+        case name: return ((type *)lists)[i]
 
     // seriously wtf
     #define call_bytes(name, stride)                             \
@@ -890,30 +902,64 @@ void gl4es_glCallLists(GLsizei n, GLenum type, const GLvoid *lists) {
             for (j = 0; j < stride; j++) {                       \
                 list += *(l + (i * stride + j)) << (stride - j); \
             }                                                    \
-            gl4es_glCallList(list + glstate->list.base);                  \
-            break
+            return list
 
-    if (glstate->raster.bm_drawing) bitmap_flush();
-    FLUSH_BEGINEND;
-    unsigned int i, j;
+    unsigned int j;
     GLuint list;
     GLubyte *l;
-    for (i = 0; i < n; i++) {
-        switch (type) {
-            call(GL_BYTE, GLbyte);
-            call(GL_UNSIGNED_BYTE, GLubyte);
-            call(GL_SHORT, GLshort);
-            call(GL_UNSIGNED_SHORT, GLushort);
-            call(GL_INT, GLint);
-            call(GL_UNSIGNED_INT, GLuint);
-            call(GL_FLOAT, GLfloat);
-            call_bytes(GL_2_BYTES, 2);
-            call_bytes(GL_3_BYTES, 3);
-            call_bytes(GL_4_BYTES, 4);
-        }
+    switch (type) {
+        call(GL_BYTE, GLbyte);
+        call(GL_UNSIGNED_BYTE, GLubyte);
+        call(GL_SHORT, GLshort);
+        call(GL_UNSIGNED_SHORT, GLushort);
+        call(GL_INT, GLint);
+        call(GL_UNSIGNED_INT, GLuint);
+        call(GL_FLOAT, GLfloat);
+        call_bytes(GL_2_BYTES, 2);
+        call_bytes(GL_3_BYTES, 3);
+        call_bytes(GL_4_BYTES, 4);
     }
     #undef call
     #undef call_bytes
+    return 0;
+}
+
+void gl4es_glCallLists(GLsizei n, GLenum type, const GLvoid *lists) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+        case GL_2_BYTES:
+        case GL_3_BYTES:
+        case GL_4_BYTES:
+            break;
+        default:
+            errorShim(GL_INVALID_ENUM);
+            return;
+    }
+    if (glstate->raster.bm_drawing) bitmap_flush();
+    FLUSH_BEGINEND;
+    // sequences of lists called outside of a list are flattened and cached (GLES2+ backend only)
+    if (!glstate->list.active && n>1 && n<=CALLLISTS_MAX_LISTS && hardext.esversion>1 && !globals4es.nolistopt) {
+        GLuint names[n];
+        for (int i = 0; i < n; i++)
+            names[i] = calllists_name(type, lists, i) + glstate->list.base;
+        renderlist_t *flat = calllists_get(glstate->calllists, names, n);
+        if (flat) {
+            noerrorShim();
+            draw_renderlist(flat);
+        } else {
+            for (int i = 0; i < n; i++)
+                gl4es_glCallList(names[i]);
+        }
+        return;
+    }
+    for (int i = 0; i < n; i++)
+        gl4es_glCallList(calllists_name(type, lists, i) + glstate->list.base);
 }
 void glCallLists(GLsizei n, GLenum type, const GLvoid *lists) AliasExport("gl4es_glCallLists");
 
@@ -927,6 +973,7 @@ void gl4es_glDeleteList(GLuint list) {
         k = kh_get(gllisthead, lists, list);
         renderlist_t *gllist = NULL;
         if (k != kh_end(lists)){
+            calllists_invalidate(glstate->calllists, list);
             gllist = kh_value(lists, k);
             free_renderlist(gllist);
             kh_del(gllisthead, lists, k);
@@ -990,6 +1037,13 @@ void gl4es_glPolygonMode(GLenum face, GLenum mode) {
 }
 void glPolygonMode(GLenum face, GLenum mode) AliasExport("gl4es_glPolygonMode");
 
+void gl4es_glPolygonOffset(GLfloat factor, GLfloat units) {
+    PUSH_IF_COMPILING(glPolygonOffset);
+    gleshard_glPolygonOffset(factor, units);
+    noerrorShim();
+}
+void glPolygonOffset(GLfloat factor, GLfloat units) AliasExport("gl4es_glPolygonOffset");
+
 
 void gl4es_flush() {
     if(glstate->list.compiling)
@@ -1124,8 +1178,7 @@ void gl4es_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean
     glstate->colormask[1]=green;
     glstate->colormask[2]=blue;
     glstate->colormask[3]=alpha;
-    LOAD_GLES(glColorMask);
-    gles_glColorMask(red, green, blue, alpha);
+    gleshard_glColorMask(red, green, blue, alpha);
 }
 void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) AliasExport("gl4es_glColorMask");
 
@@ -1201,6 +1254,56 @@ void gl4es_use_scratch_indices(int use) {
     bindBuffer(GL_ELEMENT_ARRAY_BUFFER, use?glstate->scratch_indices:0);
 }
 
+// Stream VBO: data is appended after the previous batch, and the buffer is orphaned when full,
+// so the driver never has to wait for a draw still in flight before overwriting
+static GLintptr stream_reserve(GLenum target, GLuint *buffer, GLintptr *offset, GLsizeiptr cap, GLsizeiptr size) {
+    LOAD_GLES(glBufferData);
+    LOAD_GLES(glGenBuffers);
+    if(size>cap)
+        return -1;
+    size = (size+15)&~15;   // keep everything 16 bytes aligned
+    if(!*buffer) {
+        gles_glGenBuffers(1, buffer);
+        bindBuffer(target, *buffer);
+        gles_glBufferData(target, cap, NULL, GL_STREAM_DRAW);
+        *offset = 0;
+    } else if(*offset+size>cap) {
+#ifdef AMIGAOS4
+        LOAD_GLES(glDeleteBuffers);
+        GLuint old_buffer = *buffer;
+        gles_glGenBuffers(1, buffer);
+        gles_glDeleteBuffers(1, &old_buffer);
+#endif
+        bindBuffer(target, *buffer);
+        gles_glBufferData(target, cap, NULL, GL_STREAM_DRAW);   // orphan
+        *offset = 0;
+    } else
+        bindBuffer(target, *buffer);
+    GLintptr ret = *offset;
+    *offset += size;
+    return ret;
+}
+
+GLintptr gl4es_stream_vertex(GLsizeiptr size) {
+    return stream_reserve(GL_ARRAY_BUFFER, &glstate->stream_vertex, &glstate->stream_vertex_offset, STREAM_VERTEX_SIZE, size);
+}
+
+GLintptr gl4es_stream_indices(GLsizeiptr size, const GLvoid* data) {
+    LOAD_GLES(glBufferSubData);
+    GLintptr ret = stream_reserve(GL_ELEMENT_ARRAY_BUFFER, &glstate->stream_indices, &glstate->stream_indices_offset, STREAM_INDICES_SIZE, size);
+    if(ret>=0)
+        gles_glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, ret, size, data);
+    return ret;
+}
+
+GLintptr gl4es_stream_unpack(GLsizeiptr size, const GLvoid* data) {
+    LOAD_GLES(glBufferSubData);
+    GLintptr ret = stream_reserve(GL_PIXEL_UNPACK_BUFFER, &glstate->stream_unpack, &glstate->stream_unpack_offset, STREAM_UNPACK_SIZE, size);
+    if(ret>=0)
+        gles_glBufferSubData(GL_PIXEL_UNPACK_BUFFER, ret, size, data);
+    return ret;
+}
+
 #if defined(AMIGAOS4) || (defined(NOX11) && defined(NOEGL))
 #ifdef AMIGAOS4
 void amiga_pre_swap()
@@ -1210,6 +1313,7 @@ EXPORT void gl4es_pre_swap()
 {
     if (glstate->list.active) gl4es_flush();
     if (glstate->raster.bm_drawing) bitmap_flush();
+    fpe_PrewarmPSA(PSA_PREWARM);
 
     if (globals4es.usefbo) {
         unbindMainFBO();
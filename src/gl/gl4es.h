@@ -125,6 +125,9 @@ void gl4es_scratch_vertex(int alloc);
 void gl4es_scratch_indices(int alloc);
 void gl4es_use_scratch_vertex(int use);
 void gl4es_use_scratch_indices(int use);
+GLintptr gl4es_stream_vertex(GLsizeiptr size);
+GLintptr gl4es_stream_indices(GLsizeiptr size, const GLvoid* data);
+GLintptr gl4es_stream_unpack(GLsizeiptr size, const GLvoid* data);
 
 void ToBuffer(int first, int count);
 void UnBuffer();
@@ -12,6 +12,12 @@
 #include "oldprogram.h"
 #include "samplers.h"
 
+#include <string.h>
+#if !defined(__EMSCRIPTEN__) && !defined(AMIGAOS4)
+#include <pthread.h>
+#define LOOKUP_THREADS
+#endif
+
 #include "../glx/hardext.h"
 
 //#define DEBUG
@@ -28,9 +34,31 @@ void gl4es_Stub(void *x, ...) {
     return;
 }
 
-__attribute__((visibility("default")))
-void *gl4es_GetProcAddress(const char *name) {
-    DBG(printf("glGetProcAddress(\"%s\")", name);)
+KHASH_MAP_IMPL_STR(procaddr, procaddr_t);
+
+void lookup_add(khash_t(procaddr) *procs, const char *name, void *func, int stub) {
+    int ret;
+    khint_t k = kh_put(procaddr, procs, name, &ret);
+    if(!ret)
+        return; // first one declared wins, like with the old strcmp chain
+    kh_value(procs, k).func = func;
+    kh_value(procs, k).stub = stub;
+}
+
+void *lookup_find(khash_t(procaddr) *procs, const char *name) {
+    khint_t k = kh_get(procaddr, procs, name);
+    if(k == kh_end(procs))
+        return NULL;
+    procaddr_t *proc = &kh_value(procs, k);
+    DBG(printf("%p\n", proc->func);)
+    if(proc->stub) {
+        DBG(printf("=> STUB\n");)
+        if(!globals4es.silentstub) LOGD("GL4ES stub: %s\n", name);
+    }
+    return proc->func;
+}
+
+static void fill_procaddr(khash_t(procaddr) *procs) {
     // generated gles wrappers
     #include "glesfuncs.inc"
 
@@ -1043,6 +1071,55 @@ void *gl4es_GetProcAddress(const char *name) {
     _EX(glGetSamplerParameteriv);
     _EX(glGetSamplerParameterIiv);
     _EX(glGetSamplerParameterIuiv);
+}
+
+// what fill_procaddr depends on
+typedef struct {
+    int esversion, fbo, blendcolor, blendeq, blendfunc;
+    int env_blendcolor, env_queries;
+} procaddr_key_t;
+
+// one lock for all the GetProcAddress tables (gl, glX and agl), they are built lazily
+#ifdef LOOKUP_THREADS
+static pthread_mutex_t procs_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define procs_lock()    pthread_mutex_lock(&procs_mutex)
+#define procs_unlock()  pthread_mutex_unlock(&procs_mutex)
+#else
+#define procs_lock()
+#define procs_unlock()
+#endif
+
+void *lookup_find_once(khash_t(procaddr) **procs, void (*fill)(khash_t(procaddr) *), const char *name) {
+    procs_lock();
+    if(!*procs) {
+        *procs = kh_init(procaddr);
+        fill(*procs);
+    }
+    void *func = lookup_find(*procs, name);
+    procs_unlock();
+    return func;
+}
+
+__attribute__((visibility("default")))
+void *gl4es_GetProcAddress(const char *name) {
+    DBG(printf("glGetProcAddress(\"%s\")", name);)
+    static khash_t(procaddr) *procs = NULL;
+    static procaddr_key_t procs_key;
+    procaddr_key_t key = {hardext.esversion, hardext.fbo, hardext.blendcolor, hardext.blendeq, hardext.blendfunc,
+                          globals4es.blendcolor, globals4es.queries};
+    procs_lock();
+    // the table depends on the hardware extensions, so build it again if they changed (or were not known yet the first time)
+    if(!procs || memcmp(&key, &procs_key, sizeof(key))) {
+        if(procs)
+            kh_destroy(procaddr, procs);
+        procs = kh_init(procaddr);
+        fill_procaddr(procs);
+        procs_key = key;
+    }
+    void *func = lookup_find(procs, name);
+    procs_unlock();
+    if(func)
+        return func;
 
     DBG(printf("NULL\n");)
     if (!globals4es.silentstub) LOGD("GL4ES GetProcAddress: %s not found.\n", name);
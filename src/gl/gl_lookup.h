@@ -1,13 +1,24 @@
 #ifndef _GL_LOOKUP_H_
 #define _GL_LOOKUP_H_
 
-#ifdef DEBUG
-#define MAP(func_name, func) \
-    if (strcmp(name, func_name) == 0) {printf("%p (%s)\n", (void*)func, #func) ;return (void *)func;}
-#else
+#include "khash.h"
+
+// GetProcAddress lookup: the MAP/STUB lists below don't compare the name anymore,
+// they fill a hash table (of name => function) once, that is then queried for each lookup
+typedef struct {
+    void    *func;
+    int     stub;
+} procaddr_t;
+
+KHASH_MAP_DECLARE_STR(procaddr, procaddr_t);
+
+void lookup_add(khash_t(procaddr) *procs, const char *name, void *func, int stub);
+void *lookup_find(khash_t(procaddr) *procs, const char *name);
+// same, but *procs is filled by fill() the first time, under the lookup lock
+void *lookup_find_once(khash_t(procaddr) **procs, void (*fill)(khash_t(procaddr) *), const char *name);
+
 #define MAP(func_name, func) \
-    if (strcmp(name, func_name) == 0) return (void *)func;
-#endif
+    lookup_add(procs, func_name, (void *)func, 0);
 
 #define EX(func_name) MAP(#func_name, func_name)
 
@@ -25,21 +36,9 @@
 #error STUB_FCT is not defined
 #endif
 
-#ifdef DEBUG
-#define STUB(func_name)                       \
-    if (strcmp(name, #func_name) == 0) {      \
-        printf("=> STUB\n");                  \
-        if(!globals4es.silentstub) LOGD("GL4ES stub: %s\n", #func_name); \
-        return (void *)STUB_FCT;              \
-    }
-#else
-#define STUB(func_name)                       \
-    if (strcmp(name, #func_name) == 0) {      \
-        if(!globals4es.silentstub) LOGD("GL4ES stub: %s\n", #func_name); \
-        return (void *)STUB_FCT;              \
-    }
-#endif
+#define STUB(func_name) \
+    lookup_add(procs, #func_name, (void *)STUB_FCT, 1);
 
 void *gl4es_GetProcAddress(const char *name);
 
-#endif //_GL_LOOKUP_H_
\ No newline at end of file
+#endif //_GL_LOOKUP_H_
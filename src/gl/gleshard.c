@@ -0,0 +1,244 @@
+#include "gleshard.h"
+
+#include "gl4es.h"
+#include "glstate.h"
+#include "init.h"
+#include "loader.h"
+#include "logs.h"
+
+/*
+ * Shadow of the states as last sent to the GLES driver.
+ * A call that doesn't change anything is dropped, as some drivers do a full validation on each state change.
+ * This is below the gl4es_ entry points (that filter the application state) so internal changes (blit, stipple...)
+ * and values that map to the same driver state are also handled.
+ */
+
+static unsigned int hard_sent[HARD_LAST];
+static unsigned int hard_dropped[HARD_LAST];
+static const char* hard_names[HARD_LAST] = {
+    "glActiveTexture",
+    "glBlendEquation",
+    "glBlendFunc",
+    "glColorMask",
+    "glCullFace",
+    "glDepthFunc",
+    "glDepthMask",
+    "glFrontFace",
+    "glPolygonOffset",
+    "glScissor",
+    "glStencilFunc",
+    "glStencilMask",
+    "glStencilOp",
+    "glViewport"
+};
+
+void gleshard_init(gleshard_t *hard) {
+    // GLES defaults, viewport and scissor depend on the surface
+    hard->valid = ((1<<HARD_LAST)-1) & ~((1<<HARD_VIEWPORT)|(1<<HARD_SCISSOR));
+    hard->active = 0;
+    hard->blendfunc[0] = hard->blendfunc[2] = GL_ONE;
+    hard->blendfunc[1] = hard->blendfunc[3] = GL_ZERO;
+    hard->blendequation[0] = hard->blendequation[1] = GL_FUNC_ADD_OES;
+    for (int i=0; i<4; i++)
+        hard->colormask[i] = GL_TRUE;
+    hard->cullface = GL_BACK;
+    hard->depthfunc = GL_LESS;
+    hard->depthmask = GL_TRUE;
+    hard->frontface = GL_CCW;
+    hard->polygonoffset[0] = hard->polygonoffset[1] = 0.0f;
+    for (int i=0; i<2; i++) {
+        hard->stencilfunc[i][0] = GL_ALWAYS;
+        hard->stencilfunc[i][1] = 0;
+        hard->stencilfunc[i][2] = ~0;
+        hard->stencilmask[i] = ~0;
+        hard->stencilop[i][0] = hard->stencilop[i][1] = hard->stencilop[i][2] = GL_KEEP;
+    }
+}
+
+void gleshard_printstats() {
+    if (!globals4es.statestats)
+        return;
+    for (int i=0; i<HARD_LAST; i++)
+        if (hard_sent[i] || hard_dropped[i])
+            SHUT_LOGD("%s: %u sent, %u dropped\n", hard_names[i], hard_sent[i], hard_dropped[i]);
+}
+
+// return 1 if the driver already has value, else update the shadow
+static int hard_same(gleshard_entry_t entry, void *shadow, const void *value, size_t size) {
+    gleshard_t *hard = glstate->gleshard;
+    if ((hard->valid & (1<<entry)) && !memcmp(shadow, value, size)) {
+        ++hard_dropped[entry];
+        return 1;
+    }
+    memcpy(shadow, value, size);
+    hard->valid |= (1<<entry);
+    ++hard_sent[entry];
+    return 0;
+}
+
+// same for states with a front and a back value
+static int hard_samefaces(gleshard_entry_t entry, GLenum face, void *shadow, const void *value, size_t size) {
+    char *front = (char*)shadow;
+    char *back = front + size;
+    int same = 1;
+    if (face!=GL_BACK && memcmp(front, value, size))
+        same = 0;
+    if (face!=GL_FRONT && memcmp(back, value, size))
+        same = 0;
+    if (same) {
+        ++hard_dropped[entry];
+        return 1;
+    }
+    if (face!=GL_BACK)
+        memcpy(front, value, size);
+    if (face!=GL_FRONT)
+        memcpy(back, value, size);
+    ++hard_sent[entry];
+    return 0;
+}
+
+void gleshard_glActiveTexture(GLenum texture) {
+    GLuint active = texture - GL_TEXTURE0;
+    if (hard_same(HARD_ACTIVETEXTURE, &glstate->gleshard->active, &active, sizeof(active)))
+        return;
+    LOAD_GLES(glActiveTexture);
+    gles_glActiveTexture(texture);
+}
+
+void gleshard_glBlendEquation(GLenum mode) {
+    GLenum v[2] = {mode, mode};
+    if (hard_same(HARD_BLENDEQUATION, glstate->gleshard->blendequation, v, sizeof(v)))
+        return;
+    LOAD_GLES2_OR_OES(glBlendEquation);
+    gles_glBlendEquation(mode);
+}
+
+void gleshard_glBlendEquationSeparate(GLenum modeRGB, GLenum modeA) {
+    GLenum v[2] = {modeRGB, modeA};
+    if (hard_same(HARD_BLENDEQUATION, glstate->gleshard->blendequation, v, sizeof(v)))
+        return;
+    LOAD_GLES2_OR_OES(glBlendEquationSeparate);
+    gles_glBlendEquationSeparate(modeRGB, modeA);
+}
+
+void gleshard_glBlendFunc(GLenum sfactor, GLenum dfactor) {
+    GLenum v[4] = {sfactor, dfactor, sfactor, dfactor};
+    if (hard_same(HARD_BLENDFUNC, glstate->gleshard->blendfunc, v, sizeof(v)))
+        return;
+    LOAD_GLES(glBlendFunc);
+    gles_glBlendFunc(sfactor, dfactor);
+}
+
+void gleshard_glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha) {
+    GLenum v[4] = {sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha};
+    if (hard_same(HARD_BLENDFUNC, glstate->gleshard->blendfunc, v, sizeof(v)))
+        return;
+    LOAD_GLES2_OR_OES(glBlendFuncSeparate);
+    gles_glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+}
+
+void gleshard_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    GLboolean v[4] = {red, green, blue, alpha};
+    if (hard_same(HARD_COLORMASK, glstate->gleshard->colormask, v, sizeof(v)))
+        return;
+    LOAD_GLES(glColorMask);
+    gles_glColorMask(red, green, blue, alpha);
+}
+
+void gleshard_glCullFace(GLenum mode) {
+    if (hard_same(HARD_CULLFACE, &glstate->gleshard->cullface, &mode, sizeof(mode)))
+        return;
+    LOAD_GLES(glCullFace);
+    gles_glCullFace(mode);
+}
+
+void gleshard_glDepthFunc(GLenum func) {
+    if (hard_same(HARD_DEPTHFUNC, &glstate->gleshard->depthfunc, &func, sizeof(func)))
+        return;
+    LOAD_GLES(glDepthFunc);
+    gles_glDepthFunc(func);
+}
+
+void gleshard_glDepthMask(GLboolean flag) {
+    if (hard_same(HARD_DEPTHMASK, &glstate->gleshard->depthmask, &flag, sizeof(flag)))
+        return;
+    LOAD_GLES(glDepthMask);
+    gles_glDepthMask(flag);
+}
+
+void gleshard_glFrontFace(GLenum mode) {
+    if (hard_same(HARD_FRONTFACE, &glstate->gleshard->frontface, &mode, sizeof(mode)))
+        return;
+    LOAD_GLES(glFrontFace);
+    gles_glFrontFace(mode);
+}
+
+void gleshard_glPolygonOffset(GLfloat factor, GLfloat units) {
+    GLfloat v[2] = {factor, units};
+    if (hard_same(HARD_POLYGONOFFSET, glstate->gleshard->polygonoffset, v, sizeof(v)))
+        return;
+    LOAD_GLES(glPolygonOffset);
+    gles_glPolygonOffset(factor, units);
+}
+
+void gleshard_glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    GLint v[4] = {x, y, width, height};
+    if (hard_same(HARD_SCISSOR, glstate->gleshard->scissor, v, sizeof(v)))
+        return;
+    LOAD_GLES(glScissor);
+    gles_glScissor(x, y, width, height);
+}
+
+void gleshard_glStencilFunc(GLenum func, GLint ref, GLuint mask) {
+    GLint v[3] = {func, ref, mask};
+    if (hard_samefaces(HARD_STENCILFUNC, GL_FRONT_AND_BACK, glstate->gleshard->stencilfunc, v, sizeof(v)))
+        return;
+    LOAD_GLES(glStencilFunc);
+    gles_glStencilFunc(func, ref, mask);
+}
+
+void gleshard_glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask) {
+    GLint v[3] = {func, ref, mask};
+    if (hard_samefaces(HARD_STENCILFUNC, face, glstate->gleshard->stencilfunc, v, sizeof(v)))
+        return;
+    LOAD_GLES2_OR_OES(glStencilFuncSeparate);
+    gles_glStencilFuncSeparate(face, func, ref, mask);
+}
+
+void gleshard_glStencilMask(GLuint mask) {
+    if (hard_samefaces(HARD_STENCILMASK, GL_FRONT_AND_BACK, glstate->gleshard->stencilmask, &mask, sizeof(mask)))
+        return;
+    LOAD_GLES(glStencilMask);
+    gles_glStencilMask(mask);
+}
+
+void gleshard_glStencilMaskSeparate(GLenum face, GLuint mask) {
+    if (hard_samefaces(HARD_STENCILMASK, face, glstate->gleshard->stencilmask, &mask, sizeof(mask)))
+        return;
+    LOAD_GLES2_OR_OES(glStencilMaskSeparate);
+    gles_glStencilMaskSeparate(face, mask);
+}
+
+void gleshard_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
+    GLenum v[3] = {fail, zfail, zpass};
+    if (hard_samefaces(HARD_STENCILOP, GL_FRONT_AND_BACK, glstate->gleshard->stencilop, v, sizeof(v)))
+        return;
+    LOAD_GLES(glStencilOp);
+    gles_glStencilOp(fail, zfail, zpass);
+}
+
+void gleshard_glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum zpass) {
+    GLenum v[3] = {fail, zfail, zpass};
+    if (hard_samefaces(HARD_STENCILOP, face, glstate->gleshard->stencilop, v, sizeof(v)))
+        return;
+    LOAD_GLES2_OR_OES(glStencilOpSeparate);
+    gles_glStencilOpSeparate(face, fail, zfail, zpass);
+}
+
+void gleshard_glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    GLint v[4] = {x, y, width, height};
+    if (hard_same(HARD_VIEWPORT, glstate->gleshard->viewport, v, sizeof(v)))
+        return;
+    LOAD_GLES(glViewport);
+    gles_glViewport(x, y, width, height);
+}
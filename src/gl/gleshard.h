@@ -0,0 +1,50 @@
+#ifndef _GL4ES_GLESHARD_H_
+#define _GL4ES_GLESHARD_H_
+
+#include "gles.h"
+
+typedef enum {
+    HARD_ACTIVETEXTURE = 0,
+    HARD_BLENDEQUATION,
+    HARD_BLENDFUNC,
+    HARD_COLORMASK,
+    HARD_CULLFACE,
+    HARD_DEPTHFUNC,
+    HARD_DEPTHMASK,
+    HARD_FRONTFACE,
+    HARD_POLYGONOFFSET,
+    HARD_SCISSOR,
+    HARD_STENCILFUNC,
+    HARD_STENCILMASK,
+    HARD_STENCILOP,
+    HARD_VIEWPORT,
+    HARD_LAST
+} gleshard_entry_t;
+
+typedef struct gleshard_s gleshard_t;
+
+void gleshard_init(gleshard_t *hard);
+void gleshard_printstats();
+
+// same as the gles_ functions, but dropped if the driver already has that state
+void gleshard_glActiveTexture(GLenum texture);
+void gleshard_glBlendEquation(GLenum mode);
+void gleshard_glBlendEquationSeparate(GLenum modeRGB, GLenum modeA);
+void gleshard_glBlendFunc(GLenum sfactor, GLenum dfactor);
+void gleshard_glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha);
+void gleshard_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+void gleshard_glCullFace(GLenum mode);
+void gleshard_glDepthFunc(GLenum func);
+void gleshard_glDepthMask(GLboolean flag);
+void gleshard_glFrontFace(GLenum mode);
+void gleshard_glPolygonOffset(GLfloat factor, GLfloat units);
+void gleshard_glScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void gleshard_glStencilFunc(GLenum func, GLint ref, GLuint mask);
+void gleshard_glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask);
+void gleshard_glStencilMask(GLuint mask);
+void gleshard_glStencilMaskSeparate(GLenum face, GLuint mask);
+void gleshard_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+void gleshard_glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum zpass);
+void gleshard_glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+#endif // _GL4ES_GLESHARD_H_
@@ -3,6 +3,7 @@
 #include "../glx/hardext.h"
 #include "fpe.h"
 #include "framebuffers.h"
+#include "gleshard.h"
 #include "gl4es.h"
 #include "glstate.h"
 #include "init.h"
@@ -13,6 +14,8 @@ glstate_t *glstate = NULL;
 
 glstate_t default_glstate = {0};
 
+GLuint builtin_serial = 0;
+
 #define DEFAULT_STATE (void*)(~(uintptr_t)0)
 
 void init_matrix(glstate_t* glstate);
@@ -48,6 +51,7 @@ static void free_texture(gltexture_t *tex)
         return;
     if(tex->glname)
         gles_glDeleteTextures(1, &tex->glname);
+    free(tex->res_copy);    // the totals go with the list
     if(tex->data)
         free(tex->data);
     // renderbuffer linked to this texture will be freed by the free_renderbuffer function.
@@ -79,8 +83,10 @@ void* NewGLState(void* shared_glstate, int es2only) {
             (*copy_state->shared_cnt)++;
         glstate->shared_cnt = copy_state->shared_cnt;
         glstate->headlists = copy_state->headlists;
+        glstate->calllists = copy_state->calllists;
         glstate->actual_tex2d = copy_state->actual_tex2d;
         glstate->texture.list = copy_state->texture.list;
+        glstate->texres = copy_state->texres;
         glstate->glsl = copy_state->glsl;
         //glstate->gleshard = copy_state->gleshard; // Not shared (at least not the VA)
         glstate->buffers = copy_state->buffers;
@@ -152,6 +158,7 @@ void* NewGLState(void* shared_glstate, int es2only) {
         khash_t(gllisthead) *list = glstate->headlists = kh_init(gllisthead);
 		k = kh_put(gllisthead, list, 1, &ret);
 		kh_del(gllisthead, list, k);
+        glstate->calllists = calllists_newcache();
     }
     // actual_tex2d
     if(!shared_glstate)
@@ -160,6 +167,7 @@ void* NewGLState(void* shared_glstate, int es2only) {
     }
     // glsl
     glstate->gleshard = (gleshard_t*)calloc(1, sizeof(gleshard_t)); // Not shared!
+    gleshard_init(glstate->gleshard);
     if(!shared_glstate)
     {
         glstate->glsl = (glsl_t*)malloc(sizeof(glsl_t));
@@ -222,6 +230,7 @@ void* NewGLState(void* shared_glstate, int es2only) {
             khint_t k;
             khash_t(tex) *list = glstate->texture.list;
             list = glstate->texture.list = kh_init(tex);
+            glstate->texres = (texres_t*)calloc(1, sizeof(texres_t));
             // segfaults if we don't do a single put
             k = kh_put(tex, list, 1, &ret);
             kh_del(tex, list, k);
@@ -345,6 +354,9 @@ void* NewGLState(void* shared_glstate, int es2only) {
         glstate->texgen[i].T_E[1] = 1.0;
         glstate->texgen[i].T_O[1] = 1.0;
     }
+    // new state, so all builtin uniforms need an upload
+    for (int i=0; i<BUILTIN_MAX; i++)
+        BUILTIN_CHANGED(i);
 
     // fpe
     if(hardext.esversion>1) {
@@ -485,6 +497,8 @@ void DeleteGLState(void* oldstate) {
     if(!state->shared_cnt) {
         free_hashmap(glbuffer_t, buffers, buff, free);
         free_hashmap(gltexture_t, texture.list, tex, free_texture);
+        free(state->texres);
+        calllists_freecache(state->calllists);   // uses the arrays of the lists
         free_hashmap(renderlist_t, headlists, gllisthead, free_renderlist);
         free_hashmap(glrenderbuffer_t, fbo.renderbufferlist, renderbufferlist_t, free_renderbuffer);
         free_hashmap(glframebuffer_t, fbo.framebufferlist, framebufferlist_t, free_framebuffer);
@@ -540,6 +554,23 @@ void DeleteGLState(void* oldstate) {
     // scratch buffer
     if(state->scratch)
         free(state->scratch);
+    // stream ring buffers
+    {
+        LOAD_GLES(glDeleteBuffers);
+        if(gles_glDeleteBuffers) {
+            if(state->stream_vertex)
+                gles_glDeleteBuffers(1, &state->stream_vertex);
+            if(state->stream_indices)
+                gles_glDeleteBuffers(1, &state->stream_indices);
+        }
+    }
+    // texture upload staging
+    texupload_free(&state->texupload);
+    if(state->stream_unpack) {
+        LOAD_GLES(glDeleteBuffers);
+        if(gles_glDeleteBuffers)
+            gles_glDeleteBuffers(1, &state->stream_unpack);
+    }
     // merger buffers
     if(state->merger_master)
         free(state->merger_master);
@@ -612,6 +643,7 @@ void ActivateGLState(void* new_glstate) {
         gles_glGetIntegerv(GL_SCISSOR_BOX, (GLint*)&newstate->raster.scissor);
     }
     glstate = newstate;
+    ++builtin_serial;   // programs have to check the stamps of the new state
 }
 
 void gl_init() {
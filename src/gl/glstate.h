@@ -8,6 +8,8 @@
 #include "queries.h"
 #include "stack.h"
 #include "stencil.h"
+#include "texres.h"
+#include "texupload.h"
 
 typedef struct glstate_s {
     int                 dummy[16];  // dummy zone, test for memory overwriting...
@@ -16,9 +18,11 @@ typedef struct glstate_s {
     map_grid_t          map_grid[2];
     map_states_t        map1, map2;
     khash_t(gllisthead) *headlists;         // shared
+    calllists_cache_t   *calllists;         // shared
     texgen_state_t      texgen[MAX_TEX];
     texenv_state_t      texenv[MAX_TEX];
     texture_state_t     texture;
+    texres_t            *texres;            // shared
     GLboolean           colormask[4];
     int	                render_mode;
     int                 polygon_mode;
@@ -80,9 +84,12 @@ typedef struct glstate_s {
     GLenum              logicop;
     glsl_t              *glsl;              //shared
     fpe_state_t         *fpe_state;
+    GLuint              builtin_stamp[BUILTIN_MAX]; // last change of each builtin uniform group
     fpe_fpe_t           *fpe;
+    fpe_state_t         fpe_last;           // raw fpe_state that gave fpe
     fpestatus_t         fpe_client;
     fpe_cache_t         *fpe_cache;
+    int                 fpe_prewarm;        // position of the PSA prewarm
     gleshard_t          *gleshard;          //shared
     glesblit_t          *blit;
     fbo_t               fbo;
@@ -102,13 +109,23 @@ typedef struct glstate_s {
     GLfloat*            merger_secondary;
     GLfloat*            merger_tex[MAX_TEX-2];
     int                 merger_indice_cap;
-    GLushort*           merger_indices;
+    GLuint*             merger_indices;
     int                 merger_used;
     // scratch VBO
     GLuint              scratch_vertex;
     GLsizei             scratch_vertex_size;
     GLuint              scratch_indices;
     GLsizei             scratch_indices_size;
+    // stream (ring) VBO for immediate mode
+    GLuint              stream_vertex;
+    GLintptr            stream_vertex_offset;
+    GLuint              stream_indices;
+    GLintptr            stream_indices_offset;
+    // stream (ring) PBO for the texture uploads
+    GLuint              stream_unpack;
+    GLintptr            stream_unpack_offset;
+    // texture upload staging
+    texupload_t         texupload;
     // Implementation read
     GLenum              readf; // implementation Read Format
     GLenum              readt; // implementation Read Type
@@ -129,5 +146,9 @@ typedef struct glstate_s {
     bind_buffers_t      bind_buffer;
 } glstate_t;
 
+// serial of the last builtin uniform change (in any glstate)
+extern GLuint builtin_serial;
+#define BUILTIN_CHANGED(G) glstate->builtin_stamp[G] = ++builtin_serial
+
 
 #endif // _GL4ES_GLSTATE_H_
@@ -5,6 +5,7 @@
 #include "loader.h"
 #include "gl4es.h"
 #include "glstate.h"
+#include "texres.h"
 
 #ifdef PANDORA
 void pandora_set_gamma();
@@ -127,6 +128,28 @@ void gl4es_glHint(GLenum pname, GLenum mode) {
             pandora_set_gamma();
 #endif
             break;
+        case GL_STREAMVBO_HINT_GL4ES:
+            if (mode<=1)
+                globals4es.streamvbo = (globals4es.usevbo)?mode:0;
+            else
+                errorShim(GL_INVALID_ENUM); 
+            break;
+        case GL_VCACHE_HINT_GL4ES:
+            if (mode<=256)
+                globals4es.vcache = (mode==1)?VCACHE_DEFAULT_SIZE:mode;
+            else
+                errorShim(GL_INVALID_ENUM); 
+            break;
+        case GL_TEXBUDGET_HINT_GL4ES:
+            globals4es.texbudget = mode;
+            texres_enforce();
+            break;
+        case GL_TEXBUDGET_GPU_GL4ES:
+        case GL_TEXBUDGET_SHADOW_GL4ES:
+        case GL_TEXBUDGET_EVICTED_GL4ES:
+        case GL_TEXBUDGET_RELOADED_GL4ES:
+            errorShim(GL_INVALID_ENUM);
+            break;
         default:
             errorGL();
             gles_glHint(pname, mode);
@@ -7,9 +7,13 @@
 #include "debug.h"
 #include "loader.h"
 #include "logs.h"
+#include "fpe_prewarm.h"
 #include "fpe_cache.h"
+#include "pixel_pool.h"
+#include "gleshard.h"
 #include "init.h"
 #include "envvars.h"
+#include "shader_cache.h"
 #if defined(__EMSCRIPTEN__) || defined(__APPLE__)
 #define NO_INIT_CONSTRUCTOR
 #endif
@@ -52,6 +56,25 @@ void glx_init();
 
 static int inited = 0;
 
+// path (1024 chars) of a gl4es file in the user folder, 0 if there is no such folder
+static int user_file(char* path, const char* name) {
+    path[0]='\0';
+    // TODO: What to do on ANDROID and EMSCRIPTEN?
+#ifdef __linux__
+    const char* home = GetEnvVar("HOME");
+    if(home && strlen(home)<1024-64)
+        strcpy(path, home);
+    if(strlen(path) && path[strlen(path)-1]!='/')
+        strcat(path, "/");
+#elif defined AMIGAOS4
+    strcpy(path, "PROGDIR:");
+#endif
+    if(!strlen(path))
+        return 0;
+    strcat(path, name);
+    return 1;
+}
+
 __attribute__((visibility("default")))
 void set_getmainfbsize(void (*new_getMainFBSize)(int* w, int* h)) {
     gl4es_getMainFBSize = (void*)new_getMainFBSize;
@@ -267,12 +290,39 @@ void initialize_gl4es() {
         globals4es.automipmap = 0;
         break;
     }
+    env(LIBGL_MIPMAPSRGB, globals4es.mipmapsrgb, "Mipmaps of sRGB textures are averaged in linear space");
 
     if(IsEnvVarTrue("LIBGL_TEXCOPY")) {
       globals4es.texcopydata = 1;
 		  SHUT_LOGD("Texture copy enabled\n");
     }
 
+    globals4es.texthreads=ReturnEnvVarIntDef("LIBGL_TEXTHREADS",-1);
+    if(globals4es.texthreads<-1)
+        globals4es.texthreads = -1;
+    if(globals4es.texthreads>TEXTHREADS_MAX)
+        globals4es.texthreads = TEXTHREADS_MAX;
+    if(globals4es.texthreads==0) {
+        SHUT_LOGD("Big textures are converted on the calling thread only\n");
+    } else if(globals4es.texthreads>0) {
+        SHUT_LOGD("Big textures are converted with %d worker thread(s)\n", globals4es.texthreads);
+    }
+
+    globals4es.texstaging=ReturnEnvVarIntDef("LIBGL_TEXSTAGING",0);
+    if(globals4es.texstaging<0 || globals4es.texstaging>2)
+        globals4es.texstaging = 0;
+    if(globals4es.texstaging==1) {
+        SHUT_LOGD("Texture uploads staged, thru a Pixel Unpack Buffer on GLES 3 hardware\n");
+    } else if(globals4es.texstaging==2) {
+        SHUT_LOGD("Texture uploads staged in memory only, no Pixel Unpack Buffer\n");
+    }
+
+    globals4es.texbudget=ReturnEnvVarIntDef("LIBGL_TEXBUDGET",0);
+    if(globals4es.texbudget<0)
+        globals4es.texbudget = 0;
+    if(globals4es.texbudget)
+        SHUT_LOGD("Textures budget of %d MB, least recently used ones evicted above that\n", globals4es.texbudget);
+
     globals4es.texshrink=ReturnEnvVarInt("LIBGL_SHRINK");
     switch(globals4es.texshrink) {
       case 10:
@@ -403,6 +453,8 @@ void initialize_gl4es() {
     }
     env(LIBGL_NOTEXMAT, globals4es.texmat, "Don't handle Texture Matrice internaly");
     env(LIBGL_NOVAOCACHE, globals4es.novaocache, "Don't use VAO cache");
+    env(LIBGL_NOLISTOPT, globals4es.nolistopt, "Don't optimize display lists at glEndList");
+    env(LIBGL_STATESTATS, globals4es.statestats, "Print the number of GLES state calls sent and dropped at exit");
     if(IsEnvVarTrue("LIBGL_NOINTOVLHACK")) {
         globals4es.nointovlhack = 1;
         SHUT_LOGD("No hack in shader converter to define overloaded function with int\n");
@@ -517,6 +569,21 @@ void initialize_gl4es() {
 	      	break;
 	    }
 	  }
+    globals4es.streamvbo = (globals4es.usevbo)?ReturnEnvVarIntDef("LIBGL_STREAMVBO",1):0;
+    if(globals4es.usevbo) {
+        if(globals4es.streamvbo) {
+            SHUT_LOGD("Stream glBegin/glEnd batches in a ring VBO\n");
+        } else {
+            SHUT_LOGD("Don't stream glBegin/glEnd batches in a ring VBO\n");
+        }
+    }
+    globals4es.vcache = ReturnEnvVarIntDef("LIBGL_VCACHE",0);
+    if(globals4es.vcache==1)
+        globals4es.vcache = VCACHE_DEFAULT_SIZE;
+    if(globals4es.vcache<0 || globals4es.vcache>256)
+        globals4es.vcache = 0;
+    if(globals4es.vcache)
+        SHUT_LOGD("Sort display lists triangles for a vertex cache of %d\n", globals4es.vcache);
 
     globals4es.fbomakecurrent = 0;
     if((hardext.vendor & VEND_ARM) || (globals4es.usefb))
@@ -645,25 +712,17 @@ void initialize_gl4es() {
 
     if(hardext.prgbin_n>0 && !globals4es.notexarray) {
         env(LIBGL_NOPSA, globals4es.nopsa, "Don't use PrecompiledShaderArchive");
-        if(globals4es.nopsa==0) {
-            cwd[0]='\0';
-            // TODO: What to do on ANDROID and EMSCRIPTEN?
-#ifdef __linux__
-            const char* home = GetEnvVar("HOME");
-            if(home)
-                strcpy(cwd, home);
-            if(cwd[strlen(cwd)]!='/')
-                strcat(cwd, "/");
-#elif defined AMIGAOS4
-            strcpy(cwd, "PROGDIR:");
-#endif
-            if(strlen(cwd)) {
-                strcat(cwd, ".gl4es.psa");
-                fpe_InitPSA(cwd);
-                fpe_readPSA();
-            }
+        if(globals4es.nopsa==0 && user_file(cwd, ".gl4es.psa")) {
+            fpe_InitPSA(cwd);
+            fpe_readPSA();
+            env(LIBGL_PSAPREWARM, globals4es.psaprewarm, "PSA programs are loaded a few at a time on SwapBuffers");
         }
     }
+    if(hardext.esversion>1) {
+        env(LIBGL_NOSHADERCACHE, globals4es.noshadercache, "Don't use the Shader Cache");
+        if(globals4es.noshadercache==0 && user_file(cwd, ".gl4es.shaders"))
+            shadercache_Init(cwd);
+    }
 }
 
 
@@ -684,9 +743,12 @@ void close_gl4es() {
     #ifndef NOX11
     FreeFBVisual();
     #endif
+    gleshard_printstats();
     gl_close();
+    pixel_pool_stop();
     fpe_writePSA();
     fpe_FreePSA();
+    shadercache_Free();
 		#if defined(GL4ES_COMPILE_FOR_USE_IN_SHARED_LIB) && defined(AMIGAOS4)
 	    os4CloseLib();
 	  #endif
@@ -18,9 +18,13 @@ typedef struct _globals4es {
  int showfps;
  int vsync;
  int automipmap;
+ int mipmapsrgb;        // gamma correct mipmap generation for sRGB textures
  int texcopydata;
  int tested_env;
  int texshrink;
+ int texthreads;        // worker threads for the conversion of big textures (-1 = one per other core)
+ int texstaging;        // glTexSubImage2D staging arena and merging (2 = without PBO)
+ int texbudget;         // GPU texture budget in MB (0 = no limit)
  int texdump;
  int alphahack;
  int texstream;
@@ -41,6 +45,7 @@ typedef struct _globals4es {
  float gamma;
  int texmat;
  int novaocache;
+ int nolistopt;
  int beginend;
  int avoid16bits;
  int avoid24bits;
@@ -51,6 +56,9 @@ typedef struct _globals4es {
  int es;
  int gl;
  int usevbo;
+ int streamvbo;         // stream immediate mode batches in a ring VBO
+ int vcache;            // post-transform cache size to sort display list triangles for (0=no sorting)
+ int statestats;        // print the redundant GLES state calls counters at exit
  int comments;
  int forcenpot;
  int fbomakecurrent;    // hack to bind/unbind FBO when doing glXMakeCurrent
@@ -66,6 +74,8 @@ typedef struct _globals4es {
  int noclean;
  int dbgshaderconv;
  int nopsa;
+ int psaprewarm;        // load the PSA programs a few at a time on SwapBuffers
+ int noshadercache;
  int noes2;
  int nointovlhack;
  int noshaderlod;
@@ -46,6 +46,7 @@ void gl4es_glLightModelf(GLenum pname, GLfloat param) {
                     return;
                 }
                 glstate->light.local_viewer=value;
+                BUILTIN_CHANGED(BUILTIN_LIGHT);
                 if(glstate->fpe_state)
                     glstate->fpe_state->light_localviewer=value;
             }
@@ -84,6 +85,7 @@ void gl4es_glLightModelfv(GLenum pname, const GLfloat* params) {
             }
             errorGL();
             memcpy(glstate->light.ambient, params, 4*sizeof(GLfloat));
+            BUILTIN_CHANGED(BUILTIN_LIGHT);
             break;
         case GL_LIGHT_MODEL_TWO_SIDE:
             if(glstate->light.two_side == params[0]) {
@@ -118,6 +120,7 @@ void gl4es_glLightModelfv(GLenum pname, const GLfloat* params) {
                     return;
                 }
                 glstate->light.local_viewer=value;
+                BUILTIN_CHANGED(BUILTIN_LIGHT);
                 if(glstate->fpe_state)
                     glstate->fpe_state->light_localviewer=value;
             }
@@ -239,6 +242,7 @@ void gl4es_glLightfv(GLenum light, GLenum pname, const GLfloat* params) {
             glstate->light.lights[nl].quadraticAttenuation = params[0];
             break;
     }
+    BUILTIN_CHANGED(BUILTIN_LIGHT);
     LOAD_GLES_FPE(glLightfv);
     gles_glLightfv(light, pname, params);
     errorGL();
@@ -336,6 +340,7 @@ void gl4es_glMaterialfv(GLenum face, GLenum pname, const GLfloat *params) {
             }
             break;
     }
+    BUILTIN_CHANGED(BUILTIN_MATERIAL);
 
     if(face==GL_BACK && hardext.esversion==1) { // lets ignore GL_BACK in GLES 1.1
         noerrorShim();
@@ -381,6 +386,7 @@ void gl4es_glMaterialf(GLenum face, GLenum pname, GLfloat param) {
             return;
         glstate->material.back.shininess = param;
     }
+    BUILTIN_CHANGED(BUILTIN_MATERIAL);
 
     if(face==GL_BACK && hardext.esversion==1) { // lets ignore GL_BACK in GLES 1.1
         noerrorShim();
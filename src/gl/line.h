@@ -5,7 +5,7 @@
 #include "list.h"
 
 void gl4es_glLineStipple(GLuint factor, GLushort pattern);
-GLfloat *gen_stipple_tex_coords(GLfloat *vert, GLushort *sindices, modeinit_t *modes, int stride, int length, GLfloat* noalloctex);
+GLfloat *gen_stipple_tex_coords(GLfloat *vert, GLuint *sindices, modeinit_t *modes, int stride, int length, GLfloat* noalloctex);
 void bind_stipple_tex();
 
 #endif // _GL4ES_LINE_H
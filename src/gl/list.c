@@ -155,15 +155,17 @@ bool islistscompatible_renderlist(renderlist_t *a, renderlist_t *b) {
         return false;
         
     // Check the size of a list, if it"s too big, don't merge...
-    if ((a->len+b->len)>60000)
+    // (stay in 16bits indices range if 32bits indices are not supported)
+    int maxlen = (hardext.elementuint)?1000000:60000;
+    if ((a->len+b->len)>maxlen)
         return false;
-    if ((a->ilen+b->ilen)>60000)
+    if ((a->ilen+b->ilen)>maxlen)
         return false;
     
     return true;
 }
 
-void renderlist_createindices(int ilen, GLushort *indices, int count) {
+void renderlist_createindices(int ilen, GLuint *indices, int count) {
     for (int i = 0; i<ilen; i++) {
         indices[i] = i+count;
     }
@@ -171,7 +173,7 @@ void renderlist_createindices(int ilen, GLushort *indices, int count) {
 
 #define vind(a) (((ind)?ind[(a)]:(a))+count)
 
-void renderlist_lineloop_lines(GLushort *ind, int len, GLushort *indices, int count) {
+void renderlist_lineloop_lines(GLuint *ind, int len, GLuint *indices, int count) {
     int ilen = len*2;  // new size is 2* + return
 
     if(len>1) {
@@ -188,7 +190,7 @@ void renderlist_lineloop_lines(GLushort *ind, int len, GLushort *indices, int co
     }
 }
 
-void renderlist_linestrip_lines(GLushort *ind, int len, GLushort *indices, int count) {
+void renderlist_linestrip_lines(GLuint *ind, int len, GLuint *indices, int count) {
     int ilen = len*2-2;  // new size is 2*
     if (ilen<1) ilen=0;
     if(len>1) {
@@ -202,7 +204,7 @@ void renderlist_linestrip_lines(GLushort *ind, int len, GLushort *indices, int c
     }
 }
 
-void renderlist_trianglestrip_triangles(GLushort *ind, int len, GLushort *indices, int count) {
+void renderlist_trianglestrip_triangles(GLuint *ind, int len, GLuint *indices, int count) {
     int ilen = (len-2)*3;  
     if (ilen<0) ilen=0;
     for (int i = 2; i<len; i++) {
@@ -212,7 +214,7 @@ void renderlist_trianglestrip_triangles(GLushort *ind, int len, GLushort *indice
     }
 }
 
-void renderlist_trianglefan_triangles(GLushort *ind, int len, GLushort *indices, int count) {
+void renderlist_trianglefan_triangles(GLuint *ind, int len, GLuint *indices, int count) {
     int ilen = (len-2)*3;  
     if (ilen<0) ilen=0;
     for (int i = 2; i<len; i++) {
@@ -222,7 +224,7 @@ void renderlist_trianglefan_triangles(GLushort *ind, int len, GLushort *indices,
     }
 }
 
-void renderlist_quads_triangles(GLushort *ind, int len, GLushort *indices, int count) {
+void renderlist_quads_triangles(GLuint *ind, int len, GLuint *indices, int count) {
     // len must be a multiple of 4 !
     len &= ~3;  // discard extra vertex...
     int ilen = len*3/2;
@@ -239,21 +241,21 @@ void renderlist_quads_triangles(GLushort *ind, int len, GLushort *indices, int c
 #undef vind
 #define vind(a) ((ind)?ind[(a)]:(a))
 void renderlist_quads2triangles(renderlist_t *a) {
-    GLushort *ind = a->indices;
+    GLuint *ind = a->indices;
     int len = (ind)? a->ilen:a->len;
     // len must be a multiple of 4 !
     len &= ~3;  // discard extra vertex...
     int ilen = len*3/2;
     if(a->use_glstate) {
         if(ind) {//need to copy first...
-            ind = (GLushort*)malloc(len*sizeof(GLushort));
-            memcpy(ind, glstate->merger_indices, len*sizeof(GLushort));
+            ind = (GLuint*)malloc(len*sizeof(GLuint));
+            memcpy(ind, glstate->merger_indices, len*sizeof(GLuint));
             a->shared_indices = NULL;   // should not be needed
         }
         resize_merger_indices(ilen);
         a->indices = glstate->merger_indices;
     } else
-        a->indices = (GLushort*)malloc(ilen*sizeof(GLushort));
+        a->indices = (GLuint*)malloc(ilen*sizeof(GLuint));
 
     for (int i=0, j=0; i+3<len; i+=4, j+=6) {
         a->indices[j+0] = vind(i+0);
@@ -331,63 +333,81 @@ void list_add_modeinit(renderlist_t* list, GLenum mode) {
     list->mode_inits[list->mode_init_len++].ilen = list->indices?list->ilen:(list->cur_istart?list->cur_istart:list->len);
 }
 
+// copy len elements of n floats, from src with a stride in bytes (0 means packed) to packed dst
+static void copy_sublist(GLfloat *dst, const GLfloat *src, int n, int stride, int len) {
+    if(!stride || stride==n*sizeof(GLfloat)) {
+        memcpy(dst, src, n*len*sizeof(GLfloat));
+        return;
+    }
+    for (int i=0; i<len; i++) {
+        memcpy(dst, src, n*sizeof(GLfloat));
+        dst += n;
+        src = (const GLfloat*)((const char*)src + stride);
+    }
+}
+
+// is the array part of the interleaved block of the list?
+static int is_interleaved(renderlist_t *a, GLfloat *p) {
+    return (a->interleaved && p>=a->interleaved && p<a->interleaved+a->interleaved_size);
+}
+
 void unshared_renderlist(renderlist_t *a, int cap) {
-    if(a->shared_arrays && ((*a->shared_arrays)--)>0) {
-        a->cap = cap;
+    // shared_arrays counts the other lists using the arrays
+    int shared = (a->shared_arrays && (*a->shared_arrays)>0);
+    if(shared)
+        --(*a->shared_arrays);
+    if(shared || a->interleaved) {
+        // non-interleaved arrays that are not shared keep their current capacity
+        int newcap = (shared)?cap:a->cap;
+        a->cap = newcap;
         GLfloat *tmp;
-        tmp = a->vert;
-        if (tmp) {
-            a->vert = alloc_sublist(4, cap);
-            memcpy(a->vert, tmp, 4*a->len*sizeof(GLfloat));
-        }
-        tmp = a->normal;
-        if (tmp) {
-            a->normal = alloc_sublist(3, cap);
-            memcpy(a->normal, tmp, 3*a->len*sizeof(GLfloat));
-        }
-        tmp = a->color;
-        if (tmp) {
-            a->color = alloc_sublist(4, cap);
-            memcpy(a->color, tmp, 4*a->len*sizeof(GLfloat));
-        }
-        tmp = a->secondary;
-        if (tmp) {
-            a->secondary = alloc_sublist(4, cap);
-            memcpy(a->secondary, tmp, 4*a->len*sizeof(GLfloat));
-        }
-        tmp = a->fogcoord;
-        if (tmp) {
-            a->fogcoord = alloc_sublist(1, cap);
-            memcpy(a->fogcoord, tmp, 1*a->len*sizeof(GLfloat));
+        // when not shared, only the interleaved arrays need to be unpacked
+        #define GO(A, N, S)                                     \
+        tmp = A;                                                \
+        if (tmp && (shared || is_interleaved(a, tmp))) {        \
+            A = alloc_sublist(N, newcap);                       \
+            copy_sublist(A, tmp, N, S, a->len);                 \
+            S = 0;                                              \
         }
+        GO(a->vert, 4, a->vert_stride)
+        GO(a->normal, 3, a->normal_stride)
+        GO(a->color, 4, a->color_stride)
+        GO(a->secondary, 4, a->secondary_stride)
+        GO(a->fogcoord, 1, a->fogcoord_stride)
         for (int i=0; i<a->maxtex; i++) {
-            tmp = a->tex[i];
-            if (tmp) {
-                a->tex[i] = alloc_sublist(4, cap);
-                memcpy(a->tex[i], tmp, 4*a->len*sizeof(GLfloat));
-            }
+            GO(a->tex[i], 4, a->tex_stride[i])
         }
+        #undef GO
+        if(!shared && a->interleaved)
+            free(a->interleaved);
+        a->interleaved = NULL;
+        a->interleaved_size = 0;
     }
-    if(a->shared_arrays && (*a->shared_arrays)==0) {
-        free(a->shared_arrays); 
+    if(a->shared_arrays) {
+        // the counter stays with the other lists if still shared
+        if(!shared)
+            free(a->shared_arrays);
         a->shared_arrays=NULL;
     }
 }
 
 void unsharedindices_renderlist(renderlist_t* a, int cap)
 {
-    if (a->shared_indices && ((*a->shared_indices)--)>0) {
+    int shared = (a->shared_indices && (*a->shared_indices)>0);
+    if (shared) {
+        --(*a->shared_indices);
         if (a->indices) {
-            GLushort* tmpi = a->indices;
+            GLuint* tmpi = a->indices;
             a->indice_cap = cap;
             if (a->indice_cap > 48) a->indice_cap = ((a->indice_cap+512)>>9)<<9;
-            a->indices = (GLushort*)malloc(a->indice_cap*sizeof(GLushort));
-            memcpy(a->indices, tmpi, a->ilen*sizeof(GLushort));
+            a->indices = (GLuint*)malloc(a->indice_cap*sizeof(GLuint));
+            memcpy(a->indices, tmpi, a->ilen*sizeof(GLuint));
         }
     } 
-    if(a->shared_indices && (*a->shared_indices)==0) {
-        free(a->shared_indices); 
-        a->shared_indices=0;
+    if(a->shared_indices) {
+        if(!shared)
+            free(a->shared_indices);
+        a->shared_indices=NULL;
     }
 }
 
@@ -404,20 +424,78 @@ void redim_renderlist(renderlist_t *a, int cap) {
     }
 }
 
+void interleave_renderlist(renderlist_t *a) {
+    // only for lists that own their separate arrays
+    if (a->use_glstate || a->shared_arrays || a->interleaved || !a->len)
+        return;
+    // size of 1 vertex record, from the attributes used
+    int stride = 0;
+    int narrays = 0;
+    #define GO(A, N, S) if (A) {if (S) return; stride += N; ++narrays;}
+    GO(a->vert, 4, a->vert_stride)
+    GO(a->color, 4, a->color_stride)
+    GO(a->secondary, 4, a->secondary_stride)
+    for (int i=0; i<a->maxtex; i++)
+        GO(a->tex[i], 4, a->tex_stride[i])
+    GO(a->normal, 3, a->normal_stride)
+    GO(a->fogcoord, 1, a->fogcoord_stride)
+    #undef GO
+    if (narrays<2)
+        return; // nothing to gain
+    GLfloat *block = NULL;
+    const int size = stride*a->len;
+#ifdef AMIGAOS4
+    block = (GLfloat*)malloc(size*sizeof(GLfloat));
+#else
+    // cache line aligned
+    if (posix_memalign((void**)&block, 64, size*sizeof(GLfloat)))
+        block = NULL;
+#endif
+    if (!block)
+        return;
+    // 4 components arrays first, to keep them 16 bytes aligned
+    int offs = 0;
+    #define GO(A, N, S)                                         \
+    if (A) {                                                    \
+        GLfloat *src = A;                                       \
+        GLfloat *dst = block + offs;                            \
+        for (int j=0; j<a->len; j++) {                          \
+            memcpy(dst, src, N*sizeof(GLfloat));                \
+            dst += stride;                                      \
+            src += N;                                           \
+        }                                                       \
+        free(A);                                                \
+        A = block + offs;                                       \
+        S = stride*sizeof(GLfloat);                             \
+        offs += N;                                              \
+    }
+    GO(a->vert, 4, a->vert_stride)
+    GO(a->color, 4, a->color_stride)
+    GO(a->secondary, 4, a->secondary_stride)
+    for (int i=0; i<a->maxtex; i++)
+        GO(a->tex[i], 4, a->tex_stride[i])
+    GO(a->normal, 3, a->normal_stride)
+    GO(a->fogcoord, 1, a->fogcoord_stride)
+    #undef GO
+    a->interleaved = block;
+    a->interleaved_size = size;
+    a->cap = a->len;
+}
+
 void prepareadd_renderlist(renderlist_t* a, int size_to_add)
 {
     // alloc or realloc a->indices first...
     int capindices = renderlist_getindicesize(a)+size_to_add;
     if (capindices > 48) capindices = ((capindices+512)>>9)<<9;
     #define alloc_a_indices                                      \
-    newind=(GLushort*)malloc(capindices*sizeof(GLushort))
+    newind=(GLuint*)malloc(capindices*sizeof(GLuint))
     #define copy_a_indices                                       \
     if (a->indices) free(a->indices);                            \
     a->indices = newind;                                         \
     a->indice_cap = capindices
     // check if "a" needs to be converted
     int ilen_a = renderlist_getindicesize(a);
-    GLushort *newind=NULL;
+    GLuint *newind=NULL;
     switch (a->mode) {
         case GL_LINE_LOOP:
             alloc_a_indices;
@@ -460,7 +538,7 @@ void prepareadd_renderlist(renderlist_t* a, int size_to_add)
             } else {
                 // a->indices already exist, just check if need to adjust its size
                 if (a->indice_cap < capindices) {
-                    a->indices = (GLushort*)realloc(a->indices, capindices*sizeof(GLushort));
+                    a->indices = (GLuint*)realloc(a->indices, capindices*sizeof(GLuint));
                     a->indice_cap = capindices;
                 }
             }
@@ -472,7 +550,7 @@ void prepareadd_renderlist(renderlist_t* a, int size_to_add)
     a->ilen = ilen_a;
 }
 
-void doadd_renderlist(renderlist_t* a, GLenum mode, GLushort* indices, int count, int size_to_add)
+void doadd_renderlist(renderlist_t* a, GLenum mode, GLuint* indices, int count, int size_to_add)
 {
     // then append b
     switch (mode) {
@@ -500,7 +578,7 @@ void doadd_renderlist(renderlist_t* a, GLenum mode, GLushort* indices, int count
                 renderlist_createindices(count, a->indices + a->ilen, a->len);
             } else {
                 // append existing one
-                GLushort* newind = a->indices+a->ilen;
+                GLuint* newind = a->indices+a->ilen;
                 for(int i=0; i<count; i++)
                     newind[i] = indices[i]+a->len;
             }
@@ -522,13 +600,13 @@ void append_renderlist(renderlist_t *a, renderlist_t *b) {
     redim_renderlist(a, cap);
     unsharedindices_renderlist(a, ((ilen_a)?ilen_a:a->len) + ((ilen_b)?ilen_b:b->len));
     // append arrays
-    if (a->vert) memcpy(a->vert+a->len*4, b->vert, b->len*4*sizeof(GLfloat));
-    if (a->normal) memcpy(a->normal+a->len*3, b->normal, b->len*3*sizeof(GLfloat));
-    if (a->color) memcpy(a->color+a->len*4, b->color, b->len*4*sizeof(GLfloat));
-    if (a->secondary) memcpy(a->secondary+a->len*4, b->secondary, b->len*4*sizeof(GLfloat));
-    if (a->fogcoord) memcpy(a->fogcoord+a->len*1, b->fogcoord, b->len*1*sizeof(GLfloat));
+    if (a->vert) copy_sublist(a->vert+a->len*4, b->vert, 4, b->vert_stride, b->len);
+    if (a->normal) copy_sublist(a->normal+a->len*3, b->normal, 3, b->normal_stride, b->len);
+    if (a->color) copy_sublist(a->color+a->len*4, b->color, 4, b->color_stride, b->len);
+    if (a->secondary) copy_sublist(a->secondary+a->len*4, b->secondary, 4, b->secondary_stride, b->len);
+    if (a->fogcoord) copy_sublist(a->fogcoord+a->len*1, b->fogcoord, 1, b->fogcoord_stride, b->len);
     for (int i=0; i<a->maxtex; i++)
-        if (a->tex[i]) memcpy(a->tex[i]+a->len*4, b->tex[i], b->len*4*sizeof(GLfloat));
+        if (a->tex[i]) copy_sublist(a->tex[i]+a->len*4, b->tex[i], 4, b->tex_stride[i], b->len);
     // indices
     if(!a->mode_inits) list_add_modeinit(a, a->mode_init);
     if (ilen_a || ilen_b || mode_needindices(a->mode) || mode_needindices(b->mode) 
@@ -623,6 +701,15 @@ renderlist_t* append_calllist(renderlist_t *list, renderlist_t *a)
             new->prev = list;
             // ok, now on new list
             list = new;
+            // the draw helpers are not shared
+            if (a->mode_inits) {
+                list->mode_inits = (modeinit_t*)malloc(list->mode_init_cap*sizeof(modeinit_t));
+                memcpy(list->mode_inits, a->mode_inits, list->mode_init_len*sizeof(modeinit_t));
+            }
+            list->ind_lines = NULL;
+            list->final_colors = NULL;
+            list->vbo_array = list->vbo_indices = 0;
+            list->use_vbo_array = list->use_vbo_indices = 0;
             // copy the many list arrays
             if (list->calls.len > 0) {
                 ++(*list->shared_calls);
@@ -694,13 +781,16 @@ void free_renderlist(renderlist_t *list) {
         if(!list->use_glstate) {
             if (!list->shared_arrays || ((*list->shared_arrays)--)==0) {
                 if (list->shared_arrays) free(list->shared_arrays);
-                if (list->vert) free(list->vert);
-                if (list->normal) free(list->normal);
-                if (list->color) free(list->color);
-                if (list->secondary) free(list->secondary);
-                if (list->fogcoord) free(list->fogcoord);
+                #define GO(A) if (A && !is_interleaved(list, A)) free(A)
+                GO(list->vert);
+                GO(list->normal);
+                GO(list->color);
+                GO(list->secondary);
+                GO(list->fogcoord);
                 for (a=0; a<list->maxtex; a++)
-                    if (list->tex[a]) free(list->tex[a]);
+                    GO(list->tex[a]);
+                #undef GO
+                if (list->interleaved) free(list->interleaved);
             }
             if (!list->shared_indices || ((*list->shared_indices)--)==0) {
                 if (list->shared_indices) free(list->shared_indices);
@@ -790,6 +880,8 @@ void resize_renderlist(renderlist_t *list) {
                 if(list->tex[a]) list->tex[a] = glstate->merger_tex[a-2];
         }
     } else {
+        if (list->interleaved)
+            unshared_renderlist(list, list->cap);   // list is growing again, get back to separate arrays
         if (list->len >= list->cap) {
             list->cap += DEFAULT_RENDER_LIST_CAPACITY*8;
             realloc_sublist(list->vert, 4, list->cap);
@@ -807,7 +899,7 @@ void resize_merger_indices(int cap) {
     if(cap<glstate->merger_indice_cap)
         return;
     glstate->merger_indice_cap = ((glstate->merger_indice_cap+cap+512)>>9)<<9;
-    glstate->merger_indices = (GLushort*)realloc(glstate->merger_indices, glstate->merger_indice_cap*sizeof(GLushort));
+    glstate->merger_indices = (GLuint*)realloc(glstate->merger_indices, glstate->merger_indice_cap*sizeof(GLuint));
 }
 
 void resize_indices_renderlist(renderlist_t *list, int n) {
@@ -820,7 +912,7 @@ void resize_indices_renderlist(renderlist_t *list, int n) {
         if(list->ilen+n<list->indice_cap)
             return;
         list->indice_cap = ((list->indice_cap+n+511)>>9)<<9;
-        list->indices = (GLushort*)realloc(list->indices, list->indice_cap*sizeof(GLushort));
+        list->indices = (GLuint*)realloc(list->indices, list->indice_cap*sizeof(GLuint));
     }
 }
 
@@ -901,13 +993,13 @@ renderlist_t* recycle_renderlist(renderlist_t *list, GLenum mode) {
         rlNormal3f(list, list->post_normals[0], list->post_normals[1], list->post_normals[2]);
     }
     // check if list needs to be converted to triangles / lines...
-    GLushort *indices = NULL;
+    GLuint *indices = NULL;
 #define pre_expand   \
             if(list->use_glstate) {\
                 resize_merger_indices(renderlist_getindicesize(list)); indices = glstate->merger_indices;\
             } else {\
                 list->indice_cap = renderlist_getindicesize(list);\
-                indices = (GLushort*)malloc(sizeof(GLushort)*list->indice_cap);\
+                indices = (GLuint*)malloc(sizeof(GLuint)*list->indice_cap);\
             }
 #define post_expand  \
             list->ilen = renderlist_getindicesize(list);\
@@ -160,6 +160,8 @@ typedef struct _renderlist_t {
     call_list_t calls;
     
     int *shared_arrays;
+    GLfloat *interleaved;   // if not NULL, single allocation where vert, normal, color... are interleaved
+    int      interleaved_size;  // in GLfloat
     GLfloat *vert;
     GLfloat *normal;
     GLfloat *color;
@@ -183,7 +185,7 @@ typedef struct _renderlist_t {
     GLfloat *vbo_fogcoord;
     GLfloat *vbo_tex[MAX_TEX];
     int *shared_indices;
-    GLushort *indices;
+    GLuint *indices;
     unsigned int indice_cap;
     int maxtex;
     GLenum  merger_mode;
@@ -221,7 +223,7 @@ typedef struct _renderlist_t {
     int     post_normal;
     GLfloat post_normals[3];
 
-    GLushort    *ind_lines;
+    GLuint    *ind_lines;
     int         ind_line;
     GLfloat      *final_colors;
 
@@ -248,6 +250,21 @@ typedef struct _renderlist_t {
 
 KHASH_MAP_DECLARE_INT(gllisthead, renderlist_t*);
 
+// glCallLists sequences, flattened in a single renderlist
+typedef struct {
+    GLuint          *names;     // list names (glListBase already applied)
+    int             n;
+    uint32_t        hash;
+    int             bake;       // translations baked in the vertices
+    unsigned int    age;
+    renderlist_t    *flat;      // NULL until the sequence is called a 2nd time
+} calllists_entry_t;
+
+typedef struct {
+    calllists_entry_t   entries[CALLLISTS_CACHE_SIZE];
+    unsigned int        age;
+} calllists_cache_t;
+
 #define DEFAULT_CALL_LIST_CAPACITY 20
 #define DEFAULT_RENDER_LIST_CAPACITY 64
 
@@ -275,6 +292,10 @@ void free_renderlist(renderlist_t *list);
 void draw_renderlist(renderlist_t *list);
 renderlist_t* end_renderlist(renderlist_t *list);
 bool isempty_renderlist(renderlist_t *list);
+bool ispurerender_renderlist(renderlist_t *list);
+bool islistscompatible_renderlist(renderlist_t *a, renderlist_t *b);
+void append_renderlist(renderlist_t *a, renderlist_t *b);
+renderlist_t* append_calllist(renderlist_t *list, renderlist_t *a);
 void resize_renderlist(renderlist_t *list);
 renderlist_t *alloc_renderlist();
 int mode_needindices(GLenum m);
@@ -285,15 +306,22 @@ void list_add_modeinit(renderlist_t* list, GLenum mode);
 void unshared_renderlist(renderlist_t *a, int cap);
 void unsharedindices_renderlist(renderlist_t* a, int cap);
 void redim_renderlist(renderlist_t *a, int cap);
+void interleave_renderlist(renderlist_t *a);
+renderlist_t* optimize_renderlist(renderlist_t *list);
 void prepareadd_renderlist(renderlist_t* a, int size_to_add);
-void doadd_renderlist(renderlist_t* a, GLenum mode, GLushort* indices, int count, int size_to_add);
-
-void renderlist_createindices(int ilen, GLushort *indices, int count);
-void renderlist_lineloop_lines(GLushort *ind, int len, GLushort *indices, int count);
-void renderlist_linestrip_lines(GLushort *ind, int len, GLushort *indices, int count);
-void renderlist_trianglestrip_triangles(GLushort *ind, int len, GLushort *indices, int count);
-void renderlist_trianglefan_triangles(GLushort *ind, int len, GLushort *indices, int count);
-void renderlist_quads_triangles(GLushort *ind, int len, GLushort *indices, int count);
+void doadd_renderlist(renderlist_t* a, GLenum mode, GLuint* indices, int count, int size_to_add);
+
+void renderlist_createindices(int ilen, GLuint *indices, int count);
+void renderlist_lineloop_lines(GLuint *ind, int len, GLuint *indices, int count);
+void renderlist_linestrip_lines(GLuint *ind, int len, GLuint *indices, int count);
+void renderlist_trianglestrip_triangles(GLuint *ind, int len, GLuint *indices, int count);
+void renderlist_trianglefan_triangles(GLuint *ind, int len, GLuint *indices, int count);
+void renderlist_quads_triangles(GLuint *ind, int len, GLuint *indices, int count);
+calllists_cache_t* calllists_newcache();
+void calllists_freecache(calllists_cache_t *cache);
+void calllists_invalidate(calllists_cache_t *cache, GLuint name);
+renderlist_t* calllists_get(calllists_cache_t *cache, const GLuint *names, int n);
+void renderlist_vcache_triangles(GLuint *ind, int ilen, GLuint *indices, int count, int cache);
 
 void rlActiveTexture(renderlist_t *list, GLenum texture );
 void rlBindTexture(renderlist_t *list, GLenum target, GLuint texture);
@@ -1,6 +1,7 @@
 #include "list.h"
 
 #include "../glx/hardext.h"
+#include "enum_info.h"
 #include "wrap/gl4es.h"
 #include "fpe.h"
 #include "init.h"
@@ -11,7 +12,6 @@
 #include "render.h"
 #include "fpe.h"
 
-/* return 1 if failed, 2 if succeed */
 typedef struct array2vbo_s {
     uintptr_t   real_base;
     uint32_t    real_size;
@@ -20,12 +20,9 @@ typedef struct array2vbo_s {
     uintptr_t   vbo_basebase;
 } array2vbo_t;
 
-int list2VBO(renderlist_t* list)
+/* compute the layout of all arrays of the list inside a single buffer, return the total size (0 if no data) */
+static uintptr_t list2VBOLayout(renderlist_t* list, array2vbo_t* work, int* sorted, int* count)
 {
-    LOAD_GLES2(glGenBuffers);
-    LOAD_GLES2(glBufferData);
-    LOAD_GLES2(glBufferSubData);
-    array2vbo_t work[ATT_MAX] = {0};
     // list -> work
     int imax = 0;
     int len = list->len;
@@ -74,7 +71,6 @@ int list2VBO(renderlist_t* list)
         }
     }
     // sort the real address...
-    int sorted[ATT_MAX];
     for (int i=0; i<imax; ++i)
         sorted[i] = i;
     // bubble sort, array is small enough, and probably almost sorted
@@ -94,8 +90,8 @@ int list2VBO(renderlist_t* list)
         if(i) for(int j=i-1; j<i; ++j) {
             array2vbo_t *t = work+sorted[j];
             if(r->real_base<t->real_base+t->real_size) {
-                base = r->vbo_base + (r->real_base - t->real_base);
-                basebase = r->vbo_basebase;
+                base = t->vbo_base + (r->real_base - t->real_base);
+                basebase = t->vbo_basebase;
                 break;
             }
         }
@@ -104,48 +100,99 @@ int list2VBO(renderlist_t* list)
         if(base == basebase)
             vbo_base += r->real_size;
     }
-    if(!vbo_base)   // no data?!
-        return 1;
-    // Create the VBO and fill the data
-    gles_glGenBuffers(1, &list->vbo_array);
-    bindBuffer(GL_ARRAY_BUFFER, list->vbo_array);
-    gles_glBufferData(GL_ARRAY_BUFFER, vbo_base, NULL, GL_STATIC_DRAW);
-    for(int i=0; i<imax; ++i) {
+    *count = imax;
+    return vbo_base;
+}
+
+/* upload all arrays at offset in the currently bound GL_ARRAY_BUFFER */
+static void list2VBOUpload(array2vbo_t* work, int* sorted, int count, uintptr_t offset)
+{
+    LOAD_GLES2(glBufferSubData);
+    for(int i=0; i<count; ++i) {
         array2vbo_t *r = work+sorted[i];
         if(r->vbo_base==r->vbo_basebase)
-            gles_glBufferSubData(GL_ARRAY_BUFFER, r->vbo_basebase, r->real_size, (void*)r->real_base);
+            gles_glBufferSubData(GL_ARRAY_BUFFER, offset+r->vbo_basebase, r->real_size, (void*)r->real_base);
     }
+}
+
+static void list2VBOPointers(renderlist_t* list, array2vbo_t* work, uintptr_t offset)
+{
     // work -> list
-    imax = 0;
+    int imax = 0;
     if(list->vert) {
-        list->vbo_vert = (GLfloat*)work[imax].vbo_base;
+        list->vbo_vert = (GLfloat*)(offset+work[imax].vbo_base);
         imax++;
     }
     if(list->color) {
-        list->vbo_color = (GLfloat*)work[imax].vbo_base;
+        list->vbo_color = (GLfloat*)(offset+work[imax].vbo_base);
         imax++;
     }
     if(list->secondary) {
-        list->vbo_secondary = (GLfloat*)work[imax].vbo_base;
+        list->vbo_secondary = (GLfloat*)(offset+work[imax].vbo_base);
         imax++;
     }
     if(list->fogcoord) {
-        list->vbo_fogcoord = (GLfloat*)work[imax].vbo_base;
+        list->vbo_fogcoord = (GLfloat*)(offset+work[imax].vbo_base);
         imax++;
     }
     if(list->normal) {
-        list->vbo_normal = (GLfloat*)work[imax].vbo_base;
+        list->vbo_normal = (GLfloat*)(offset+work[imax].vbo_base);
         imax++;
     }
     for (int a=0; a<list->maxtex; ++a) {
         if(list->tex[a]) {
-            list->vbo_tex[a] = (GLfloat*)work[imax].vbo_base;
+            list->vbo_tex[a] = (GLfloat*)(offset+work[imax].vbo_base);
             imax++;
         }
     }
+}
+
+/* return 1 if failed, 2 if succeed */
+int list2VBO(renderlist_t* list)
+{
+    LOAD_GLES2(glGenBuffers);
+    LOAD_GLES2(glBufferData);
+    array2vbo_t work[ATT_MAX] = {0};
+    int sorted[ATT_MAX];
+    int count;
+    uintptr_t size = list2VBOLayout(list, work, sorted, &count);
+    if(!size)   // no data?!
+        return 1;
+    // Create the VBO and fill the data
+    gles_glGenBuffers(1, &list->vbo_array);
+    bindBuffer(GL_ARRAY_BUFFER, list->vbo_array);
+    if(size==work[sorted[0]].real_size) {
+        // only 1 block (like interleaved list), upload it in one go
+        gles_glBufferData(GL_ARRAY_BUFFER, size, (void*)work[sorted[0]].real_base, GL_STATIC_DRAW);
+    } else {
+        gles_glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
+        list2VBOUpload(work, sorted, count, 0);
+    }
+    list2VBOPointers(list, work, 0);
 
     return 2;
 }
+
+/* stream the arrays in the immediate mode ring VBO: return 1 if failed, 3 if succeed
+   the list doesn't own the VBO, so list->vbo_array must be cleared after the draw */
+int list2Stream(renderlist_t* list)
+{
+    array2vbo_t work[ATT_MAX] = {0};
+    int sorted[ATT_MAX];
+    int count;
+    uintptr_t size = list2VBOLayout(list, work, sorted, &count);
+    if(!size)
+        return 1;
+    GLintptr offset = gl4es_stream_vertex(size);  // reserve and bind the ring VBO
+    if(offset<0)
+        return 1;
+    list2VBOUpload(work, sorted, count, offset);
+    list2VBOPointers(list, work, offset);
+    list->vbo_array = glstate->stream_vertex;
+
+    return 3;
+}
+
 typedef struct save_vbo_s {
     GLuint          real_buffer;
     const GLvoid*   real_pointer;
@@ -220,7 +267,83 @@ void listInactiveVBO(renderlist_t* list, save_vbo_t* saved) {
     }
 }
 
-int fill_lineIndices(modeinit_t *modes, int length, GLenum mode, GLushort* indices, GLushort *ind_line)
+/* narrow 32bits renderlist indices to 16bits (in scratch), optionaly rebased */
+static GLushort* list_narrowIndicesBase(const GLuint* indices, GLsizei count, GLuint base)
+{
+    gl4es_scratch(count*sizeof(GLushort));
+    GLushort *tmp = (GLushort*)glstate->scratch;
+    for (int i=0; i<count; i++)
+        tmp[i] = indices[i]-base;
+    return tmp;
+}
+static GLushort* list_narrowIndices(const GLuint* indices, GLsizei count)
+{
+    return list_narrowIndicesBase(indices, count, 0);
+}
+
+/* move all enabled arrays by delta vertices, so the chunk can be drawn with 16bits indices */
+static void list_shiftArrays(GLint delta)
+{
+    for (int i=0; i<hardext.maxvattrib; i++) {
+        vertexattrib_t *v = &glstate->vao->vertexattrib[i];
+        if(!v->enabled)
+            continue;
+        GLintptr offset = (GLintptr)delta*((v->stride)?v->stride:(v->size*gl_sizeof(v->type)));
+        if(v->real_buffer)
+            v->real_pointer = (const char*)v->real_pointer + offset;
+        else
+            v->pointer = (const char*)v->pointer + offset;
+    }
+}
+
+/* draw client side 32bits indices of a list */
+static void list_drawElements(renderlist_t* list, GLenum mode, GLsizei count, const GLuint* indices)
+{
+    LOAD_GLES_FPE(glDrawElements);
+    if(hardext.elementuint) {
+        gles_glDrawElements(mode, count, GL_UNSIGNED_INT, indices);
+        return;
+    }
+    if(list->len<=65536) {
+        gles_glDrawElements(mode, count, GL_UNSIGNED_SHORT, list_narrowIndices(indices, count));
+        return;
+    }
+    // no GL_OES_element_index_uint: split in chunks of primitives that fit in 16bits indices
+    int prim = (mode==GL_TRIANGLES)?3:((mode==GL_LINES)?2:((mode==GL_POINTS)?1:0));
+    if(hardext.esversion==1 || !prim) {
+        static int warn = 1;
+        if(warn) {
+            SHUT_LOGE("Cannot draw list of %d vertices without GL_OES_element_index_uint\n", list->len);
+            warn = 0;
+        }
+        return;
+    }
+    count -= count%prim;    // an incomplete last primitive is not drawn anyway
+    int first = 0;
+    while(first<count) {
+        GLuint imin = indices[first], imax = indices[first];
+        int last = first;
+        while(last<count) {
+            GLuint pmin = imin, pmax = imax;
+            for (int j=0; j<prim; j++) {
+                if(indices[last+j]<pmin) pmin = indices[last+j];
+                if(indices[last+j]>pmax) pmax = indices[last+j];
+            }
+            if(pmax-pmin>65535)
+                break;
+            imin = pmin; imax = pmax;
+            last += prim;
+        }
+        if(last==first)
+            last += prim;   // a single primitive bigger than 16bits, should not happens
+        list_shiftArrays(imin);
+        gles_glDrawElements(mode, last-first, GL_UNSIGNED_SHORT, list_narrowIndicesBase(indices+first, last-first, imin));
+        list_shiftArrays(-(GLint)imin);
+        first = last;
+    }
+}
+
+int fill_lineIndices(modeinit_t *modes, int length, GLenum mode, GLuint* indices, GLuint *ind_line)
 {
     #define ind(a)  indices?indices[a]:(a)
     int k=0;
@@ -357,7 +480,7 @@ void draw_renderlist(renderlist_t *list) {
     gl4es_glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 
 	int old_tex;
-    GLushort *indices;
+    GLuint *indices;
     int use_texgen[MAX_TEX] = {0};
     old_tex = glstate->texture.client;
     GLuint cur_tex = old_tex;
@@ -503,8 +626,9 @@ void draw_renderlist(renderlist_t *list) {
         if (! list->len)
             continue;
 
+        // unnamed lists (immediate mode) are streamed in the ring VBO, as they will not be drawn again
         int use_vbo_array = list->use_vbo_array;
-        if(!use_vbo_array && (hardext.esversion==1 || globals4es.usevbo==0 || !list->name)) {
+        if(!use_vbo_array && (hardext.esversion==1 || globals4es.usevbo==0 || (!list->name && !globals4es.streamvbo))) {
             use_vbo_array = 1;
         }
         int use_vbo_indices = list->use_vbo_indices;
@@ -692,14 +816,17 @@ void draw_renderlist(renderlist_t *list) {
         if(use_vbo_array==0) {
             if((glstate->render_mode == GL_SELECT) || (glstate->polygon_mode == GL_LINE) || (glstate->polygon_mode == GL_POINT))
                 use_vbo_array = 1;
-            else
+            else if(list->name)
                 // evaluated, seems good to go !
                 use_vbo_array = list2VBO(list);
+            else
+                use_vbo_array = list2Stream(list);
         }
         save_vbo_t saved[NB_VA];
-        if(use_vbo_array==2)
+        if(use_vbo_array>=2)
             listActiveVBO(list, saved);
-        if(list->use_vbo_array != use_vbo_array)
+        // streamed data is only valid for this draw, so don't remember it
+        if(list->use_vbo_array != use_vbo_array && use_vbo_array!=3)
             list->use_vbo_array = use_vbo_array;
         
         GLenum mode;
@@ -716,42 +843,76 @@ void draw_renderlist(renderlist_t *list) {
                 vtx.type = GL_FLOAT;
                 vtx.normalized = GL_FALSE;
                 vtx.size = 4;
-                vtx.stride = 0;
-                select_glDrawElements(&vtx, list->mode, list->ilen, GL_UNSIGNED_SHORT, indices);
+                vtx.stride = list->vert_stride;
+                select_glDrawElements(&vtx, list->mode, list->ilen, GL_UNSIGNED_INT, indices);
                 use_vbo_indices = 1;
             } else {
                 if (glstate->polygon_mode == GL_LINE && list->mode_init>=GL_TRIANGLES) {
                     int ilen = list->ilen;
                     if(!list->ind_lines) {
-                        GLushort *ind_line = list->ind_lines = (GLushort*)malloc(sizeof(GLushort)*ilen*4+2);
+                        list->ind_lines = (GLuint*)malloc(sizeof(GLuint)*ilen*4+2);
                         modeinit_t tmp; tmp.mode_init = list->mode_init; tmp.ilen=list->ilen;
                         int k = fill_lineIndices(list->mode_inits?list->mode_inits:&tmp, list->mode_inits?list->mode_init_len:1, list->mode, indices, list->ind_lines);
                         list->ind_line = k;
                     }
                     bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-                    gles_glDrawElements(mode, list->ind_line, GL_UNSIGNED_SHORT, list->ind_lines);
+                    list_drawElements(list, mode, list->ind_line, list->ind_lines);
+                    use_vbo_indices = 1;
+                } else if(!hardext.elementuint && list->len>65536) {
+                    // more vertices than 16bits indices can address, draw by chunks
+                    bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                    for (glstate->instanceID=0; glstate->instanceID<list->instanceCount; ++glstate->instanceID)
+                        list_drawElements(list, mode, list->ilen, indices);
+                    glstate->instanceID = 0;
                     use_vbo_indices = 1;
                 } else {
-                    int vbo_indices = 0;
+                    GLenum itype = GL_UNSIGNED_INT;
+                    const GLvoid* draw_indices = indices;
                     if(!use_vbo_indices) {
-                        // create VBO for indices
+                        // create VBO for indices, 16bits when enough
                         LOAD_GLES2(glGenBuffers);
                         LOAD_GLES2(glBufferData);
+                        // the VBO get the triangles sorted for the vertex cache (list->indices keep the original order, for GL_LINE or GL_SELECT)
+                        GLuint *sorted = NULL;
+                        if(globals4es.vcache && list->mode==GL_TRIANGLES && list->ilen>=6) {
+                            sorted = (GLuint*)malloc(list->ilen*sizeof(GLuint));
+                            renderlist_vcache_triangles(indices, list->ilen, sorted, list->len, globals4es.vcache);
+                            draw_indices = sorted;
+                        }
+                        if(list->len<=65536) {
+                            itype = GL_UNSIGNED_SHORT;
+                            draw_indices = list_narrowIndices(draw_indices, list->ilen);
+                        }
                         gles_glGenBuffers(1, &list->vbo_indices);
                         bindBuffer(GL_ELEMENT_ARRAY_BUFFER, list->vbo_indices);
-                        gles_glBufferData(GL_ELEMENT_ARRAY_BUFFER, list->ilen*sizeof(GL_UNSIGNED_SHORT), indices, GL_STATIC_DRAW);
+                        gles_glBufferData(GL_ELEMENT_ARRAY_BUFFER, list->ilen*gl_sizeof(itype), draw_indices, GL_STATIC_DRAW);
+                        if(sorted)
+                            free(sorted);
                         use_vbo_indices = 2;
-                        vbo_indices = 1;
+                        draw_indices = NULL;
                     } else if(use_vbo_indices==2) {
+                        if(list->len<=65536)
+                            itype = GL_UNSIGNED_SHORT;
                         bindBuffer(GL_ELEMENT_ARRAY_BUFFER, list->vbo_indices);
-                        vbo_indices = 1;
-                    } else
-                        realize_bufferIndex();
+                        draw_indices = NULL;
+                    } else {
+                        if(!hardext.elementuint) {
+                            itype = GL_UNSIGNED_SHORT;
+                            draw_indices = list_narrowIndices(indices, list->ilen);
+                        }
+                        GLintptr stream_indices = -1;
+                        if(use_vbo_array==3)
+                            stream_indices = gl4es_stream_indices(list->ilen*gl_sizeof(itype), draw_indices);
+                        if(stream_indices>=0)
+                            draw_indices = (GLvoid*)stream_indices; // ring VBO is bound, draw with offset
+                        else
+                            realize_bufferIndex();
+                    }
                     if(list->instanceCount==1)
-                        gles_glDrawElements(mode, list->ilen, GL_UNSIGNED_SHORT, vbo_indices?NULL:indices);
+                        gles_glDrawElements(mode, list->ilen, itype, draw_indices);
                     else {
                         for (glstate->instanceID=0; glstate->instanceID<list->instanceCount; ++glstate->instanceID)
-                            gles_glDrawElements(mode, list->ilen, GL_UNSIGNED_SHORT, vbo_indices?NULL:indices);
+                            gles_glDrawElements(mode, list->ilen, itype, draw_indices);
                         glstate->instanceID = 0;
                     }
                     wantBufferIndex(0);
@@ -764,19 +925,19 @@ void draw_renderlist(renderlist_t *list) {
                 vtx.type = GL_FLOAT;
                 vtx.size = 4;
                 vtx.normalized = GL_FALSE;
-                vtx.stride = 0;
+                vtx.stride = list->vert_stride;
                 select_glDrawArrays(&vtx, list->mode, 0, list->len);
             } else {
                 int len = list->len;
                 if ((glstate->polygon_mode == GL_LINE) && (list->mode_init>=GL_TRIANGLES)) {
                     if(!list->ind_lines) {
-                        GLushort *ind_line = list->ind_lines = (GLushort*)malloc(sizeof(GLushort)*len*4+2);
+                        list->ind_lines = (GLuint*)malloc(sizeof(GLuint)*len*4+2);
                         modeinit_t tmp; tmp.mode_init = list->mode_init; tmp.ilen=len;
                         int k = fill_lineIndices(list->mode_inits?list->mode_inits:&tmp, list->mode_inits?list->mode_init_len:1, list->mode, NULL, list->ind_lines);
                         list->ind_line = k;
                     }
                     bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-					gles_glDrawElements(mode, list->ind_line, GL_UNSIGNED_SHORT, list->ind_lines);
+					list_drawElements(list, mode, list->ind_line, list->ind_lines);
                 } else {
                     if(list->instanceCount==1)
                         gles_glDrawArrays(mode, 0, len);
@@ -790,8 +951,10 @@ void draw_renderlist(renderlist_t *list) {
         }
         if(list->use_vbo_indices != use_vbo_indices)
             list->use_vbo_indices = use_vbo_indices;
-        if(use_vbo_array==2)
+        if(use_vbo_array>=2)
             listInactiveVBO(list, saved);
+        if(use_vbo_array==3)
+            list->vbo_array = 0;    // the ring VBO is not owned by the list
 
         #define TEXTURE(A) if (cur_tex!=A) {gl4es_glClientActiveTexture(A+GL_TEXTURE0); cur_tex=A;}
         if(hardext.esversion==1)
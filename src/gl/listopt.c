@@ -0,0 +1,529 @@
+#include "list.h"
+
+#include "../glx/hardext.h"
+#include "gl4es.h"
+#include "glstate.h"
+#include "init.h"
+#include "matvec.h"
+
+/*
+ * Display list optimizer, run once at glEndList (GLES2+ backend only)
+ *  1. state that is overwritten before the next draw is dropped (Matrix, BindTexture, ColorMaterial)
+ *  2. stages that have nothing left to do are removed
+ *  3. adjacent compatible draw stages are merged
+ *  4. triangle based primitives are converted to indexed GL_TRIANGLES, and duplicated vertices removed
+ */
+
+// stage content that needs the state as set before (unknown GL calls, attribute stack)
+static int opt_barrier(renderlist_t *list) {
+    return (list->calls.len || list->pushattribute || list->popattribute);
+}
+
+static int opt_isnop(renderlist_t *list) {
+    if (list->len || opt_barrier(list))
+        return 0;
+    if (list->matrix_op || list->raster_op || list->raster || list->bitmaps)
+        return 0;
+    if (list->material || list->colormat_face || list->light || list->lightmodel || list->texgen || list->texenv)
+        return 0;
+    if (list->fog_op || list->pointparam_op || list->render_op || list->linestipple_op || list->polygon_mode)
+        return 0;
+    if (list->set_texture || list->set_tmu)
+        return 0;
+    return 1;
+}
+
+static int opt_islines(renderlist_t *list) {
+    return (list->len && rendermode_dimensions(list->mode)==2);
+}
+
+// a is a stage without draw, directly followed by b
+static void opt_deadmatrix(renderlist_t *a, renderlist_t *b) {
+    if (!a->matrix_op || !b->matrix_op || opt_barrier(b))
+        return;
+    // what comes after the matrix in a must not depend on it (or on the active texture unit)
+    if (a->set_tmu || a->raster_op || a->raster || a->bitmaps || a->light || a->texgen)
+        return;
+    if (b->matrix_op==2) {
+        // glMultMatrix: fold a in b
+        matrix_mul(a->matrix_val, b->matrix_val, b->matrix_val);
+        b->matrix_op = a->matrix_op;
+    }
+    a->matrix_op = 0;
+}
+
+static void opt_deadtexture(renderlist_t *a, renderlist_t *b) {
+    if (!a->set_texture || !b->set_texture || opt_barrier(b))
+        return;
+    if (a->raster || a->bitmaps)
+        return;
+    if (a->tmu!=b->tmu || a->target_texture!=b->target_texture)
+        return;
+    a->set_texture = false;
+}
+
+static void opt_deadcolormat(renderlist_t *a, renderlist_t *b) {
+    if (!a->colormat_face || !b->colormat_face || opt_barrier(b) || b->material)
+        return;
+    if (a->colormat_face!=b->colormat_face && b->colormat_face!=GL_FRONT_AND_BACK)
+        return;
+    a->colormat_face = 0;
+}
+
+static void opt_state(renderlist_t *list) {
+    // dead state
+    for (renderlist_t *l = list; l && l->next; l = l->next)
+        if (!l->len) {
+            opt_deadmatrix(l, l->next);
+            opt_deadtexture(l, l->next);
+            opt_deadcolormat(l, l->next);
+        }
+    // state set again to the same value
+    int tex_known = 0, cm_known = 0;
+    int tex_tmu = 0;
+    GLenum tex_target = 0, cm_face = 0, cm_mode = 0;
+    GLuint tex_texture = 0;
+    for (renderlist_t *l = list; l; l = l->next) {
+        if (opt_barrier(l))
+            tex_known = cm_known = 0;
+        if (l->set_texture) {
+            if (tex_known && l->tmu==tex_tmu && l->target_texture==tex_target && l->texture==tex_texture)
+                l->set_texture = false;
+            else {
+                tex_known = 1;
+                tex_tmu = l->tmu;
+                tex_target = l->target_texture;
+                tex_texture = l->texture;
+            }
+        }
+        if (l->colormat_face) {
+            if (cm_known && l->colormat_face==cm_face && l->colormat_mode==cm_mode)
+                l->colormat_face = 0;
+            else {
+                cm_known = 1;
+                cm_face = l->colormat_face;
+                cm_mode = l->colormat_mode;
+            }
+        }
+        // raster and line stipple bind there own texture
+        if (l->raster || l->bitmaps || opt_islines(l))
+            tex_known = 0;
+    }
+}
+
+static renderlist_t* opt_unlink(renderlist_t *list, renderlist_t *l) {
+    // remove l from the chain, return the (maybe new) first stage
+    renderlist_t *next = l->next;
+    if (l->prev)
+        l->prev->next = next;
+    else
+        list = next;
+    if (next)
+        next->prev = l->prev;
+    l->next = l->prev = NULL;
+    free_renderlist(l);
+    return list;
+}
+
+static renderlist_t* opt_removenop(renderlist_t *list) {
+    renderlist_t *l = list;
+    while (l) {
+        renderlist_t *next = l->next;
+        if ((l->prev || next) && opt_isnop(l))
+            list = opt_unlink(list, l);
+        l = next;
+    }
+    return list;
+}
+
+static void opt_merge(renderlist_t *list) {
+    renderlist_t *l = list;
+    while (l && l->next) {
+        renderlist_t *b = l->next;
+        if (l->len && b->len && ispurerender_renderlist(b) && islistscompatible_renderlist(l, b)) {
+            append_renderlist(l, b);
+            opt_unlink(list, b);
+        } else
+            l = b;
+    }
+}
+
+static void opt_triangles(renderlist_t *list) {
+    if (!list->len || list->use_glstate || list->shared_arrays || list->shared_indices)
+        return;
+    // GL_QUAD_STRIP and GL_POLYGON keep there own layout, that polygon mode GL_LINE needs
+    switch (list->mode_init) {
+        case GL_TRIANGLES:
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+        case GL_QUADS:
+            break;
+        default:
+            return;
+    }
+    if (list->mode==GL_TRIANGLES && list->indices)
+        return;
+    if (rendermode_dimensions(list->mode)!=3 || list->mode==GL_QUAD_STRIP || list->mode==GL_POLYGON)
+        return;
+    if (list->mode_inits)
+        return;     // merged list are already indexed triangles
+    prepareadd_renderlist(list, 0);
+    list->mode = GL_TRIANGLES;
+}
+
+static inline uint32_t opt_hashvertex(GLfloat **arrays, const int *sizes, int n, int i) {
+    uint32_t h = 2166136261u;
+    for (int a=0; a<n; a++) {
+        const uint32_t *p = (const uint32_t*)(arrays[a]+i*sizes[a]);
+        for (int j=0; j<sizes[a]; j++)
+            h = (h ^ p[j]) * 16777619u;
+    }
+    return h;
+}
+
+static inline int opt_samevertex(GLfloat **arrays, const int *sizes, int n, int i, int j) {
+    for (int a=0; a<n; a++)
+        if (memcmp(arrays[a]+i*sizes[a], arrays[a]+j*sizes[a], sizes[a]*sizeof(GLfloat)))
+            return 0;
+    return 1;
+}
+
+static void opt_dedup(renderlist_t *list) {
+    if (!list->indices || list->len<2 || list->use_glstate || list->shared_arrays || list->shared_indices || list->interleaved)
+        return;
+    GLfloat *arrays[5+MAX_TEX];
+    int sizes[5+MAX_TEX];
+    int n = 0;
+    #define GO(A, S, STRIDE) if (A) { if (STRIDE) return; arrays[n] = A; sizes[n++] = S; }
+    GO(list->vert, 4, list->vert_stride);
+    GO(list->normal, 3, list->normal_stride);
+    GO(list->color, 4, list->color_stride);
+    GO(list->secondary, 4, list->secondary_stride);
+    GO(list->fogcoord, 1, list->fogcoord_stride);
+    for (int a=0; a<list->maxtex; a++)
+        GO(list->tex[a], 4, list->tex_stride[a]);
+    #undef GO
+    if (!n)
+        return;
+    const int len = list->len;
+    int hsize = 64;
+    while (hsize < len*2) hsize<<=1;
+    // hash of the kept vertices (index+1, 0 is empty), vertices are compacted in place
+    GLuint *hash = (GLuint*)calloc(hsize, sizeof(GLuint));
+    GLuint *remap = (GLuint*)malloc(len*sizeof(GLuint));
+    int newlen = 0;
+    for (int i=0; i<len; i++) {
+        uint32_t slot = opt_hashvertex(arrays, sizes, n, i) & (hsize-1);
+        while (hash[slot] && !opt_samevertex(arrays, sizes, n, hash[slot]-1, i))
+            slot = (slot+1) & (hsize-1);
+        if (hash[slot]) {
+            remap[i] = hash[slot]-1;
+        } else {
+            if (newlen!=i)
+                for (int a=0; a<n; a++)
+                    memcpy(arrays[a]+newlen*sizes[a], arrays[a]+i*sizes[a], sizes[a]*sizeof(GLfloat));
+            remap[i] = newlen;
+            hash[slot] = ++newlen;
+        }
+    }
+    if (newlen<len) {
+        for (int i=0; i<list->ilen; i++)
+            list->indices[i] = remap[list->indices[i]];
+        list->len = newlen;
+    }
+    free(remap);
+    free(hash);
+}
+
+renderlist_t* optimize_renderlist(renderlist_t *list) {
+    if (!list)
+        return list;
+    opt_state(list);
+    list = opt_removenop(list);
+    opt_merge(list);
+    for (renderlist_t *l = list; l; l = l->next) {
+        opt_triangles(l);
+        opt_dedup(l);
+    }
+    return list;
+}
+
+/*
+ * Reorder triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007)
+ * ind/ilen are the triangles, count the number of vertices, and cache the cache size to optimize for.
+ * Result is written to indices (ilen elements)
+ */
+void renderlist_vcache_triangles(GLuint *ind, int ilen, GLuint *indices, int count, int cache) {
+    const int ntri = ilen/3;
+    // triangles using each vertex
+    int *offset = (int*)calloc(count+1, sizeof(int));
+    for (int i=0; i<ntri*3; i++)
+        offset[ind[i]+1]++;
+    for (int v=0; v<count; v++)
+        offset[v+1] += offset[v];
+    int *live = (int*)malloc(count*sizeof(int));
+    int *cachetime = (int*)malloc(count*sizeof(int));
+    for (int v=0; v<count; v++) {
+        live[v] = offset[v+1]-offset[v];
+        cachetime[v] = offset[v];   // used as fill cursor first
+    }
+    int *adj = (int*)malloc(ntri*3*sizeof(int));
+    for (int t=0; t<ntri; t++)
+        for (int j=0; j<3; j++)
+            adj[cachetime[ind[t*3+j]]++] = t;
+    memset(cachetime, 0, count*sizeof(int));
+    char *emitted = (char*)calloc(ntri, 1);
+    int *deadend = (int*)malloc(ntri*3*sizeof(int));
+    int *cand = (int*)malloc(ntri*3*sizeof(int));
+    int ndead = 0;
+    int stamp = cache+1;
+    int cursor = 0;
+    int k = 0;
+    int f = 0;
+    while (f>=0) {
+        // emit all the triangles around f
+        int ncand = 0;
+        for (int a=offset[f]; a<offset[f+1]; a++) {
+            const int t = adj[a];
+            if (emitted[t])
+                continue;
+            for (int j=0; j<3; j++) {
+                const GLuint v = ind[t*3+j];
+                indices[k++] = v;
+                deadend[ndead++] = v;
+                cand[ncand++] = v;
+                live[v]--;
+                if (stamp-cachetime[v] > cache)
+                    cachetime[v] = stamp++;
+            }
+            emitted[t] = 1;
+        }
+        // next fanning vertex: the oldest one still in cache that will stay there
+        int best = -1, bestp = 0;
+        for (int c=0; c<ncand; c++) {
+            const int v = cand[c];
+            if (live[v]>0) {
+                int p = 0;
+                if (stamp-cachetime[v]+2*live[v] <= cache)
+                    p = stamp-cachetime[v];
+                if (p>bestp) {
+                    bestp = p;
+                    best = v;
+                }
+            }
+        }
+        if (best==-1) {
+            // dead-end: take a recent vertex, or the next one in input order
+            while (ndead && !live[deadend[ndead-1]])
+                ndead--;
+            if (ndead)
+                best = deadend[--ndead];
+            else {
+                while (cursor<count && !live[cursor])
+                    cursor++;
+                best = (cursor<count)?cursor:-1;
+            }
+        }
+        f = best;
+    }
+    // extra indices (not a full triangle) are kept as-is
+    for (int i=k; i<ilen; i++)
+        indices[i] = ind[i];
+    free(cand);
+    free(deadend);
+    free(emitted);
+    free(adj);
+    free(cachetime);
+    free(live);
+    free(offset);
+}
+
+/*
+ * glCallLists flattening: a sequence of lists called again and again (text rendering, scene graphs)
+ * is concatenated once in a single renderlist, then optimized like a regular list.
+ * Pure translations of the modelview (glyph advance...) are applied to the vertices so the draws merge.
+ */
+
+static int flat_istranslation(const GLfloat *m) {
+    // matrix_val is column major: translation is 12..14
+    for (int i=0; i<12; i++)
+        if (m[i] != ((i%5)?0.0f:1.0f))
+            return 0;
+    return (m[15]==1.0f);
+}
+
+// stage content that uses the modelview matrix when executed (not when drawn)
+static int flat_needsmatrix(renderlist_t *list) {
+    return (list->raster_op || list->light || list->texgen || opt_islines(list));
+}
+
+static void flat_translation(GLfloat *m, const GLfloat *t) {
+    set_identity(m);
+    m[12] = t[0]; m[13] = t[1]; m[14] = t[2];
+}
+
+static void flat_translate(renderlist_t *list, const GLfloat *t) {
+    if (!list->vert)
+        return;
+    unshared_renderlist(list, list->cap);
+    GLfloat *v = list->vert;
+    for (int i=0; i<list->len; i++, v+=4) {
+        v[0] += t[0]*v[3];
+        v[1] += t[1]*v[3];
+        v[2] += t[2]*v[3];
+    }
+}
+
+static void flat_bake(renderlist_t *list) {
+    GLfloat t[3] = {0.0f, 0.0f, 0.0f};
+    int pending = 0;
+    renderlist_t *l = list;
+    for (; l; l = l->next) {
+        if (opt_barrier(l)) {
+            // unknown calls can change anything (texgen, clip planes...), stop baking there
+            if (pending) {
+                renderlist_t *m = alloc_renderlist();
+                m->matrix_op = 2;
+                flat_translation(m->matrix_val, t);
+                m->prev = l->prev;
+                m->next = l;
+                l->prev->next = m;
+                l->prev = m;
+            }
+            return;
+        }
+        if (l->matrix_op==2 && flat_istranslation(l->matrix_val) && !flat_needsmatrix(l)) {
+            t[0] += l->matrix_val[12];
+            t[1] += l->matrix_val[13];
+            t[2] += l->matrix_val[14];
+            pending = 1;
+            l->matrix_op = 0;
+        } else if (l->matrix_op==1) {
+            t[0] = t[1] = t[2] = 0.0f;
+            pending = 0;
+        } else if (pending && (l->matrix_op || flat_needsmatrix(l))) {
+            GLfloat m[16];
+            flat_translation(m, t);
+            if (l->matrix_op)
+                matrix_mul(m, l->matrix_val, l->matrix_val);
+            else
+                memcpy(l->matrix_val, m, 16*sizeof(GLfloat));
+            l->matrix_op = 2;
+            t[0] = t[1] = t[2] = 0.0f;
+            pending = 0;
+        }
+        if (pending && l->len)
+            flat_translate(l, t);
+        if (!l->next)
+            break;
+    }
+    // the modelview must end as if all the lists were called
+    if (pending && l) {
+        renderlist_t *m = alloc_renderlist();
+        m->matrix_op = 2;
+        flat_translation(m->matrix_val, t);
+        m->prev = l;
+        l->next = m;
+    }
+}
+
+static renderlist_t* flatten_renderlists(renderlist_t **lists, int n, int bake) {
+    renderlist_t *flat = alloc_renderlist();
+    for (int i=0; i<n; i++)
+        if (lists[i])
+            append_calllist(flat, lists[i]);
+    // the copied stages are reopened so they can be merged (nothing to adjust on GLES2+)
+    for (renderlist_t *l = flat; l; l = l->next)
+        if (l->len)
+            l->open = true;
+    if (bake)
+        flat_bake(flat);
+    return optimize_renderlist(flat);
+}
+
+static renderlist_t* calllists_getlist(GLuint name) {
+    khint_t k = kh_get(gllisthead, glstate->headlists, name);
+    if (k != kh_end(glstate->headlists))
+        return kh_value(glstate->headlists, k);
+    return NULL;
+}
+
+// translations can be moved from the modelview to the vertices
+static int calllists_canbake() {
+    if (glstate->matrix_mode!=GL_MODELVIEW || glstate->glsl->program)
+        return 0;
+    for (int i=0; i<hardext.maxtex; i++)
+        if (glstate->enable.texgen_s[i] || glstate->enable.texgen_t[i] || glstate->enable.texgen_r[i] || glstate->enable.texgen_q[i])
+            return 0;
+    return 1;
+}
+
+calllists_cache_t* calllists_newcache() {
+    return (calllists_cache_t*)calloc(1, sizeof(calllists_cache_t));
+}
+
+static void calllists_freeentry(calllists_entry_t *e) {
+    free(e->names);
+    free_renderlist(e->flat);
+    memset(e, 0, sizeof(calllists_entry_t));
+}
+
+void calllists_freecache(calllists_cache_t *cache) {
+    if (!cache)
+        return;
+    for (int i=0; i<CALLLISTS_CACHE_SIZE; i++)
+        calllists_freeentry(&cache->entries[i]);
+    free(cache);
+}
+
+void calllists_invalidate(calllists_cache_t *cache, GLuint name) {
+    if (!cache)
+        return;
+    for (int i=0; i<CALLLISTS_CACHE_SIZE; i++) {
+        calllists_entry_t *e = &cache->entries[i];
+        for (int j=0; j<e->n; j++)
+            if (e->names[j]==name) {
+                calllists_freeentry(e);
+                break;
+            }
+    }
+}
+
+renderlist_t* calllists_get(calllists_cache_t *cache, const GLuint *names, int n) {
+    if (!cache || n<2 || n>CALLLISTS_MAX_LISTS)
+        return NULL;
+    const int bake = calllists_canbake();
+    uint32_t hash = 2166136261u ^ bake;
+    for (int i=0; i<n; i++)
+        hash = (hash ^ names[i]) * 16777619u;
+    calllists_entry_t *e = NULL;
+    calllists_entry_t *old = &cache->entries[0];
+    for (int i=0; i<CALLLISTS_CACHE_SIZE && !e; i++) {
+        calllists_entry_t *c = &cache->entries[i];
+        if (c->n==n && c->hash==hash && c->bake==bake && !memcmp(c->names, names, n*sizeof(GLuint)))
+            e = c;
+        else if (c->age < old->age)
+            old = c;
+    }
+    ++cache->age;
+    if (!e) {
+        // first time this sequence is seen: just remember it, one-shot strings are not worth flattening
+        calllists_freeentry(old);
+        old->names = (GLuint*)malloc(n*sizeof(GLuint));
+        memcpy(old->names, names, n*sizeof(GLuint));
+        old->n = n;
+        old->hash = hash;
+        old->bake = bake;
+        old->age = cache->age;
+        return NULL;
+    }
+    e->age = cache->age;
+    if (!e->flat) {
+        renderlist_t **lists = (renderlist_t**)malloc(n*sizeof(renderlist_t*));
+        for (int i=0; i<n; i++)
+            lists[i] = calllists_getlist(names[i]);
+        e->flat = flatten_renderlists(lists, n, bake);
+        free(lists);
+    }
+    return e->flat;
+}
@@ -54,6 +54,20 @@ static int update_current_identity(int I) {
 	}
 }
 
+static void builtin_changed_mat() {
+	switch(glstate->matrix_mode) {
+		case GL_MODELVIEW:
+			BUILTIN_CHANGED(BUILTIN_MV);
+			break;
+		case GL_PROJECTION:
+			BUILTIN_CHANGED(BUILTIN_P);
+			break;
+		case GL_TEXTURE:
+			BUILTIN_CHANGED(BUILTIN_T0+glstate->texture.active);
+			break;
+	}
+}
+
 static int send_to_hardware() {
 	if(hardext.esversion>1)
 		return 0;
@@ -214,6 +228,7 @@ DBG(printf("glPopMatrix(), list=%p\n", glstate->list.active);)
 			}
 		#undef P
 	}
+	builtin_changed_mat();
 }
 
 void gl4es_glLoadMatrixf(const GLfloat * m) {
@@ -229,6 +244,7 @@ DBG(printf("glLoadMatrix(%f, %f, %f, %f, %f, %f, %f...), list=%p\n", m[0], m[1],
 	}
 	memcpy(update_current_mat(), m, 16*sizeof(GLfloat));
 	const int id = update_current_identity(0);
+	builtin_changed_mat();
 	if(glstate->matrix_mode==GL_MODELVIEW)
 		glstate->normal_matrix_dirty = glstate->inv_mv_matrix_dirty = 1;
 	if(glstate->matrix_mode==GL_MODELVIEW || glstate->matrix_mode==GL_PROJECTION)
@@ -262,6 +278,7 @@ DBG(printf("glMultMatrix(%f, %f, %f, %f, %f, %f, %f...), list=%p\n", m[0], m[1],
 	GLfloat *current_mat = update_current_mat();
 	matrix_mul(current_mat, m, current_mat);
 	const int id = update_current_identity(0);
+	builtin_changed_mat();
 	if(glstate->matrix_mode==GL_MODELVIEW)
 		glstate->normal_matrix_dirty = glstate->inv_mv_matrix_dirty = 1;
 	if(glstate->matrix_mode==GL_MODELVIEW || glstate->matrix_mode==GL_PROJECTION)
@@ -290,6 +307,7 @@ DBG(printf("glLoadIdentity(), list=%p\n", glstate->list.active);)
 	}
 	set_identity(update_current_mat());
 	update_current_identity(1);
+	builtin_changed_mat();
 	if(glstate->matrix_mode==GL_MODELVIEW)
 		glstate->normal_matrix_dirty = glstate->inv_mv_matrix_dirty = 1;
 	if(glstate->matrix_mode==GL_MODELVIEW || glstate->matrix_mode==GL_PROJECTION)
@@ -2,37 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include "../config.h"
 #include "enum_info.h"
 #include "gl4es.h"
 #include "glstate.h"
 #include "debug.h"
+#include "pixel_pool.h"
+#include "pixel_simd.h"
 
-#ifdef __BIG_ENDIAN__
-#define GL_INT8_REV     GL_UNSIGNED_INT_8_8_8_8
-#define GL_INT8         GL_UNSIGNED_INT_8_8_8_8_REV
-#else
-#define GL_INT8_REV     GL_UNSIGNED_INT_8_8_8_8_REV
-#define GL_INT8         GL_UNSIGNED_INT_8_8_8_8
-#endif
-
-typedef union {
-    uint16_t bin;
-    struct {
-        uint16_t sign:1;
-        uint16_t exp:5;
-        uint16_t mant:10;
-    } x;
-} halffloat_t;
-
-typedef union {
-    float f;
-    uint32_t bin;
-    struct {
-        uint32_t sign:1;
-        uint32_t exp:8;
-        uint32_t mant:23;
-    } x;
-} fullfloat_t;
+typedef GLushort halffloat_t;
 
 static const colorlayout_t *get_color_map(GLenum format) {
     #define map(fmt, ...)                               \
@@ -61,55 +39,6 @@ static const colorlayout_t *get_color_map(GLenum format) {
     #undef map
 }
 
-static inline float float_h2f(halffloat_t t)
-{
-    fullfloat_t tmp;
-    tmp.x.sign = t.x.sign;  // copy sign
-    if(t.x.exp==0 /*&& t.mant==0*/) {
-    // 0 and denormal?
-        tmp.x.exp=0;
-        tmp.x.mant=0;
-    } else if (t.x.exp==31) {
-    // Inf / NaN
-        tmp.x.exp=255;
-        tmp.x.mant=(t.x.mant<<13);
-    } else {
-        tmp.x.mant=(t.x.mant<<13);
-        tmp.x.exp = t.x.exp+0x38;
-    }
-
-    return tmp.f;
-}
-
-static inline halffloat_t float_f2h(float f)
-{
-    fullfloat_t tmp;
-    halffloat_t ret;
-    tmp.f = f;
-    ret.x.sign = tmp.x.sign;
-    if (tmp.x.exp == 0) {
-        // O and denormal
-        ret.bin = 0;
-    } else if (tmp.x.exp==255) {
-        // Inf / NaN
-        ret.x.exp = 31;
-        ret.x.mant = tmp.x.mant>>13;
-    } else if(tmp.x.exp>0x71) {
-        // flush to 0
-        ret.x.exp = 0;
-        ret.x.mant = 0;
-    } else if(tmp.x.exp<0x8e) {
-        // clamp to max
-        ret.x.exp = 30;
-        ret.x.mant = 1023;
-    } else {
-        ret.x.exp = tmp.x.exp - 38;
-        ret.x.mant = tmp.x.mant>>13;
-    }
-
-    return ret;
-}
-
 static inline
 bool remap_pixel(const GLvoid *src, GLvoid *dst,
                  const colorlayout_t *src_color, GLenum src_type,
@@ -152,7 +81,7 @@ bool remap_pixel(const GLvoid *src, GLvoid *dst,
     switch (src_type) {
         type_case(GL_DOUBLE, GLdouble, read_each(,,))
         type_case(GL_FLOAT, GLfloat, read_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,float_h2f))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,pixel_h2f))
         type_case(GL_BYTE, GLbyte, read_each(, / 128.0f,))
         case GL_INT8_REV:
         type_case(GL_UNSIGNED_BYTE, GLubyte, read_each(, / 255.0f,))
@@ -227,7 +156,7 @@ bool remap_pixel(const GLvoid *src, GLvoid *dst,
     }
     switch (dst_type) {
         type_case(GL_FLOAT, GLfloat, write_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,float_f2h))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,pixel_f2h))
         type_case(GL_BYTE, GLbyte, write_each(, * 127.0f,))
         type_case(GL_UNSIGNED_BYTE, GLubyte, write_each(, * 255.0,))
         type_case(GL_UNSIGNED_SHORT, GLushort, write_each(, / 65535.0f,))
@@ -338,7 +267,7 @@ bool transform_pixel(const GLvoid *src, GLvoid *dst,
     switch (src_type) {
         type_case(GL_DOUBLE, GLdouble, read_each(,,))
         type_case(GL_FLOAT, GLfloat, read_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,float_h2f))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,pixel_h2f))
         case GL_INT8_REV:
         type_case(GL_UNSIGNED_BYTE, GLubyte, read_each(, / 255.0f,))
         type_case(GL_UNSIGNED_SHORT, GLushort, read_each(, / 65535.0f,))
@@ -382,7 +311,7 @@ bool transform_pixel(const GLvoid *src, GLvoid *dst,
 
     switch (src_type) {
         type_case(GL_FLOAT, GLfloat, write_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,float_f2h))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,pixel_f2h))
         type_case(GL_UNSIGNED_BYTE, GLubyte, write_each(, * 255.0,))
         type_case(GL_UNSIGNED_SHORT, GLushort, write_each(, / 65535.0f,))
         type_case(GL_INT8_REV, GLubyte, write_each(, * 255.0,))
@@ -492,7 +421,7 @@ bool half_pixel(const GLvoid *src0, const GLvoid *src1,
     switch (src_type) {
         type_case(GL_DOUBLE, GLdouble, read_each(,,))
         type_case(GL_FLOAT, GLfloat, read_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,float_h2f))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,pixel_h2f))
         case GL_INT8_REV:
         type_case(GL_UNSIGNED_BYTE, GLubyte, read_each(, / 255.0f,))
         type_case(GL_UNSIGNED_SHORT, GLushort, read_each(, / 65535.0f,))
@@ -542,7 +471,7 @@ bool half_pixel(const GLvoid *src0, const GLvoid *src1,
 
     switch (src_type) {
         type_case(GL_FLOAT, GLfloat, write_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,float_f2h))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,pixel_f2h))
         type_case(GL_UNSIGNED_BYTE, GLubyte, write_each(, * 255.0,))
         type_case(GL_UNSIGNED_SHORT, GLushort, write_each(, / 65535.0f,))
         type_case(GL_INT8_REV, GLubyte, write_each(, * 255.0,))
@@ -660,7 +589,7 @@ bool quarter_pixel(const GLvoid *src[16],
     switch (src_type) {
         type_case(GL_DOUBLE, GLdouble, read_each(,,))
         type_case(GL_FLOAT, GLfloat, read_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,float_h2f))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, read_each(,,pixel_h2f))
         case GL_INT8_REV:
         type_case(GL_UNSIGNED_BYTE, GLubyte, read_each(, / 255.0f,))
         type_case(GL_UNSIGNED_SHORT, GLushort, read_each(, / 65535.0f,))
@@ -710,7 +639,7 @@ bool quarter_pixel(const GLvoid *src[16],
 
     switch (src_type) {
         type_case(GL_FLOAT, GLfloat, write_each(,,))
-        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,float_f2h))
+        type_case(GL_HALF_FLOAT_OES, halffloat_t, write_each(,,pixel_f2h))
         type_case(GL_UNSIGNED_BYTE, GLubyte, write_each(, * 255.0,))
         type_case(GL_UNSIGNED_SHORT, GLushort, write_each(, / 65535.0f,))
         type_case(GL_INT8_REV, GLubyte, write_each(, * 255.0,))
@@ -763,6 +692,38 @@ bool quarter_pixel(const GLvoid *src[16],
     #undef write_each
 }
 
+// a pixel_convert, shared by the bands of rows
+typedef struct {
+    pixel_row_t row;        // specialized kernel, or NULL for remap_pixel
+    const colorlayout_t *src_color, *dst_color;
+    GLenum src_type, dst_type;
+    uintptr_t src, dst;
+    GLuint width;
+    GLuint src_pitch, dst_pitch;
+    GLsizei src_stride, dst_stride;
+} convert_job_t;
+
+static void convert_band(void *arg, GLuint y0, GLuint y1) {
+    const convert_job_t *job = (const convert_job_t *)arg;
+    uintptr_t src_pos = job->src + (uintptr_t)y0*job->src_pitch;
+    uintptr_t dst_pos = job->dst + (uintptr_t)y0*job->dst_pitch;
+    for (GLuint i = y0; i < y1; i++) {
+        if (job->row) {
+            job->row((const GLvoid *)src_pos, (GLvoid *)dst_pos, job->width);
+        } else {
+            uintptr_t s = src_pos, d = dst_pos;
+            for (int j = 0; j < job->width; j++) {
+                remap_pixel((const GLvoid *)s, (GLvoid *)d,
+                                job->src_color, job->src_type, job->dst_color, job->dst_type);
+                s += job->src_stride;
+                d += job->dst_stride;
+            }
+        }
+        src_pos += job->src_pitch;
+        dst_pos += job->dst_pitch;
+    }
+}
+
 bool pixel_convert(const GLvoid *src, GLvoid **dst,
                    GLuint width, GLuint height,
                    GLenum src_format, GLenum src_type,
@@ -810,352 +771,22 @@ bool pixel_convert(const GLvoid *src, GLvoid **dst,
         *dst = malloc(dst_size);
     uintptr_t src_pos = widthalign((uintptr_t)src, align);
     uintptr_t dst_pos = widthalign((uintptr_t)*dst, align);
-    // fast optimized loop for common conversion cases first...
-    // TODO: Rewrite that with some Macro, it's obviously doable to simplify the reading (and writting) of all this
-    // simple BGRA <-> RGBA / UNSIGNED_BYTE 
-    if ((((src_format == GL_BGRA) && (dst_format == GL_RGBA)) || ((src_format == GL_RGBA) && (dst_format == GL_BGRA))) 
-        && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				tmp = *(const GLuint*)src_pos;
-                #ifdef __BIG_ENDIAN__
-                *(GLuint*)dst_pos = (tmp&0x00ff00ff) | ((tmp&0x0000ff00)<<16) | ((tmp&0xff000000)>>16);
-                #else
-				*(GLuint*)dst_pos = (tmp&0xff00ff00) | ((tmp&0x00ff0000)>>16) | ((tmp&0x000000ff)<<16);
-                #endif
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGBA or BGRA with GL_INT_8_8_8_8 <-> GL_INT_8_8_8_8_REV
-    if((src_format==dst_format) && (src_format==GL_RGBA || src_format==GL_BGRA) && ((src_type==GL_INT8 && dst_type==GL_INT8_REV) || (src_type==GL_INT8_REV && dst_type==GL_INT8))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				((char*)dst_pos)[0] = ((char*)src_pos)[3];
-				((char*)dst_pos)[1] = ((char*)src_pos)[2];
-				((char*)dst_pos)[2] = ((char*)src_pos)[1];
-                ((char*)dst_pos)[3] = ((char*)src_pos)[0];
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    #ifdef __BIG_ENDIAN__
-    // RGBA or BGRA with GL_UNSIGNED_INT_8_8_8_8_REV <-> GL_UNSIGNED_BYTE
-    if((src_format==dst_format) && (src_format==GL_RGBA || src_format==GL_BGRA) && ((src_type==GL_UNSIGNED_INT_8_8_8_8_REV && dst_type==GL_UNSIGNED_BYTE) || (src_type==GL_UNSIGNED_BYTE && dst_type==GL_UNSIGNED_INT_8_8_8_8_REV))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				((char*)dst_pos)[0] = ((char*)src_pos)[3];
-				((char*)dst_pos)[1] = ((char*)src_pos)[2];
-				((char*)dst_pos)[2] = ((char*)src_pos)[1];
-                ((char*)dst_pos)[3] = ((char*)src_pos)[0];
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    #endif
-    // BGRA1555 -> RGBA5551
-    if ((src_format == GL_BGRA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_SHORT_5_5_5_1) && (src_type == GL_UNSIGNED_SHORT_1_5_5_5_REV)) {
-      GLushort tmp;
-      for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-          // invert 1555/BGRA to 5551/RGBA (0x1f / 0x3e0 / 7c00)
-          tmp=*(GLushort*)src_pos;
-          *(GLushort*)dst_pos = ((tmp&0x8000)>>15) | ((tmp&0x7fff)<<1);
-          src_pos += src_stride;
-          dst_pos += dst_stride;
-        }
-        dst_pos += dst_width;
-        src_pos += src_widthadj;
-      }
-      return true;
-    }
-    // L -> RGBA
-    if ((src_format == GL_LUMINANCE) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				//tmp = *(const GLuint*)src_pos;
-                unsigned char* byte_dst = (unsigned char*)dst_pos;
-                #ifdef __BIG_ENDIAN__
-                byte_dst[1] = byte_dst[2] = byte_dst[3] = *(GLubyte*)src_pos;
-                byte_dst[0] = 255;
-                #else
-                byte_dst[0] = byte_dst[1] = byte_dst[2] = *(GLubyte*)src_pos;
-                byte_dst[3] = 255;
-                #endif
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // L -> RGB
-    if ((src_format == GL_LUMINANCE) && (dst_format == GL_RGB) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				//tmp = *(const GLuint*)src_pos;
-                unsigned char* byte_dst = (unsigned char*)dst_pos;
-                byte_dst[0] = byte_dst[1] = byte_dst[2] = *(GLubyte*)src_pos;
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGBA -> LA
-    if ((src_format == GL_RGBA) && (dst_format == GL_LUMINANCE_ALPHA) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				//tmp = *(const GLuint*)src_pos;
-                unsigned char* byte_src = (unsigned char*)src_pos;
-                #ifdef __BIG_ENDIAN__
-                *(GLushort*)dst_pos = ((((int)byte_src[3])*77 + ((int)byte_src[2])*151 + ((int)byte_src[1])*28)&0xff00)>>8 | (byte_src[0]<<8);
-                #else
-                *(GLushort*)dst_pos = ((((int)byte_src[0])*77 + ((int)byte_src[1])*151 + ((int)byte_src[2])*28)&0xff00)>>8 | (byte_src[3]<<8);
-                #endif
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGRA -> LA
-    if ((src_format == GL_BGRA) && (dst_format == GL_LUMINANCE_ALPHA) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				//tmp = *(const GLuint*)src_pos;
-                unsigned char* byte_src = (unsigned char*)src_pos;
-                #ifdef __BIG_ENDIAN__
-                *(GLushort*)dst_pos = ((((int)byte_src[1])*77 + ((int)byte_src[2])*151 + ((int)byte_src[3])*28)&0xff00)>>8 | (byte_src[0]<<8);
-                #else
-                *(GLushort*)dst_pos = ((((int)byte_src[2])*77 + ((int)byte_src[1])*151 + ((int)byte_src[0])*28)&0xff00)>>8 | (byte_src[3]<<8);
-                #endif
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGB(A) -> L
-    if (((src_format == GL_RGBA)||(src_format == GL_RGB)) && (dst_format == GL_LUMINANCE) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				//tmp = *(const GLuint*)src_pos;
-                unsigned char* byte_src = (unsigned char*)src_pos;
-                #ifdef __BIG_ENDIAN__
-                *(unsigned char*)dst_pos = (((int)byte_src[3])*77 + ((int)byte_src[2])*151 + ((int)byte_src[1])*28)>>8;
-                #else
-                *(unsigned char*)dst_pos = (((int)byte_src[0])*77 + ((int)byte_src[1])*151 + ((int)byte_src[2])*28)>>8;
-                #endif
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGR(A) -> L
-    if (((src_format == GL_BGRA)||(src_format == GL_BGR)) && (dst_format == GL_LUMINANCE) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				//tmp = *(const GLuint*)src_pos;
-                unsigned char* byte_src = (unsigned char*)src_pos;
-                #ifdef __BIG_ENDIAN__
-                *(unsigned char*)dst_pos = (((int)byte_src[1])*77 + ((int)byte_src[2])*151 + ((int)byte_src[3])*28)>>8;
-                #else
-                *(unsigned char*)dst_pos = (((int)byte_src[2])*77 + ((int)byte_src[1])*151 + ((int)byte_src[0])*28)>>8;
-                #endif
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGR(A) -> RGB
-    if (((src_format == GL_BGR)||(src_format == GL_BGRA)) && (dst_format == GL_RGB) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				((char*)dst_pos)[0] = ((char*)src_pos)[2];
-				((char*)dst_pos)[1] = ((char*)src_pos)[1];
-				((char*)dst_pos)[2] = ((char*)src_pos)[0];
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGR -> RGBA
-    if (((src_format == GL_BGR)) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				((unsigned char*)dst_pos)[0] = ((unsigned char*)src_pos)[2];
-				((unsigned char*)dst_pos)[1] = ((unsigned char*)src_pos)[1];
-				((unsigned char*)dst_pos)[2] = ((unsigned char*)src_pos)[0];
-                ((unsigned char*)dst_pos)[3] = 255;
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGBA -> RGB
-    if ((src_format == GL_RGBA) && (dst_format == GL_RGB) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				((char*)dst_pos)[0] = ((char*)src_pos)[0];
-				((char*)dst_pos)[1] = ((char*)src_pos)[1];
-				((char*)dst_pos)[2] = ((char*)src_pos)[2];
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGB(A) -> RGB565
-    if (((src_format == GL_RGB)||(src_format == GL_RGBA)) && (dst_format == GL_RGB) && (dst_type == GL_UNSIGNED_SHORT_5_6_5) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				*(GLushort*)dst_pos = ((GLushort)(((char*)src_pos)[2]&0xf8)>>(3)) | ((GLushort)(((char*)src_pos)[1]&0xfc)<<(5-2)) | ((GLushort)(((char*)src_pos)[0]&0xf8)<<(11-3));
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGR(A) -> RGB565
-    if (((src_format == GL_BGR) || (src_format == GL_BGRA)) && (dst_format == GL_RGB) && (dst_type == GL_UNSIGNED_SHORT_5_6_5) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				*(GLushort*)dst_pos = ((GLushort)(((char*)src_pos)[0]&0xf8)>>(3)) | ((GLushort)(((char*)src_pos)[1]&0xfc)<<(5-2)) | ((GLushort)(((char*)src_pos)[2]&0xf8)<<(11-3));
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGBA -> RGBA5551
-    if ((src_format == GL_RGBA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_SHORT_5_5_5_1) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				*(GLushort*)dst_pos = ((GLushort)(((char*)src_pos)[2]&0xf8)>>(3-1)) | ((GLushort)(((char*)src_pos)[1]&0xf8)<<(5-2)) | ((GLushort)(((char*)src_pos)[0]&0xf8)<<(10-2)) | ((GLushort)(((char*)src_pos)[3])>>15);
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGRA -> RGBA5551
-    if ((src_format == GL_BGRA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_SHORT_5_5_5_1) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				*(GLushort*)dst_pos = ((GLushort)(((char*)src_pos)[0]&0xf8)>>(3-1)) | ((GLushort)(((char*)src_pos)[1]&0xf8)<<(5-2)) | ((GLushort)(((char*)src_pos)[2]&0xf8)<<(10-2)) | ((GLushort)(((char*)src_pos)[3])>>15);
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGBA -> RGBA4444
-    if ((src_format == GL_RGBA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_SHORT_4_4_4_4) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				*(GLushort*)dst_pos = ((GLushort)(((char*)src_pos)[3]&0xf0))>>(4) | ((GLushort)(((char*)src_pos)[2]&0xf0)) | ((GLushort)(((char*)src_pos)[1]&0xf0))<<(4) | ((GLushort)(((char*)src_pos)[0]&0xf0))<<(8);
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGRA -> RGBA4444
-    if ((src_format == GL_BGRA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_SHORT_4_4_4_4) && ((src_type == GL_UNSIGNED_BYTE))) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				*(GLushort*)dst_pos = ((GLushort)(((char*)src_pos)[3]&0xf0)>>(4)) | ((GLushort)(((char*)src_pos)[0]&0xf0)) | ((GLushort)(((char*)src_pos)[1]&0xf0)<<(4)) | ((GLushort)(((char*)src_pos)[2]&0xf0)<<(8));
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // BGRA4444 -> RGBA 
-    if ((src_format == GL_BGRA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_BYTE) && (src_type == GL_UNSIGNED_SHORT_4_4_4_4_REV)) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-                const GLushort pix = *(GLushort*)src_pos;
-                ((char*)dst_pos)[3] = ((pix>>12)&0x0f)<<4;
-                ((char*)dst_pos)[2] = ((pix>>8)&0x0f)<<4;
-                ((char*)dst_pos)[1] = ((pix>>4)&0x0f)<<4;
-                ((char*)dst_pos)[0] = ((pix)&0x0f)<<4;  
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
-        return true;
-    }
-    // RGBA5551 -> RGBA
-    if ((src_format == GL_RGBA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_BYTE) && (src_type == GL_UNSIGNED_SHORT_5_5_5_1)) {
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-                const GLushort pix = *(GLushort*)src_pos;
-                ((unsigned char*)dst_pos)[0] = ((pix>>11)&0x1f)<<3;
-                ((unsigned char*)dst_pos)[1] = ((pix>>6)&0x1f)<<3;
-                ((unsigned char*)dst_pos)[2] = ((pix>>1)&0x1f)<<3;
-                ((unsigned char*)dst_pos)[3] = ((pix)&0x01)?255:0;  
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
+    convert_job_t job = {0};
+    job.src_color = src_color;
+    job.dst_color = dst_color;
+    job.src_type = src_type;
+    job.dst_type = dst_type;
+    job.src = src_pos;
+    job.dst = dst_pos;
+    job.width = width;
+    job.src_pitch = src_width;
+    job.dst_pitch = dst_width2;
+    job.src_stride = src_stride;
+    job.dst_stride = dst_stride;
+    // specialized row conversion for the common cases first...
+    job.row = pixel_row_kernel(src_format, src_type, dst_format, dst_type, 0);
+    if (job.row) {
+        pixel_parallel(height, pixels, convert_band, &job);
         return true;
     }
 	if (! remap_pixel((const GLvoid *)src_pos, (GLvoid *)dst_pos,
@@ -1187,16 +818,7 @@ bool pixel_convert(const GLvoid *src, GLvoid **dst,
             src_pos += src_widthadj;
         }
     } else {
-        for (int i = 0; i < height; i++) {
-            for (int j = 0; j < width; j++) {
-                remap_pixel((const GLvoid *)src_pos, (GLvoid *)dst_pos,
-                                src_color, src_type, dst_color, dst_type);
-                src_pos += src_stride;
-                dst_pos += dst_stride;
-            }
-            dst_pos += dst_width;
-            src_pos += src_widthadj;
-        }
+        pixel_parallel(height, pixels, convert_band, &job);
     }
 	return true;
 }
@@ -1232,6 +854,49 @@ bool pixel_transform(const GLvoid *src, GLvoid **dst,
     return false;
 }
 
+// a scaling, shared by the bands of destination rows
+typedef struct {
+    uintptr_t src, dst;
+    GLuint width, height, new_width;
+    GLuint pixel_size;
+    const colorlayout_t *src_color;
+    GLenum type;
+    GLfloat ratiox, ratioy;     // pixel_scale
+    int dx, dy;                 // pixel_halfscale
+    int dxs[4], dys[4];         // pixel_quarterscale
+    pixel_half_t half;          // box filter kernel, if there is one for the format
+} scale_job_t;
+
+// one row of a half size image with a box filter kernel, a 1 pixel wide source is doubled first
+static void half_row(pixel_half_t half, const GLubyte *row0, const GLubyte *row1, GLubyte *dst,
+                     GLuint width, GLuint new_width, GLuint pixel_size) {
+    if(width>1) {
+        half(row0, row1, dst, new_width);
+        return;
+    }
+    GLubyte tmp0[8], tmp1[8];   // kernels are for 4 bytes pixels at most
+    memcpy(tmp0, row0, pixel_size); memcpy(tmp0+pixel_size, row0, pixel_size);
+    memcpy(tmp1, row1, pixel_size); memcpy(tmp1+pixel_size, row1, pixel_size);
+    half(tmp0, tmp1, dst, 1);
+}
+
+static void scale_band(void *arg, GLuint y0, GLuint y1) {
+    const scale_job_t *job = (const scale_job_t *)arg;
+    const GLuint pixel_size = job->pixel_size;
+    uintptr_t pos = job->dst + (uintptr_t)y0 * job->new_width * pixel_size;
+    uintptr_t pixel;
+    for (int y = y0; y < y1; y++) {
+        int oldy = y*job->ratioy; if(oldy>=job->height) oldy=job->height-1;
+        for (int x = 0; x < job->new_width; x++) {
+            int oldx = x*job->ratiox; if(oldx>=job->width) oldx=job->width-1;
+            pixel = job->src + (oldx +
+                          oldy * job->width) * pixel_size;
+            memcpy((GLvoid *)pos, (GLvoid *)pixel, pixel_size);
+            pos += pixel_size;
+        }
+    }
+}
+
 bool pixel_scale(const GLvoid *old, GLvoid **new,
                  GLuint width, GLuint height,
                  GLuint new_width, GLuint new_height,
@@ -1242,24 +907,55 @@ bool pixel_scale(const GLvoid *old, GLvoid **new,
     ratioy = ((float)height)/new_height;
     //printf("scaling %ux%u -> %ux%u (%f/%f)\n", width, height, new_width, new_height, ratiox, ratioy);
     GLvoid *dst;
-    uintptr_t src, pos, pixel;
 
     pixel_size = pixel_sizeof(format, type);
     dst = malloc(pixel_size * new_width * new_height);
-    src = (uintptr_t)old;
-    pos = (uintptr_t)dst;
-    for (int y = 0; y < new_height; y++) {
-        int oldy = y*ratioy; if(oldy>=height) oldy=height-1;
-        for (int x = 0; x < new_width; x++) {
-            int oldx = x*ratiox; if(oldx>=width) oldx=width-1;
-            pixel = src + (oldx +
-                          oldy * width) * pixel_size;
-            memcpy((GLvoid *)pos, (GLvoid *)pixel, pixel_size);
+    scale_job_t job = {0};
+    job.src = (uintptr_t)old;
+    job.dst = (uintptr_t)dst;
+    job.width = width;
+    job.height = height;
+    job.new_width = new_width;
+    job.pixel_size = pixel_size;
+    job.ratiox = ratiox;
+    job.ratioy = ratioy;
+    pixel_parallel(new_height, width * height, scale_band, &job);
+    *new = dst;
+    return true;
+}
+
+static void halfscale_band(void *arg, GLuint y0, GLuint y1) {
+    const scale_job_t *job = (const scale_job_t *)arg;
+    const GLuint pixel_size = job->pixel_size;
+    const GLuint width = job->width;
+    const uintptr_t src = job->src;
+    const int dx = job->dx, mx = dx + 1;
+    const int dy = job->dy, my = dy + 1;
+    uintptr_t pos = job->dst + (uintptr_t)y0 * job->new_width * pixel_size;
+    uintptr_t pix0, pix1, pix2, pix3;
+    if(job->half) {
+        for (int y = y0; y < y1; y++) {
+            pix0 = src + (y * my) * width * pixel_size;
+            half_row(job->half, (const GLubyte *)pix0, (const GLubyte *)(pix0 + dy * width * pixel_size), (GLubyte *)pos,
+                     width, job->new_width, pixel_size);
+            pos += job->new_width * pixel_size;
+        }
+        return;
+    }
+    for (int y = y0; y < y1; y++) {
+        for (int x = 0; x < job->new_width; x++) {
+            pix0 = src + ((x * mx) +
+                          (y * my) * width) * pixel_size;
+            pix1 = src + ((x * mx + dx) +
+                          (y * my) * width) * pixel_size;
+            pix2 = src + ((x * mx) +
+                          (y * my + dy) * width) * pixel_size;
+            pix3 = src + ((x * mx + dx) +
+                          (y * my + dy) * width) * pixel_size;
+            half_pixel((GLvoid *)pix0, (GLvoid *)pix1, (GLvoid *)pix2, (GLvoid *)pix3, (GLvoid *)pos, job->src_color, job->type);
             pos += pixel_size;
         }
     }
-    *new = dst;
-    return true;
 }
 
 bool pixel_halfscale(const GLvoid *old, GLvoid **new,
@@ -1308,20 +1004,18 @@ bool pixel_halfscale(const GLvoid *old, GLvoid **new,
         *new = dst;
         return 1;
     }
-    for (int y = 0; y < new_height; y++) {
-        for (int x = 0; x < new_width; x++) {
-            pix0 = src + ((x * mx) +
-                          (y * my) * width) * pixel_size;
-            pix1 = src + ((x * mx + dx) +
-                          (y * my) * width) * pixel_size;
-            pix2 = src + ((x * mx) +
-                          (y * my + dy) * width) * pixel_size;
-            pix3 = src + ((x * mx + dx) +
-                          (y * my + dy) * width) * pixel_size;
-            half_pixel((GLvoid *)pix0, (GLvoid *)pix1, (GLvoid *)pix2, (GLvoid *)pix3, (GLvoid *)pos, src_color, type);
-            pos += pixel_size;
-        }
-    }
+    scale_job_t job = {0};
+    job.src = src;
+    job.dst = pos;
+    job.width = width;
+    job.new_width = new_width;
+    job.pixel_size = pixel_size;
+    job.src_color = src_color;
+    job.type = type;
+    job.dx = dx;
+    job.dy = dy;
+    job.half = pixel_half_kernel(format, type, 0, 0);
+    pixel_parallel(new_height, width * height, halfscale_band, &job);
     *new = dst;
     return 1;
 }
@@ -1337,40 +1031,65 @@ bool pixel_thirdscale(const GLvoid *old, GLvoid **new,
         return false;
     }
 //    printf("LIBGL: halfscaling %ux%u -> %ux%u\n", width, height, new_width, new_height);
-    const colorlayout_t *src_color;
-    src_color = get_color_map(format);
     GLvoid *dst;
-    uintptr_t src, pos, pix0, pix1, pix2, pix3;
+    uintptr_t src, pos, pix0;
 
     pixel_size = pixel_sizeof(format, type);
     dest_size = pixel_sizeof(format, GL_UNSIGNED_SHORT_4_4_4_4);
     dst = malloc(dest_size * new_width * new_height);
     src = (uintptr_t)old;
     pos = (uintptr_t)dst;
-    const int dx = (width>1)?1:0;
-    const int mx = dx + 1;
-    const int dy = (height>1)?1:0;
-    const int my = dy + 1;
-    GLubyte tmp[4];
+    // halved in a temporary RGBA row, then packed
+    pixel_half_t half = pixel_half_kernel(format, type, 0, 0);
+    pixel_row_t pack = pixel_row_kernel(format, type, format, GL_UNSIGNED_SHORT_4_4_4_4, 0);
+    GLubyte *tmp = (GLubyte *)malloc(new_width * pixel_size);
     for (int y = 0; y < new_height; y++) {
-        for (int x = 0; x < new_width; x++) {
-            pix0 = src + ((x * mx) +
-                          (y * my) * width) * pixel_size;
-            pix1 = src + ((x * mx + dx) +
-                          (y * my) * width) * pixel_size;
-            pix2 = src + ((x * mx) +
-                          (y * my + dy) * width) * pixel_size;
-            pix3 = src + ((x * mx + dx) +
-                          (y * my + dy) * width) * pixel_size;
-            half_pixel((GLvoid *)pix0, (GLvoid *)pix1, (GLvoid *)pix2, (GLvoid *)pix3, (GLvoid *)tmp, src_color, type);
-            *((GLushort*)pos) = (((GLushort)tmp[0])&0xf0)<<8 | (((GLushort)tmp[1])&0xf0)<<4 | (((GLushort)tmp[2])&0xf0) | (((GLushort)tmp[3])>>4);
-            pos += dest_size;
-        }
+        pix0 = src + (y * 2) * width * pixel_size;
+        half((const GLvoid *)pix0, (const GLvoid *)(pix0 + width * pixel_size), tmp, new_width);
+        pack(tmp, (GLvoid *)pos, new_width);
+        pos += new_width * dest_size;
     }
+    free(tmp);
     *new = dst;
     return true;
 }
 
+static void quarterscale_band(void *arg, GLuint y0, GLuint y1) {
+    const scale_job_t *job = (const scale_job_t *)arg;
+    const GLuint pixel_size = job->pixel_size;
+    const GLuint width = job->width;
+    const uintptr_t src = job->src;
+    uintptr_t pos = job->dst + (uintptr_t)y0 * job->new_width * pixel_size;
+    uintptr_t pix[16];
+    if(job->half) {
+        // 2 half size rows, halved again
+        const GLuint pitch = width * pixel_size;
+        GLubyte *tmp0 = (GLubyte *)malloc(job->new_width * 2 * pixel_size * 2);
+        GLubyte *tmp1 = tmp0 + job->new_width * 2 * pixel_size;
+        for (int y = y0; y < y1; y++) {
+            const GLubyte *row = (const GLubyte *)src + (y * 4) * pitch;
+            job->half(row, row + pitch, tmp0, job->new_width * 2);
+            job->half(row + pitch * 2, row + pitch * 3, tmp1, job->new_width * 2);
+            job->half(tmp0, tmp1, (GLvoid *)pos, job->new_width);
+            pos += job->new_width * pixel_size;
+        }
+        free(tmp0);
+        return;
+    }
+    for (int y = y0; y < y1; y++) {
+        for (int x = 0; x < job->new_width; x++) {
+            for (int dx=0; dx<4; dx++) {
+                for (int dy=0; dy<4; dy++) {
+                    pix[dx+dy*4] = src + ((x * 4 + job->dxs[dx]) +
+                                          (y * 4 + job->dys[dy]) * width) * pixel_size;
+                }
+            }
+            quarter_pixel((const GLvoid **)pix, (GLvoid *)pos, job->src_color, job->type);
+            pos += pixel_size;
+        }
+    }
+}
+
 bool pixel_quarterscale(const GLvoid *old, GLvoid **new,
                  GLuint width, GLuint height,
                  GLenum format, GLenum type) {
@@ -1411,19 +1130,97 @@ bool pixel_quarterscale(const GLvoid *old, GLvoid **new,
         *new = dst;
         return 1;
     }
-    for (int y = 0; y < new_height; y++) {
-        for (int x = 0; x < new_width; x++) {
-            for (int dx=0; dx<4; dx++) {
-                for (int dy=0; dy<4; dy++) {
-                    pix[dx+dy*4] = src + ((x * 4 + dxs[dx]) +
-                                          (y * 4 + dys[dy]) * width) * pixel_size;
-                }
+    scale_job_t job = {0};
+    job.src = src;
+    job.dst = pos;
+    job.width = width;
+    job.new_width = new_width;
+    job.pixel_size = pixel_size;
+    job.src_color = src_color;
+    job.type = type;
+    memcpy(job.dxs, dxs, sizeof(dxs));
+    memcpy(job.dys, dys, sizeof(dys));
+    if(width>=4 && height>=4)
+        job.half = pixel_half_kernel(format, type, 0, 0);
+    pixel_parallel(new_height, width * height, quarterscale_band, &job);
+    *new = dst;
+    return true;
+}
+
+// a mipmap chain, the bands are blocks of rows of all the levels from first to last
+typedef struct {
+    pixel_half_t half;
+    GLuint pixel_size;
+    int first, last;
+    GLubyte *data[MAX_MIPMAP_LEVELS+1];     // data[0] is the source image
+    GLuint w[MAX_MIPMAP_LEVELS+1], h[MAX_MIPMAP_LEVELS+1];
+} mipmap_job_t;
+
+// block b is the rows b<<(last-k) to (b+1)<<(last-k) of level k: they only need the rows of level k-1 of the same block,
+// so a block goes down all the levels while its rows are still in the cache
+static void mipmap_band(void *arg, GLuint b0, GLuint b1) {
+    const mipmap_job_t *job = (const mipmap_job_t *)arg;
+    const GLuint pixel_size = job->pixel_size;
+    for (int k = job->first; k <= job->last; k++) {
+        const int shift = job->last - k;
+        GLuint y1 = b1 << shift;
+        if(y1 > job->h[k]) y1 = job->h[k];
+        const GLuint src_pitch = job->w[k-1] * pixel_size;
+        const GLuint dst_pitch = job->w[k] * pixel_size;
+        const GLuint dy = (job->h[k-1] > 1) ? src_pitch : 0;
+        for (GLuint y = b0 << shift; y < y1; y++) {
+            const GLubyte *row = job->data[k-1] + (y * 2) * src_pitch;
+            half_row(job->half, row, row + dy, job->data[k] + y * dst_pitch, job->w[k-1], job->w[k], pixel_size);
+        }
+    }
+}
+
+bool pixel_mipmaps(const GLvoid *src, GLvoid **levels, int nlevels,
+                   GLuint width, GLuint height,
+                   GLenum format, GLenum type, int srgb) {
+    if(!src || nlevels<1 || nlevels>MAX_MIPMAP_LEVELS)
+        return false;
+    mipmap_job_t job = {0};
+    job.pixel_size = pixel_sizeof(format, type);
+    job.w[0] = width;
+    job.h[0] = height;
+    size_t size = 0;
+    for (int k = 1; k <= nlevels; k++) {
+        job.w[k] = (job.w[k-1] > 1) ? job.w[k-1] / 2 : 1;
+        job.h[k] = (job.h[k-1] > 1) ? job.h[k-1] / 2 : 1;
+        size += (size_t)job.w[k] * job.h[k] * job.pixel_size;
+    }
+    if(!size)
+        return false;
+    GLubyte *dst = (GLubyte *)malloc(size);
+    job.data[0] = (GLubyte *)src;
+    for (int k = 1; k <= nlevels; k++) {
+        job.data[k] = (k == 1) ? dst : job.data[k-1] + job.w[k-1] * job.h[k-1] * job.pixel_size;
+        levels[k-1] = job.data[k];
+    }
+    const colorlayout_t *src_color = get_color_map(format);
+    if(src_color->type)
+        job.half = pixel_half_kernel(format, type, srgb, 0);
+    if(!job.half) {
+        // no kernel, level by level then
+        for (int k = 1; k <= nlevels; k++) {
+            GLvoid *out = NULL;
+            if(!pixel_halfscale(job.data[k-1], &out, job.w[k-1], job.h[k-1], format, type)) {
+                free(dst);
+                return false;
             }
-            quarter_pixel((const GLvoid **)pix, (GLvoid *)pos, src_color, type);
-            pos += pixel_size;
+            memcpy(job.data[k], out, job.w[k] * job.h[k] * job.pixel_size);
+            free(out);
         }
+        return true;
+    }
+    for (job.first = 1; job.first <= nlevels; job.first = job.last + 1) {
+        job.last = job.first + MIPMAP_BLOCK_LEVELS - 1;
+        if(job.last > nlevels)
+            job.last = nlevels;
+        const GLuint rows = 1 << (job.last - job.first);     // of level first, per block
+        pixel_parallel((job.h[job.first] + rows - 1) / rows, job.w[job.first-1] * job.h[job.first-1], mipmap_band, &job);
     }
-    *new = dst;
     return true;
 }
 
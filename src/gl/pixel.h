@@ -4,6 +4,14 @@
 #include <stdbool.h>
 #include "gles.h"
 
+#ifdef __BIG_ENDIAN__
+#define GL_INT8_REV     GL_UNSIGNED_INT_8_8_8_8
+#define GL_INT8         GL_UNSIGNED_INT_8_8_8_8_REV
+#else
+#define GL_INT8_REV     GL_UNSIGNED_INT_8_8_8_8_REV
+#define GL_INT8         GL_UNSIGNED_INT_8_8_8_8
+#endif
+
 typedef struct {
     GLenum type;
     GLint red, green, blue, alpha;
@@ -43,6 +51,12 @@ bool pixel_quarterscale(const GLvoid *src, GLvoid **dst,
                   GLuint width, GLuint height,
                   GLenum format, GLenum type);
 
+// levels 1 to nlevels of a width x height image (each one half the previous one, down to 1x1), box filtered in a single pass,
+// averaged in linear space if srgb is set. All the levels are in one allocation: only levels[0] must be freed.
+bool pixel_mipmaps(const GLvoid *src, GLvoid **levels, int nlevels,
+                  GLuint width, GLuint height,
+                  GLenum format, GLenum type, int srgb);
+
 bool pixel_doublescale(const GLvoid *src, GLvoid **dst,
                   GLuint width, GLuint height,
                   GLenum format, GLenum type);
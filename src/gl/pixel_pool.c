@@ -0,0 +1,137 @@
+#include "pixel_pool.h"
+
+#if !defined(__EMSCRIPTEN__) && !defined(AMIGAOS4)
+#include <pthread.h>
+#include <unistd.h>
+#define PIXEL_THREADS
+#endif
+
+#include "../config.h"
+#include "init.h"
+#include "logs.h"
+
+#ifndef PIXEL_THREADS
+// no thread, everything is done on the calling thread
+void pixel_parallel(GLuint height, GLuint pixels, pixel_band_t band, void *arg) {
+    band(arg, 0, height);
+}
+void pixel_pool_stop() {
+}
+#else
+
+static pthread_mutex_t pool_submit = PTHREAD_MUTEX_INITIALIZER;    // one image at a time
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;     // protects everything below
+static pthread_cond_t pool_work = PTHREAD_COND_INITIALIZER;        // new bands to process, or quit
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;        // the last band is finished
+static pthread_t pool_threads[TEXTHREADS_MAX];
+static int pool_size = 0;       // number of worker threads running
+static int pool_started = 0;
+static int pool_quit = 0;
+
+static struct {
+    pixel_band_t band;
+    void        *arg;
+    GLuint      height;
+    GLuint      rows;       // rows per band
+    int         nbands;     // 0 when idle
+    int         next;       // next band to process
+    int         done;       // bands finished
+} pool_job;
+
+// take the next band and process it, called with pool_mutex locked (and still locked on return)
+static void pool_runband() {
+    GLuint y0 = pool_job.rows*(pool_job.next++);
+    GLuint y1 = y0+pool_job.rows;
+    if(y1>pool_job.height)
+        y1 = pool_job.height;
+    pixel_band_t band = pool_job.band;
+    void *arg = pool_job.arg;
+    pthread_mutex_unlock(&pool_mutex);
+    band(arg, y0, y1);
+    pthread_mutex_lock(&pool_mutex);
+    if(++pool_job.done==pool_job.nbands)
+        pthread_cond_signal(&pool_done);
+}
+
+static void *pool_worker(void *arg) {
+    pthread_mutex_lock(&pool_mutex);
+    while(1) {
+        while(!pool_quit && pool_job.next>=pool_job.nbands)
+            pthread_cond_wait(&pool_work, &pool_mutex);
+        if(pool_quit)
+            break;
+        pool_runband();
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return NULL;
+}
+
+// called with pool_submit locked
+static void pool_start() {
+    pool_started = 1;
+    int n = globals4es.texthreads;
+    if(n<0) {
+        // auto: one worker per other core
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        n = (ncpu>1)?ncpu-1:0;
+    }
+    if(n>TEXTHREADS_MAX)
+        n = TEXTHREADS_MAX;
+    for (int i=0; i<n; ++i) {
+        if(pthread_create(&pool_threads[pool_size], NULL, pool_worker, NULL))
+            break;
+        ++pool_size;
+    }
+    SHUT_LOGD("%d worker thread(s) for the texture conversions\n", pool_size);
+}
+
+void pixel_parallel(GLuint height, GLuint pixels, pixel_band_t band, void *arg) {
+    if(!globals4es.texthreads || pixels<TEXTHREADS_MINPIXELS || height<2 || pthread_mutex_trylock(&pool_submit)) {
+        band(arg, 0, height);
+        return;
+    }
+    if(!pool_started)
+        pool_start();
+    if(!pool_size) {
+        pthread_mutex_unlock(&pool_submit);
+        band(arg, 0, height);
+        return;
+    }
+    // a few bands per thread, so a slow thread doesn't delay the whole image
+    int nbands = (pool_size+1)*4;
+    if(nbands>height)
+        nbands = height;
+    GLuint rows = (height+nbands-1)/nbands;
+    pthread_mutex_lock(&pool_mutex);
+    pool_job.band = band;
+    pool_job.arg = arg;
+    pool_job.height = height;
+    pool_job.rows = rows;
+    pool_job.nbands = (height+rows-1)/rows;
+    pool_job.next = 0;
+    pool_job.done = 0;
+    pthread_cond_broadcast(&pool_work);
+    // the calling thread works too
+    while(pool_job.next<pool_job.nbands)
+        pool_runband();
+    while(pool_job.done<pool_job.nbands)
+        pthread_cond_wait(&pool_done, &pool_mutex);
+    pool_job.nbands = 0;
+    pool_job.next = 0;
+    pthread_mutex_unlock(&pool_mutex);
+    pthread_mutex_unlock(&pool_submit);
+}
+
+void pixel_pool_stop() {
+    pthread_mutex_lock(&pool_submit);
+    pthread_mutex_lock(&pool_mutex);
+    pool_quit = 1;
+    pthread_cond_broadcast(&pool_work);
+    pthread_mutex_unlock(&pool_mutex);
+    for (int i=0; i<pool_size; ++i)
+        pthread_join(pool_threads[i], NULL);
+    pool_size = 0;
+    pool_started = 1;   // don't restart
+    pthread_mutex_unlock(&pool_submit);
+}
+#endif
@@ -0,0 +1,21 @@
+#ifndef _GL4ES_PIXEL_POOL_H_
+#define _GL4ES_PIXEL_POOL_H_
+
+#include "gles.h"
+
+/*
+  Worker threads for the conversions of big textures (LIBGL_TEXTHREADS)
+
+  The rows of an image are split in bands, processed by the worker threads and the calling thread,
+  and pixel_parallel returns once all of them are done. Small images, or a pool already busy with
+  another image (from another context), are just processed on the calling thread.
+*/
+
+// process rows y0 to y1-1 (bands never overlap, so band must only write its own rows)
+typedef void (*pixel_band_t)(void *arg, GLuint y0, GLuint y1);
+
+// run band on rows 0 to height-1, pixels is the size of the image, to decide if it's worth splitting
+void pixel_parallel(GLuint height, GLuint pixels, pixel_band_t band, void *arg);
+void pixel_pool_stop();
+
+#endif // _GL4ES_PIXEL_POOL_H_
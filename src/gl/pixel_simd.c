@@ -0,0 +1,829 @@
+#include "pixel_simd.h"
+
+#include <math.h>
+#if !defined(__EMSCRIPTEN__) && !defined(AMIGAOS4)
+#include <pthread.h>
+#define SRGB_ONCE
+#endif
+
+#include "const.h"
+#include "enum_info.h"
+#include "pixel.h"
+
+#if !defined(__BIG_ENDIAN__)
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PIXEL_SSE2
+#define PIXEL_SIMD
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_NEON
+#define PIXEL_SIMD
+#endif
+#endif
+
+// scalar kernels, the formulas are the ones of the old fast paths of pixel_convert
+
+// BGRA <-> RGBA / UNSIGNED_BYTE
+static void swap_rb_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, s+=4, d+=4) {
+        uint32_t tmp;
+        memcpy(&tmp, s, 4);
+        #ifdef __BIG_ENDIAN__
+        tmp = (tmp&0x00ff00ff) | ((tmp&0x0000ff00)<<16) | ((tmp&0xff000000)>>16);
+        #else
+        tmp = (tmp&0xff00ff00) | ((tmp&0x00ff0000)>>16) | ((tmp&0x000000ff)<<16);
+        #endif
+        memcpy(d, &tmp, 4);
+    }
+}
+// GL_UNSIGNED_INT_8_8_8_8 <-> GL_UNSIGNED_INT_8_8_8_8_REV
+static void reverse32_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, s+=4, d+=4) {
+        d[0] = s[3];
+        d[1] = s[2];
+        d[2] = s[1];
+        d[3] = s[0];
+    }
+}
+// BGRA1555 -> RGBA5551
+static void bgra1555_rgba5551_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLushort *s = (const GLushort*)src;
+    GLushort *d = (GLushort*)dst;
+    for (GLuint i=0; i<width; ++i) {
+        GLushort tmp = s[i];
+        d[i] = ((tmp&0x8000)>>15) | ((tmp&0x7fff)<<1);
+    }
+}
+// L -> RGBA
+static void l_rgba_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, d+=4) {
+        #ifdef __BIG_ENDIAN__
+        d[1] = d[2] = d[3] = s[i];
+        d[0] = 255;
+        #else
+        d[0] = d[1] = d[2] = s[i];
+        d[3] = 255;
+        #endif
+    }
+}
+// L -> RGB
+static void l_rgb_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, d+=3)
+        d[0] = d[1] = d[2] = s[i];
+}
+// LA -> RGBA
+static void la_rgba_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, s+=2, d+=4) {
+        d[0] = d[1] = d[2] = s[0];
+        d[3] = s[1];
+    }
+}
+// RGB -> RGBA
+static void rgb_rgba_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, s+=3, d+=4) {
+        d[0] = s[0];
+        d[1] = s[1];
+        d[2] = s[2];
+        d[3] = 255;
+    }
+}
+// BGR -> RGBA
+static void bgr_rgba_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, s+=3, d+=4) {
+        d[0] = s[2];
+        d[1] = s[1];
+        d[2] = s[0];
+        d[3] = 255;
+    }
+}
+// RGBA -> RGB, BGR(A) -> RGB
+static inline void rgb_rgb(const GLubyte *s, GLubyte *d, GLuint width, int bpp, int swap)
+{
+    for (GLuint i=0; i<width; ++i, s+=bpp, d+=3) {
+        d[0] = s[swap?2:0];
+        d[1] = s[1];
+        d[2] = s[swap?0:2];
+    }
+}
+static void rgba_rgb_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_rgb(src, dst, width, 4, 0); }
+static void bgr_rgb_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_rgb(src, dst, width, 3, 1); }
+static void bgra_rgb_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_rgb(src, dst, width, 4, 1); }
+// RGBA / BGRA -> LA
+static inline void rgba_la(const GLubyte *s, GLushort *d, GLuint width, int swap)
+{
+    for (GLuint i=0; i<width; ++i, s+=4) {
+        #ifdef __BIG_ENDIAN__
+        const int r = s[swap?1:3], g = s[2], b = s[swap?3:1];
+        d[i] = (((r*77 + g*151 + b*28)&0xff00)>>8) | (s[0]<<8);
+        #else
+        const int r = s[swap?2:0], g = s[1], b = s[swap?0:2];
+        d[i] = (((r*77 + g*151 + b*28)&0xff00)>>8) | (s[3]<<8);
+        #endif
+    }
+}
+static void rgba_la_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgba_la(src, dst, width, 0); }
+static void bgra_la_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgba_la(src, dst, width, 1); }
+// RGB(A) / BGR(A) -> L
+static inline void rgb_l(const GLubyte *s, GLubyte *d, GLuint width, int bpp, int swap)
+{
+    for (GLuint i=0; i<width; ++i, s+=bpp) {
+        #ifdef __BIG_ENDIAN__
+        const int r = s[swap?1:3], g = s[2], b = s[swap?3:1];
+        #else
+        const int r = s[swap?2:0], g = s[1], b = s[swap?0:2];
+        #endif
+        d[i] = (r*77 + g*151 + b*28)>>8;
+    }
+}
+static void rgb_l_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_l(src, dst, width, 3, 0); }
+static void rgba_l_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_l(src, dst, width, 4, 0); }
+static void bgr_l_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_l(src, dst, width, 3, 1); }
+static void bgra_l_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_l(src, dst, width, 4, 1); }
+// RGB(A) / BGR(A) -> RGB565
+static inline void rgb_565(const GLubyte *s, GLushort *d, GLuint width, int bpp, int swap)
+{
+    for (GLuint i=0; i<width; ++i, s+=bpp) {
+        const GLushort r = s[swap?2:0], g = s[1], b = s[swap?0:2];
+        d[i] = ((r&0xf8)<<8) | ((g&0xfc)<<3) | ((b&0xf8)>>3);
+    }
+}
+static void rgb_565_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_565(src, dst, width, 3, 0); }
+static void rgba_565_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_565(src, dst, width, 4, 0); }
+static void bgr_565_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_565(src, dst, width, 3, 1); }
+static void bgra_565_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgb_565(src, dst, width, 4, 1); }
+// RGBA / BGRA -> RGBA5551
+static inline void rgba_5551(const GLubyte *s, GLushort *d, GLuint width, int swap)
+{
+    for (GLuint i=0; i<width; ++i, s+=4) {
+        const GLushort r = s[swap?2:0], g = s[1], b = s[swap?0:2], a = s[3];
+        d[i] = ((r&0xf8)<<8) | ((g&0xf8)<<3) | ((b&0xf8)>>2) | (a>>7);
+    }
+}
+static void rgba_5551_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgba_5551(src, dst, width, 0); }
+static void bgra_5551_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgba_5551(src, dst, width, 1); }
+// RGBA / BGRA -> RGBA4444
+static inline void rgba_4444(const GLubyte *s, GLushort *d, GLuint width, int swap)
+{
+    for (GLuint i=0; i<width; ++i, s+=4) {
+        const GLushort r = s[swap?2:0], g = s[1], b = s[swap?0:2], a = s[3];
+        d[i] = ((r&0xf0)<<8) | ((g&0xf0)<<4) | (b&0xf0) | ((a&0xf0)>>4);
+    }
+}
+static void rgba_4444_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgba_4444(src, dst, width, 0); }
+static void bgra_4444_c(const GLvoid *src, GLvoid *dst, GLuint width) { rgba_4444(src, dst, width, 1); }
+// BGRA4444 -> RGBA
+static void bgra4444_rgba_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLushort *s = (const GLushort*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, d+=4) {
+        const GLushort pix = s[i];
+        d[3] = ((pix>>12)&0x0f)<<4;
+        d[2] = ((pix>>8)&0x0f)<<4;
+        d[1] = ((pix>>4)&0x0f)<<4;
+        d[0] = ((pix)&0x0f)<<4;
+    }
+}
+// RGBA5551 -> RGBA
+static void rgba5551_rgba_c(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLushort *s = (const GLushort*)src;
+    GLubyte *d = (GLubyte*)dst;
+    for (GLuint i=0; i<width; ++i, d+=4) {
+        const GLushort pix = s[i];
+        d[0] = ((pix>>11)&0x1f)<<3;
+        d[1] = ((pix>>6)&0x1f)<<3;
+        d[2] = ((pix>>1)&0x1f)<<3;
+        d[3] = ((pix)&0x01)?255:0;
+    }
+}
+// float <-> half float, n components per pixel
+static inline void f2h(const GLfloat *s, GLushort *d, GLuint count)
+{
+    for (GLuint i=0; i<count; ++i)
+        d[i] = pixel_f2h(s[i]);
+}
+static void f2h1_c(const GLvoid *src, GLvoid *dst, GLuint width) { f2h(src, dst, width); }
+static void f2h2_c(const GLvoid *src, GLvoid *dst, GLuint width) { f2h(src, dst, width*2); }
+static void f2h3_c(const GLvoid *src, GLvoid *dst, GLuint width) { f2h(src, dst, width*3); }
+static void f2h4_c(const GLvoid *src, GLvoid *dst, GLuint width) { f2h(src, dst, width*4); }
+static inline void h2f(const GLushort *s, GLfloat *d, GLuint count)
+{
+    for (GLuint i=0; i<count; ++i)
+        d[i] = pixel_h2f(s[i]);
+}
+static void h2f1_c(const GLvoid *src, GLvoid *dst, GLuint width) { h2f(src, dst, width); }
+static void h2f2_c(const GLvoid *src, GLvoid *dst, GLuint width) { h2f(src, dst, width*2); }
+static void h2f3_c(const GLvoid *src, GLvoid *dst, GLuint width) { h2f(src, dst, width*3); }
+static void h2f4_c(const GLvoid *src, GLvoid *dst, GLuint width) { h2f(src, dst, width*4); }
+
+// SIMD kernels: the vector loop, then the scalar kernel for the remaining pixels
+
+#ifdef PIXEL_SSE2
+static inline __m128i load(const GLubyte *p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void store(GLubyte *p, __m128i v) { _mm_storeu_si128((__m128i*)p, v); }
+static inline __m128i v_set(uint32_t u) { return _mm_set1_epi32((int)u); }
+static inline __m128i v_or3(__m128i a, __m128i b, __m128i c) { return _mm_or_si128(_mm_or_si128(a, b), c); }
+// R and B swapped in 4 RGBA / BGRA pixels
+static inline __m128i v_swap_rb(__m128i x)
+{
+    const __m128i lo = v_set(0xff);
+    return v_or3(_mm_and_si128(x, v_set(0xff00ff00)), _mm_and_si128(_mm_srli_epi32(x, 16), lo), _mm_slli_epi32(_mm_and_si128(x, lo), 16));
+}
+// 32 bits lanes holding 16 bits values => 8 ushorts (sign extended so the saturation of packs does nothing)
+static inline __m128i v_pack16(__m128i a, __m128i b)
+{
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+}
+static inline __m128i v_565(__m128i x)
+{
+    return v_or3(_mm_slli_epi32(_mm_and_si128(x, v_set(0xf8)), 8), _mm_and_si128(_mm_srli_epi32(x, 5), v_set(0x7e0)),
+                 _mm_and_si128(_mm_srli_epi32(x, 19), v_set(0x1f)));
+}
+static inline __m128i v_5551(__m128i x)
+{
+    return _mm_or_si128(v_or3(_mm_slli_epi32(_mm_and_si128(x, v_set(0xf8)), 8), _mm_and_si128(_mm_srli_epi32(x, 5), v_set(0x7c0)),
+                 _mm_and_si128(_mm_srli_epi32(x, 18), v_set(0x3e))), _mm_srli_epi32(x, 31));
+}
+static inline __m128i v_4444(__m128i x)
+{
+    return _mm_or_si128(v_or3(_mm_slli_epi32(_mm_and_si128(x, v_set(0xf0)), 8), _mm_and_si128(_mm_srli_epi32(x, 4), v_set(0xf00)),
+                 _mm_and_si128(_mm_srli_epi32(x, 16), v_set(0xf0))), _mm_srli_epi32(x, 28));
+}
+static inline __m128i v_select(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+// same as pixel_f2h, on 4 floats (result in the 32 bits lanes)
+static inline __m128i v_f2h(const GLfloat *p)
+{
+    __m128i b = _mm_castps_si128(_mm_loadu_ps(p));
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(b, 16), v_set(0x8000));
+    __m128i x = _mm_and_si128(b, v_set(0x7fffffff));
+    __m128i r = _mm_add_epi32(_mm_add_epi32(x, v_set(0xfff)), _mm_and_si128(_mm_srli_epi32(x, 13), v_set(1)));
+    __m128i h = _mm_sub_epi32(_mm_srli_epi32(r, 13), v_set(112<<10));
+    // x and r are < 2^31, signed compares are fine
+    h = v_select(_mm_cmpgt_epi32(r, v_set((143u<<23)-1)), v_set(0x7bff), h);
+    h = _mm_andnot_si128(_mm_cmplt_epi32(r, v_set(113u<<23)), h);
+    __m128i nan = _mm_or_si128(v_set(0x7c00), _mm_and_si128(_mm_cmpgt_epi32(x, v_set(0x7f800000)), v_set(0x200)));
+    h = v_select(_mm_cmpgt_epi32(x, v_set(0x7f7fffff)), nan, h);
+    return _mm_or_si128(h, sign);
+}
+
+static void swap_rb_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+4<=width; i+=4, s+=16, d+=16)
+        store(d, v_swap_rb(load(s)));
+    swap_rb_c(s, d, width-i);
+}
+static void l_rgba_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    const __m128i ff = v_set(0xffffffff);
+    GLuint i = 0;
+    for (; i+16<=width; i+=16, s+=16, d+=64) {
+        __m128i x = load(s);
+        __m128i ll = _mm_unpacklo_epi8(x, x), la = _mm_unpacklo_epi8(x, ff);
+        store(d, _mm_unpacklo_epi16(ll, la));
+        store(d+16, _mm_unpackhi_epi16(ll, la));
+        ll = _mm_unpackhi_epi8(x, x); la = _mm_unpackhi_epi8(x, ff);
+        store(d+32, _mm_unpacklo_epi16(ll, la));
+        store(d+48, _mm_unpackhi_epi16(ll, la));
+    }
+    l_rgba_c(s, d, width-i);
+}
+static void la_rgba_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    const __m128i z = _mm_setzero_si128(), lo = v_set(0xff);
+    GLuint i = 0;
+    for (; i+8<=width; i+=8, s+=16, d+=32) {
+        __m128i x = load(s);
+        __m128i a = _mm_unpacklo_epi16(x, z), b = _mm_unpackhi_epi16(x, z);
+        __m128i la = _mm_and_si128(a, lo), lb = _mm_and_si128(b, lo);
+        store(d, v_or3(_mm_slli_epi32(a, 16), la, _mm_slli_epi32(la, 8)));
+        store(d+16, v_or3(_mm_slli_epi32(b, 16), lb, _mm_slli_epi32(lb, 8)));
+    }
+    la_rgba_c(s, d, width-i);
+}
+#define PACK16(name, conv, swap)                                            \
+static void name##_simd(const GLvoid *src, GLvoid *dst, GLuint width)      \
+{                                                                           \
+    const GLubyte *s = (const GLubyte*)src;                                 \
+    GLubyte *d = (GLubyte*)dst;                                             \
+    GLuint i = 0;                                                           \
+    for (; i+8<=width; i+=8, s+=32, d+=16) {                                \
+        __m128i a = load(s), b = load(s+16);                                \
+        if(swap) { a = v_swap_rb(a); b = v_swap_rb(b); }                    \
+        store(d, v_pack16(conv(a), conv(b)));                               \
+    }                                                                       \
+    name##_c(s, d, width-i);                                                \
+}
+PACK16(rgba_565, v_565, 0)
+PACK16(bgra_565, v_565, 1)
+PACK16(rgba_5551, v_5551, 0)
+PACK16(bgra_5551, v_5551, 1)
+PACK16(rgba_4444, v_4444, 0)
+PACK16(bgra_4444, v_4444, 1)
+#undef PACK16
+static inline void f2h_simd(const GLfloat *s, GLushort *d, GLuint count)
+{
+    GLuint i = 0;
+    for (; i+8<=count; i+=8)
+        _mm_storeu_si128((__m128i*)(d+i), v_pack16(v_f2h(s+i), v_f2h(s+i+4)));
+    f2h(s+i, d+i, count-i);
+}
+#endif // PIXEL_SSE2
+
+#ifdef PIXEL_NEON
+// same as pixel_f2h, on 4 floats (result in the 32 bits lanes)
+static inline uint32x4_t v_f2h(const GLfloat *p)
+{
+    uint32x4_t b = vreinterpretq_u32_f32(vld1q_f32(p));
+    uint32x4_t sign = vandq_u32(vshrq_n_u32(b, 16), vdupq_n_u32(0x8000));
+    uint32x4_t x = vandq_u32(b, vdupq_n_u32(0x7fffffff));
+    uint32x4_t r = vaddq_u32(vaddq_u32(x, vdupq_n_u32(0xfff)), vandq_u32(vshrq_n_u32(x, 13), vdupq_n_u32(1)));
+    uint32x4_t h = vsubq_u32(vshrq_n_u32(r, 13), vdupq_n_u32(112<<10));
+    h = vbslq_u32(vcgeq_u32(r, vdupq_n_u32(143u<<23)), vdupq_n_u32(0x7bff), h);
+    h = vbslq_u32(vcltq_u32(r, vdupq_n_u32(113u<<23)), vdupq_n_u32(0), h);
+    uint32x4_t nan = vorrq_u32(vdupq_n_u32(0x7c00), vandq_u32(vcgtq_u32(x, vdupq_n_u32(0x7f800000)), vdupq_n_u32(0x200)));
+    h = vbslq_u32(vcgeq_u32(x, vdupq_n_u32(0x7f800000)), nan, h);
+    return vorrq_u32(h, sign);
+}
+// 8 pixels from r,g,b,a planes (shift right and insert, the top bits of each component are kept)
+static inline uint16x8_t v_565(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint16x8_t v = vshll_n_u8(r, 8);
+    v = vsriq_n_u16(v, vshll_n_u8(g, 8), 5);
+    return vsriq_n_u16(v, vshll_n_u8(b, 8), 11);
+}
+static inline uint16x8_t v_5551(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint16x8_t v = vshll_n_u8(r, 8);
+    v = vsriq_n_u16(v, vshll_n_u8(g, 8), 5);
+    v = vsriq_n_u16(v, vshll_n_u8(b, 8), 10);
+    return vsriq_n_u16(v, vshll_n_u8(a, 8), 15);
+}
+static inline uint16x8_t v_4444(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint16x8_t v = vshll_n_u8(r, 8);
+    v = vsriq_n_u16(v, vshll_n_u8(g, 8), 4);
+    v = vsriq_n_u16(v, vshll_n_u8(b, 8), 8);
+    return vsriq_n_u16(v, vshll_n_u8(a, 8), 12);
+}
+
+static void swap_rb_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+16<=width; i+=16, s+=64, d+=64) {
+        uint8x16x4_t v = vld4q_u8(s);
+        uint8x16_t t = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = t;
+        vst4q_u8(d, v);
+    }
+    swap_rb_c(s, d, width-i);
+}
+static void l_rgba_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+16<=width; i+=16, s+=16, d+=64) {
+        uint8x16x4_t v;
+        v.val[0] = v.val[1] = v.val[2] = vld1q_u8(s);
+        v.val[3] = vdupq_n_u8(255);
+        vst4q_u8(d, v);
+    }
+    l_rgba_c(s, d, width-i);
+}
+static void la_rgba_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+16<=width; i+=16, s+=32, d+=64) {
+        uint8x16x2_t la = vld2q_u8(s);
+        uint8x16x4_t v;
+        v.val[0] = v.val[1] = v.val[2] = la.val[0];
+        v.val[3] = la.val[1];
+        vst4q_u8(d, v);
+    }
+    la_rgba_c(s, d, width-i);
+}
+static void rgb_rgba_simd(const GLvoid *src, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s = (const GLubyte*)src;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+16<=width; i+=16, s+=48, d+=64) {
+        uint8x16x3_t rgb = vld3q_u8(s);
+        uint8x16x4_t v;
+        v.val[0] = rgb.val[0];
+        v.val[1] = rgb.val[1];
+        v.val[2] = rgb.val[2];
+        v.val[3] = vdupq_n_u8(255);
+        vst4q_u8(d, v);
+    }
+    rgb_rgba_c(s, d, width-i);
+}
+#define PACK16(name, conv, r, b)                                            \
+static void name##_simd(const GLvoid *src, GLvoid *dst, GLuint width)      \
+{                                                                           \
+    const GLubyte *s = (const GLubyte*)src;                                 \
+    GLushort *d = (GLushort*)dst;                                           \
+    GLuint i = 0;                                                           \
+    for (; i+16<=width; i+=16, s+=64, d+=16) {                              \
+        uint8x16x4_t v = vld4q_u8(s);                                       \
+        vst1q_u16(d, conv(vget_low_u8(v.val[r]), vget_low_u8(v.val[1]),    \
+            vget_low_u8(v.val[b]), vget_low_u8(v.val[3])));                 \
+        vst1q_u16(d+8, conv(vget_high_u8(v.val[r]), vget_high_u8(v.val[1]), \
+            vget_high_u8(v.val[b]), vget_high_u8(v.val[3])));               \
+    }                                                                       \
+    name##_c(s, d, width-i);                                                \
+}
+PACK16(rgba_565, v_565, 0, 2)
+PACK16(bgra_565, v_565, 2, 0)
+PACK16(rgba_5551, v_5551, 0, 2)
+PACK16(bgra_5551, v_5551, 2, 0)
+PACK16(rgba_4444, v_4444, 0, 2)
+PACK16(bgra_4444, v_4444, 2, 0)
+#undef PACK16
+static inline void f2h_simd(const GLfloat *s, GLushort *d, GLuint count)
+{
+    GLuint i = 0;
+    for (; i+8<=count; i+=8)
+        vst1q_u16(d+i, vcombine_u16(vmovn_u32(v_f2h(s+i)), vmovn_u32(v_f2h(s+i+4))));
+    f2h(s+i, d+i, count-i);
+}
+#endif // PIXEL_NEON
+
+#ifdef PIXEL_SIMD
+static void f2h1_simd(const GLvoid *src, GLvoid *dst, GLuint width) { f2h_simd(src, dst, width); }
+static void f2h2_simd(const GLvoid *src, GLvoid *dst, GLuint width) { f2h_simd(src, dst, width*2); }
+static void f2h3_simd(const GLvoid *src, GLvoid *dst, GLuint width) { f2h_simd(src, dst, width*3); }
+static void f2h4_simd(const GLvoid *src, GLvoid *dst, GLuint width) { f2h_simd(src, dst, width*4); }
+#endif
+
+typedef struct {
+    GLenum src_format, src_type;
+    GLenum dst_format, dst_type;
+    pixel_row_t row;
+    pixel_row_t row_c;
+} pixel_kernel_t;
+
+#define C(sf, st, df, dt, k) {sf, st, df, dt, k##_c, k##_c}
+#ifdef PIXEL_SIMD
+#define S(sf, st, df, dt, k) {sf, st, df, dt, k##_simd, k##_c}
+#else
+#define S(sf, st, df, dt, k) C(sf, st, df, dt, k)
+#endif
+#ifdef PIXEL_NEON
+#define N(sf, st, df, dt, k) S(sf, st, df, dt, k)
+#else
+#define N(sf, st, df, dt, k) C(sf, st, df, dt, k)
+#endif
+#define UB GL_UNSIGNED_BYTE
+static const pixel_kernel_t kernels[] = {
+    S(GL_BGRA, UB, GL_RGBA, UB, swap_rb),
+    S(GL_RGBA, UB, GL_BGRA, UB, swap_rb),
+    C(GL_RGBA, GL_INT8, GL_RGBA, UB, reverse32),
+    C(GL_RGBA, UB, GL_RGBA, GL_INT8, reverse32),
+    C(GL_BGRA, GL_INT8, GL_BGRA, UB, reverse32),
+    C(GL_BGRA, UB, GL_BGRA, GL_INT8, reverse32),
+    C(GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, bgra1555_rgba5551),
+    S(GL_LUMINANCE, UB, GL_RGBA, UB, l_rgba),
+    C(GL_LUMINANCE, UB, GL_RGB, UB, l_rgb),
+    S(GL_LUMINANCE_ALPHA, UB, GL_RGBA, UB, la_rgba),
+    N(GL_RGB, UB, GL_RGBA, UB, rgb_rgba),
+    C(GL_BGR, UB, GL_RGBA, UB, bgr_rgba),
+    C(GL_RGBA, UB, GL_RGB, UB, rgba_rgb),
+    C(GL_BGR, UB, GL_RGB, UB, bgr_rgb),
+    C(GL_BGRA, UB, GL_RGB, UB, bgra_rgb),
+    C(GL_RGBA, UB, GL_LUMINANCE_ALPHA, UB, rgba_la),
+    C(GL_BGRA, UB, GL_LUMINANCE_ALPHA, UB, bgra_la),
+    C(GL_RGB, UB, GL_LUMINANCE, UB, rgb_l),
+    C(GL_RGBA, UB, GL_LUMINANCE, UB, rgba_l),
+    C(GL_BGR, UB, GL_LUMINANCE, UB, bgr_l),
+    C(GL_BGRA, UB, GL_LUMINANCE, UB, bgra_l),
+    C(GL_RGB, UB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, rgb_565),
+    S(GL_RGBA, UB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, rgba_565),
+    C(GL_BGR, UB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, bgr_565),
+    S(GL_BGRA, UB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, bgra_565),
+    S(GL_RGBA, UB, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, rgba_5551),
+    S(GL_BGRA, UB, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, bgra_5551),
+    S(GL_RGBA, UB, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, rgba_4444),
+    S(GL_BGRA, UB, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, bgra_4444),
+    C(GL_BGRA, GL_UNSIGNED_SHORT_4_4_4_4_REV, GL_RGBA, UB, bgra4444_rgba),
+    C(GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, GL_RGBA, UB, rgba5551_rgba),
+    S(GL_RGBA, GL_FLOAT, GL_RGBA, GL_HALF_FLOAT_OES, f2h4),
+    S(GL_RGB, GL_FLOAT, GL_RGB, GL_HALF_FLOAT_OES, f2h3),
+    S(GL_LUMINANCE_ALPHA, GL_FLOAT, GL_LUMINANCE_ALPHA, GL_HALF_FLOAT_OES, f2h2),
+    S(GL_RG, GL_FLOAT, GL_RG, GL_HALF_FLOAT_OES, f2h2),
+    S(GL_LUMINANCE, GL_FLOAT, GL_LUMINANCE, GL_HALF_FLOAT_OES, f2h1),
+    S(GL_ALPHA, GL_FLOAT, GL_ALPHA, GL_HALF_FLOAT_OES, f2h1),
+    S(GL_RED, GL_FLOAT, GL_RED, GL_HALF_FLOAT_OES, f2h1),
+    C(GL_RGBA, GL_HALF_FLOAT_OES, GL_RGBA, GL_FLOAT, h2f4),
+    C(GL_RGB, GL_HALF_FLOAT_OES, GL_RGB, GL_FLOAT, h2f3),
+    C(GL_LUMINANCE_ALPHA, GL_HALF_FLOAT_OES, GL_LUMINANCE_ALPHA, GL_FLOAT, h2f2),
+    C(GL_RG, GL_HALF_FLOAT_OES, GL_RG, GL_FLOAT, h2f2),
+    C(GL_LUMINANCE, GL_HALF_FLOAT_OES, GL_LUMINANCE, GL_FLOAT, h2f1),
+    C(GL_ALPHA, GL_HALF_FLOAT_OES, GL_ALPHA, GL_FLOAT, h2f1),
+    C(GL_RED, GL_HALF_FLOAT_OES, GL_RED, GL_FLOAT, h2f1),
+};
+#undef UB
+#undef N
+#undef S
+#undef C
+
+pixel_row_t pixel_row_kernel(GLenum src_format, GLenum src_type, GLenum dst_format, GLenum dst_type, int scalar)
+{
+    // a few dozen entries, looked up once per pixel_convert call (not per pixel) and without any state,
+    // so it can be used from several threads
+    for (int i=0; i<sizeof(kernels)/sizeof(kernels[0]); ++i) {
+        const pixel_kernel_t *k = kernels+i;
+        if(k->src_format==src_format && k->src_type==src_type && k->dst_format==dst_format && k->dst_type==dst_type)
+            return scalar?k->row_c:k->row;
+    }
+    return NULL;
+}
+
+// Half size box filter: each destination pixel is the rounded average of a 2x2 block, channel by channel.
+// Integer only, the same results as (a+b+c+d+2)/4 on each channel for all the variants.
+
+static inline void half_ub(const GLubyte *s0, const GLubyte *s1, GLubyte *d, GLuint width, int bpp)
+{
+    for (GLuint i=0; i<width; ++i, s0+=bpp*2, s1+=bpp*2, d+=bpp)
+        for (int k=0; k<bpp; ++k)
+            d[k] = (s0[k]+s0[k+bpp]+s1[k]+s1[k+bpp]+2)>>2;
+}
+static void half1_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) { half_ub(row0, row1, dst, width, 1); }
+static void half2_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) { half_ub(row0, row1, dst, width, 2); }
+static void half3_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) { half_ub(row0, row1, dst, width, 3); }
+static void half4_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) { half_ub(row0, row1, dst, width, 4); }
+// one field of packed 16 bits pixels
+static inline GLushort half_field(GLushort a, GLushort b, GLushort c, GLushort e, int shift, int mask)
+{
+    return ((((a>>shift)&mask)+((b>>shift)&mask)+((c>>shift)&mask)+((e>>shift)&mask)+2)>>2)<<shift;
+}
+#define HALF16(name, s0, m0, s1, m1, s2, m2, s3, m3)                                                \
+static void name##_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)             \
+{                                                                                                   \
+    const GLushort *a = (const GLushort*)row0, *b = (const GLushort*)row1;                          \
+    GLushort *d = (GLushort*)dst;                                                                   \
+    for (GLuint i=0; i<width; ++i, a+=2, b+=2)                                                      \
+        d[i] = half_field(a[0], a[1], b[0], b[1], s0, m0) | half_field(a[0], a[1], b[0], b[1], s1, m1) \
+             | half_field(a[0], a[1], b[0], b[1], s2, m2) | half_field(a[0], a[1], b[0], b[1], s3, m3); \
+}
+HALF16(half565, 11, 0x1f, 5, 0x3f, 0, 0x1f, 0, 0)
+HALF16(half5551, 11, 0x1f, 6, 0x1f, 1, 0x1f, 0, 0x01)
+HALF16(half4444, 12, 0x0f, 8, 0x0f, 4, 0x0f, 0, 0x0f)
+#undef HALF16
+
+// sRGB: the average is done on linear values (16 bits), alpha stays linear
+static GLushort srgb_lin[256];          // sRGB => linear
+static GLubyte lin_srgb[1<<14];         // linear (top 14 bits) => sRGB
+#ifdef SRGB_ONCE
+static pthread_once_t srgb_once = PTHREAD_ONCE_INIT;
+#endif
+static void srgb_fill()
+{
+    for (int i=0; i<(1<<14); ++i) {
+        float l = (i+0.5f)/(1<<14);
+        float s = (l<=0.0031308f)?l*12.92f:1.055f*powf(l, 1.f/2.4f)-0.055f;
+        lin_srgb[i] = (GLubyte)(s*255.f+0.5f);
+    }
+    for (int i=0; i<256; ++i) {
+        float s = i/255.f;
+        float l = (s<=0.04045f)?s/12.92f:powf((s+0.055f)/1.055f, 2.4f);
+        srgb_lin[i] = (GLushort)(l*65535.f+0.5f);
+    }
+}
+// filled once, several contexts (or a context and the pool workers) can get there at the same time
+static void srgb_tables()
+{
+#ifdef SRGB_ONCE
+    pthread_once(&srgb_once, srgb_fill);
+#else
+    // no thread here, a plain lazy fill is enough
+    if(!srgb_lin[255])
+        srgb_fill();
+#endif
+}
+static inline void half_srgb(const GLubyte *s0, const GLubyte *s1, GLubyte *d, GLuint width, int bpp)
+{
+    for (GLuint i=0; i<width; ++i, s0+=bpp*2, s1+=bpp*2, d+=bpp) {
+        for (int k=0; k<3; ++k)
+            d[k] = lin_srgb[(srgb_lin[s0[k]]+srgb_lin[s0[k+bpp]]+srgb_lin[s1[k]]+srgb_lin[s1[k+bpp]])>>4];
+        if(bpp==4)
+            d[3] = (s0[3]+s0[7]+s1[3]+s1[7]+2)>>2;
+    }
+}
+static void half3srgb_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) { half_srgb(row0, row1, dst, width, 3); }
+static void half4srgb_c(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) { half_srgb(row0, row1, dst, width, 4); }
+
+#ifdef PIXEL_SSE2
+// channels widened to 16 bits, the rows added
+static inline __m128i v_addrows_lo(__m128i a, __m128i b) { const __m128i z = _mm_setzero_si128(); return _mm_add_epi16(_mm_unpacklo_epi8(a, z), _mm_unpacklo_epi8(b, z)); }
+static inline __m128i v_addrows_hi(__m128i a, __m128i b) { const __m128i z = _mm_setzero_si128(); return _mm_add_epi16(_mm_unpackhi_epi8(a, z), _mm_unpackhi_epi8(b, z)); }
+// (sum+2)/4 on 2x8 ushorts, packed back to 16 bytes
+static inline __m128i v_avg4(__m128i a, __m128i b)
+{
+    const __m128i two = _mm_set1_epi16(2);
+    return _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(a, two), 2), _mm_srli_epi16(_mm_add_epi16(b, two), 2));
+}
+static void half1_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s0 = (const GLubyte*)row0, *s1 = (const GLubyte*)row1;
+    GLubyte *d = (GLubyte*)dst;
+    const __m128i lo = _mm_set1_epi16(0xff);
+    GLuint i = 0;
+    for (; i+16<=width; i+=16, s0+=32, s1+=32, d+=16) {
+        __m128i a = load(s0), b = load(s1);
+        __m128i x = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, lo), _mm_srli_epi16(a, 8)),
+                                  _mm_add_epi16(_mm_and_si128(b, lo), _mm_srli_epi16(b, 8)));
+        a = load(s0+16); b = load(s1+16);
+        __m128i y = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, lo), _mm_srli_epi16(a, 8)),
+                                  _mm_add_epi16(_mm_and_si128(b, lo), _mm_srli_epi16(b, 8)));
+        store(d, v_avg4(x, y));
+    }
+    half_ub(s0, s1, d, width-i, 1);
+}
+// LA: the pixels are the 32 bits elements of the widened registers
+static inline __m128i v_pairs32(__m128i lo, __m128i hi)
+{
+    lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+    hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+}
+static void half2_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s0 = (const GLubyte*)row0, *s1 = (const GLubyte*)row1;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+8<=width; i+=8, s0+=32, s1+=32, d+=16) {
+        __m128i a = load(s0), b = load(s1);
+        __m128i x = v_pairs32(v_addrows_lo(a, b), v_addrows_hi(a, b));
+        a = load(s0+16); b = load(s1+16);
+        __m128i y = v_pairs32(v_addrows_lo(a, b), v_addrows_hi(a, b));
+        store(d, v_avg4(x, y));
+    }
+    half_ub(s0, s1, d, width-i, 2);
+}
+// RGBA: the pixels are the 64 bits elements of the widened registers
+static void half4_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s0 = (const GLubyte*)row0, *s1 = (const GLubyte*)row1;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+4<=width; i+=4, s0+=32, s1+=32, d+=16) {
+        __m128i a = load(s0), b = load(s1);
+        __m128i p01 = v_addrows_lo(a, b), p23 = v_addrows_hi(a, b);
+        a = load(s0+16); b = load(s1+16);
+        __m128i p45 = v_addrows_lo(a, b), p67 = v_addrows_hi(a, b);
+        store(d, v_avg4(_mm_add_epi16(_mm_unpacklo_epi64(p01, p23), _mm_unpackhi_epi64(p01, p23)),
+                        _mm_add_epi16(_mm_unpacklo_epi64(p45, p67), _mm_unpackhi_epi64(p45, p67))));
+    }
+    half_ub(s0, s1, d, width-i, 4);
+}
+// 565: each field of the 2 rows added, then the pairs of pixels with madd
+static inline __m128i v_half565_field(__m128i a0, __m128i b0, __m128i a1, __m128i b1, int shift, int mask)
+{
+    const __m128i m = _mm_set1_epi16(mask), one = _mm_set1_epi16(1), two = _mm_set1_epi16(2);
+    __m128i x = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(a0, shift), m), _mm_and_si128(_mm_srli_epi16(b0, shift), m));
+    __m128i y = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(a1, shift), m), _mm_and_si128(_mm_srli_epi16(b1, shift), m));
+    x = _mm_packs_epi32(_mm_madd_epi16(x, one), _mm_madd_epi16(y, one));
+    return _mm_slli_epi16(_mm_srli_epi16(_mm_add_epi16(x, two), 2), shift);
+}
+static void half565_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)
+{
+    const GLushort *s0 = (const GLushort*)row0, *s1 = (const GLushort*)row1;
+    GLushort *d = (GLushort*)dst;
+    GLuint i = 0;
+    for (; i+8<=width; i+=8, s0+=16, s1+=16, d+=8) {
+        __m128i a0 = load((const GLubyte*)s0), a1 = load((const GLubyte*)(s0+8));
+        __m128i b0 = load((const GLubyte*)s1), b1 = load((const GLubyte*)(s1+8));
+        store((GLubyte*)d, v_or3(v_half565_field(a0, b0, a1, b1, 11, 0x1f), v_half565_field(a0, b0, a1, b1, 5, 0x3f),
+                                 v_half565_field(a0, b0, a1, b1, 0, 0x1f)));
+    }
+    half565_c(s0, s1, d, width-i);
+}
+#endif // PIXEL_SSE2
+
+#ifdef PIXEL_NEON
+// the channels are deinterleaved by vldN, so the same code for 1 to 4 bytes per pixel
+static void half1_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)
+{
+    const GLubyte *s0 = (const GLubyte*)row0, *s1 = (const GLubyte*)row1;
+    GLubyte *d = (GLubyte*)dst;
+    GLuint i = 0;
+    for (; i+8<=width; i+=8, s0+=16, s1+=16, d+=8)
+        vst1_u8(d, vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(vld1q_u8(s0)), vld1q_u8(s1)), 2));
+    half_ub(s0, s1, d, width-i, 1);
+}
+#define HALFN(n)                                                                            \
+static void half##n##_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width) \
+{                                                                                           \
+    const GLubyte *s0 = (const GLubyte*)row0, *s1 = (const GLubyte*)row1;                   \
+    GLubyte *d = (GLubyte*)dst;                                                             \
+    GLuint i = 0;                                                                           \
+    for (; i+8<=width; i+=8, s0+=16*n, s1+=16*n, d+=8*n) {                                  \
+        uint8x16x##n##_t a = vld##n##q_u8(s0), b = vld##n##q_u8(s1);                        \
+        uint8x8x##n##_t r;                                                                  \
+        for (int k=0; k<n; ++k)                                                             \
+            r.val[k] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[k]), b.val[k]), 2);         \
+        vst##n##_u8(d, r);                                                                  \
+    }                                                                                       \
+    half_ub(s0, s1, d, width-i, n);                                                         \
+}
+HALFN(2)
+HALFN(3)
+HALFN(4)
+#undef HALFN
+static void half565_simd(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width)
+{
+    const GLushort *s0 = (const GLushort*)row0, *s1 = (const GLushort*)row1;
+    GLushort *d = (GLushort*)dst;
+    const uint16x8_t m5 = vdupq_n_u16(0x1f), m6 = vdupq_n_u16(0x3f);
+    GLuint i = 0;
+    for (; i+8<=width; i+=8, s0+=16, s1+=16, d+=8) {
+        // even / odd pixels
+        uint16x8x2_t a = vld2q_u16(s0), b = vld2q_u16(s1);
+        uint16x8_t r = vaddq_u16(vaddq_u16(vshrq_n_u16(a.val[0], 11), vshrq_n_u16(a.val[1], 11)),
+                                 vaddq_u16(vshrq_n_u16(b.val[0], 11), vshrq_n_u16(b.val[1], 11)));
+        uint16x8_t g = vaddq_u16(vaddq_u16(vandq_u16(vshrq_n_u16(a.val[0], 5), m6), vandq_u16(vshrq_n_u16(a.val[1], 5), m6)),
+                                 vaddq_u16(vandq_u16(vshrq_n_u16(b.val[0], 5), m6), vandq_u16(vshrq_n_u16(b.val[1], 5), m6)));
+        uint16x8_t bl = vaddq_u16(vaddq_u16(vandq_u16(a.val[0], m5), vandq_u16(a.val[1], m5)),
+                                  vaddq_u16(vandq_u16(b.val[0], m5), vandq_u16(b.val[1], m5)));
+        vst1q_u16(d, vorrq_u16(vorrq_u16(vshlq_n_u16(vrshrq_n_u16(r, 2), 11), vshlq_n_u16(vrshrq_n_u16(g, 2), 5)), vrshrq_n_u16(bl, 2)));
+    }
+    half565_c(s0, s1, d, width-i);
+}
+#endif // PIXEL_NEON
+
+#ifdef PIXEL_SIMD
+#define HS(k) ((scalar)?k##_c:k##_simd)
+#else
+#define HS(k) k##_c
+#endif
+#ifdef PIXEL_NEON
+#define HN(k) HS(k)
+#else
+#define HN(k) k##_c
+#endif
+pixel_half_t pixel_half_kernel(GLenum format, GLenum type, int srgb, int scalar)
+{
+    switch(type) {
+        case GL_UNSIGNED_BYTE:
+        case GL_INT8_REV:
+        case GL_INT8:
+            // every byte is a channel, so only the size of the pixel matters (and where alpha is for sRGB)
+            switch(pixel_sizeof(format, GL_UNSIGNED_BYTE)) {
+                case 1: return HS(half1);
+                case 2: return HS(half2);
+                case 3:
+                    if(srgb) { srgb_tables(); return half3srgb_c; }
+                    return HN(half3);
+                case 4:
+                    if(srgb && type!=GL_INT8) { srgb_tables(); return half4srgb_c; }
+                    return HS(half4);
+            }
+            return NULL;
+        case GL_UNSIGNED_SHORT_5_6_5:
+            return HS(half565);
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return half5551_c;
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+            return half4444_c;
+    }
+    return NULL;
+}
+#undef HN
+#undef HS
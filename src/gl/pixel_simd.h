@@ -0,0 +1,60 @@
+#ifndef _GL4ES_PIXEL_SIMD_H_
+#define _GL4ES_PIXEL_SIMD_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "gles.h"
+
+// Row kernels used by pixel_convert for the common format / type pairs.
+// A kernel converts width packed pixels from src to dst (no alignment needed, src and dst don't overlap).
+// NEON or SSE2 is used for the hot pairs if the build target has it, a scalar loop otherwise.
+typedef void (*pixel_row_t)(const GLvoid *src, GLvoid *dst, GLuint width);
+
+// Kernel for (src_format, src_type) => (dst_format, dst_type), NULL if there is none (generic conversion then).
+// Types are the ones seen by pixel_convert: GL_INT8_REV already changed to GL_UNSIGNED_BYTE, GL_HALF_FLOAT to GL_HALF_FLOAT_OES.
+// With scalar set, the plain C version of the kernel is returned (same results, used by pixelbench).
+pixel_row_t pixel_row_kernel(GLenum src_format, GLenum src_type, GLenum dst_format, GLenum dst_type, int scalar);
+
+// Half size box filter kernels, used by the scalings and the mipmap generation.
+// A kernel averages the 2x2 blocks of 2 rows (2*width pixels each) into width pixels, with integer maths and rounding.
+typedef void (*pixel_half_t)(const GLvoid *row0, const GLvoid *row1, GLvoid *dst, GLuint width);
+
+// Kernel for (format, type), NULL if there is none. With srgb set, RGB(A) bytes are averaged in linear space (alpha stays linear).
+pixel_half_t pixel_half_kernel(GLenum format, GLenum type, int srgb, int scalar);
+
+// float => half float, round to nearest even, too big values are clamped to 65504, too small ones (and denormals) flushed to 0
+static inline GLushort pixel_f2h(GLfloat f)
+{
+    uint32_t b;
+    memcpy(&b, &f, sizeof(b));
+    uint32_t sign = (b>>16)&0x8000;
+    uint32_t x = b&0x7fffffff;
+    if(x>=0x7f800000)   // Inf / NaN
+        return sign|0x7c00|((x>0x7f800000)?0x200:0);
+    uint32_t r = x + 0xfff + ((x>>13)&1);
+    if(r>=(143u<<23))
+        return sign|0x7bff;
+    if(r<(113u<<23))
+        return sign;
+    return sign|((r>>13)-(112<<10));
+}
+
+// half float => float, denormals flushed to 0
+static inline GLfloat pixel_h2f(GLushort h)
+{
+    uint32_t sign = ((uint32_t)(h&0x8000))<<16;
+    uint32_t exp = (h>>10)&0x1f;
+    uint32_t mant = h&0x3ff;
+    uint32_t b;
+    if(exp==0)
+        b = sign;
+    else if(exp==31)    // Inf / NaN
+        b = sign|0x7f800000|(mant<<13);
+    else
+        b = sign|((exp+112)<<23)|(mant<<13);
+    GLfloat f;
+    memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+#endif // _GL4ES_PIXEL_SIMD_H_
@@ -26,6 +26,7 @@ void gl4es_glClipPlanef(GLenum plane, const GLfloat *equation)
     } else {    // TODO: should fist compute the clipplane and compare to stored one before sending to hardware
         int p = plane-GL_CLIP_PLANE0;
         matrix_vector(getInvMVMat(), equation, glstate->planes[p]); //Tested, seems ok
+        BUILTIN_CHANGED(BUILTIN_CLIPPLANES);
         noerrorShim();
     }
 }
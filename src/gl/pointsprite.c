@@ -107,6 +107,7 @@ void gl4es_glPointParameterfv(GLenum pname, const GLfloat * params)
             glstate->pointsprite.coordOrigin = *params;
             break;
     }
+    BUILTIN_CHANGED(BUILTIN_POINTSPRITE);
 
     LOAD_GLES_FPE(glPointParameterfv);
     errorGL();
@@ -122,6 +123,7 @@ void gl4es_glPointSize(GLfloat size) {
         return;
     }
     glstate->pointsprite.size = size;
+    BUILTIN_CHANGED(BUILTIN_POINTSPRITE);
     errorGL();
     LOAD_GLES_FPE(glPointSize);
     gles_glPointSize(size);
@@ -8,6 +8,7 @@
 #include "gl4es.h"
 #include "glstate.h"
 #include "loader.h"
+#include "shader_cache.h"
 #include "shaderconv.h"
 #include "fpe_shader.h"
 
@@ -157,9 +158,11 @@ void deleteProgram(program_t *glprogram, khint_t k_program) {
         kh_destroy(uniformlist, glprogram->uniform);
         glprogram->uniform = NULL;
     }
+    free(glprogram->uniformloc);
     // clean cache
     if(glprogram->cache.cache)
         free(glprogram->cache.cache);
+    free(glprogram->cache.gen);
     // clean fpe cache if it exist
     if(glprogram->fpe_cache)
         fpe_disposeCache((fpe_cache_t*)glprogram->fpe_cache, 1);
@@ -525,6 +528,9 @@ static void clear_program(program_t *glprogram)
             kh_del(uniformlist, glprogram->uniform, k);
         )
     }
+    free(glprogram->uniformloc);
+    glprogram->uniformloc = NULL;
+    glprogram->uniformloc_size = 0;
     glprogram->cache.size = 0;  // reset cache buffer
 }
 
@@ -601,12 +607,17 @@ static void fill_program(program_t *glprogram)
         DBG(else printf("LIBGL: Warning, getting Uniform #%d info failed with %s\n", i, PrintEnum(e2));)
     }
     free(name);
+    FillUniformLoc(glprogram);
     // reset uniform cache
     if(glprogram->cache.cap < uniform_cache) {
         glprogram->cache.cap=uniform_cache;
+        free(glprogram->cache.cache);
+        free(glprogram->cache.gen);
         glprogram->cache.cache = malloc(glprogram->cache.cap);
+        glprogram->cache.gen = (GLuint*)malloc(glprogram->cache.cap);    // one GLuint every 4 bytes
     }
     memset(glprogram->cache.cache, 0, glprogram->cache.cap);
+    memset(glprogram->cache.gen, 0, glprogram->cache.cap);
     //Maybe Sampler uniform should not be initialized to 0, but to -1, to be sure the value is initialized?
     if(glprogram->uniform) {
         uniform_t *m;
@@ -785,6 +796,27 @@ void gl4es_glLinkProgram(GLuint program) {
             if(attribute)
                 gl4es_glBindAttribLocation(glprogram->id, i, attribute);
         }
+    // try the program binary from the shader cache first
+    uint64_t cachekey = shadercache_ProgramKey(glprogram);
+    GLenum format;
+    int size;
+    void* binary;
+    if(cachekey && shadercache_GetProgram(cachekey, &format, &size, &binary)) {
+        LOAD_GLES_OES(glProgramBinary);
+        LOAD_GLES2(glGetProgramiv);
+        gles_glProgramBinary(glprogram->id, format, binary, size);
+        gles_glGetProgramiv(glprogram->id, GL_LINK_STATUS, &glprogram->linked);
+        DBG(printf(" cached binary link status = %d\n", glprogram->linked);)
+        if(glprogram->linked) {
+            fill_program(glprogram);
+            noerrorShimNoPurge();
+            return;
+        }
+        // binary refused (driver update?), do a real link
+    }
+    // deferred shaders need to be really compiled now
+    for (int i=0; i<glprogram->attach_size; i++)
+        realizeShader(getShader(glprogram->attach[i]));
     // ok, continue with linking
     LOAD_GLES2(glLinkProgram);
     if(gles_glLinkProgram) {
@@ -797,6 +829,16 @@ void gl4es_glLinkProgram(GLuint program) {
         DBG(printf(" link status = %d\n", glprogram->linked);)
         if(glprogram->linked) {
             fill_program(glprogram);
+            // the shaders are good, save them in the shader cache
+            for (int i=0; i<glprogram->attach_size; i++) {
+                shader_t *glshader = getShader(glprogram->attach[i]);
+                if(glshader && glshader->cachekey && !glshader->cached)
+                    shadercache_AddShader(glshader->cachekey, glshader->converted, &glshader->need);
+            }
+            if(cachekey && gl4es_getProgramBinary(glprogram->id, &size, &format, &binary)) {
+                shadercache_AddProgram(cachekey, format, size, binary);
+                free(binary);
+            }
             noerrorShimNoPurge();
         } else {
             // should DBG the linker error?
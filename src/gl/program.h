@@ -100,6 +100,21 @@ typedef enum {
     MAT_MAX
 } reserved_matrix_t;
 
+// groups of builtin uniforms, stamped by the glstate when changed
+typedef enum {
+    BUILTIN_MV = 0,     // modelview (and MVP, normal matrix)
+    BUILTIN_P,          // projection (and MVP)
+    BUILTIN_T0,         // one per texture matrix
+    BUILTIN_LIGHT = BUILTIN_T0 + MAX_TEX,   // light sources and light model
+    BUILTIN_MATERIAL,
+    BUILTIN_FOG,
+    BUILTIN_CLIPPLANES,
+    BUILTIN_POINTSPRITE,
+    BUILTIN_TEXENV,
+    BUILTIN_TEXGEN,
+    BUILTIN_MAX
+} builtin_group_t;
+
 typedef struct {
     GLuint          internal_id; // internal id of the uniform
     GLuint          id;     // glsl id of the uniform
@@ -111,14 +126,25 @@ typedef struct {
     int             cache_size; // this is GLsizeof(type)*size
     uintptr_t       parent_offs;    // in case the uniform is from a fpe custom program
     int             parent_size;    // 0 means not found in parent... like for builtin
+    GLuint          parent_gen;     // generation of the parent uniform at the last sync
 } uniform_t;
 
 KHASH_MAP_DECLARE_INT(uniformlist, uniform_t *);
 
+// dense view of the uniforms, indexed by location, for the glUniform calls
+typedef struct {
+    GLint           id;         // glsl id of the uniform, -1 if location is not used
+    GLenum          type;
+    GLint           size;
+    GLuint          cache_offs;
+} uniformloc_t;
+
 typedef struct {
     void*           cache;  // buffer of the uniform size
     int             cap;    // capacity of the cache
     int             size;   // next available free space in the cache
+    GLuint*         gen;    // generation of each uniform (indexed by cache offset/4), 0 if untouched since link
+    GLuint          serial; // last generation given (never reset)
 } uniformcache_t;
 
 typedef struct {
@@ -219,7 +245,10 @@ typedef struct {
     khash_t(attribloclist)     *attribloc;
     khash_t(uniformlist) *uniform;
     int             num_uniform;
+    uniformloc_t    *uniformloc;    // NULL if locations are too sparse (then use uniform)
+    int             uniformloc_size;
     uniformcache_t  cache;
+    GLuint          parent_serial;  // for fpe custom program: serial of the parent cache at the last sync
     // builtin attrib
     int                             has_builtin_attrib;
     GLint                           builtin_attrib[ATT_MAX];
@@ -243,6 +272,9 @@ typedef struct {
     int                             has_builtin_texgen;
     builtin_fog_t                   builtin_fog;
     GLint                           builtin_instanceID;
+    // glstate stamps of the builtin uniforms last uploaded
+    GLuint                          builtin_serial;
+    GLuint                          builtin_stamp[BUILTIN_MAX];
     // fpe uniform
     GLint                           fpe_alpharef;
     int                             has_fpe;
@@ -326,6 +358,7 @@ int gl4es_getProgramBinary(GLuint program, int *length, GLenum *format, void** b
             gles_glUseProgram(prg);         \
     }
 
+void FillUniformLoc(program_t *glprogram);
 void GoUniformfv(program_t *glprogram, GLint location, int size, int count, const GLfloat *value);
 void GoUniformiv(program_t *glprogram, GLint location, int size, int count, const GLint *value);
 void GoUniformMatrix2fv(program_t *glprogram, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
@@ -4,6 +4,7 @@
 #include "blit.h"
 #include "debug.h"
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "init.h"
 #include "list.h"
@@ -66,8 +67,7 @@ void gl4es_glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 	{
 		FLUSH_BEGINEND;
 		if (glstate->raster.bm_drawing)	bitmap_flush();
-    	LOAD_GLES(glViewport);
-		gles_glViewport(x, y, width, height);
+		gleshard_glViewport(x, y, width, height);
 		glstate->raster.viewport.x = x;
 		glstate->raster.viewport.y = y;
 		glstate->raster.viewport.width = width;
@@ -97,8 +97,7 @@ void gl4es_glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
 	{
 		FLUSH_BEGINEND;
 		if (glstate->raster.bm_drawing) bitmap_flush();
-    	LOAD_GLES(glScissor);
-		gles_glScissor(x, y, width, height);
+		gleshard_glScissor(x, y, width, height);
 		glstate->raster.scissor.x = x;
 		glstate->raster.scissor.y = y;
 		glstate->raster.scissor.width = width;
@@ -108,12 +107,10 @@ void gl4es_glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
 
 // hacky viewport temporary changes
 void pushViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
-    LOAD_GLES(glViewport);
-    gles_glViewport(x, y, width, height);
+    gleshard_glViewport(x, y, width, height);
 }
 void popViewport() {
-    LOAD_GLES(glViewport);
-    gles_glViewport(glstate->raster.viewport.x, glstate->raster.viewport.y, glstate->raster.viewport.width, glstate->raster.viewport.height);
+    gleshard_glViewport(glstate->raster.viewport.x, glstate->raster.viewport.y, glstate->raster.viewport.width, glstate->raster.viewport.height);
 }
 
 
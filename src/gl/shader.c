@@ -6,6 +6,7 @@
 #include "gl4es.h"
 #include "glstate.h"
 #include "loader.h"
+#include "shader_cache.h"
 #include "shaderconv.h"
 
 //#define DEBUG
@@ -123,8 +124,13 @@ void gl4es_glCompileShader(GLuint shader) {
     CHECK_SHADER(void, shader)
 
     glshader->compiled = 1;
+    glshader->deferred = 0;
     LOAD_GLES2(glCompileShader);
-    if(gles_glCompileShader) {
+    if(gles_glCompileShader && glshader->cached && !globals4es.logshader) {
+        // the shader cache says this source compiles fine, so the real compilation is only done if needed
+        glshader->deferred = 1;
+        noerrorShim();
+    } else if(gles_glCompileShader) {
         gles_glCompileShader(glshader->id);
         errorGL();
         if(globals4es.logshader) {
@@ -146,6 +152,28 @@ void gl4es_glCompileShader(GLuint shader) {
         noerrorShim();
 }
 
+void realizeShader(shader_t *glshader) {
+    if(!glshader || !glshader->deferred)
+        return;
+    glshader->deferred = 0;
+    LOAD_GLES2(glCompileShader);
+    gles_glCompileShader(glshader->id);
+}
+
+// convert the shader source, from the shader cache if possible
+static void convertShader(shader_t *glshader) {
+    glshader->cached = 0;
+    glshader->cachekey = shadercache_ShaderKey(glshader->source, glshader->type==GL_VERTEX_SHADER?1:0, &glshader->need);
+    if(glshader->cachekey) {
+        glshader->converted = shadercache_GetShader(glshader->cachekey, &glshader->need);
+        if(glshader->converted) {
+            glshader->cached = 1;
+            return;
+        }
+    }
+    glshader->converted = ConvertShader(glshader->source, glshader->type==GL_VERTEX_SHADER?1:0, &glshader->need);
+}
+
 void gl4es_glShaderSource(GLuint shader, GLsizei count, const GLchar * const *string, const GLint *length) {
     DBG(printf("glShaderSource(%d, %d, %p, %p)\n", shader, count, string, length);)
     // sanity check
@@ -174,10 +202,12 @@ void gl4es_glShaderSource(GLuint shader, GLsizei count, const GLchar * const *st
     LOAD_GLES2(glShaderSource);
     if (gles_glShaderSource) {
         // adapt shader if needed (i.e. not an es2 context and shader is not #version 100)
+        glshader->cachekey = 0;
+        glshader->cached = 0;
         if(glstate->glsl->es2 && !strncmp(glshader->source, "#version 100", 12))
             glshader->converted = strdup(glshader->source);
         else
-            glshader->converted = ConvertShader(glshader->source, glshader->type==GL_VERTEX_SHADER?1:0, &glshader->need);
+            convertShader(glshader);
         // send source to GLES2 hardware if any
         gles_glShaderSource(shader, 1, (const GLchar * const*)((glshader->converted)?(&glshader->converted):(&glshader->source)), NULL);
         errorGL();
@@ -233,7 +263,7 @@ void redoShader(GLuint shader, shaderconv_need_t *need) {
         return;
     free(glshader->converted);
     memcpy(&glshader->need, need, sizeof(shaderconv_need_t));
-    glshader->converted = ConvertShader(glshader->source, glshader->type==GL_VERTEX_SHADER?1:0, &glshader->need);
+    convertShader(glshader);
     // send source to GLES2 hardware if any
     gles_glShaderSource(shader, 1, (const GLchar * const*)((glshader->converted)?(&glshader->converted):(&glshader->source)), NULL);
     // recompile...
@@ -303,6 +333,7 @@ void gl4es_glGetShaderInfoLog(GLuint shader, GLsizei maxLength, GLsizei *length,
     }
     LOAD_GLES2(glGetShaderInfoLog);
     if(gles_glGetShaderInfoLog) {
+        realizeShader(glshader);
         gles_glGetShaderInfoLog(glshader->id, maxLength, length, infoLog);
         errorGL();
     } else {
@@ -325,7 +356,9 @@ void gl4es_glGetShaderiv(GLuint shader, GLenum pname, GLint *params) {
             *params = (glshader->deleted)?GL_TRUE:GL_FALSE;
             break;
         case GL_COMPILE_STATUS:
-            if(gles_glGetShaderiv) {
+            if(glshader->deferred) {
+                *params = GL_TRUE;
+            } else if(gles_glGetShaderiv) {
                 gles_glGetShaderiv(glshader->id, pname, params);
                 errorGL();
             } else {
@@ -334,6 +367,7 @@ void gl4es_glGetShaderiv(GLuint shader, GLenum pname, GLint *params) {
             break;
         case GL_INFO_LOG_LENGTH:
             if(gles_glGetShaderiv) {
+                realizeShader(glshader);
                 gles_glGetShaderiv(glshader->id, pname, params);
                 errorGL();
             } else {
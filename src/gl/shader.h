@@ -30,6 +30,10 @@ typedef struct shader_s {
     char*           converted;  // converted source (or null if nothing)
     // shaderconv
     shaderconv_need_t  need;    // the varying need / provide of the shader
+    // shader cache
+    uint64_t        cachekey;   // key of the converted source in the shader cache (0 if none)
+    int             cached;     // converted source comes from the cache, so it's known to compile
+    int             deferred;   // real compilation not done yet
 } shader_t;
 
 KHASH_MAP_DECLARE_INT(shaderlist, shader_t *);
@@ -49,6 +53,7 @@ void gl4es_glReleaseShaderCompiler(void);
 void accumShaderNeeds(GLuint shader, shaderconv_need_t *need);
 int isShaderCompatible(GLuint shader, shaderconv_need_t *need);
 void redoShader(GLuint shader, shaderconv_need_t *need);
+void realizeShader(shader_t *glshader);
 shader_t *getShader(GLuint shader);
 
 #define CHECK_SHADER(type, shader) \
@@ -0,0 +1,308 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "../glx/hardext.h"
+#include "build_info.h"
+#include "init.h"
+#include "khash.h"
+#include "logs.h"
+#include "shader_cache.h"
+
+//#define DEBUG
+#ifdef DEBUG
+#define DBG(a) a
+#else
+#define DBG(a)
+#endif
+
+static const char SHADERCACHE_SIGN[] = "GL4ES ShaderCache";
+#define SHADERCACHE_VERSION 1
+#define RECORD_MAGIC    0x52444853  // "SHDR"
+
+#define KIND_SHADER     1
+#define KIND_PROGRAM    2
+
+typedef struct cache_entry_s {
+    int         kind;
+    int         size;
+    void*       data;
+} cache_entry_t;
+
+KHASH_MAP_INIT_INT64(shadercache, cache_entry_t*);
+
+static khash_t(shadercache) *cache = NULL;
+static char *cache_name = NULL;
+static uint64_t cache_config = 0;   // hash of the gl4es build and config
+static long cache_filesize = 0;
+
+// FNV-1a 64bits
+#define HASH_INIT 0xcbf29ce484222325ULL
+static uint64_t hash_data(uint64_t h, const void* data, int size)
+{
+    const uint8_t* s = (const uint8_t*)data;
+    for (int i=0; i<size; ++i)
+        h = (h ^ s[i]) * 0x100000001b3ULL;
+    return h;
+}
+static uint64_t hash_string(uint64_t h, const char* s)
+{
+    return hash_data(h, s, s?(strlen(s)+1):0);
+}
+
+static void cache_put(uint64_t key, int kind, int size, void* data)
+{
+    int ret;
+    khint_t k = kh_put(shadercache, cache, key, &ret);
+    if(!ret) {
+        cache_entry_t *old = kh_value(cache, k);
+        free(old->data);
+        free(old);
+    }
+    cache_entry_t *e = (cache_entry_t*)malloc(sizeof(cache_entry_t));
+    e->kind = kind;
+    e->size = size;
+    e->data = data;
+    kh_value(cache, k) = e;
+}
+
+static cache_entry_t* cache_get(uint64_t key, int kind)
+{
+    if(!cache || !key)
+        return NULL;
+    khint_t k = kh_get(shadercache, cache, key);
+    if(k==kh_end(cache))
+        return NULL;
+    cache_entry_t *e = kh_value(cache, k);
+    return (e->kind==kind)?e:NULL;
+}
+
+static void cache_append(uint64_t key, int kind, int size, const void* data);
+
+static void cache_rewrite()
+{
+    remove(cache_name);
+    cache_filesize = 0;
+    uint64_t key;
+    cache_entry_t *e;
+    kh_foreach(cache, key, e,
+        cache_append(key, e->kind, e->size, e->data);
+    );
+}
+
+static void cache_read()
+{
+    FILE *f = fopen(cache_name, "rb");
+    if(!f)
+        return;
+    fseek(f, 0, SEEK_END);
+    cache_filesize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char tmp[sizeof(SHADERCACHE_SIGN)];
+    int version = 0;
+    if(cache_filesize>SHADERCACHE_MAX_SIZE
+     || fread(tmp, sizeof(SHADERCACHE_SIGN), 1, f)!=1 || strcmp(tmp, SHADERCACHE_SIGN)
+     || fread(&version, sizeof(version), 1, f)!=1 || version!=SHADERCACHE_VERSION) {
+        // too big, or unknown: start a new one
+        fclose(f);
+        remove(cache_name);
+        cache_filesize = 0;
+        return;
+    }
+    int n = 0;
+    while(1) {
+        // stop at the first incomplete record (if the program crashed while writing it)
+        uint32_t magic, check;
+        int kind, size;
+        uint64_t key;
+        if(fread(&magic, sizeof(magic), 1, f)!=1 || magic!=RECORD_MAGIC)
+            break;
+        if(fread(&kind, sizeof(kind), 1, f)!=1 || fread(&key, sizeof(key), 1, f)!=1)
+            break;
+        if(fread(&size, sizeof(size), 1, f)!=1 || size<=0 || size>cache_filesize)
+            break;
+        void* data = malloc(size);
+        if(fread(data, size, 1, f)!=1 || fread(&check, sizeof(check), 1, f)!=1) {
+            free(data);
+            break;
+        }
+        if((uint32_t)hash_data(hash_data(HASH_INIT, &key, sizeof(key)), data, size)!=check) {
+            free(data);
+            break;
+        }
+        cache_put(key, kind, size, data);
+        ++n;
+    }
+    long good = ftell(f);
+    fclose(f);
+    // new records are appended, so a bad record at the end would hide them: save the good ones again
+    if(good<cache_filesize)
+        cache_rewrite();
+    SHUT_LOGD("Loaded a Shader Cache with %d entries\n", n);
+}
+
+static void cache_append(uint64_t key, int kind, int size, const void* data)
+{
+    if(cache_filesize>SHADERCACHE_MAX_SIZE)
+        return;
+    FILE *f = fopen(cache_name, "ab");
+    if(!f)
+        return;
+    fseek(f, 0, SEEK_END);
+    if(ftell(f)==0) {
+        int version = SHADERCACHE_VERSION;
+        fwrite(SHADERCACHE_SIGN, sizeof(SHADERCACHE_SIGN), 1, f);
+        fwrite(&version, sizeof(version), 1, f);
+    }
+    // build the record first, so it's written in one go
+    uint32_t magic = RECORD_MAGIC;
+    uint32_t check = (uint32_t)hash_data(hash_data(HASH_INIT, &key, sizeof(key)), data, size);
+    int l = sizeof(magic)+sizeof(kind)+sizeof(key)+sizeof(size)+size+sizeof(check);
+    char* buff = (char*)malloc(l);
+    char* s = buff;
+    memcpy(s, &magic, sizeof(magic)); s+=sizeof(magic);
+    memcpy(s, &kind, sizeof(kind)); s+=sizeof(kind);
+    memcpy(s, &key, sizeof(key)); s+=sizeof(key);
+    memcpy(s, &size, sizeof(size)); s+=sizeof(size);
+    memcpy(s, data, size); s+=size;
+    memcpy(s, &check, sizeof(check));
+    fwrite(buff, l, 1, f);
+    cache_filesize = ftell(f);
+    fclose(f);
+    free(buff);
+}
+
+void shadercache_Init(const char* name)
+{
+    if(cache)
+        return; // already inited
+    cache = kh_init(shadercache);
+    cache_name = strdup(name);
+    cache_read();
+}
+
+void shadercache_Free()
+{
+    if(!cache)
+        return;
+    cache_entry_t *e;
+    kh_foreach_value(cache, e,
+        free(e->data);
+        free(e);
+    );
+    kh_destroy(shadercache, cache);
+    cache = NULL;
+    free(cache_name);
+    cache_name = NULL;
+    cache_config = 0;
+}
+
+int shadercache_Enabled()
+{
+    return cache?1:0;
+}
+
+static uint64_t shadercache_Config()
+{
+    // conversion depends on the gl4es version, the hardware and the LIBGL_xxx options
+    if(!cache_config) {
+        uint64_t h = hash_string(HASH_INIT, get_build_id());
+        h = hash_data(h, &hardext, sizeof(hardext));
+        h = hash_data(h, &globals4es, sizeof(globals4es));
+        cache_config = h?h:1;
+    }
+    return cache_config;
+}
+
+uint64_t shadercache_ShaderKey(const char* source, int isVertex, shaderconv_need_t *need)
+{
+    if(!cache || !source)
+        return 0;
+    uint64_t h = shadercache_Config();
+    h = hash_data(h, &isVertex, sizeof(isVertex));
+    h = hash_data(h, need, sizeof(shaderconv_need_t));
+    h = hash_string(h, source);
+    return h?h:1;
+}
+
+char* shadercache_GetShader(uint64_t key, shaderconv_need_t *need)
+{
+    cache_entry_t *e = cache_get(key, KIND_SHADER);
+    if(!e || e->size<=sizeof(shaderconv_need_t))
+        return NULL;
+    // the resulting need, then the converted source
+    memcpy(need, e->data, sizeof(shaderconv_need_t));
+    int l = e->size-sizeof(shaderconv_need_t);
+    char* converted = (char*)malloc(l+1);
+    memcpy(converted, (char*)e->data+sizeof(shaderconv_need_t), l);
+    converted[l] = '\0';
+    DBG(printf("ShaderCache: shader %016llx found\n", (unsigned long long)key);)
+    return converted;
+}
+
+void shadercache_AddShader(uint64_t key, const char* converted, shaderconv_need_t *need)
+{
+    if(!cache || !key || !converted)
+        return;
+    if(cache_get(key, KIND_SHADER))
+        return; // already there
+    int l = strlen(converted);
+    int size = sizeof(shaderconv_need_t)+l;
+    char* data = (char*)malloc(size);
+    memcpy(data, need, sizeof(shaderconv_need_t));
+    memcpy(data+sizeof(shaderconv_need_t), converted, l);
+    cache_put(key, KIND_SHADER, size, data);
+    cache_append(key, KIND_SHADER, size, data);
+    DBG(printf("ShaderCache: shader %016llx added\n", (unsigned long long)key);)
+}
+
+uint64_t shadercache_ProgramKey(program_t *glprogram)
+{
+    if(!cache || !hardext.prgbin_n)
+        return 0;
+    uint64_t h = shadercache_Config();
+    // the shaders, as they are sent to the driver
+    for (int i=0; i<glprogram->attach_size; ++i) {
+        shader_t *glshader = getShader(glprogram->attach[i]);
+        if(!glshader)
+            return 0;
+        h = hash_data(h, &glshader->type, sizeof(glshader->type));
+        h = hash_string(h, glshader->converted?glshader->converted:glshader->source);
+    }
+    // and the attributes binding
+    for (GLuint i=0; i<MAX_VATTRIB; ++i) {
+        khint_t k = kh_get(attribloclist, glprogram->attribloc, i);
+        if(k!=kh_end(glprogram->attribloc)) {
+            attribloc_t *attribloc = kh_value(glprogram->attribloc, k);
+            h = hash_data(h, &i, sizeof(i));
+            h = hash_string(h, attribloc->name);
+        }
+    }
+    return h?h:1;
+}
+
+int shadercache_GetProgram(uint64_t key, GLenum *format, int *size, void **binary)
+{
+    cache_entry_t *e = cache_get(key, KIND_PROGRAM);
+    if(!e || e->size<=sizeof(GLenum))
+        return 0;
+    memcpy(format, e->data, sizeof(GLenum));
+    *size = e->size-sizeof(GLenum);
+    *binary = (char*)e->data+sizeof(GLenum);
+    DBG(printf("ShaderCache: program %016llx found\n", (unsigned long long)key);)
+    return 1;
+}
+
+void shadercache_AddProgram(uint64_t key, GLenum format, int size, void *binary)
+{
+    if(!cache || !key || size<=0)
+        return;
+    int l = sizeof(GLenum)+size;
+    char* data = (char*)malloc(l);
+    memcpy(data, &format, sizeof(GLenum));
+    memcpy(data+sizeof(GLenum), binary, size);
+    cache_put(key, KIND_PROGRAM, l, data);
+    cache_append(key, KIND_PROGRAM, l, data);
+    DBG(printf("ShaderCache: program %016llx added\n", (unsigned long long)key);)
+}
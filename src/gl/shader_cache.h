@@ -0,0 +1,30 @@
+#ifndef _GL4ES_SHADER_CACHE_H_
+#define _GL4ES_SHADER_CACHE_H_
+
+#include <stdint.h>
+#include "gles.h"
+#include "program.h"
+#include "shader.h"
+
+/*
+  On disk cache of user shaders: the converted GLSL ES source of each shader, and the
+  Program Binary of linked programs (if GL_OES_get_program_binary is supported).
+  Entries are keyed by a hash of their inputs (and of the gl4es build and config),
+  and appended to the cache file as soon as they are known to be good.
+*/
+
+void shadercache_Init(const char* name);
+void shadercache_Free();
+int shadercache_Enabled();
+
+// converted shaders
+uint64_t shadercache_ShaderKey(const char* source, int isVertex, shaderconv_need_t *need);
+char* shadercache_GetShader(uint64_t key, shaderconv_need_t *need);
+void shadercache_AddShader(uint64_t key, const char* converted, shaderconv_need_t *need);
+
+// linked programs
+uint64_t shadercache_ProgramKey(program_t *glprogram);
+int shadercache_GetProgram(uint64_t key, GLenum *format, int *size, void **binary);
+void shadercache_AddProgram(uint64_t key, GLenum format, int size, void *binary);
+
+#endif // _GL4ES_SHADER_CACHE_H_
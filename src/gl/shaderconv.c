@@ -447,9 +447,31 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
       sprintf(gl4es_VA[i], "%s%d", gl4es_VertexAttrib, i);
     }
   }
-  int fpeShader = (strstr(pEntry, fpeshader_signature)!=NULL)?1:0;
   int maskbefore = 4|(isVertex?1:2);
   int maskafter = 8|(isVertex?1:2);
+  if(strstr(pEntry, fpeshader_es_signature)) {
+    // FPE shader already generated for GLES, only the needs are reported
+    if(!need || (need->need_texcoord==-1 && !need->need_color && !need->need_secondary && !need->need_fogcoord
+      && !need->need_notexarray && !need->need_normalmatrix && !need->need_mvmatrix && !need->need_mvpmatrix
+      && !need->need_clean && !need->need_clipvertex && !need->need_texs)) {
+      if((globals4es.dbgshaderconv&maskbefore)==maskbefore) {
+        printf("Shader source%s:\n%s\n", pEntry, " (FPEShader generated)");
+      }
+      if(need && isVertex) {
+        if(strstr(pEntry, gl4es_frontColorSource)) need->need_color = 1;
+        if(strstr(pEntry, gl4es_backColorSource)) need->need_color = 2;
+        if(strstr(pEntry, gl4es_frontSecondaryColorSource)) need->need_secondary = 1;
+        if(strstr(pEntry, gl4es_backSecondaryColorSource)) need->need_secondary = 2;
+      }
+      return strdup(pEntry);
+    }
+    // linked with a shader that needs more: do a full conversion
+    char* desktop = fpe_DesktopShader(pEntry);
+    char* ret = ConvertShader(desktop, isVertex, need);
+    free(desktop);
+    return ret;
+  }
+  int fpeShader = (strstr(pEntry, fpeshader_signature)!=NULL)?1:0;
   if((globals4es.dbgshaderconv&maskbefore)==maskbefore) {
     printf("Shader source%s:\n%s\n", pEntry, fpeShader?" (FPEShader generated)":"");
   }
@@ -506,6 +528,7 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
     /* else no location or in / out are supported */
   }
   #endif
+  free(versionString);
   //sprintf(GLESFullHeader, GLESHeader, (wanthighp && hardext.highp==1 && !isVertex)?GLESUseFragHighp:"", (wanthighp)?"highp":"mediump", (wanthighp)?"highp":"mediump");
   sprintf(GLESFullHeader, GLESHeader[versionHeader], "", (wanthighp)?"highp":"mediump", (wanthighp)?"highp":"mediump");
 
@@ -643,7 +666,7 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
           state = 1;  // integer part
         else if (*newptr == '.')
           state = 2;  // fractional part
-        else if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<')))
+        else if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<') || (*newptr==',')))
           state = 0; // separator
         else 
           state = 3; // something else
@@ -653,9 +676,9 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
           state = 1;  // integer part
         else if (*newptr == '.')
           state = 2;  // fractional part
-        else if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<')))
+        else if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<') || (*newptr==',')))
           state = 0; // separator
-        else  if (*newptr == 'f' ) {
+        else  if (*newptr == 'f' || *newptr == 'F') {
           // remove that f
           memmove(newptr, newptr+1, strlen(newptr+1)+1);
           newptr--;
@@ -665,9 +688,9 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
       case 2: // fractionnal part
         if ((*newptr >= '0') && (*newptr <= '9'))
           state = 2;
-        else if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<')))
+        else if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<') || (*newptr==',')))
           state = 0; // separator
-        else  if (*newptr == 'f' ) {
+        else  if (*newptr == 'f' || *newptr == 'F') {
           // remove that f
           memmove(newptr, newptr+1, strlen(newptr+1)+1);
           newptr--;
@@ -675,7 +698,7 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
           state = 3;
           break;
       case 3:
-        if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<')))
+        if ((*newptr==' ') || (*newptr==0x0d) || (*newptr==0x0a) || (*newptr=='-') || (*newptr=='+') || (*newptr=='*') || (*newptr=='/') || (*newptr=='(') || (*newptr==')' || (*newptr=='>') || (*newptr=='<') || (*newptr==',')))
           state = 0; // separator
         else      
           state = 3;
@@ -1019,21 +1042,21 @@ char* ConvertShader(const char* pEntry, int isVertex, shaderconv_need_t *need)
     Tmp = InplaceReplace(Tmp, &tmpsize, "gl_MaxClipPlanes", "_gl4es_MaxClipPlanes");
   }
 
-  if(strstr(Tmp, "gl_PointParameters") || strstr(Tmp, "gl_Point"))
+  if(FindString(Tmp, "gl_PointParameters") || FindString(Tmp, "gl_Point"))
     {
       Tmp = InplaceInsert(GetLine(Tmp, headline), gl4es_PointSpriteSource, Tmp, &tmpsize);
       headline+=CountLine(gl4es_PointSpriteSource);
       Tmp = InplaceReplace(Tmp, &tmpsize, "gl_PointParameters", "_gl4es_PointParameters");
     }
-  if(strstr(Tmp, "gl_Point"))
+  if(FindString(Tmp, "gl_Point"))
     Tmp = InplaceReplace(Tmp, &tmpsize, "gl_Point", "_gl4es_Point");
-  if(strstr(Tmp, "gl_FogParameters") || strstr(Tmp, "gl_Fog"))
+  if(FindString(Tmp, "gl_FogParameters") || FindString(Tmp, "gl_Fog"))
     {
       Tmp = InplaceInsert(GetLine(Tmp, headline), hardext.highp?gl4es_FogParametersSourceHighp:gl4es_FogParametersSource, Tmp, &tmpsize);
       headline+=CountLine(gl4es_FogParametersSource);
       Tmp = InplaceReplace(Tmp, &tmpsize, "gl_FogParameters", "_gl4es_FogParameters");
     }
-  if(strstr(Tmp, "gl_Fog"))
+  if(FindString(Tmp, "gl_Fog"))
     Tmp = InplaceReplace(Tmp, &tmpsize, "gl_Fog", "_gl4es_Fog");
   if(strstr(Tmp, "gl_TextureEnvColor")) {
     Tmp = InplaceInsert(GetLine(Tmp, headline), gl4es_texenvcolorSource, Tmp, &tmpsize);
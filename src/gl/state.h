@@ -229,12 +229,27 @@ typedef struct glsl_s {
     oldprogram_t           *frg_prog;
 } glsl_t;
 
-typedef struct {
+typedef struct gleshard_s {
     GLuint          program;
     program_t       *glprogram;
     GLuint          active; // active texture (is it shared?)
     vertexattrib_t  vertexattrib[MAX_VATTRIB];
     GLfloat         vavalue[MAX_VATTRIB][4];
+    // last states sent to the driver, see gleshard.c
+    GLuint          valid;  // 1 bit per HARD_xxx entry
+    GLenum          blendfunc[4];
+    GLenum          blendequation[2];
+    GLboolean       colormask[4];
+    GLenum          cullface;
+    GLenum          depthfunc;
+    GLboolean       depthmask;
+    GLenum          frontface;
+    GLfloat         polygonoffset[2];
+    GLint           scissor[4];
+    GLint           stencilfunc[2][3];  // front/back: func, ref, mask
+    GLuint          stencilmask[2];
+    GLenum          stencilop[2][3];
+    GLint           viewport[4];
 } gleshard_t;
 
 typedef struct {
@@ -371,6 +386,7 @@ typedef struct {
     GLuint  array;
     GLuint  index;
     GLuint  want_index;
+    GLuint  unpack;     // GL_PIXEL_UNPACK_BUFFER, only bound by the texture upload staging
     int     used;
 } bind_buffers_t;
 
@@ -3,13 +3,13 @@
 #include "../glx/hardext.h"
 #include "debug.h"
 #include "gl4es.h"
+#include "gleshard.h"
 #include "glstate.h"
 #include "loader.h"
 
 void gl4es_glStencilMask(GLuint mask) {
     if(!glstate->list.pending) 
         PUSH_IF_COMPILING(glStencilMask);
-    LOAD_GLES(glStencilMask);
     if(glstate->stencil.mask[0]==glstate->stencil.mask[1] && glstate->stencil.mask[0]==mask) {
         noerrorShim();
         return;
@@ -17,7 +17,7 @@ void gl4es_glStencilMask(GLuint mask) {
     FLUSH_BEGINEND;
     glstate->stencil.mask[0] = glstate->stencil.mask[1] = mask;
     errorGL();
-    gles_glStencilMask(mask);
+    gleshard_glStencilMask(mask);
 }
 void glStencilMask(GLuint mask) AliasExport("gl4es_glStencilMask");
 
@@ -42,7 +42,7 @@ void gl4es_glStencilMaskSeparate(GLenum face, GLuint mask) {
 
     errorGL();
     if(gles_glStencilMaskSeparate) {
-        gles_glStencilMaskSeparate(face, mask);
+        gleshard_glStencilMaskSeparate(face, mask);
     } else {
         // fake function..., call it only for front or front_and_back, just ignore back (crappy, I know)
         if (face==GL_FRONT)
@@ -62,13 +62,12 @@ void gl4es_glStencilFunc(GLenum func, GLint ref, GLuint mask) {
           noerrorShim();
           return;
       }
-    LOAD_GLES(glStencilFunc);
     errorGL();
     FLUSH_BEGINEND;
     glstate->stencil.func[0] = glstate->stencil.func[1] = func;
     glstate->stencil.f_ref[0] = glstate->stencil.f_ref[1] = ref;
     glstate->stencil.f_mask[0] = glstate->stencil.f_mask[1] = mask;
-    gles_glStencilFunc(func, ref, mask);
+    gleshard_glStencilFunc(func, ref, mask);
 }
 void glStencilFunc(GLenum func, GLint ref, GLuint mask) AliasExport("gl4es_glStencilFunc");
 
@@ -96,7 +95,7 @@ void gl4es_glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mas
     glstate->stencil.f_ref[idx]=ref;
     glstate->stencil.f_mask[idx]=mask;
     if(gles_glStencilFuncSeparate) {
-        gles_glStencilFuncSeparate(face, func, ref, mask);
+        gleshard_glStencilFuncSeparate(face, func, ref, mask);
     } else {
         // fake function..., call it only for front or front_and_back, just ignore back (crappy, I know)
         if (face==GL_FRONT)
@@ -116,13 +115,12 @@ void gl4es_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
           noerrorShim();
           return;
       }
-    LOAD_GLES(glStencilOp);
     FLUSH_BEGINEND;
     glstate->stencil.sfail[0] = glstate->stencil.sfail[1] = fail;
     glstate->stencil.dpfail[0] = glstate->stencil.dpfail[1] = zfail;
     glstate->stencil.dppass[0] = glstate->stencil.dppass[1] = zpass;
     errorGL();
-    gles_glStencilOp(fail, zfail, zpass);
+    gleshard_glStencilOp(fail, zfail, zpass);
 }
 void glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) AliasExport("gl4es_glStencilOp");
 
@@ -149,7 +147,7 @@ void gl4es_glStencilOpSeparate(GLenum face, GLenum sfail, GLenum zfail, GLenum z
     glstate->stencil.dpfail[idx] = zfail;
     glstate->stencil.dppass[idx] = zpass;
     if(gles_glStencilOpSeparate) {
-        gles_glStencilOpSeparate(face, sfail, zfail, zpass);
+        gleshard_glStencilOpSeparate(face, sfail, zfail, zpass);
     } else {
         //fake, again
         if (face==GL_FRONT)
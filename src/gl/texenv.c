@@ -552,6 +552,7 @@ void gl4es_glTexEnvf(GLenum target, GLenum pname, GLfloat param) {
                     }
                     FLUSH_BEGINEND;
                     t->rgb_scale = param;
+                    BUILTIN_CHANGED(BUILTIN_TEXENV);
                     if(glstate->fpe_state) {
                         if(param==1.0f)
                             glstate->fpe_state->texenv[tmu].texrgbscale = 0;
@@ -568,6 +569,7 @@ void gl4es_glTexEnvf(GLenum target, GLenum pname, GLfloat param) {
                     }
                     FLUSH_BEGINEND;
                     t->alpha_scale = param;
+                    BUILTIN_CHANGED(BUILTIN_TEXENV);
                     if(glstate->fpe_state) {
                         if(param==1.0f)
                             glstate->fpe_state->texenv[tmu].texalphascale = 0;
@@ -616,6 +618,7 @@ void gl4es_glTexEnvfv(GLenum target, GLenum pname, const GLfloat *param) {
         }
         FLUSH_BEGINEND;
         memcpy(t->color, param, 4*sizeof(GLfloat));
+        BUILTIN_CHANGED(BUILTIN_TEXENV);
         errorGL();
         if(hardext.esversion==1) {
             LOAD_GLES2(glTexEnvfv);
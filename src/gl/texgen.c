@@ -90,6 +90,7 @@ void gl4es_glTexGenfv(GLenum coord, GLenum pname, const GLfloat *param) {
                 default:
                     errorShim(GL_INVALID_ENUM);
             }
+            BUILTIN_CHANGED(BUILTIN_TEXGEN);
             return;
         case GL_EYE_PLANE: {
             // need to transform here
@@ -111,6 +112,7 @@ void gl4es_glTexGenfv(GLenum coord, GLenum pname, const GLfloat *param) {
                 default:
                     errorShim(GL_INVALID_ENUM);
                 }
+            BUILTIN_CHANGED(BUILTIN_TEXGEN);
             return;
             }
         default:
@@ -172,14 +174,14 @@ void gl4es_glGetTexGenfv(GLenum coord,GLenum pname,GLfloat *params) {
 }
 
 
-void dot_loop(const GLfloat *verts, const GLfloat *params, GLfloat *out, GLint count, GLushort *indices) {
+void dot_loop(const GLfloat *verts, const GLfloat *params, GLfloat *out, GLint count, GLuint *indices) {
     for (int i = 0; i < count; i++) {
-	GLushort k = indices?indices[i]:i;
+	GLuint k = indices?indices[i]:i;
         out[k*4] = dot4(verts+k*4, params);// + params[3];
     }
 }
 
-void sphere_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GLint count, GLushort *indices) {
+void sphere_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GLint count, GLuint *indices) {
     // based on https://www.opengl.org/wiki/Mathematics_of_glTexGen
 /*    if (!norm) {
         printf("LIBGL: GL_SPHERE_MAP without Normals\n");
@@ -192,7 +194,7 @@ void sphere_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GLint
     GLfloat eye[4], eye_norm[4], reflect[4];
     GLfloat a;
     for (int i=0; i<count; i++) {
-	GLushort k = indices?indices[i]:i;
+	GLuint k = indices?indices[i]:i;
         vector_matrix(verts+k*4, ModelviewMatrix, eye);
         vector4_normalize(eye);
         vector3_matrix((norm)?(norm+k*3):glstate->normal, InvModelview, eye_norm);
@@ -210,7 +212,7 @@ void sphere_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GLint
 
 }
 
-void reflection_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GLint count, GLushort *indices) {
+void reflection_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GLint count, GLuint *indices) {
     // based on https://www.opengl.org/wiki/Mathematics_of_glTexGen
 /*    if (!norm) {
         printf("LIBGL: GL_REFLECTION_MAP without Normals\n");
@@ -222,7 +224,7 @@ void reflection_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GL
     GLfloat eye[4], eye_norm[4];
     GLfloat a;
     for (int i=0; i<count; i++) {
-	GLushort k = indices?indices[i]:i;
+	GLuint k = indices?indices[i]:i;
         vector_matrix(verts+k*4, ModelviewMatrix, eye);
         vector4_normalize(eye);
         vector3_matrix((norm)?(norm+k*3):glstate->normal, InvModelview, eye_norm);
@@ -236,19 +238,19 @@ void reflection_loop(const GLfloat *verts, const GLfloat *norm, GLfloat *out, GL
 
 }
 
-void eye_loop(const GLfloat *verts, const GLfloat *param, GLfloat *out, GLint count, GLushort *indices) {
+void eye_loop(const GLfloat *verts, const GLfloat *param, GLfloat *out, GLint count, GLuint *indices) {
     // based on https://www.opengl.org/wiki/Mathematics_of_glTexGen
     // First get the ModelviewMatrix
     const GLfloat *ModelviewMatrix = getMVMat();
     GLfloat tmp[4];
     for (int i=0; i<count; i++) {
-	GLushort k = indices?indices[i]:i;
+	GLuint k = indices?indices[i]:i;
         matrix_vector(ModelviewMatrix, verts+k*4, tmp);
         out[k*4]=dot4(param, tmp);
     }
 }
 
-void eye_loop_dual(const GLfloat *verts, const GLfloat *param1, const GLfloat* param2, GLfloat *out, GLint count, GLushort *indices) {
+void eye_loop_dual(const GLfloat *verts, const GLfloat *param1, const GLfloat* param2, GLfloat *out, GLint count, GLuint *indices) {
     // based on https://www.opengl.org/wiki/Mathematics_of_glTexGen
     // First get the ModelviewMatrix
     GLfloat ModelviewMatrix[16], InvModelview[16];
@@ -259,14 +261,14 @@ void eye_loop_dual(const GLfloat *verts, const GLfloat *param1, const GLfloat* p
     matrix_inverse(ModelviewMatrix, InvModelview);
     GLfloat tmp[4];
     for (int i=0; i<count; i++) {
-	GLushort k = indices?indices[i]:i;
+	GLuint k = indices?indices[i]:i;
         matrix_vector(ModelviewMatrix, verts+k*4, tmp);
         out[k*4+0]=dot4(param1, tmp);
         out[k*4+1]=dot4(param2, tmp);
     }
 }
 
-static inline void tex_coord_loop(GLfloat *verts, GLfloat *norm, GLfloat *out, GLint count, GLenum type, GLfloat *param_o, GLfloat *param_e, GLushort *indices) {
+static inline void tex_coord_loop(GLfloat *verts, GLfloat *norm, GLfloat *out, GLint count, GLenum type, GLfloat *param_o, GLfloat *param_e, GLuint *indices) {
     switch (type) {
         case GL_OBJECT_LINEAR:
             dot_loop(verts, param_o, out, count, indices);
@@ -280,7 +282,7 @@ static inline void tex_coord_loop(GLfloat *verts, GLfloat *norm, GLfloat *out, G
     }
 }
 
-void gen_tex_coords(GLfloat *verts, GLfloat *norm, GLfloat **coords, GLint count, GLint *needclean, int texture, GLushort *indices, GLuint ilen) {
+void gen_tex_coords(GLfloat *verts, GLfloat *norm, GLfloat **coords, GLint count, GLint *needclean, int texture, GLuint *indices, GLuint ilen) {
 //printf("gen_tex_coords(%p, %p, %p, %d, %p, %d, %p, %d) texgen = S:%s T:%s R:%s Q:%s, enabled:%c%c%c%c, tex=%02X\n", verts, norm, *coords, count, needclean, texture, indices, ilen, (glstate->enable.texgen_s[texture])?PrintEnum(glstate->texgen[texture].S):"-", (glstate->enable.texgen_t[texture])?PrintEnum(glstate->texgen[texture].T):"-", (glstate->enable.texgen_r[texture])?PrintEnum(glstate->texgen[texture].R):"-", (glstate->enable.texgen_q[texture])?PrintEnum(glstate->texgen[texture].Q):"-", (glstate->enable.texgen_s[texture])?'S':'-', (glstate->enable.texgen_t[texture])?'T':'-', (glstate->enable.texgen_r[texture])?'R':'-', (glstate->enable.texgen_q[texture])?'Q':'-', glstate->enable.texture[texture]);
     // TODO: do less work when called from glDrawElements?
     (*needclean) = 0;
@@ -393,14 +395,14 @@ void gen_tex_coords(GLfloat *verts, GLfloat *norm, GLfloat **coords, GLint count
         tex_coord_loop(verts, norm, (*coords)+2, (indices)?ilen:count, glstate->texgen[texture].R, glstate->texgen[texture].R_O, glstate->texgen[texture].R_E, indices);
     else
         for (int i=0; i<((indices)?ilen:count); i++) {
-            GLushort k = indices?indices[i]:i;
+            GLuint k = indices?indices[i]:i;
             (*coords)[k*4+2] = 0.0f;
         }
     if (glstate->enable.texgen_q[texture])
         tex_coord_loop(verts, norm, (*coords)+3, (indices)?ilen:count, glstate->texgen[texture].Q, glstate->texgen[texture].Q_O, glstate->texgen[texture].Q_E, indices);
     else
         for (int i=0; i<((indices)?ilen:count); i++) {
-            GLushort k = indices?indices[i]:i;
+            GLuint k = indices?indices[i]:i;
             (*coords)[k*4+3] = 1.0f;
         }
 }
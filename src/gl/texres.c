@@ -0,0 +1,339 @@
+#include "texres.h"
+
+#include <gl4eshint.h>
+#include "../glx/hardext.h"
+#include "decompress.h"
+#include "enum_info.h"
+#include "gleshard.h"
+#include "glstate.h"
+#include "init.h"
+#include "loader.h"
+#include "logs.h"
+#include "pixel.h"
+#include "stb_dxt_104.h"
+
+//#define DEBUG
+#ifdef DEBUG
+#define DBG(a) a
+#else
+#define DBG(a)
+#endif
+
+static int inline nlevel(int size, int level) {
+    if(size) {
+        size>>=level;
+        if(!size) size=1;
+    }
+    return size;
+}
+
+// return the max level for that WxH size
+static int inline maxlevel(int w, int h) {
+    int mlevel = 0;
+    while(w!=1 || h!=1) {
+        w>>=1; h>>=1;
+        if(!w) w=1;
+        if(!h) h=1;
+        ++mlevel;
+    }
+    return mlevel;
+}
+
+static GLsizeiptr copy_size(gltexture_t *tex) {
+    return ((tex->width+3)>>2)*((tex->height+3)>>2)*(tex->res_dxt5?16:8);
+}
+
+static int has_mips(gltexture_t *tex) {
+    return tex->res_mips || tex->mipmap_auto || tex->mipmap_done;
+}
+
+// update the totals with the current state of tex
+static void account(gltexture_t *tex) {
+    GLsizeiptr gpu = 0;
+    if(!tex->res_evicted)
+        gpu = tex->res_base + (has_mips(tex)?tex->res_base/3:0);
+    GLsizeiptr shadow = (tex->data?tex->width*tex->height*4:0) + (tex->res_copy?copy_size(tex):0);
+    texres_t *res = glstate->texres;
+    res->gpu += gpu - tex->res_gpu;
+    res->shadow += shadow - tex->res_shadow;
+    tex->res_gpu = gpu;
+    tex->res_shadow = shadow;
+}
+
+void texres_uploaded(gltexture_t *tex, GLint level, GLsizeiptr size) {
+    if(level) {
+        tex->res_mips = 1;
+    } else {
+        if(tex->res_evicted) {
+            // respecified: the old content is not needed anymore
+            free(tex->res_copy);
+            tex->res_copy = NULL;
+            tex->res_evicted = 0;
+        }
+        tex->res_base = size?size:tex->nwidth*tex->nheight*pixel_sizeof(tex->format, tex->type);
+    }
+    account(tex);
+}
+
+void texres_forget(gltexture_t *tex) {
+    free(tex->res_copy);
+    tex->res_copy = NULL;
+    glstate->texres->gpu -= tex->res_gpu;
+    glstate->texres->shadow -= tex->res_shadow;
+    tex->res_gpu = tex->res_shadow = 0;
+}
+
+void texres_touch(gltexture_t *tex) {
+    tex->res_lru = ++glstate->texres->serial;
+}
+
+// the LIBGL_COPY data is level 0 only if the app never uploaded other levels (each glTexImage2D overwrites it)
+static int copy_is_base(gltexture_t *tex) {
+    return globals4es.texcopydata && tex->data && !tex->res_mips;
+}
+
+static int is_bound(gltexture_t *tex) {
+    for (int a=0; a<hardext.maxtex; a++)
+        for (int j=0; j<ENABLED_TEXTURE_LAST; j++)
+            if(glstate->texture.bound[a][j]==tex)
+                return 1;
+    return 0;
+}
+
+static int evictable(gltexture_t *tex) {
+    // only the plain 2D textures, with a LIBGL_COPY of level 0 or that can be read back thru an FBO
+    return tex->glname && tex->valid && !tex->res_evicted && tex->res_base
+        && tex->target==GL_TEXTURE_2D && (tex->format==GL_RGBA || tex->format==GL_RGB)
+        && (copy_is_base(tex) || (hardext.fbo && tex->type==GL_UNSIGNED_BYTE))
+        && !tex->streamed && !tex->binded_fbo && !tex->shrink && !tex->useratio && !tex->adjust
+        && tex->base_level<=0 && tex->width==tex->nwidth && tex->height==tex->nheight
+        && !is_bound(tex);
+}
+
+// DXTc copy of an RGBA image, edges are replicated in the incomplete blocks
+static GLvoid *compress(const GLuint *src, int w, int h, int dxt5) {
+    const int blocksize = dxt5?16:8;
+    GLubyte *copy = (GLubyte*)malloc(((w+3)>>2)*((h+3)>>2)*blocksize);
+    if(!copy)
+        return NULL;
+    GLubyte *dst = copy;
+    GLuint block[16];
+    for (int y=0; y<h; y+=4)
+        for (int x=0; x<w; x+=4) {
+            for (int i=0; i<16; ++i) {
+                int xx = x+(i&3), yy = y+(i>>2);
+                if(xx>=w) xx = w-1;
+                if(yy>=h) yy = h-1;
+                block[i] = src[xx+yy*w];
+            }
+            stb_compress_dxt_block(dst, (const unsigned char*)block, dxt5, STB_DXT_NORMAL);
+            dst += blocksize;
+        }
+    return copy;
+}
+
+static GLuint *decompress(gltexture_t *tex) {
+    const int w = tex->width, h = tex->height;
+    const int pw = (w+3)&~3, ph = (h+3)&~3;
+    GLuint *img = (GLuint*)malloc(pw*ph*4);
+    if(!img)
+        return NULL;
+    const GLubyte *src = (const GLubyte*)tex->res_copy;
+    int simpleAlpha = 0, complexAlpha = 0;
+    for (int y=0; y<h; y+=4)
+        for (int x=0; x<w; x+=4) {
+            if(tex->res_dxt5) {
+                DecompressBlockDXT5(x, y, pw, src, 0, &simpleAlpha, &complexAlpha, img);
+                src += 16;
+            } else {
+                DecompressBlockDXT1(x, y, pw, src, 0, &simpleAlpha, &complexAlpha, img);
+                src += 8;
+            }
+        }
+    if(pw!=w)
+        for (int y=1; y<h; ++y)
+            memmove(img+y*w, img+y*pw, w*4);
+    return img;
+}
+
+// level 0 as packed RGBA, thru an FBO, NULL if it cannot be read
+static GLuint *readback(gltexture_t *tex) {
+    LOAD_GLES2_OR_OES(glGenFramebuffers);
+    LOAD_GLES2_OR_OES(glBindFramebuffer);
+    LOAD_GLES2_OR_OES(glFramebufferTexture2D);
+    LOAD_GLES2_OR_OES(glCheckFramebufferStatus);
+    LOAD_GLES2_OR_OES(glDeleteFramebuffers);
+    LOAD_GLES(glReadPixels);
+    LOAD_GLES(glPixelStorei);
+    LOAD_GLES(glGetError);
+    const int w = tex->width, h = tex->height;
+    GLuint *rgba = (GLuint*)malloc(w*h*4);
+    if(!rgba)
+        return NULL;
+    GLuint fbo;
+    gles_glGenFramebuffers(1, &fbo);
+    gles_glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gles_glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex->glname, 0);
+    int ok = (gles_glCheckFramebufferStatus(GL_FRAMEBUFFER)==GL_FRAMEBUFFER_COMPLETE);
+    if(ok) {
+        if(glstate->texture.pack_align!=1)
+            gles_glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        gles_glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+        if(glstate->texture.pack_align!=1)
+            gles_glPixelStorei(GL_PACK_ALIGNMENT, glstate->texture.pack_align);
+        ok = (gles_glGetError()==GL_NO_ERROR);
+    }
+    gles_glBindFramebuffer(GL_FRAMEBUFFER, (glstate->fbo.current_fb->id)?glstate->fbo.current_fb->id:glstate->fbo.mainfbo_fbo);
+    gles_glDeleteFramebuffers(1, &fbo);
+    if(!ok) {
+        DBG(printf("texres: cannot read back texture %u, not evicted\n", tex->texture);)
+        free(rgba);
+        return NULL;
+    }
+    return rgba;
+}
+
+// tex is left untouched if it cannot be read back
+static void evict(gltexture_t *tex) {
+    LOAD_GLES(glBindTexture);
+    LOAD_GLES(glTexImage2D);
+    DBG(printf("texres: evicting texture %u (%dx%d, %d bytes)\n", tex->texture, tex->width, tex->height, (int)tex->res_gpu);)
+    const int w = tex->width, h = tex->height;
+    FLUSH_TEXUPLOAD;
+    if(!copy_is_base(tex)) {
+        GLuint *rgba = readback(tex);
+        if(!rgba)
+            return;
+        // DXT1 is enough if all is opaque
+        int dxt5 = 0;
+        if(tex->format==GL_RGBA)
+            for (int i=0; i<w*h && !dxt5; ++i)
+                if((rgba[i]&0xff000000)!=0xff000000)
+                    dxt5 = 1;
+        tex->res_dxt5 = dxt5;
+        tex->res_copy = compress(rgba, w, h, dxt5);
+        free(rgba);
+        if(!tex->res_copy)
+            return;
+    }
+    // free the storage of all the levels, but keep the texture object (and its parameters)
+    const GLuint tmu = glstate->gleshard->active;
+    gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
+    const int n = has_mips(tex)?maxlevel(w, h):0;
+    for (int i=0; i<=n; ++i)
+        gles_glTexImage2D(GL_TEXTURE_2D, i, tex->format, 0, 0, 0, tex->format, tex->type, NULL);
+    gles_glBindTexture(GL_TEXTURE_2D, glstate->actual_tex2d[tmu]);
+    tex->res_evicted = 1;
+    ++glstate->texres->evictions;
+    account(tex);
+}
+
+void texres_restore(gltexture_t *tex, int TMU) {
+    LOAD_GLES(glBindTexture);
+    LOAD_GLES(glTexImage2D);
+    LOAD_GLES(glPixelStorei);
+    DBG(printf("texres: re-uploading texture %u (%dx%d)\n", tex->texture, tex->width, tex->height);)
+    const int w = tex->width, h = tex->height;
+    GLvoid *rgba = (tex->res_copy)?decompress(tex):tex->data;
+    if(!rgba)
+        return;     // keep it evicted, it will be tried again
+    GLvoid *pixels = rgba;
+    if(!pixel_convert(rgba, &pixels, w, h, GL_RGBA, GL_UNSIGNED_BYTE, tex->format, tex->type, 0, 1)) {
+        if(rgba!=tex->data)
+            free(rgba);
+        return;
+    }
+    const GLuint oldactive = glstate->gleshard->active;
+    gleshard_glActiveTexture(GL_TEXTURE0+TMU);
+    if(glstate->actual_tex2d[TMU]!=tex->glname) {
+        gles_glBindTexture(GL_TEXTURE_2D, tex->glname);
+        glstate->actual_tex2d[TMU] = tex->glname;
+    }
+    if(glstate->texture.unpack_align!=1)
+        gles_glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gles_glTexImage2D(GL_TEXTURE_2D, 0, tex->format, w, h, 0, tex->format, tex->type, pixels);
+    // the mipmaps are rebuilt from level 0
+    if(has_mips(tex) || is_mipmap_needed(&tex->sampler)) {
+        int nw = w, nh = h;
+        const int n = maxlevel(nw, nh);
+        GLvoid *mips[MAX_MIPMAP_LEVELS] = {0};
+        if(n && pixel_mipmaps(pixels, mips, n, nw, nh, tex->format, tex->type, 0)) {
+            for (int i=0; i<n; ++i) {
+                nw = nlevel(nw, 1);
+                nh = nlevel(nh, 1);
+                gles_glTexImage2D(GL_TEXTURE_2D, i+1, tex->format, nw, nh, 0, tex->format, tex->type, mips[i]);
+            }
+            tex->res_mips = 1;
+        }
+        free(mips[0]);
+    }
+    if(glstate->texture.unpack_align!=1)
+        gles_glPixelStorei(GL_UNPACK_ALIGNMENT, glstate->texture.unpack_align);
+    gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
+    if(pixels!=rgba)
+        free(pixels);
+    if(rgba!=tex->data)
+        free(rgba);
+    free(tex->res_copy);
+    tex->res_copy = NULL;
+    tex->res_evicted = 0;
+    ++glstate->texres->reloads;
+    account(tex);
+}
+
+static int lru_cmp(const void *a, const void *b) {
+    GLuint la = (*(gltexture_t**)a)->res_lru;
+    GLuint lb = (*(gltexture_t**)b)->res_lru;
+    return (la<lb)?-1:((la>lb)?1:0);
+}
+
+void texres_enforce() {
+    texres_t *res = glstate->texres;
+    if(!globals4es.texbudget || glstate->list.compiling)
+        return;
+    const GLsizeiptr budget = (GLsizeiptr)globals4es.texbudget*1024*1024;
+    if(res->gpu<=budget)
+        return;
+    // the last pass found nothing more to evict, and nothing changed since
+    if(res->gpu==res->stuck_gpu && budget==res->stuck_budget)
+        return;
+    // all the candidates, oldest first
+    khash_t(tex) *list = glstate->texture.list;
+    int n = 0;
+    gltexture_t **candidates = (gltexture_t**)malloc(kh_size(list)*sizeof(gltexture_t*));
+    gltexture_t *tex;
+    if(candidates) {
+        kh_foreach_value(list, tex,
+            if(evictable(tex))
+                candidates[n++] = tex;
+        );
+        qsort(candidates, n, sizeof(gltexture_t*), lru_cmp);
+        for (int i=0; i<n && res->gpu>budget; ++i)
+            evict(candidates[i]);
+        free(candidates);
+    }
+    if(res->gpu>budget) {
+        res->stuck_gpu = res->gpu;
+        res->stuck_budget = budget;
+    }
+}
+
+int texres_getter(GLenum pname, GLfloat *params) {
+    switch(pname) {
+        case GL_TEXBUDGET_GPU_GL4ES:
+            *params = glstate->texres->gpu>>10;
+            break;
+        case GL_TEXBUDGET_SHADOW_GL4ES:
+            *params = glstate->texres->shadow>>10;
+            break;
+        case GL_TEXBUDGET_EVICTED_GL4ES:
+            *params = glstate->texres->evictions;
+            break;
+        case GL_TEXBUDGET_RELOADED_GL4ES:
+            *params = glstate->texres->reloads;
+            break;
+        default:
+            return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,46 @@
+#ifndef _GL4ES_TEXRES_H_
+#define _GL4ES_TEXRES_H_
+
+#include "texture.h"
+
+/*
+  Texture residency (LIBGL_TEXBUDGET)
+
+  The GPU size of each texture (and of its CPU copies) is accounted. When the GPU total goes over the
+  budget, the least recently bound textures get evicted: level 0 is read back and kept as DXTc
+  (or the LIBGL_COPY data is used, if the app didn't upload other levels over it), and the GLES
+  storage of all levels is freed, keeping the texture object and its parameters. An evicted texture is re-uploaded (with its mipmaps) when it's bound
+  again by realize_bound / realize_textures.
+  Level 0 is only read back from an 8 bits RGB/RGBA texture, thru an FBO: if the FBO is not complete
+  or the read fails, the texture is left alone.
+  The budget is enforced after a glTexImage2D and on glBindTexture, never during a draw. When a pass
+  can't get under the budget, the next ones are skipped until the total (or the budget) changes.
+*/
+
+// totals of the textures of a texture list (shared like the list)
+typedef struct {
+    GLsizeiptr  gpu;        // accounted GPU size
+    GLsizeiptr  shadow;     // accounted CPU size (LIBGL_COPY data and DXTc copies)
+    GLuint      evictions;
+    GLuint      reloads;
+    GLuint      serial;     // LRU stamps
+    GLsizeiptr  stuck_gpu;  // gpu and budget when the last pass couldn't get under the budget
+    GLsizeiptr  stuck_budget;
+} texres_t;
+
+// level of tex has been (re)specified, size is the GPU size for compressed ones (0 to compute it)
+void texres_uploaded(gltexture_t *tex, GLint level, GLsizeiptr size);
+// tex is going to be deleted
+void texres_forget(gltexture_t *tex);
+// tex is bound to a texture unit
+void texres_touch(gltexture_t *tex);
+// re-upload evicted tex, it's bound (or will be) on TMU
+void texres_restore(gltexture_t *tex, int TMU);
+// evict textures until the GPU total is back under the budget
+void texres_enforce();
+// residency counters (for glGet), return 0 if pname is not one of them
+int texres_getter(GLenum pname, GLfloat *params);
+
+#define RESTORE_TEXTURE(tex, TMU) if((tex)->res_evicted) texres_restore(tex, TMU)
+
+#endif // _GL4ES_TEXRES_H_
@@ -15,6 +15,8 @@
 #include "matrix.h"
 #include "pixel.h"
 #include "raster.h"
+#include "texres.h"
+#include "texupload.h"
 
 //#define DEBUG
 #ifdef DEBUG
@@ -49,6 +51,20 @@ static int inline nlevel(int size, int level) {
     return size;
 }
 
+// mipmaps of sRGB textures are averaged in linear space (LIBGL_MIPMAPSRGB)
+static int mipmap_srgb(gltexture_t *bound) {
+    if(!globals4es.mipmapsrgb)
+        return 0;
+    switch(bound->wanted_internal) {
+        case GL_SRGB:
+        case GL_SRGB8:
+        case GL_SRGB_ALPHA:
+        case GL_SRGB8_ALPHA8:
+            return 1;
+    }
+    return 0;
+}
+
 // return the max level for that WxH size
 static int inline maxlevel(int w, int h) {
     int mlevel = 0;
@@ -1459,15 +1475,13 @@ void gl4es_glTexImage2D(GLenum target, GLint level, GLint internalformat,
                     bound->mipmap_done = 1;
                 int leveln = level, nw = nwidth, nh = nheight, nww=width, nhh=height;
                 int pot = (nh==nhh && nw==nww);
-                void *ndata = pixels;
-                while(nw!=1 || nh!=1) {
-                    if(pixels) {
-                        GLvoid *out = ndata;
-                        pixel_halfscale(ndata, &out, nww, nhh, format, type);
-                        if (out != ndata && ndata!=pixels)
-                            free(ndata);
-                        ndata = out;
-                    }
+                // the whole chain at once
+                const int n = maxlevel(nw, nh);
+                GLvoid *mips[MAX_MIPMAP_LEVELS] = {0};
+                if(pixels && n && !pixel_mipmaps(pixels, mips, n, nww, nhh, format, type, mipmap_srgb(bound)))
+                    mips[0] = NULL;
+                for (int i=0; i<n; ++i) {
+                    void *ndata = mips[0]?mips[i]:NULL;
                     nw = nlevel(nw, 1);
                     nh = nlevel(nh, 1);
                     nww = nlevel(nww, 1);
@@ -1475,11 +1489,10 @@ void gl4es_glTexImage2D(GLenum target, GLint level, GLint internalformat,
                     ++leveln;
                     gles_glTexImage2D(rtarget, leveln, format, nw, nh, border,
                                     format, type, (pot)?ndata:NULL);
-                    if(!pot && pixels) gles_glTexSubImage2D(rtarget, leveln, 0, 0, nww, nhh,
+                    if(!pot && ndata) gles_glTexSubImage2D(rtarget, leveln, 0, 0, nww, nhh,
                                         format, type, ndata);
                 }
-                if (ndata!=pixels)
-                    free(ndata);
+                free(mips[0]);
             }
         /*if (bound && bound->mipmap_need && !bound->mipmap_auto && (globals4es.automipmap!=3))
             gles_glTexParameteri( rtarget, GL_GENERATE_MIPMAP, GL_FALSE );*/
@@ -1506,6 +1519,10 @@ void gl4es_glTexImage2D(GLenum target, GLint level, GLint internalformat,
         //memset(bound->data, 0, width*height*4);
         }
     }
+    if ((rtarget==GL_TEXTURE_2D) && !bound->streamed) {
+        texres_uploaded(bound, level, 0);
+        texres_enforce();
+    }
     if (pixels != datab) {
         free(pixels);
     }
@@ -1523,7 +1540,15 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
     } else {
         PUSH_IF_COMPILING(glTexSubImage2D);
     }
+    const GLuint itarget = what_target(target);
+    const GLuint rtarget = map_tex_target(target);
+    gltexture_t *bound = glstate->texture.bound[glstate->texture.active][itarget];
+    // converted texels go to the staging arena, and the upload may be merged with the next one
+    const int staging = globals4es.texstaging && rtarget==GL_TEXTURE_2D && !bound->shrink && !bound->useratio
+                        && !(globals4es.texstream && bound->streamed);
+    glstate->texupload.hold = staging;
     realize_bound(glstate->texture.active, target);
+    glstate->texupload.hold = 0;
 
 #ifdef __BIG_ENDIAN__
     if(type==GL_UNSIGNED_INT_8_8_8_8)
@@ -1538,9 +1563,6 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
         datab += (uintptr_t)glstate->vao->unpack->data;
     GLvoid *pixels = (GLvoid*)datab;
 
-    const GLuint itarget = what_target(target);
-    const GLuint rtarget = map_tex_target(target);
-
     LOAD_GLES(glTexSubImage2D);
     LOAD_GLES(glTexParameteri);
     noerrorShim();
@@ -1549,7 +1571,6 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
         return;
     }
     
-    gltexture_t *bound = glstate->texture.bound[glstate->texture.active][itarget];
     if (globals4es.automipmap) {
         if (level>0)
             if ((globals4es.automipmap==1) || (globals4es.automipmap==3) || bound->mipmap_need) {
@@ -1565,9 +1586,17 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
         int imgWidth, pixelSize, dstWidth;
         pixelSize = pixel_sizeof(format, type);
         imgWidth = ((glstate->texture.unpack_row_length)? glstate->texture.unpack_row_length:width) * pixelSize;
-        GLubyte *dst = (GLubyte *)malloc(width * height * pixelSize);
+        GLubyte *dst = NULL;
+        if (staging && format==bound->format && type==bound->type && bound->inter_format==bound->format && bound->inter_type==bound->type) {
+            // nothing else to do on the rows, they can go directly to the arena
+            dstWidth = widthalign(width * pixelSize, glstate->texture.unpack_align);
+            dst = (GLubyte *)texupload_alloc(height * dstWidth);
+        }
+        if (!dst) {
+            dst = (GLubyte *)malloc(width * height * pixelSize);
+            dstWidth = width * pixelSize;
+        }
         pixels = (GLvoid *)dst;
-        dstWidth = width * pixelSize;
         const GLubyte *src = (GLubyte *)datab;
         src += glstate->texture.unpack_skip_pixels * pixelSize + glstate->texture.unpack_skip_rows * imgWidth;
         for (int y = height; y; --y) {
@@ -1593,13 +1622,23 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
     } else  
 #endif
     {
+        const int twopass = (bound->inter_format!=bound->format || bound->inter_type!=bound->type);
+        if (staging && !twopass && (format!=bound->inter_format || type!=bound->inter_type)) {
+            pixels = texupload_alloc(height*widthalign(width*pixel_sizeof(bound->inter_format, bound->inter_type), glstate->texture.unpack_align));
+            if (!pixels)
+                pixels = old;
+        }
         if (!pixel_convert(old, &pixels, width, height, format, type, bound->inter_format, bound->inter_type, 0, glstate->texture.unpack_align)) {
             printf("LIBGL: Error in pixel_convert while glTexSubImage2D\n");
         } else {
             format = bound->inter_format;
             type = bound->inter_type;
-            if(bound->inter_format!=bound->format || bound->inter_type!=bound->type) {
-                GLvoid* pix2 = pixels;
+            if(twopass) {
+                GLvoid* pix2 = NULL;
+                if (staging)
+                    pix2 = texupload_alloc(height*widthalign(width*pixel_sizeof(bound->format, bound->type), glstate->texture.unpack_align));
+                if (!pix2)
+                    pix2 = pixels;
                 if (!pixel_convert(pixels, &pix2, width, height, format, type, bound->format, bound->type, 0, glstate->texture.unpack_align)) {
                     printf("LIBGL: Error in pixel_convert while glTexSubImage2D\n");
                 }
@@ -1681,11 +1720,15 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
     }*/
     } else {
         errorGL();
-        gles_glTexSubImage2D(rtarget, level, xoffset, yoffset,
-                     width, height, format, type, pixels);
+        if (staging)
+            texupload_submit(level, xoffset, yoffset, width, height, format, type, pixels);
+        else
+            gles_glTexSubImage2D(rtarget, level, xoffset, yoffset,
+                         width, height, format, type, pixels);
         DBG(CheckGLError(1);)
         // check if base_level is set... and calculate lower level mipmap
         if(bound->base_level == level && !(bound->max_level==level && level==0)) {
+            FLUSH_TEXUPLOAD;    // the other levels are sent directly
             int leveln = level, nw = width, nh = height, xx=xoffset, yy=yoffset;
             void *ndata = pixels;
             while(leveln) {
@@ -1716,26 +1759,23 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
         if((bound->max_level==bound->base_level) && (bound->base_level==0))
             genmipmap = 0;
         if(genmipmap && (globals4es.automipmap!=3)) {
+            FLUSH_TEXUPLOAD;
             int leveln = level, nw = width, nh = height, xx=xoffset, yy=yoffset;
-            void *ndata = pixels;
-            while(nw!=1 || nh!=1) {
-                if(pixels) {
-                    GLvoid *out = ndata;
-                    pixel_halfscale(ndata, &out, nw, nh, format, type);
-                    if (out != ndata && ndata!=pixels)
-                        free(ndata);
-                    ndata = out;
-                }
+            // the whole chain at once
+            const int n = maxlevel(nw, nh);
+            GLvoid *mips[MAX_MIPMAP_LEVELS] = {0};
+            if(pixels && n && !pixel_mipmaps(pixels, mips, n, nw, nh, format, type, mipmap_srgb(bound)))
+                mips[0] = NULL;
+            for (int i=0; i<n; ++i) {
                 nw = nlevel(nw, 1);
                 nh = nlevel(nh, 1);
                 xx = xx>>1;
                 yy = yy>>1;
                 ++leveln;
                 gles_glTexSubImage2D(rtarget, leveln, xx, yy, nw, nh,
-                                    format, type, ndata);
+                                    format, type, mips[0]?mips[i]:NULL);
             }
-            if (ndata!=pixels)
-                free(ndata);
+            free(mips[0]);
         }
     }
 
@@ -1750,7 +1790,7 @@ void gl4es_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
             printf("LIBGL: Error on pixel_convert while TEXCOPY in glTexSubImage2D\n");
     }
 
-    if (pixels != datab)
+    if (pixels != datab && !texupload_owns(pixels))
         free((GLvoid *)pixels);
 }
 
@@ -154,6 +154,15 @@ typedef struct {
     GLvoid *data;	// in case we want to keep a copy of it (it that case, always RGBA/GL_UNSIGNED_BYTE
     glsampler_t sampler;    // internal sampler if not superceeded by glBindSampler
     glsampler_t actual;     // actual sampler
+    // residency (LIBGL_TEXBUDGET)
+    GLsizeiptr res_base;    // size of level 0 on the GPU
+    GLboolean res_mips;     // other levels have been uploaded
+    GLsizeiptr res_gpu;     // accounted GPU size
+    GLsizeiptr res_shadow;  // accounted CPU size (data and res_copy)
+    GLuint res_lru;         // stamp of the last bind
+    GLboolean res_evicted;  // GLES storage freed, re-uploaded from data or res_copy when bound again
+    GLboolean res_dxt5;     // res_copy is DXT5 (DXT1 else)
+    GLvoid *res_copy;       // DXTc copy of level 0 while evicted (NULL if data is used)
 } gltexture_t;
 
 KHASH_MAP_DECLARE_INT(tex, gltexture_t *);
@@ -256,5 +265,6 @@ int samplerParameterfv(glsampler_t* sampler, GLenum pname, const GLfloat *param)
 int getSamplerParameterfv(glsampler_t* sampler, GLenum pname, GLfloat *params);
 
 void init_sampler(glsampler_t* sampler);
+int is_mipmap_needed(glsampler_t* sampler);
 
 #endif // _GL4ES_TEXTURE_H_
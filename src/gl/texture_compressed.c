@@ -16,6 +16,7 @@
 #include "pixel.h"
 #include "raster.h"
 #include "stb_dxt_104.h"
+#include "texres.h"
 
 //#define DEBUG
 #ifdef DEBUG
@@ -300,24 +301,24 @@ void gl4es_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalfor
             bound->mipmap_need = 1;
             // and upload higher level here...
             int leveln = level, nww=width, nhh=height;
-            void *ndata = pixels;
-            while(nww!=1 || nhh!=1) {
+            // the whole chain at once
+            const int n = maxlevel(nww, nhh);
+            GLvoid *mips[MAX_MIPMAP_LEVELS] = {0};
+            if(half && n && !pixel_mipmaps(pixels, mips, n, nww, nhh, GL_RGBA, GL_UNSIGNED_BYTE, globals4es.mipmapsrgb && isDXTcSRGB(internalformat)))
+                mips[0] = NULL;
+            for (int i=0; i<n; ++i) {
+                void *ndata = mips[0]?mips[i]:pixels;
                 GLvoid *out = ndata;
-                if(half) {  // half can be null if no data...
-                    pixel_halfscale(ndata, &out, nww, nhh, GL_RGBA, GL_UNSIGNED_BYTE);
-                    if (out != ndata && ndata!=pixels)
-                        free(ndata);
-                    ndata = out;
-                }
                 nww = nlevel(nww, 1);
                 nhh = nlevel(nhh, 1);
-                if(half)
+                if(mips[0])   // half can be null if no data...
                     pixel_convert(ndata, &out, nww, nhh, GL_RGBA, GL_UNSIGNED_BYTE, format, type, 0, 1);
                 ++leveln;
                 gl4es_glTexImage2D(target, leveln, new_intformat, nww, nhh, border, format, type, out);
                 if(out!=ndata)
                     free(out);
             }
+            free(mips[0]);
             bound->mipmap_auto = 1;
         }
 
@@ -339,6 +340,10 @@ void gl4es_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalfor
             glstate->fpe_bound_changed = glstate->texture.active+1;
         gles_glCompressedTexImage2D(rtarget, level, internalformat, width, height, border, imageSize, datab);
         errorGL();
+        if (rtarget==GL_TEXTURE_2D) {
+            texres_uploaded(bound, level, imageSize);
+            texres_enforce();
+        }
     }
     glstate->vao->unpack = unpack;
 }
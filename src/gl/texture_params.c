@@ -10,11 +10,13 @@
 #include "fpe.h"
 #include "framebuffers.h"
 #include "gles.h"
+#include "gleshard.h"
 #include "init.h"
 #include "loader.h"
 #include "matrix.h"
 #include "pixel.h"
 #include "raster.h"
+#include "texres.h"
 
 KHASH_MAP_IMPL_INT(tex, gltexture_t *);
 
@@ -192,6 +194,7 @@ void gl4es_glBindTexture(GLenum target, GLuint texture) {
         FLUSH_BEGINEND;
         tex_changed = glstate->texture.active+1;
         glstate->texture.bound[glstate->texture.active][itarget] = tex;
+        texres_touch(tex);
 
         LOAD_GLES(glBindTexture);
         switch(target) {
@@ -215,6 +218,7 @@ void gl4es_glBindTexture(GLenum target, GLuint texture) {
                     glstate->fpe_bound_changed = glstate->texture.active+1;
                 break;
         }
+        texres_enforce();
     }
 }
 int is_mipmap_needed(glsampler_t* sampler)
@@ -367,6 +371,7 @@ void gl4es_glDeleteTextures(GLsizei n, const GLuint *textures) {
     DBG(printf("glDeleteTextures(%d, %p {%d...})\n", n, textures, n?textures[0]:-1);)
     if(!glstate) return;
     FLUSH_BEGINEND;
+    FLUSH_TEXUPLOAD;
     
     noerrorShim();
     LOAD_GLES(glDeleteTextures);
@@ -410,6 +415,7 @@ void gl4es_glDeleteTextures(GLsizei n, const GLuint *textures) {
 #endif
                 #if 1
                 kh_del(tex, list, k);
+                texres_forget(tex);
                 if (tex->data) free(tex->data);
                 free(tex);
                 #else
@@ -469,9 +475,24 @@ void gl4es_glGenTextures(GLsizei n, GLuint * textures) {
     }
 }
 
+static int is_texture_evicted(GLuint texture) {
+    khash_t(tex) *list = glstate->texture.list;
+    khint_t k = kh_get(tex, list, texture);
+    return (k!=kh_end(list)) && kh_value(list, k)->res_evicted;
+}
+
 GLboolean gl4es_glAreTexturesResident(GLsizei n, const GLuint *textures, GLboolean *residences) {
     noerrorShim();
-    return true;
+    // only the textures evicted by LIBGL_TEXBUDGET are not resident
+    int i;
+    for (i=0; i<n; ++i)
+        if(is_texture_evicted(textures[i]))
+            break;
+    if(i==n)
+        return true;    // residences is left untouched then
+    for (i=0; i<n; ++i)
+        residences[i] = is_texture_evicted(textures[i])?GL_FALSE:GL_TRUE;
+    return false;
 }
 
 void gl4es_glGetTexLevelParameterfv(GLenum target, GLint level, GLenum pname, GLfloat *params) {
@@ -698,6 +719,7 @@ void gl4es_glPixelStorei(GLenum pname, GLint param) {
                 errorShim(GL_INVALID_VALUE);
                 return;
             }
+            FLUSH_TEXUPLOAD;    // the pending upload uses the current one
             glstate->texture.unpack_align=param;
             break;
     }
@@ -707,6 +729,8 @@ void gl4es_glPixelStorei(GLenum pname, GLint param) {
 
 // bind the correct texture on Tex2D or TEXCUBE mapper...
 void realize_bound(int TMU, GLenum target) {
+    if(!glstate->texupload.hold)
+        FLUSH_TEXUPLOAD;
     realize_active();
     LOAD_GLES(glBindTexture);
     gltexture_t *tex = glstate->texture.bound[TMU][what_target(target)];
@@ -747,6 +771,7 @@ void realize_bound(int TMU, GLenum target) {
                 if (glstate->bound_changed < TMU+1)
                     glstate->bound_changed = TMU+1;
             }
+            RESTORE_TEXTURE(tex, TMU);
             break;
     }
     // all done
@@ -755,17 +780,12 @@ void realize_bound(int TMU, GLenum target) {
 }
 
 void realize_active() {
-    LOAD_GLES(glActiveTexture);
-    if(glstate->gleshard->active == glstate->texture.active)
-        return;
-    glstate->gleshard->active = glstate->texture.active;
-    gles_glActiveTexture(GL_TEXTURE0 + glstate->gleshard->active);
+    gleshard_glActiveTexture(GL_TEXTURE0 + glstate->texture.active);
 }
 
 void realize_1texture(GLenum target, int TMU, gltexture_t* tex, glsampler_t* sampler)
 {
     DBG(printf("realize_1texture(%s, %d, %p[%u], %p)\n", PrintEnum(target), TMU, tex, tex->glname, sampler);)
-    LOAD_GLES(glActiveTexture);
     LOAD_GLES(glTexParameteri);
     // check sampler stuff
     if(!sampler) sampler = &tex->sampler;
@@ -773,40 +793,28 @@ void realize_1texture(GLenum target, int TMU, gltexture_t* tex, glsampler_t* sam
     param = get_texture_min_filter(tex, sampler);
     if(tex->actual.min_filter!=param) {
         DBG(printf("Adjusting %s[%d]:Texture[%u].min_filter = %s (binded=%u)\n", PrintEnum(target), TMU, tex->glname, PrintEnum(param), glstate->actual_tex2d[TMU]);)
-        if(glstate->gleshard->active!=TMU) {
-            glstate->gleshard->active = TMU;
-            gles_glActiveTexture(GL_TEXTURE0+TMU);
-        }
+        gleshard_glActiveTexture(GL_TEXTURE0+TMU);
         gles_glTexParameteri(target, GL_TEXTURE_MIN_FILTER, param);
         tex->actual.min_filter=param;
     }
     param = sampler->mag_filter;
     if(tex->actual.mag_filter!=param) {
         DBG(printf("Adjusting %s[%d]:Texture[%u].mag_filter = %s (min=%s/%s)\n", PrintEnum(target), TMU, tex->glname, PrintEnum(param), PrintEnum(sampler->min_filter), PrintEnum(tex->actual.min_filter));)
-        if(glstate->gleshard->active!=TMU) {
-            glstate->gleshard->active = TMU;
-            gles_glActiveTexture(GL_TEXTURE0+TMU);
-        }
+        gleshard_glActiveTexture(GL_TEXTURE0+TMU);
         gles_glTexParameteri(target, GL_TEXTURE_MAG_FILTER, param);
         tex->actual.mag_filter=param;
     }
     param = get_texture_wrap_s(tex, sampler);
     if(tex->actual.wrap_s!=param) {
         DBG(printf("Adjusting %s[%d]:Texture[%u].wrap_s = %s\n", PrintEnum(target), TMU, tex->glname, PrintEnum(param));)
-        if(glstate->gleshard->active!=TMU) {
-            glstate->gleshard->active = TMU;
-            gles_glActiveTexture(GL_TEXTURE0+TMU);
-        }
+        gleshard_glActiveTexture(GL_TEXTURE0+TMU);
         gles_glTexParameteri(target, GL_TEXTURE_WRAP_S, param);
         tex->actual.wrap_s=param;
     }
     param = get_texture_wrap_t(tex, sampler);
     if(tex->actual.wrap_t!=param) {
         DBG(printf("Adjusting %s[%d]:Texture[%u].wrap_t = %s\n", PrintEnum(target), TMU, tex->glname, PrintEnum(param));)
-        if(glstate->gleshard->active!=TMU) {
-            glstate->gleshard->active = TMU;
-            gles_glActiveTexture(GL_TEXTURE0+TMU);
-        }
+        gleshard_glActiveTexture(GL_TEXTURE0+TMU);
         gles_glTexParameteri(target, GL_TEXTURE_WRAP_T, param);
         tex->actual.wrap_t=param;
     }
@@ -816,8 +824,8 @@ void realize_textures(int drawing) {
     LOAD_GLES(glEnable);
     LOAD_GLES(glDisable);
     LOAD_GLES(glBindTexture);
-    LOAD_GLES(glActiveTexture);
     LOAD_GLES(glTexParameteri);
+    FLUSH_TEXUPLOAD;
 #ifdef TEXSTREAM
     DBG(printf("realize_textures(%d), glstate->bound_changed=%d, glstate->enable.texture[0]=%X glsate->actual_tex2d[0]=%u / glstate->bound_stream[0]=%u\n", drawing, glstate->bound_changed, glstate->enable.texture[0], glstate->actual_tex2d[0], glstate->bound_stream[0]);)
 #else
@@ -856,10 +864,7 @@ void realize_textures(int drawing) {
                 || (glstate->bound_stream[i] != tex->streamed)
 #endif
             ) {
-                if(glstate->gleshard->active!=i) {
-                    glstate->gleshard->active = i;
-                    gles_glActiveTexture(GL_TEXTURE0+i);
-                }
+                gleshard_glActiveTexture(GL_TEXTURE0+i);
 #ifdef TEXSTREAM
                 int streamed = tex->streamed;
                 int streamingID = tex->streamingID;
@@ -887,6 +892,7 @@ void realize_textures(int drawing) {
                 gles_glBindTexture(GL_TEXTURE_2D, t);
                 glstate->actual_tex2d[i] = t;
             }
+            RESTORE_TEXTURE(tex, i);
         }
         // check, if drawing, if mipmap needs some special care...
         if(drawing) {
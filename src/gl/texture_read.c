@@ -165,6 +165,7 @@ void gl4es_glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint
 void gl4es_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid * data) {
     DBG(printf("glReadPixels(%i, %i, %i, %i, %s, %s, 0x%p)\n", x, y, width, height, PrintEnum(format), PrintEnum(type), data);)
     FLUSH_BEGINEND;
+    FLUSH_TEXUPLOAD;
     if (glstate->list.compiling && glstate->list.active) {
         errorShim(GL_INVALID_OPERATION);
         return;	// never in list
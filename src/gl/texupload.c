@@ -0,0 +1,139 @@
+#include "texupload.h"
+
+#include "../config.h"
+#include "../glx/hardext.h"
+#include "buffers.h"
+#include "enum_info.h"
+#include "gl4es.h"
+#include "gleshard.h"
+#include "glstate.h"
+#include "init.h"
+#include "loader.h"
+#include "pixel.h"
+
+//#define DEBUG
+#ifdef DEBUG
+#define DBG(a) a
+#else
+#define DBG(a)
+#endif
+
+GLvoid *texupload_alloc(GLsizeiptr size) {
+    texupload_t *t = &glstate->texupload;
+    if(!globals4es.texstaging || size>TEXUPLOAD_ARENA_MAX)
+        return NULL;
+    // start on the unpack alignment, so the rows of 2 uploads are contiguous
+    GLsizeiptr start = widthalign(t->used, glstate->texture.unpack_align);
+    if(start+size>t->cap) {
+        // only the pending upload can be in the arena at this point
+        FLUSH_TEXUPLOAD;
+        t->used = start = 0;
+        if(size>t->cap) {
+            GLsizeiptr cap = t->cap?t->cap:TEXUPLOAD_ARENA_MIN;
+            while(cap<size)
+                cap *= 2;
+            if(cap>TEXUPLOAD_ARENA_MAX)
+                cap = TEXUPLOAD_ARENA_MAX;
+            GLvoid *raw = malloc(cap+15);
+            if(!raw)
+                return NULL;
+            free(t->raw);
+            t->raw = raw;
+            t->arena = (GLvoid*)widthalign(raw, 16);
+            t->cap = cap;
+            DBG(printf("texupload: arena is now %d bytes\n", (int)cap);)
+        }
+    }
+    t->used = start+size;
+    return t->arena+start;
+}
+
+int texupload_owns(const GLvoid *ptr) {
+    texupload_t *t = &glstate->texupload;
+    return t->arena && ptr>=t->arena && ptr<t->arena+t->cap;
+}
+
+// send to the GL_TEXTURE_2D bound on the active TMU, thru the ring PBO if there is one
+static void texupload_send(GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                           GLenum format, GLenum type, const GLvoid *data, GLsizeiptr size) {
+    LOAD_GLES(glTexSubImage2D);
+    if(hardext.pbo && globals4es.texstaging==1 && data) {
+        GLintptr offset = gl4es_stream_unpack(size, data);
+        if(offset>=0) {
+            gles_glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, (const GLvoid*)offset);
+            bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // everything else still uploads from client memory
+            return;
+        }
+    }
+    gles_glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, data);
+}
+
+// bytes really read by GLES (the last row is not padded)
+static GLsizeiptr upload_size(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint align) {
+    GLsizeiptr row = width*pixel_sizeof(format, type);
+    return (height-1)*widthalign(row, align) + row;
+}
+
+void texupload_submit(GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                      GLenum format, GLenum type, const GLvoid *pixels) {
+    texupload_t *t = &glstate->texupload;
+    const GLint align = glstate->texture.unpack_align;
+    const GLuint texture = glstate->actual_tex2d[glstate->texture.active];
+    if(!texupload_owns(pixels)) {
+        // client memory (or a temporary buffer), it cannot be kept
+        FLUSH_TEXUPLOAD;
+        texupload_send(level, xoffset, yoffset, width, height, format, type, pixels, upload_size(width, height, format, type, align));
+        return;
+    }
+    const GLsizeiptr size = height*widthalign(width*pixel_sizeof(format, type), align);
+    if(t->pending && t->texture==texture && t->level==level && t->format==format && t->type==type && t->align==align
+        && t->x==xoffset && t->width==width && t->y+t->height==yoffset && t->data+t->size==pixels) {
+        // the rows just below the pending ones: merged
+        DBG(printf("texupload: merging %dx%d at (%d,%d) with the pending %dx%d\n", width, height, xoffset, yoffset, t->width, t->height);)
+        t->height += height;
+        t->size += size;
+        return;
+    }
+    GLsizeiptr used = t->used;
+    FLUSH_TEXUPLOAD;
+    t->used = used;
+    t->pending = 1;
+    t->texture = texture;
+    t->tmu = glstate->texture.active;
+    t->level = level;
+    t->x = xoffset;
+    t->y = yoffset;
+    t->width = width;
+    t->height = height;
+    t->format = format;
+    t->type = type;
+    t->align = align;
+    t->data = (GLvoid*)pixels;
+    t->size = size;
+}
+
+void texupload_flush() {
+    texupload_t *t = &glstate->texupload;
+    if(!t->pending)
+        return;
+    t->pending = 0;
+    DBG(printf("texupload: sending %dx%d at (%d,%d) level %d of texture %u\n", t->width, t->height, t->x, t->y, t->level, t->texture);)
+    LOAD_GLES(glBindTexture);
+    // the texture may not be the one bound anymore
+    const GLuint oldactive = glstate->gleshard->active;
+    const GLuint bound = glstate->actual_tex2d[t->tmu];
+    gleshard_glActiveTexture(GL_TEXTURE0+t->tmu);
+    if(bound!=t->texture)
+        gles_glBindTexture(GL_TEXTURE_2D, t->texture);
+    texupload_send(t->level, t->x, t->y, t->width, t->height, t->format, t->type, t->data,
+                   upload_size(t->width, t->height, t->format, t->type, t->align));
+    if(bound!=t->texture)
+        gles_glBindTexture(GL_TEXTURE_2D, bound);
+    gleshard_glActiveTexture(GL_TEXTURE0+oldactive);
+    t->used = 0;
+}
+
+void texupload_free(texupload_t *texupload) {
+    free(texupload->raw);
+    memset(texupload, 0, sizeof(texupload_t));
+}
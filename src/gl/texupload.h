@@ -0,0 +1,50 @@
+#ifndef _GL4ES_TEXUPLOAD_H_
+#define _GL4ES_TEXUPLOAD_H_
+
+#include "gles.h"
+
+/*
+  Texture upload staging (LIBGL_TEXSTAGING)
+
+  glTexSubImage2D converts the texels in a per context arena, reused from one upload to the other,
+  instead of a fresh malloc'd buffer. The last upload is kept pending in the arena, so the next
+  glTexSubImage2D of the rows just below (same texture, level, format, x and width) is merged with
+  it and both are sent to GLES in one call. Pending uploads are sent before anything that can use
+  the texture (drawing, binding change, read back, ...).
+  On GLES 3 hardware, the data goes thru a ring Pixel Unpack Buffer, so the driver doesn't have to
+  copy it synchronously while the GPU is still rendering.
+*/
+
+typedef struct {
+    GLvoid      *arena;     // aligned arena, converted texels of the pending upload (and of the current one)
+    GLvoid      *raw;       // what has been malloc'd for the arena
+    GLsizeiptr  cap;        // size of the arena
+    GLsizeiptr  used;       // end of the data in use in the arena
+    int         hold;       // don't send the pending upload in realize_bound (glTexSubImage2D is running)
+    // the pending upload
+    int         pending;
+    GLuint      texture;    // GLES name of the texture
+    int         tmu;
+    GLint       level;
+    GLint       x, y;
+    GLsizei     width, height;
+    GLenum      format, type;
+    GLint       align;
+    GLvoid      *data;
+    GLsizeiptr  size;
+} texupload_t;
+
+// space for size bytes of converted texels in the arena (aligned on 16 bytes), NULL if the staging is not used
+GLvoid *texupload_alloc(GLsizeiptr size);
+// is ptr in the arena (so must not be freed)?
+int texupload_owns(const GLvoid *ptr);
+// upload to the texture bound on the active TMU (GL_TEXTURE_2D), merged with the pending upload if possible
+void texupload_submit(GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                      GLenum format, GLenum type, const GLvoid *pixels);
+// send the pending upload, if any
+void texupload_flush();
+void texupload_free(texupload_t *texupload);
+
+#define FLUSH_TEXUPLOAD if(glstate->texupload.pending) texupload_flush()
+
+#endif // _GL4ES_TEXUPLOAD_H_
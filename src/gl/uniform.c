@@ -13,6 +13,61 @@
 #define DBG(a)
 #endif
 
+// build the dense location table from the uniform hashmap (after a link)
+void FillUniformLoc(program_t *glprogram)
+{
+    free(glprogram->uniformloc);
+    glprogram->uniformloc = NULL;
+    glprogram->uniformloc_size = 0;
+    // locations are given by the driver: usually 0..n-1, but not always
+    int n = kh_size(glprogram->uniform);
+    GLint maxloc = -1;
+    uniform_t *m;
+    kh_foreach_value(glprogram->uniform, m,
+        if((GLint)m->id > maxloc) maxloc = m->id;
+    )
+    if(maxloc<0 || maxloc>=4*n+64)
+        return; // empty or too sparse, stay with the hashmap
+    glprogram->uniformloc_size = maxloc+1;
+    glprogram->uniformloc = (uniformloc_t*)malloc(glprogram->uniformloc_size*sizeof(uniformloc_t));
+    for (int i=0; i<glprogram->uniformloc_size; ++i)
+        glprogram->uniformloc[i].id = -1;
+    kh_foreach_value(glprogram->uniform, m,
+        uniformloc_t *u = glprogram->uniformloc + m->id;
+        u->id = m->id;
+        u->type = m->type;
+        u->size = m->size;
+        u->cache_offs = m->cache_offs;
+    )
+}
+
+// a uniform (count elements, stride bytes apart) got a new value in the cache
+static inline void uniform_changed(uniformcache_t *cache, GLuint offs, int count, int stride)
+{
+    GLuint serial = ++cache->serial;
+    for (int i=0; i<count; ++i)
+        cache->gen[(offs+i*stride)>>2] = serial;
+}
+
+// uniform at location, from the dense table, or from the hashmap (filling tmp) if there is none
+static inline uniformloc_t* findUniformLoc(program_t *glprogram, GLint location, uniformloc_t *tmp)
+{
+    if(glprogram->uniformloc) {
+        if(location<0 || location>=glprogram->uniformloc_size || glprogram->uniformloc[location].id==-1)
+            return NULL;
+        return glprogram->uniformloc+location;
+    }
+    khint_t k = kh_get(uniformlist, glprogram->uniform, location);
+    if (k==kh_end(glprogram->uniform))
+        return NULL;
+    uniform_t *m = kh_value(glprogram->uniform, k);
+    tmp->id = m->id;
+    tmp->type = m->type;
+    tmp->size = m->size;
+    tmp->cache_offs = m->cache_offs;
+    return tmp;
+}
+
 int uniformsize(GLenum type) {
     #define GO(T, t, s) \
         case T: return sizeof(t)*s
@@ -110,13 +165,11 @@ void gl4es_glGetUniformfv(GLuint program, GLint location, GLfloat *params) {
     FLUSH_BEGINEND;
     CHECK_PROGRAM(void, program);
 
-    khint_t k;
-    uniform_t *gluniform = NULL;
-    k = kh_get(uniformlist, glprogram->uniform, k);
-    if(k!=kh_end(glprogram->uniform)) {
-        gluniform = kh_value(glprogram->uniform, k);
+    uniformloc_t loc;
+    uniformloc_t *gluniform = findUniformLoc(glprogram, location, &loc);
+    if(gluniform) {
         uintptr_t offs = gluniform->cache_offs;
-        int size = gluniform->cache_size;
+        int size = uniformsize(gluniform->type);   // only the element at location
         if(is_uniform_float(gluniform->type)) {
             memcpy(params, glprogram->cache.cache+offs, size);
             noerrorShim();
@@ -137,13 +190,11 @@ void gl4es_glGetUniformiv(GLuint program, GLint location, GLint *params) {
     FLUSH_BEGINEND;
     CHECK_PROGRAM(void, program);
 
-    khint_t k;
-    uniform_t *gluniform = NULL;
-    k = kh_get(uniformlist, glprogram->uniform, k);
-    if(k!=kh_end(glprogram->uniform)) {
-        gluniform = kh_value(glprogram->uniform, k);
+    uniformloc_t loc;
+    uniformloc_t *gluniform = findUniformLoc(glprogram, location, &loc);
+    if(gluniform) {
         uintptr_t offs = gluniform->cache_offs;
-        int size = gluniform->cache_size;
+        int size = uniformsize(gluniform->type);   // only the element at location
         if(is_uniform_int(gluniform->type)) {
             memcpy(params, glprogram->cache.cache+offs, size);
             noerrorShim();
@@ -172,14 +223,12 @@ void GoUniformfv(program_t *glprogram, GLint location, int size, int count, cons
         return;
     }
 
-    khint_t k;
-    uniform_t *m;
-    k = kh_get(uniformlist, glprogram->uniform, location);
-    if (k==kh_end(glprogram->uniform)) {
+    uniformloc_t loc;
+    uniformloc_t *m = findUniformLoc(glprogram, location, &loc);
+    if (!m) {
         errorShim(GL_INVALID_OPERATION);
         return;
     }
-    m = kh_value(glprogram->uniform, k);
     if(size != n_uniform(m->type) || !is_uniform_float(m->type) || count>m->size) {
         errorShim(GL_INVALID_OPERATION);
         return;
@@ -192,6 +241,7 @@ void GoUniformfv(program_t *glprogram, GLint location, int size, int count, cons
     }
     // update uniform
     memcpy(glprogram->cache.cache + m->cache_offs, value, rsize);
+    uniform_changed(&glprogram->cache, m->cache_offs, count, rsize/count);
     LOAD_GLES2(glUniform1fv);
     LOAD_GLES2(glUniform2fv);
     LOAD_GLES2(glUniform3fv);
@@ -219,14 +269,12 @@ void GoUniformiv(program_t *glprogram, GLint location, int size, int count, cons
         return;
     }
 
-    khint_t k;
-    uniform_t *m;
-    k = kh_get(uniformlist, glprogram->uniform, location);
-    if (k==kh_end(glprogram->uniform)) {
+    uniformloc_t loc;
+    uniformloc_t *m = findUniformLoc(glprogram, location, &loc);
+    if (!m) {
         errorShim(GL_INVALID_OPERATION);
         return;
     }
-    m = kh_value(glprogram->uniform, k);
     if(size != n_uniform(m->type) || !is_uniform_int(m->type)  || count>m->size) {
         errorShim(GL_INVALID_OPERATION);
         return;
@@ -240,6 +288,7 @@ void GoUniformiv(program_t *glprogram, GLint location, int size, int count, cons
     DBG(printf("Uniform updated, cache=%p(%d/%d), offset=%p, size=%d\n", glprogram->cache.cache, glprogram->cache.size, glprogram->cache.cap, m->cache_offs, rsize);)
     // update uniform
     memcpy(glprogram->cache.cache + m->cache_offs, value, rsize);
+    uniform_changed(&glprogram->cache, m->cache_offs, count, rsize/count);
     LOAD_GLES2(glUniform1iv);
     LOAD_GLES2(glUniform2iv);
     LOAD_GLES2(glUniform3iv);
@@ -531,14 +580,12 @@ void GoUniformMatrix2fv(program_t *glprogram, GLint location, GLsizei count, GLb
         errorShim(GL_INVALID_VALUE);
         return;
     }
-    khint_t k;
-    uniform_t *m;
-    k = kh_get(uniformlist, glprogram->uniform, location);
-    if (k==kh_end(glprogram->uniform)) {
+    uniformloc_t loc;
+    uniformloc_t *m = findUniformLoc(glprogram, location, &loc);
+    if (!m) {
         errorShim(GL_INVALID_OPERATION);
         return;
     }
-    m = kh_value(glprogram->uniform, k);
     if(m->type!=GL_FLOAT_MAT2  || count>m->size) {
         errorShim(GL_INVALID_OPERATION);
         return;
@@ -562,6 +609,7 @@ void GoUniformMatrix2fv(program_t *glprogram, GLint location, GLsizei count, GLb
     }
     // update uniform
     memcpy(glprogram->cache.cache + m->cache_offs, v, rsize);
+    uniform_changed(&glprogram->cache, m->cache_offs, count, rsize/count);
     LOAD_GLES2(glUniformMatrix2fv);
     if (gles_glUniformMatrix2fv) {
         gles_glUniformMatrix2fv(m->id, count, GL_FALSE, v);
@@ -597,14 +645,12 @@ void GoUniformMatrix3fv(program_t *glprogram, GLint location, GLsizei count, GLb
         errorShim(GL_INVALID_VALUE);
         return;
     }
-    khint_t k;
-    uniform_t *m;
-    k = kh_get(uniformlist, glprogram->uniform, location);
-    if (k==kh_end(glprogram->uniform)) {
+    uniformloc_t loc;
+    uniformloc_t *m = findUniformLoc(glprogram, location, &loc);
+    if (!m) {
         errorShim(GL_INVALID_OPERATION);
         return;
     }
-    m = kh_value(glprogram->uniform, k);
     if(m->type!=GL_FLOAT_MAT3  || count>m->size) {
         errorShim(GL_INVALID_OPERATION);
         return;
@@ -628,6 +674,7 @@ void GoUniformMatrix3fv(program_t *glprogram, GLint location, GLsizei count, GLb
     }
     // update uniform
     memcpy(glprogram->cache.cache + m->cache_offs, v, rsize);
+    uniform_changed(&glprogram->cache, m->cache_offs, count, rsize/count);
     LOAD_GLES2(glUniformMatrix3fv);
     if (gles_glUniformMatrix3fv) {
         gles_glUniformMatrix3fv(m->id, count, GL_FALSE, v);
@@ -661,14 +708,12 @@ void GoUniformMatrix4fv(program_t *glprogram, GLint location, GLsizei count, GLb
         errorShim(GL_INVALID_VALUE);
         return;
     }
-    khint_t k;
-    uniform_t *m;
-    k = kh_get(uniformlist, glprogram->uniform, location);
-    if (k==kh_end(glprogram->uniform)) {
+    uniformloc_t loc;
+    uniformloc_t *m = findUniformLoc(glprogram, location, &loc);
+    if (!m) {
         errorShim(GL_INVALID_OPERATION);
         return;
     }
-    m = kh_value(glprogram->uniform, k);
     if(m->type!=GL_FLOAT_MAT4  || count>m->size) {
         errorShim(GL_INVALID_OPERATION);
         return;
@@ -690,6 +735,7 @@ void GoUniformMatrix4fv(program_t *glprogram, GLint location, GLsizei count, GLb
     }
     // update uniform
     memcpy(glprogram->cache.cache + m->cache_offs, v, rsize);
+    uniform_changed(&glprogram->cache, m->cache_offs, count, rsize/count);
     LOAD_GLES2(glUniformMatrix4fv);
     if (gles_glUniformMatrix4fv) {
         gles_glUniformMatrix4fv(m->id, count, GL_FALSE, v);
@@ -707,13 +753,11 @@ int GetUniformi(program_t *glprogram, GLint location)
         return 0;
     }
 
-    khint_t k;
-    uniform_t *m;
-    k = kh_get(uniformlist, glprogram->uniform, location);
-    if (k==kh_end(glprogram->uniform)) {
+    uniformloc_t loc;
+    uniformloc_t *m = findUniformLoc(glprogram, location, &loc);
+    if (!m) {
         return 0;
     }
-    m = kh_value(glprogram->uniform, k);
 
     // ok, grab the value in the cache
     GLint ret;
@@ -9,6 +9,7 @@
 #define skip_glEnable
 #define skip_glIsEnabled
 #define skip_glNormal3f
+#define skip_glPolygonOffset
 
 #define skip_glBindBuffer
 #define skip_glBufferData
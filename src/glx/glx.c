@@ -26,6 +26,7 @@
 #include "../agl/amigaos.h"
 #endif // AMIGAOS4
 #include "../gl/debug.h"
+#include "../gl/fpe_prewarm.h"
 #include "../gl/framebuffers.h"
 #include "../gl/init.h"
 #include "../gl/loader.h"
@@ -1426,6 +1427,7 @@ void gl4es_glXSwapBuffers(Display *display,
     }
     if (glstate->raster.bm_drawing)
         bitmap_flush();
+    fpe_PrewarmPSA(PSA_PREWARM);
     EGLSurface surface = eglSurface;
     int PBuffer = 0;
     {
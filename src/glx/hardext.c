@@ -419,6 +419,9 @@ void GetHardwareExtensions(int notest)
             hardext.glsl300es = 1;
         if(testGLSL("#version 310 es", 1))
             hardext.glsl310es = 1;
+        const char *version = (const char *) gles_glGetString(GL_VERSION);
+        if(version && !strncmp(version, "OpenGL ES 3", 11))
+            hardext.pbo = 1;
     }
     if(hardext.glsl120) {
         SHUT_LOGD("GLSL 120 supported and used\n");
@@ -429,6 +432,9 @@ void GetHardwareExtensions(int notest)
     if(hardext.glsl310es) {
         SHUT_LOGD("GLSL 310 es supported%s\n", hardext.glsl120?"":" and used");
     }
+    if(hardext.pbo) {
+        SHUT_LOGD("Pixel Unpack Buffer (GLES 3) supported\n");
+    }
 
 #ifndef NOEGL
     if(strstr(egl_eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_gl_colorspace")) {
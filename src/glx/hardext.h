@@ -68,6 +68,7 @@ typedef struct _hardext {
     int glsl120;        // does version 120 glsl shader are supported ?
     int glsl300es;      // does version 300es glsl shader are supported ?
     int glsl310es;      // does version 300es glsl shader are supported ?
+    int pbo;            // GLES 3 Pixel Unpack Buffer
 } hardext_t;
 
 extern hardext_t hardext;
@@ -13,7 +13,9 @@ void glXStub(void *x, ...) {
     return;
 }
 
-void *gl4es_glXGetProcAddress(const char *name) {
+void *gl4es_glXGetProcAddress(const char *name);
+
+static void fill_glxprocaddr(khash_t(procaddr) *procs) {
 
 #ifndef NOX11
     // glX calls
@@ -69,6 +71,13 @@ void *gl4es_glXGetProcAddress(const char *name) {
 #endif //NOX11
     _EX(glXGetProcAddress);
     _ARB(glXGetProcAddress);
+}
+
+void *gl4es_glXGetProcAddress(const char *name) {
+    static khash_t(procaddr) *procs = NULL;
+    void *func = lookup_find_once(&procs, fill_glxprocaddr, name);
+    if(func)
+        return func;
 
     return gl4es_GetProcAddress(name);
 }